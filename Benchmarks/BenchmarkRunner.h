@@ -0,0 +1,184 @@
+#pragma once
+
+#include <juce_gui_basics/juce_gui_basics.h>
+#include <Utility/Config.h>
+
+#include <iostream>
+
+// A benchmark runs a piece of code a number of times, and reports how long one call takes
+// Every benchmark is also written to the JSON report, so results can be compared across commits
+struct Benchmark {
+    String name;
+    NamedValueSet parameters;
+
+    // Measured. Called "iterations" times per sample, and the time per call is reported
+    std::function<void()> run;
+
+    // Not measured, called before and after every sample
+    std::function<void()> setUp;
+    std::function<void()> tearDown;
+
+    int iterations = 1;
+};
+
+class BenchmarkRunner {
+public:
+    struct Options {
+        String filter;
+        int numSamples = 10;
+        int maxObjects = 50000;
+        bool hasDisplay = true;
+    };
+
+    explicit BenchmarkRunner(Options benchmarkOptions)
+        : options(std::move(benchmarkOptions))
+    {
+    }
+
+    Options const& getOptions() const { return options; }
+
+    bool isEnabled(String const& name) const
+    {
+        return options.filter.isEmpty() || name.containsIgnoreCase(options.filter);
+    }
+
+    void run(Benchmark const& benchmark)
+    {
+        if (!isEnabled(benchmark.name))
+            return;
+
+        // Warm up caches and lazily initialised state, without recording it
+        sample(benchmark);
+
+        Array<double> samples;
+        for (int i = 0; i < options.numSamples; i++) {
+            samples.add(sample(benchmark) / static_cast<double>(benchmark.iterations));
+        }
+
+        std::sort(samples.begin(), samples.end());
+
+        double mean = 0.0;
+        for (auto s : samples) {
+            mean += s;
+        }
+        mean /= static_cast<double>(samples.size());
+
+        double variance = 0.0;
+        for (auto s : samples) {
+            variance += (s - mean) * (s - mean);
+        }
+
+        auto const median = samples.size() % 2 == 0 ? (samples[samples.size() / 2 - 1] + samples[samples.size() / 2]) / 2.0 : samples[samples.size() / 2];
+        auto const stddev = std::sqrt(variance / static_cast<double>(samples.size()));
+
+        auto* result = new DynamicObject();
+        result->setProperty("name", benchmark.name);
+        result->setProperty("parameters", toVar(benchmark.parameters));
+        result->setProperty("iterations", benchmark.iterations);
+        result->setProperty("samples", samples.size());
+        result->setProperty("min_ms", samples.getFirst());
+        result->setProperty("median_ms", median);
+        result->setProperty("mean_ms", mean);
+        result->setProperty("max_ms", samples.getLast());
+        result->setProperty("stddev_ms", stddev);
+        results.append(var(result));
+
+        std::cout << benchmark.name.paddedRight(' ', 56) << String(median, 4).paddedLeft(' ', 12) << " ms  (min " << String(samples.getFirst(), 4) << ", stddev " << String(stddev, 4) << ")" << std::endl;
+    }
+
+    // Benchmarks that can't run in this environment are still listed, so a missing result doesn't look like a regression
+    void skip(String const& name, String const& reason)
+    {
+        if (!isEnabled(name))
+            return;
+
+        auto* result = new DynamicObject();
+        result->setProperty("name", name);
+        result->setProperty("skipped", reason);
+        results.append(var(result));
+
+        std::cout << name.paddedRight(' ', 56) << "     skipped  (" << reason << ")" << std::endl;
+    }
+
+    var getReport() const
+    {
+        auto* report = new DynamicObject();
+        report->setProperty("version", PLUGDATA_VERSION);
+        report->setProperty("git_hash", PLUGDATA_GIT_HASH);
+        report->setProperty("timestamp", Time::getCurrentTime().toISO8601(true));
+        report->setProperty("os", SystemStats::getOperatingSystemName());
+        report->setProperty("cpu", SystemStats::getCpuModel());
+        report->setProperty("num_cpus", SystemStats::getNumCpus());
+        report->setProperty("results", results);
+        return var(report);
+    }
+
+    bool writeReport(File const& file) const
+    {
+        return file.replaceWithText(JSON::toString(getReport()));
+    }
+
+    // Prints how much the median changed for every benchmark that is also in the baseline report
+    // Returns false if the baseline is missing or isn't a benchmark report
+    bool compareWith(File const& baselineFile) const
+    {
+        if (!baselineFile.existsAsFile()) {
+            std::cerr << "Baseline " << baselineFile.getFullPathName() << " doesn't exist" << std::endl;
+            return false;
+        }
+
+        auto const baseline = JSON::parse(baselineFile);
+        auto const* baselineResults = baseline.isObject() ? baseline["results"].getArray() : nullptr;
+        if (!baselineResults) {
+            std::cerr << "Baseline " << baselineFile.getFullPathName() << " is not a benchmark report" << std::endl;
+            return false;
+        }
+
+        std::cout << std::endl
+                  << "Compared to " << baseline["git_hash"].toString() << ":" << std::endl;
+
+        for (auto const& result : *results.getArray()) {
+            if (!result.hasProperty("median_ms"))
+                continue;
+
+            for (auto const& baselineResult : *baselineResults) {
+                if (baselineResult["name"] == result["name"] && baselineResult.hasProperty("median_ms")) {
+                    auto const before = static_cast<double>(baselineResult["median_ms"]);
+                    auto const after = static_cast<double>(result["median_ms"]);
+                    auto const change = before > 0.0 ? (after - before) / before * 100.0 : 0.0;
+                    std::cout << result["name"].toString().paddedRight(' ', 56) << (change >= 0.0 ? "+" : "") << String(change, 1) << "%" << std::endl;
+                }
+            }
+        }
+    }
+
+private:
+    static double sample(Benchmark const& benchmark)
+    {
+        if (benchmark.setUp)
+            benchmark.setUp();
+
+        auto const start = Time::getHighResolutionTicks();
+        for (int i = 0; i < benchmark.iterations; i++) {
+            benchmark.run();
+        }
+        auto const elapsed = Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - start) * 1000.0;
+
+        if (benchmark.tearDown)
+            benchmark.tearDown();
+
+        return elapsed;
+    }
+
+    static var toVar(NamedValueSet const& values)
+    {
+        auto* object = new DynamicObject();
+        for (auto const& value : values) {
+            object->setProperty(value.name, value.value);
+        }
+        return var(object);
+    }
+
+    Options options;
+    var results = Array<var>();
+};
@@ -0,0 +1,119 @@
+#include <juce_audio_basics/juce_audio_basics.h>
+
+#include <Utility/Config.h>
+#include <FluidLite/include/fluidlite.h>
+
+#include "BenchmarkRunner.h"
+
+// Prefer the GM soundfont that the standalone unpacks, so the benchmark uses a realistic instrument set
+static File getBenchmarkSoundFont()
+{
+    auto generalUser = ProjectInfo::appDataDir.getChildFile("Extra").getChildFile("GS").getChildFile("GeneralUser_GS.sf3");
+    if (generalUser.existsAsFile())
+        return generalUser;
+
+    return File(__FILE__).getParentDirectory().getParentDirectory().getChildFile("Libraries/FluidLite/example/sf_/Boomwhacker.sf2");
+}
+
+struct FluidSynthInstance {
+    FluidSynthInstance(File const& soundFont, int polyphony, double sampleRate = 48000.0)
+    {
+        settings = new_fluid_settings();
+        fluid_settings_setint(settings, "synth.polyphony", polyphony);
+        fluid_settings_setnum(settings, "synth.sample-rate", sampleRate);
+        synth = new_fluid_synth(settings);
+        loaded = fluid_synth_sfload(synth, soundFont.getFullPathName().toRawUTF8(), 1) >= 0;
+    }
+
+    ~FluidSynthInstance()
+    {
+        delete_fluid_synth(synth);
+        delete_fluid_settings(settings);
+    }
+
+    void render(AudioBuffer<float>& buffer)
+    {
+        auto* const* output = buffer.getArrayOfWritePointers();
+        fluid_synth_write_float(synth, buffer.getNumSamples(), output[0], 0, 1, output[1], 0, 1);
+    }
+
+    fluid_settings_t* settings;
+    fluid_synth_t* synth;
+    bool loaded;
+};
+
+// Plays a dense General MIDI arrangement: all 16 channels busy, with chords, drums on channel 10, sustain pedal and pitch bend
+static void renderDenseGeneralMidi(FluidSynthInstance& fluid, double seconds, int blockSize)
+{
+    Random random(42);
+    AudioBuffer<float> buffer(2, blockSize);
+
+    for (int channel = 0; channel < 16; channel++) {
+        if (channel != 9)
+            fluid_synth_program_change(fluid.synth, channel, channel * 8);
+        fluid_synth_cc(fluid.synth, channel, 91, 60); // Reverb send
+        fluid_synth_cc(fluid.synth, channel, 93, 40); // Chorus send
+    }
+
+    auto const numBlocks = static_cast<int>(seconds * 48000.0 / blockSize);
+    for (int block = 0; block < numBlocks; block++) {
+        for (int channel = 0; channel < 16; channel++) {
+            if (random.nextInt(4) == 0) {
+                auto root = 36 + random.nextInt(48);
+                for (auto interval : { 0, 4, 7 }) {
+                    fluid_synth_noteon(fluid.synth, channel, root + interval, 40 + random.nextInt(80));
+                }
+            }
+            if (random.nextInt(4) == 0) {
+                auto root = 36 + random.nextInt(48);
+                for (auto interval : { 0, 4, 7 }) {
+                    fluid_synth_noteoff(fluid.synth, channel, root + interval);
+                }
+            }
+            if (random.nextInt(64) == 0) {
+                fluid_synth_cc(fluid.synth, channel, 64, random.nextBool() ? 127 : 0);
+            }
+            if (random.nextInt(16) == 0) {
+                fluid_synth_pitch_bend(fluid.synth, channel, random.nextInt(16384));
+            }
+        }
+
+        fluid.render(buffer);
+    }
+}
+
+void runInternalSynthBenchmarks(BenchmarkRunner& runner)
+{
+    auto const soundFont = getBenchmarkSoundFont();
+
+    for (auto polyphony : { 64, 256 }) {
+        auto const name = "internalsynth/render/" + String(polyphony);
+        if (!runner.isEnabled(name))
+            continue;
+
+        if (!FluidSynthInstance(soundFont, polyphony).loaded) {
+            runner.skip(name, "couldn't load " + soundFont.getFileName());
+            continue;
+        }
+
+        std::unique_ptr<FluidSynthInstance> fluid;
+
+        // Every sample starts with a fresh synth, so voices from the previous sample don't carry over
+        Benchmark render;
+        render.name = name;
+        render.parameters.set("voices", polyphony);
+        render.parameters.set("seconds", 10);
+        render.parameters.set("soundfont", soundFont.getFileName());
+        render.setUp = [&fluid, &soundFont, polyphony]() {
+            fluid = std::make_unique<FluidSynthInstance>(soundFont, polyphony);
+        };
+        render.run = [&fluid]() {
+            renderDenseGeneralMidi(*fluid, 10.0, 256);
+        };
+        render.tearDown = [&fluid]() {
+            fluid.reset();
+        };
+
+        runner.run(render);
+    }
+}
@@ -0,0 +1,87 @@
+// Workaround for naming issue on windows
+#include <juce_gui_basics/juce_gui_basics.h>
+#define Rectangle juce::Rectangle
+
+#include <PluginProcessor.h>
+
+#include "BenchmarkRunner.h"
+
+extern void runProcessorBenchmarks(BenchmarkRunner& runner, PluginProcessor& processor);
+extern void runPatchBenchmarks(BenchmarkRunner& runner, PluginProcessor& processor);
+extern void runTextEditorBenchmarks(BenchmarkRunner& runner, PluginProcessor& processor);
+extern void runUtilityBenchmarks(BenchmarkRunner& runner);
+extern void runInternalSynthBenchmarks(BenchmarkRunner& runner);
+
+static void printUsage()
+{
+    std::cout << "Usage: plugdata_benchmarks [options]" << std::endl
+              << "  --json <file>        Write results as JSON" << std::endl
+              << "  --compare <file>     Compare results with an earlier JSON report" << std::endl
+              << "  --filter <text>      Only run benchmarks whose name contains this" << std::endl
+              << "  --samples <n>        Number of samples per benchmark (default 10)" << std::endl
+              << "  --max-objects <n>    Skip generated patches larger than this (default 50000)" << std::endl
+              << "  --quick              Fewer samples and smaller patches, for a quick check" << std::endl
+              << "  --headless           Skip benchmarks that need a display, even if there is one" << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+    ArgumentList arguments(argc, argv);
+
+    if (arguments.containsOption("--help|-h")) {
+        printUsage();
+        return 0;
+    }
+
+    ScopedJuceInitialiser_GUI gui;
+
+    BenchmarkRunner::Options options;
+    options.filter = arguments.getValueForOption("--filter");
+
+    if (arguments.containsOption("--quick")) {
+        options.numSamples = 3;
+        options.maxObjects = 5000;
+    }
+    if (arguments.containsOption("--samples"))
+        options.numSamples = jmax(1, arguments.getValueForOption("--samples").getIntValue());
+    if (arguments.containsOption("--max-objects"))
+        options.maxObjects = jmax(1, arguments.getValueForOption("--max-objects").getIntValue());
+
+    // Canvases and connections are components, they can be benchmarked without a window but not without a display
+    options.hasDisplay = !arguments.containsOption("--headless") && Desktop::getInstance().getDisplays().getPrimaryDisplay() != nullptr;
+
+    BenchmarkRunner runner(options);
+
+    {
+        PluginProcessor processor;
+
+        // The object library is loaded asynchronously
+        MessageManager::getInstance()->runDispatchLoopUntil(2000);
+
+        runProcessorBenchmarks(runner, processor);
+        runPatchBenchmarks(runner, processor);
+        runTextEditorBenchmarks(runner, processor);
+
+        processor.patches.clear();
+    }
+
+    runUtilityBenchmarks(runner);
+    runInternalSynthBenchmarks(runner);
+
+    if (arguments.containsOption("--json")) {
+        auto const file = File::getCurrentWorkingDirectory().getChildFile(arguments.getValueForOption("--json"));
+        if (!runner.writeReport(file)) {
+            std::cerr << "Couldn't write " << file.getFullPathName() << std::endl;
+            return 1;
+        }
+        std::cout << std::endl
+                  << "Results written to " << file.getFullPathName() << std::endl;
+    }
+
+    if (arguments.containsOption("--compare")) {
+        if (!runner.compareWith(File::getCurrentWorkingDirectory().getChildFile(arguments.getValueForOption("--compare"))))
+            return 1;
+    }
+
+    return 0;
+}
@@ -0,0 +1,215 @@
+// Workaround for naming issue on windows
+#include <juce_gui_basics/juce_gui_basics.h>
+#define Rectangle juce::Rectangle
+
+#include <PluginProcessor.h>
+#include <PluginEditor.h>
+#include <Canvas.h>
+#include <Connection.h>
+#include <Pd/Library.h>
+
+#include "BenchmarkRunner.h"
+#include "PatchGenerator.h"
+
+static void runLoadAndSaveBenchmarks(BenchmarkRunner& runner, PluginProcessor& processor, int numObjects, File const& patchFile)
+{
+    Benchmark load;
+    load.name = "patch/load/" + String(numObjects);
+    load.parameters.set("objects", numObjects);
+    load.run = [&processor, &patchFile]() {
+        processor.loadPatch(patchFile, nullptr);
+    };
+    load.tearDown = [&processor]() {
+        processor.patches.clear();
+    };
+    runner.run(load);
+
+    auto const names = StringArray { "patch/save/", "patch/getObjects/", "patch/getConnections/" };
+    auto const enabled = std::any_of(names.begin(), names.end(), [&runner, numObjects](auto const& name) { return runner.isEnabled(name + String(numObjects)); });
+    if (!enabled)
+        return;
+
+    auto patch = processor.loadPatch(patchFile, nullptr);
+    auto const saveFile = File::createTempFile(".pd");
+
+    Benchmark save;
+    save.name = "patch/save/" + String(numObjects);
+    save.parameters.set("objects", numObjects);
+    save.run = [&patch, &saveFile]() {
+        patch->savePatch(saveFile);
+    };
+    runner.run(save);
+
+    // What a canvas reads from pd every time it synchronises
+    Benchmark getObjects;
+    getObjects.name = "patch/getObjects/" + String(numObjects);
+    getObjects.parameters.set("objects", numObjects);
+    getObjects.run = [&patch]() {
+        auto objects = patch->getObjects();
+        ignoreUnused(objects);
+    };
+    runner.run(getObjects);
+
+    Benchmark getConnections;
+    getConnections.name = "patch/getConnections/" + String(numObjects);
+    getConnections.parameters.set("objects", numObjects);
+    getConnections.run = [&patch]() {
+        auto connections = patch->getConnections();
+        ignoreUnused(connections);
+    };
+    runner.run(getConnections);
+
+    saveFile.deleteFile();
+    processor.patches.clear();
+}
+
+static void runCanvasBenchmarks(BenchmarkRunner& runner, PluginProcessor& processor, PluginEditor* editor, int numObjects, File const& patchFile)
+{
+    auto const names = StringArray { "canvas/open/", "canvas/performSynchronise/", "canvas/findPath/", "canvas/updatePath/", "canvas/repaint/", "canvas/frame/", "canvas/pan/" };
+    auto const enabled = std::any_of(names.begin(), names.end(), [&runner, numObjects](auto const& name) { return runner.isEnabled(name + String(numObjects)); });
+    if (!enabled)
+        return;
+
+    if (!editor) {
+        for (auto const& name : names) {
+            runner.skip(name + String(numObjects), "no display");
+        }
+        return;
+    }
+
+    auto patch = processor.loadPatch(patchFile, nullptr);
+    std::unique_ptr<Canvas> cnv;
+
+    // Creating the canvas creates all the objects and connections, like opening a patch does
+    Benchmark open;
+    open.name = "canvas/open/" + String(numObjects);
+    open.parameters.set("objects", numObjects);
+    open.run = [&processor, &cnv, editor, &patch]() {
+        processor.lockAudioThread();
+        cnv = std::make_unique<Canvas>(editor, patch);
+        processor.unlockAudioThread();
+    };
+    open.tearDown = [&cnv]() {
+        cnv.reset();
+    };
+    runner.run(open);
+
+    cnv = std::make_unique<Canvas>(editor, patch);
+
+    // Nothing changed in pd, so this measures the cost of checking every object and connection
+    Benchmark synchronise;
+    synchronise.name = "canvas/performSynchronise/" + String(numObjects);
+    synchronise.parameters.set("objects", numObjects);
+    synchronise.parameters.set("connections", cnv->connections.size());
+    synchronise.run = [&cnv]() {
+        cnv->performSynchronise();
+    };
+    runner.run(synchronise);
+
+    Benchmark findPath;
+    findPath.name = "canvas/findPath/" + String(numObjects);
+    findPath.parameters.set("connections", cnv->connections.size());
+    findPath.run = [&cnv]() {
+        for (auto* connection : cnv->connections) {
+            connection->findPath();
+        }
+    };
+    runner.run(findPath);
+
+    Benchmark updatePath;
+    updatePath.name = "canvas/updatePath/" + String(numObjects);
+    updatePath.parameters.set("connections", cnv->connections.size());
+    updatePath.run = [&cnv]() {
+        for (auto* connection : cnv->connections) {
+            connection->updatePath();
+        }
+    };
+    runner.run(updatePath);
+
+    // Render a 4K sized area of the canvas, like a full repaint while panning
+    auto renderTarget = Image(Image::ARGB, 3840, 2160, true);
+    for (auto zoom : { 0.5f, 1.0f, 2.0f }) {
+        cnv->zoomScale = zoom;
+
+        Benchmark repaint;
+        repaint.name = "canvas/repaint/" + String(numObjects) + "/zoom" + String(zoom, 1);
+        repaint.parameters.set("objects", numObjects);
+        repaint.parameters.set("zoom", zoom);
+        repaint.run = [&cnv, &renderTarget, zoom]() {
+            Graphics g(renderTarget);
+            g.addTransform(AffineTransform::translation(-cnv->canvasOrigin.toFloat()).scaled(zoom));
+            g.reduceClipRegion(cnv->canvasOrigin.x, cnv->canvasOrigin.y, static_cast<int>(3840 / zoom), static_cast<int>(2160 / zoom));
+            cnv->paint(g);
+        };
+        runner.run(repaint);
+    }
+
+    // A frame of what the viewport shows, with only the visible objects painted
+    auto* viewport = cnv->viewport.get();
+    viewport->setSize(1920, 1080);
+    for (auto zoom : { 1.0f, 0.3f }) {
+        cnv->zoomScale = zoom;
+
+        Benchmark frame;
+        frame.name = "canvas/frame/" + String(numObjects) + "/zoom" + String(zoom, 1);
+        frame.parameters.set("objects", numObjects);
+        frame.parameters.set("zoom", zoom);
+        frame.run = [viewport]() {
+            viewport->createComponentSnapshot(viewport->getLocalBounds());
+        };
+        runner.run(frame);
+
+        Benchmark pan;
+        pan.name = "canvas/pan/" + String(numObjects) + "/zoom" + String(zoom, 1);
+        pan.parameters.set("objects", numObjects);
+        pan.parameters.set("zoom", zoom);
+        pan.run = [viewport]() {
+            viewport->setViewPosition(viewport->getViewPosition() + Point<int>(37, 23));
+            viewport->createComponentSnapshot(viewport->getLocalBounds());
+        };
+        runner.run(pan);
+    }
+
+    cnv.reset();
+    processor.patches.clear();
+}
+
+static void runLibraryBenchmarks(BenchmarkRunner& runner, PluginProcessor& processor)
+{
+    // What the suggestions show while typing in a new object
+    auto const queries = StringArray { "o", "os", "osc", "metro", "li", "list", "f", "vline~", "zzz" };
+
+    Benchmark autocomplete;
+    autocomplete.name = "library/autocomplete";
+    autocomplete.parameters.set("queries", queries.size());
+    autocomplete.iterations = queries.size();
+    autocomplete.run = [&processor, &queries, i = 0]() mutable {
+        auto suggestions = processor.objectLibrary->autocomplete(queries[i++ % queries.size()], File());
+        ignoreUnused(suggestions);
+    };
+    runner.run(autocomplete);
+}
+
+void runPatchBenchmarks(BenchmarkRunner& runner, PluginProcessor& processor)
+{
+    // Canvases, objects and connections are components that need the editor's look and feel, but not a window
+    std::unique_ptr<AudioProcessorEditor> editor;
+    if (runner.getOptions().hasDisplay)
+        editor.reset(processor.createEditorIfNeeded());
+
+    for (auto numObjects : { 1000, 5000, 20000, 50000 }) {
+        if (numObjects > runner.getOptions().maxObjects)
+            continue;
+
+        TemporaryFile patchFile(".pd");
+        patchFile.getFile().replaceWithText(PatchGenerator::generateControlPatch(numObjects));
+
+        runLoadAndSaveBenchmarks(runner, processor, numObjects, patchFile.getFile());
+        runCanvasBenchmarks(runner, processor, dynamic_cast<PluginEditor*>(editor.get()), numObjects, patchFile.getFile());
+    }
+
+    runLibraryBenchmarks(runner, processor);
+
+    editor.reset();
+    MessageManager::getInstance()->runDispatchLoopUntil(10);
+}
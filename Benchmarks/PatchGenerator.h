@@ -0,0 +1,87 @@
+#pragma once
+
+#include <juce_gui_basics/juce_gui_basics.h>
+#include <Utility/Config.h>
+
+// Generates patches of a given size, so benchmarks don't depend on patches that might change
+namespace PatchGenerator {
+
+// Chains of control objects with a message box on top, laid out on a grid like a large hand-made patch
+// Every chain also has a connection that goes back up, so connection routing has some work to do
+inline String generateControlPatch(int numObjects)
+{
+    static StringArray const chain = { "f", "+ 1", "t f f", "* 2", "moses 100", "- 1", "abs" };
+    int const chainLength = chain.size() + 1;
+    int const chainsPerRow = 40;
+
+    String patch = "#N canvas 0 50 1200 800 12;\n";
+    int index = 0;
+
+    for (int chainIndex = 0; index < numObjects; chainIndex++) {
+        auto const x = 20 + (chainIndex % chainsPerRow) * 120;
+        auto const y = 20 + (chainIndex / chainsPerRow) * chainLength * 30;
+        auto const first = index;
+
+        patch << "#X msg " << x << " " << y << " " << chainIndex << ";\n";
+        index++;
+
+        for (int i = 0; i < chain.size() && index < numObjects; i++) {
+            patch << "#X obj " << x << " " << (y + (i + 1) * 30) << " " << chain[i] << ";\n";
+            patch << "#X connect " << (index - 1) << " 0 " << index << " 0;\n";
+            index++;
+        }
+
+        // [t f f] right outlet into the right inlet of [f]
+        if (index - first > 3)
+            patch << "#X connect " << (first + 3) << " 1 " << (first + 1) << " 1;\n";
+    }
+
+    return patch;
+}
+
+// Oscillators into a filter and the output, with the audio input mixed in
+inline String generateSignalPatch(int numVoices, int numChannels)
+{
+    String patch = "#N canvas 0 50 1200 800 12;\n";
+
+    String outputs, inputs;
+    for (int channel = 1; channel <= numChannels; channel++) {
+        outputs << " " << channel;
+        inputs << " " << channel;
+    }
+
+    patch << "#X obj 20 20 adc~" << inputs << ";\n";
+    patch << "#X obj 20 400 dac~" << outputs << ";\n";
+
+    int index = 2;
+    for (int voice = 0; voice < numVoices; voice++) {
+        auto const x = 20 + voice * 100;
+        patch << "#X obj " << x << " 100 osc~ " << (110 + voice * 55) << ";\n";
+        patch << "#X obj " << x << " 150 *~ 0.01;\n";
+        patch << "#X obj " << x << " 200 lop~ 2000;\n";
+        patch << "#X connect " << index << " 0 " << (index + 1) << " 0;\n";
+        patch << "#X connect " << (index + 1) << " 0 " << (index + 2) << " 0;\n";
+        patch << "#X connect " << (index + 2) << " 0 1 " << (voice % numChannels) << ";\n";
+        index += 3;
+    }
+
+    for (int channel = 0; channel < numChannels; channel++) {
+        patch << "#X connect 0 " << channel << " 1 " << channel << ";\n";
+    }
+
+    return patch;
+}
+
+// Receives a number, increments it and sends it on. The toggle is a target for direct messages
+inline String generateMessagePatch()
+{
+    return "#N canvas 0 50 450 300 12;\n"
+           "#X obj 20 20 r bench_in;\n"
+           "#X obj 20 50 + 1;\n"
+           "#X obj 20 80 s bench_out;\n"
+           "#X obj 20 120 tgl 15 0 empty empty empty 17 7 0 10 #fcfcfc #000000 #000000 0 1;\n"
+           "#X connect 0 0 1 0;\n"
+           "#X connect 1 0 2 0;\n";
+}
+
+}
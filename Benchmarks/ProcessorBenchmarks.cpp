@@ -0,0 +1,175 @@
+// Workaround for naming issue on windows
+#include <juce_gui_basics/juce_gui_basics.h>
+#define Rectangle juce::Rectangle
+
+#include <PluginProcessor.h>
+#include <Pd/MessageListener.h>
+
+#include "BenchmarkRunner.h"
+#include "PatchGenerator.h"
+
+// Enables as many stereo buses as needed for the channel count, the same way a host would
+static int setNumChannels(PluginProcessor& processor, int numChannels)
+{
+    auto layout = processor.getBusesLayout();
+    for (auto* buses : { &layout.inputBuses, &layout.outputBuses }) {
+        int channels = 0;
+        for (auto& bus : *buses) {
+            bus = channels < numChannels ? AudioChannelSet::stereo() : AudioChannelSet::disabled();
+            channels += bus.size();
+        }
+    }
+
+    processor.setBusesLayout(layout);
+    return processor.getTotalNumOutputChannels();
+}
+
+static void runProcessBlockBenchmarks(BenchmarkRunner& runner, PluginProcessor& processor)
+{
+    for (auto numChannels : { 2, 8 }) {
+        auto const actualChannels = setNumChannels(processor, numChannels);
+        auto patch = processor.loadPatch(PatchGenerator::generateSignalPatch(32, actualChannels), nullptr);
+
+        for (auto blockSize : { 64, 256, 1024 }) {
+            auto const name = "processBlock/" + String(actualChannels) + "ch/" + String(blockSize);
+            if (!runner.isEnabled(name))
+                continue;
+
+            processor.prepareToPlay(44100.0, blockSize);
+            processor.startDSP();
+
+            AudioBuffer<float> buffer(actualChannels, blockSize);
+            MidiBuffer midi;
+
+            // About a second of audio per sample, so short blocks aren't dominated by timer resolution
+            Benchmark benchmark;
+            benchmark.name = name;
+            benchmark.parameters.set("channels", actualChannels);
+            benchmark.parameters.set("block_size", blockSize);
+            benchmark.parameters.set("sample_rate", 44100);
+            benchmark.iterations = 44100 / blockSize;
+            benchmark.run = [&processor, &buffer, &midi]() {
+                buffer.clear();
+                midi.clear();
+                processor.processBlock(buffer, midi);
+            };
+
+            runner.run(benchmark);
+            processor.releaseResources();
+        }
+
+        processor.patches.removeAllInstancesOf(patch);
+    }
+
+    setNumChannels(processor, 2);
+}
+
+struct CountingListener : public pd::MessageListener {
+    void receiveMessage(String const& name, int argc, t_atom* argv) override
+    {
+        numMessages++;
+    }
+
+    int numMessages = 0;
+};
+
+static void runMessageBenchmarks(BenchmarkRunner& runner, PluginProcessor& processor)
+{
+    int const numMessages = 1000;
+
+    auto patch = processor.loadPatch(PatchGenerator::generateMessagePatch(), nullptr);
+    auto* toggle = patch->getObjects()[3];
+
+    CountingListener listener;
+    processor.registerMessageListener(toggle, &listener);
+
+    // Like a [receive] in the patch getting messages from outside
+    Benchmark sendFloat;
+    sendFloat.name = "messages/sendFloat";
+    sendFloat.parameters.set("messages", numMessages);
+    sendFloat.iterations = numMessages;
+    sendFloat.run = [&processor, i = 0]() mutable {
+        processor.sendFloat("bench_in", static_cast<float>(i++));
+    };
+    runner.run(sendFloat);
+
+    // What a GUI object does when it's clicked: lock the audio thread, send the message and call the listeners of the object
+    Benchmark directMessage;
+    directMessage.name = "messages/sendDirectMessage";
+    directMessage.parameters.set("messages", numMessages);
+    directMessage.iterations = numMessages;
+    directMessage.run = [&processor, toggle, i = 0]() mutable {
+        processor.sendDirectMessage(toggle, static_cast<float>(i++ % 2));
+    };
+    runner.run(directMessage);
+
+    // Messages from the message thread are queued, and handled on the audio thread before the next block
+    Benchmark queuedMessages;
+    queuedMessages.name = "messages/enqueueFunctionAsync";
+    queuedMessages.parameters.set("messages", numMessages);
+    queuedMessages.iterations = 1;
+    queuedMessages.run = [&processor, numMessages]() {
+        for (int i = 0; i < numMessages; i++) {
+            processor.enqueueFunctionAsync([&processor, i]() {
+                processor.sendFloat("bench_in", static_cast<float>(i));
+            });
+        }
+        processor.sendMessagesFromQueue();
+    };
+    runner.run(queuedMessages);
+
+    processor.unregisterMessageListener(toggle, &listener);
+    processor.patches.removeAllInstancesOf(patch);
+}
+
+static void runStateBenchmarks(BenchmarkRunner& runner, PluginProcessor& processor)
+{
+    for (auto numObjects : { 1000, 10000 }) {
+        if (numObjects > runner.getOptions().maxObjects)
+            continue;
+
+        auto const saveName = "state/getStateInformation/" + String(numObjects);
+        auto const restoreName = "state/setStateInformation/" + String(numObjects);
+        if (!runner.isEnabled(saveName) && !runner.isEnabled(restoreName))
+            continue;
+
+        processor.patches.clear();
+        processor.loadPatch(PatchGenerator::generateControlPatch(numObjects), nullptr);
+
+        MemoryBlock state;
+        processor.getStateInformation(state);
+
+        Benchmark save;
+        save.name = saveName;
+        save.parameters.set("objects", numObjects);
+        save.parameters.set("bytes", static_cast<int64>(state.getSize()));
+        save.run = [&processor]() {
+            MemoryBlock block;
+            processor.getStateInformation(block);
+        };
+        runner.run(save);
+
+        // Restoring reloads all patches, like a host does when a session is opened
+        Benchmark restore;
+        restore.name = restoreName;
+        restore.parameters.set("objects", numObjects);
+        restore.parameters.set("bytes", static_cast<int64>(state.getSize()));
+        restore.run = [&processor, &state]() {
+            processor.setStateInformation(state.getData(), static_cast<int>(state.getSize()));
+        };
+        restore.tearDown = []() {
+            MessageManager::getInstance()->runDispatchLoopUntil(10);
+        };
+        runner.run(restore);
+
+        processor.patches.clear();
+        MessageManager::getInstance()->runDispatchLoopUntil(10);
+    }
+}
+
+void runProcessorBenchmarks(BenchmarkRunner& runner, PluginProcessor& processor)
+{
+    runProcessBlockBenchmarks(runner, processor);
+    runMessageBenchmarks(runner, processor);
+    runStateBenchmarks(runner, processor);
+}
@@ -0,0 +1,156 @@
+// Workaround for naming issue on windows
+#include <juce_gui_basics/juce_gui_basics.h>
+#define Rectangle juce::Rectangle
+
+#include <PluginProcessor.h>
+#include <Utility/Fonts.h>
+#include <Dialogs/TextEditorDialog.h>
+
+#include "BenchmarkRunner.h"
+
+// Lines like the ones that [coll] sends to the text editor
+static String createText(int numLines, int seed)
+{
+    StringArray lines;
+    Random random(seed);
+    for (int i = 0; i < numLines; i++) {
+        lines.add(String(i) + ", " + String(random.nextInt(1000)) + " " + String(random.nextFloat()) + " symbol_" + String(random.nextInt(100)) + ";");
+    }
+    return lines.joinIntoString("\n");
+}
+
+static void runDocumentBenchmarks(BenchmarkRunner& runner, int numLines)
+{
+    auto const text = createText(numLines, 42);
+    auto const chunk = createText(100, 7);
+
+    TextDocument document;
+    document.setFont(Font(15.0f));
+
+    // What [text define] and [coll] do when they send a large document in pieces
+    Benchmark append;
+    append.name = "texteditor/document/appendText/" + String(numLines);
+    append.parameters.set("lines", numLines);
+    append.parameters.set("chunk_lines", 100);
+    append.iterations = 100;
+    append.setUp = [&document, &text]() {
+        // An open editor has already measured the document
+        document.replaceAll(text);
+        document.getBounds();
+    };
+    append.run = [&document, &chunk]() {
+        document.appendText("\n" + chunk);
+    };
+    runner.run(append);
+
+    document.replaceAll(text);
+
+    // Scrolling only lays out the rows that become visible, and measures the document for the scroll range
+    Benchmark scroll;
+    scroll.name = "texteditor/document/scroll/" + String(numLines);
+    scroll.parameters.set("lines", numLines);
+    scroll.parameters.set("pages", 20);
+    scroll.iterations = 20;
+    scroll.setUp = [&document]() {
+        // Setting the font throws away the layout, so every sample starts from a freshly loaded document
+        document.setFont(document.getFont());
+    };
+    scroll.run = [&document, random = Random(1)]() mutable {
+        auto const bounds = document.getBounds();
+        auto const area = Rectangle<float>(0.0f, random.nextFloat() * bounds.getHeight(), 600.0f, 400.0f);
+
+        auto rows = document.findRowsIntersecting(area);
+        auto glyphs = document.findGlyphsIntersecting(area);
+        ignoreUnused(rows, glyphs);
+    };
+    runner.run(scroll);
+
+    // Typing a newline and deleting it again, in the middle of the document
+    Benchmark insert;
+    insert.name = "texteditor/document/insert/" + String(numLines);
+    insert.parameters.set("lines", numLines);
+    insert.iterations = 100;
+    insert.run = [&document, row = numLines / 2]() {
+        Transaction transaction;
+        transaction.selection = Selection(row, 0, row, 0);
+        transaction.content = "new line\n";
+
+        auto const undo = document.fulfill(transaction);
+        document.fulfill(undo);
+    };
+    runner.run(insert);
+}
+
+static void runEditorBenchmarks(BenchmarkRunner& runner, Component* parent, int numLines)
+{
+    auto const names = StringArray { "texteditor/editor/appendText/", "texteditor/editor/paint/" };
+    auto const enabled = std::any_of(names.begin(), names.end(), [&runner, numLines](auto const& name) { return runner.isEnabled(name + String(numLines)); });
+    if (!enabled)
+        return;
+
+    if (!parent) {
+        for (auto const& name : names) {
+            runner.skip(name + String(numLines), "no display");
+        }
+        return;
+    }
+
+    auto const text = createText(numLines, 42);
+    auto const chunk = createText(100, 7);
+
+    // The editor needs the colours of plugdata's look and feel, so it lives inside the plugin editor
+    PlugDataTextEditor editor;
+    parent->addChildComponent(editor);
+    editor.setBounds(0, 0, 600, 400);
+
+    Benchmark append;
+    append.name = names[0] + String(numLines);
+    append.parameters.set("lines", numLines);
+    append.parameters.set("chunk_lines", 100);
+    append.iterations = 100;
+    append.setUp = [&editor, &text]() {
+        editor.setText(text);
+    };
+    append.run = [&editor, &chunk]() {
+        editor.appendText("\n" + chunk);
+    };
+    runner.run(append);
+
+    editor.setText(text);
+
+    // One page down per call, with everything the editor draws for that page
+    Image image(Image::ARGB, editor.getWidth(), editor.getHeight(), true);
+    Benchmark paint;
+    paint.name = names[1] + String(numLines);
+    paint.parameters.set("lines", numLines);
+    paint.parameters.set("width", editor.getWidth());
+    paint.parameters.set("height", editor.getHeight());
+    paint.iterations = 20;
+    paint.setUp = [&editor]() {
+        editor.translateView(0.0f, std::numeric_limits<float>::max());
+    };
+    paint.run = [&editor, &image]() {
+        editor.translateView(0.0f, -static_cast<float>(editor.getHeight()));
+
+        Graphics g(image);
+        editor.paintEntireComponent(g, false);
+    };
+    runner.run(paint);
+
+    parent->removeChildComponent(&editor);
+}
+
+void runTextEditorBenchmarks(BenchmarkRunner& runner, PluginProcessor& processor)
+{
+    std::unique_ptr<AudioProcessorEditor> editor;
+    if (runner.getOptions().hasDisplay)
+        editor.reset(processor.createEditorIfNeeded());
+
+    for (auto numLines : { 10000, 100000 }) {
+        runDocumentBenchmarks(runner, numLines);
+        runEditorBenchmarks(runner, editor.get(), numLines);
+    }
+
+    editor.reset();
+    MessageManager::getInstance()->runDispatchLoopUntil(10);
+}
@@ -0,0 +1,269 @@
+// Workaround for naming issue on windows
+#include <juce_gui_basics/juce_gui_basics.h>
+#include <juce_dsp/juce_dsp.h>
+#define Rectangle juce::Rectangle
+
+#include <Utility/Config.h>
+#include <Utility/StackShadow.h>
+#include <Utility/Limiter.h>
+#include <Utility/SafetyLimiter.h>
+#include <Utility/TextLayoutCache.h>
+#include <Utility/LineRope.h>
+
+#include "BenchmarkRunner.h"
+
+static Image createNoiseImage(Image::PixelFormat format, int width, int height, Random& random)
+{
+    auto image = Image(format, width, height, true, SoftwareImageType());
+    Image::BitmapData data(image, Image::BitmapData::readWrite);
+
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            // Keep ARGB pixels premultiplied, like JUCE expects
+            auto alpha = static_cast<uint8>(random.nextInt(256));
+            auto colour = Colour(static_cast<uint8>(random.nextInt(256)), static_cast<uint8>(random.nextInt(256)), static_cast<uint8>(random.nextInt(256)), alpha);
+            data.setPixelColour(x, y, format == Image::SingleChannel ? Colours::white.withAlpha(alpha) : colour);
+        }
+    }
+
+    return image;
+}
+
+static void runStackBlurBenchmarks(BenchmarkRunner& runner)
+{
+    Random random(42);
+
+    for (auto size : { 64, 256, 1024, 2048 }) {
+        for (auto format : { Image::ARGB, Image::SingleChannel }) {
+            auto const formatName = format == Image::ARGB ? String("argb") : String("bw");
+            auto const source = createNoiseImage(format, size, size, random);
+
+            Image image;
+            auto const copySource = [&image, &source]() {
+                image = source.createCopy();
+            };
+
+            Benchmark scalar;
+            scalar.name = "stackblur/scalar/" + formatName + "/" + String(size);
+            scalar.parameters.set("size", size);
+            scalar.parameters.set("radius", 12);
+            scalar.setUp = copySource;
+            scalar.run = [&image, format]() {
+                if (format == Image::ARGB)
+                    StackShadow::applyStackBlurARGB(image, 12);
+                else
+                    StackShadow::applyStackBlurBW(image, 12);
+            };
+            runner.run(scalar);
+
+            Benchmark vectorised;
+            vectorised.name = "stackblur/vectorised/" + formatName + "/" + String(size);
+            vectorised.parameters.set("size", size);
+            vectorised.parameters.set("radius", 12);
+            vectorised.setUp = copySource;
+            vectorised.run = [&image]() {
+                StackShadow::applyStackBlur(image, 12);
+            };
+            runner.run(vectorised);
+        }
+    }
+}
+
+static AudioBuffer<float> createNoise(int numChannels, int numSamples, float level, Random& random)
+{
+    AudioBuffer<float> buffer(numChannels, numSamples);
+    for (int ch = 0; ch < numChannels; ch++) {
+        for (int n = 0; n < numSamples; n++) {
+            buffer.setSample(ch, n, (random.nextFloat() * 2.0f - 1.0f) * level);
+        }
+    }
+    return buffer;
+}
+
+static void runProtectedModeBenchmarks(BenchmarkRunner& runner)
+{
+    Random random(42);
+
+    constexpr int numChannels = 2;
+    constexpr int blockSize = 512;
+
+    for (auto level : { 0.5f, 2.0f }) {
+        auto const source = createNoise(numChannels, blockSize, level, random);
+        auto const levelName = level < 1.0f ? String("quiet") : String("loud");
+
+        AudioBuffer<float> buffer;
+
+        // The protected mode we had before: a scalar isfinite check and a compressor-style limiter
+        Limiter compressorLimiter;
+        compressorLimiter.prepare({ 48000.0, static_cast<uint32>(blockSize), static_cast<uint32>(numChannels) });
+
+        Benchmark compressor;
+        compressor.name = "protectedmode/compressor/" + levelName;
+        compressor.parameters.set("channels", numChannels);
+        compressor.parameters.set("block_size", blockSize);
+        compressor.iterations = 1000;
+        compressor.run = [&buffer, &source, &compressorLimiter]() {
+            buffer.makeCopyOf(source, true);
+            auto* const* writePtr = buffer.getArrayOfWritePointers();
+            for (int ch = 0; ch < numChannels; ch++) {
+                for (int n = 0; n < blockSize; n++) {
+                    if (!std::isfinite(writePtr[ch][n])) {
+                        writePtr[ch][n] = 0.0f;
+                    }
+                }
+            }
+
+            auto block = dsp::AudioBlock<float>(buffer);
+            compressorLimiter.process(block);
+        };
+        runner.run(compressor);
+
+        SafetyLimiter safetyLimiter;
+        safetyLimiter.prepare(48000.0, blockSize);
+
+        Benchmark safety;
+        safety.name = "protectedmode/safetylimiter/" + levelName;
+        safety.parameters.set("channels", numChannels);
+        safety.parameters.set("block_size", blockSize);
+        safety.iterations = 1000;
+        safety.run = [&buffer, &source, &safetyLimiter]() {
+            buffer.makeCopyOf(source, true);
+            auto* const* writePtr = buffer.getArrayOfWritePointers();
+            for (int ch = 0; ch < numChannels; ch++) {
+                SafetyLimiter::sanitise(writePtr[ch], blockSize);
+            }
+
+            auto block = dsp::AudioBlock<float>(buffer);
+            safetyLimiter.process(block);
+        };
+        runner.run(safety);
+    }
+}
+
+static void runTextLayoutCacheBenchmarks(BenchmarkRunner& runner)
+{
+    // Roughly what a large patch measures and draws when it's opened or zoomed
+    StringArray texts;
+    Random random(42);
+    for (int i = 0; i < 2000; i++) {
+        texts.add("object_" + String(random.nextInt(500)) + " " + String(random.nextInt(1000)));
+    }
+
+    auto const font = Font(15.0f);
+    Image image(Image::ARGB, 200, 40, true);
+
+    Benchmark uncached;
+    uncached.name = "textcache/font";
+    uncached.parameters.set("texts", texts.size());
+    uncached.run = [&texts, &font, &image]() {
+        Graphics g(image);
+        g.setFont(font);
+        for (auto& text : texts) {
+            font.getStringWidth(text);
+            g.drawFittedText(text, Rectangle<int>(0, 0, 200, 20), Justification::centredLeft, 1, 1.0f);
+        }
+    };
+    runner.run(uncached);
+
+    TextLayoutCache::clear();
+
+    Benchmark cached;
+    cached.name = "textcache/cached";
+    cached.parameters.set("texts", texts.size());
+    cached.run = [&texts, &font, &image]() {
+        Graphics g(image);
+        g.setFont(font);
+        for (auto& text : texts) {
+            TextLayoutCache::getStringWidth(text, font);
+            TextLayoutCache::drawFittedText(g, text, Rectangle<int>(0, 0, 200, 20), Justification::centredLeft, 1, 1.0f);
+        }
+    };
+    runner.run(cached);
+}
+
+static void runLineRopeBenchmarks(BenchmarkRunner& runner)
+{
+    // About 3 MB of text, what opening a large [coll] in the text editor looks like
+    StringArray lines;
+    Random random(42);
+    for (int i = 0; i < 100000; i++) {
+        lines.add(String(i) + ", " + String(random.nextInt(1000)) + " " + String(random.nextFloat()) + " symbol_" + String(random.nextInt(100)) + ";");
+    }
+    auto const text = lines.joinIntoString("\n");
+    auto const font = Font(15.0f);
+
+    Benchmark loadArray;
+    loadArray.name = "linerope/load/array";
+    loadArray.parameters.set("lines", lines.size());
+    loadArray.run = [&text]() {
+        Array<String> array;
+        for (auto const& line : StringArray::fromLines(text)) {
+            array.add(line);
+        }
+    };
+    runner.run(loadArray);
+
+    Benchmark loadRope;
+    loadRope.name = "linerope/load/rope";
+    loadRope.parameters.set("lines", lines.size());
+    loadRope.run = [&text]() {
+        LineRope<String> rope;
+        for (auto const& line : StringArray::fromLines(text)) {
+            rope.add(line);
+        }
+    };
+    runner.run(loadRope);
+
+    LineRope<String> rope;
+    Array<String> array;
+    for (auto const& line : lines) {
+        rope.add(line);
+        array.add(line);
+    }
+
+    // Scrolling only lays out the lines that become visible
+    Benchmark scroll;
+    scroll.name = "linerope/scroll";
+    scroll.parameters.set("lines", lines.size());
+    scroll.parameters.set("pages", 20);
+    scroll.run = [&rope, &font]() {
+        Random random(1);
+        for (int page = 0; page < 20; page++) {
+            auto const firstLine = random.nextInt(rope.size() - 40);
+            for (int i = firstLine; i < firstLine + 40; i++) {
+                GlyphArrangement glyphs;
+                glyphs.addLineOfText(font, rope[i], 0.0f, 0.0f);
+            }
+        }
+    };
+    runner.run(scroll);
+
+    // Typing a newline and deleting it again, in the middle of the document
+    Benchmark editArray;
+    editArray.name = "linerope/edit/array";
+    editArray.parameters.set("lines", lines.size());
+    editArray.iterations = 100;
+    editArray.run = [&array]() {
+        array.insert(50000, "new line");
+        array.remove(50000);
+    };
+    runner.run(editArray);
+
+    Benchmark editRope;
+    editRope.name = "linerope/edit/rope";
+    editRope.parameters.set("lines", lines.size());
+    editRope.iterations = 100;
+    editRope.run = [&rope]() {
+        rope.insert(50000, "new line");
+        rope.removeRange(50000, 1);
+    };
+    runner.run(editRope);
+}
+
+void runUtilityBenchmarks(BenchmarkRunner& runner)
+{
+    runStackBlurBenchmarks(runner);
+    runProtectedModeBenchmarks(runner);
+    runTextLayoutCacheBenchmarks(runner);
+    runLineRopeBenchmarks(runner);
+}
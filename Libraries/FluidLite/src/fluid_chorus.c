@@ -423,28 +423,38 @@ fluid_chorus_update(fluid_chorus_t* chorus)
 }
 
 
-void fluid_chorus_processmix(fluid_chorus_t* chorus, fluid_real_t *in,
-			    fluid_real_t *left_out, fluid_real_t *right_out)
+/* Renders one block of the chorus signal into out
+ * The chorus state is copied to local variables first: the delay line
+ * is written for every sample, and the compiler can't know that this
+ * doesn't change the rest of the chorus struct, so it would otherwise
+ * have to reload all of it for every sample. */
+static void fluid_chorus_processblock(fluid_chorus_t* chorus, const fluid_real_t* FLUID_RESTRICT in,
+				      fluid_real_t* FLUID_RESTRICT out)
 {
   int sample_index;
   int i;
-  fluid_real_t d_in, d_out;
+  fluid_real_t d_out;
+
+  fluid_real_t* FLUID_RESTRICT chorusbuf = chorus->chorusbuf;
+  const int* lookup_tab = chorus->lookup_tab;
+  const int number_blocks = chorus->number_blocks;
+  const long modulation_period_samples = chorus->modulation_period_samples;
+  const fluid_real_t level = chorus->level;
+  int counter = chorus->counter;
+  long phase[MAX_CHORUS];
+
+  for (i = 0; i < number_blocks; i++) {
+    phase[i] = chorus->phase[i];
+  }
 
   for (sample_index = 0; sample_index < FLUID_BUFSIZE; sample_index++) {
 
-    d_in = in[sample_index];
     d_out = 0.0f;
 
-# if 0
-    /* Debug: Listen to the chorus signal only */
-    left_out[sample_index]=0;
-    right_out[sample_index]=0;
-#endif
-
     /* Write the current sample into the circular buffer */
-    chorus->chorusbuf[chorus->counter] = d_in;
+    chorusbuf[counter] = in[sample_index];
 
-    for (i = 0; i < chorus->number_blocks; i++) {
+    for (i = 0; i < number_blocks; i++) {
       int ii;
       /* Calculate the delay in subsamples for the delay line of chorus block nr. */
 
@@ -452,8 +462,8 @@ void fluid_chorus_processmix(fluid_chorus_t* chorus, fluid_real_t *in,
        * will always be positive.  It will always include a number of
        * full periods of MAX_SAMPLES*INTERPOLATION_SUBSAMPLES to
        * remain positive at all times. */
-      int pos_subsamples = (INTERPOLATION_SUBSAMPLES * chorus->counter
-			    - chorus->lookup_tab[chorus->phase[i]]);
+      int pos_subsamples = (INTERPOLATION_SUBSAMPLES * counter
+			    - lookup_tab[phase[i]]);
 
       int pos_samples = pos_subsamples/INTERPOLATION_SUBSAMPLES;
 
@@ -467,95 +477,58 @@ void fluid_chorus_processmix(fluid_chorus_t* chorus, fluid_real_t *in,
 
 	/* The & in chorusbuf[...] is equivalent to a division modulo
 	   MAX_SAMPLES, only faster. */
-	d_out += chorus->chorusbuf[pos_samples & MAX_SAMPLES_ANDMASK]
+	d_out += chorusbuf[pos_samples & MAX_SAMPLES_ANDMASK]
 	  * chorus->sinc_table[ii][pos_subsamples];
 
 	pos_samples--;
       };
       /* Cycle the phase of the modulating LFO */
-      chorus->phase[i]++;
-      chorus->phase[i] %= (chorus->modulation_period_samples);
+      if (++phase[i] >= modulation_period_samples) {
+	phase[i] = 0;
+      }
     } /* foreach chorus block */
 
-    d_out *= chorus->level;
-
-    /* Add the chorus sum d_out to output */
-    left_out[sample_index] += d_out;
-    right_out[sample_index] += d_out;
+    out[sample_index] = d_out * level;
 
     /* Move forward in circular buffer */
-    chorus->counter++;
-    chorus->counter %= MAX_SAMPLES;
+    counter = (counter + 1) & MAX_SAMPLES_ANDMASK;
 
   } /* foreach sample */
+
+  for (i = 0; i < number_blocks; i++) {
+    chorus->phase[i] = phase[i];
+  }
+  chorus->counter = counter;
 }
 
-/* Duplication of code ... (replaces sample data instead of mixing) */
-void fluid_chorus_processreplace(fluid_chorus_t* chorus, fluid_real_t *in,
-				fluid_real_t *left_out, fluid_real_t *right_out)
+void fluid_chorus_processmix(fluid_chorus_t* chorus, fluid_real_t *in,
+			    fluid_real_t *left_out, fluid_real_t *right_out)
 {
+  fluid_real_t d_out[FLUID_BUFSIZE];
   int sample_index;
-  int i;
-  fluid_real_t d_in, d_out;
-
-  for (sample_index = 0; sample_index < FLUID_BUFSIZE; sample_index++) {
-
-    d_in = in[sample_index];
-    d_out = 0.0f;
-
-# if 0
-    /* Debug: Listen to the chorus signal only */
-    left_out[sample_index]=0;
-    right_out[sample_index]=0;
-#endif
-
-    /* Write the current sample into the circular buffer */
-    chorus->chorusbuf[chorus->counter] = d_in;
-
-    for (i = 0; i < chorus->number_blocks; i++) {
-      int ii;
-      /* Calculate the delay in subsamples for the delay line of chorus block nr. */
-
-      /* The value in the lookup table is so, that this expression
-       * will always be positive.  It will always include a number of
-       * full periods of MAX_SAMPLES*INTERPOLATION_SUBSAMPLES to
-       * remain positive at all times. */
-      int pos_subsamples = (INTERPOLATION_SUBSAMPLES * chorus->counter
-			    - chorus->lookup_tab[chorus->phase[i]]);
 
-      int pos_samples = pos_subsamples / INTERPOLATION_SUBSAMPLES;
+  fluid_chorus_processblock(chorus, in, d_out);
 
-      /* modulo divide by INTERPOLATION_SUBSAMPLES */
-      pos_subsamples &= INTERPOLATION_SUBSAMPLES_ANDMASK;
-
-      for (ii = 0; ii < INTERPOLATION_SAMPLES; ii++){
-	/* Add the delayed signal to the chorus sum d_out Note: The
-	 * delay in the delay line moves backwards for increasing
-	 * delay!*/
-
-	/* The & in chorusbuf[...] is equivalent to a division modulo
-	   MAX_SAMPLES, only faster. */
-	d_out += chorus->chorusbuf[pos_samples & MAX_SAMPLES_ANDMASK]
-	  * chorus->sinc_table[ii][pos_subsamples];
-
-	pos_samples--;
-      };
-      /* Cycle the phase of the modulating LFO */
-      chorus->phase[i]++;
-      chorus->phase[i] %= (chorus->modulation_period_samples);
-    } /* foreach chorus block */
-
-    d_out *= chorus->level;
+  /* Add the chorus sum d_out to output */
+  for (sample_index = 0; sample_index < FLUID_BUFSIZE; sample_index++) {
+    left_out[sample_index] += d_out[sample_index];
+    right_out[sample_index] += d_out[sample_index];
+  }
+}
 
-    /* Store the chorus sum d_out to output */
-    left_out[sample_index] = d_out;
-    right_out[sample_index] = d_out;
+void fluid_chorus_processreplace(fluid_chorus_t* chorus, fluid_real_t *in,
+				fluid_real_t *left_out, fluid_real_t *right_out)
+{
+  fluid_real_t d_out[FLUID_BUFSIZE];
+  int sample_index;
 
-    /* Move forward in circular buffer */
-    chorus->counter++;
-    chorus->counter %= MAX_SAMPLES;
+  fluid_chorus_processblock(chorus, in, d_out);
 
-  } /* foreach sample */
+  /* Store the chorus sum d_out to output */
+  for (sample_index = 0; sample_index < FLUID_BUFSIZE; sample_index++) {
+    left_out[sample_index] = d_out[sample_index];
+    right_out[sample_index] = d_out[sample_index];
+  }
 }
 
 /* Purpose:
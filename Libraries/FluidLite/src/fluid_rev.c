@@ -107,19 +107,6 @@ fluid_allpass_getfeedback(fluid_allpass* allpass)
   return allpass->feedback;
 }
 
-#define fluid_allpass_process(_allpass, _input) \
-{ \
-  fluid_real_t output; \
-  fluid_real_t bufout; \
-  bufout = _allpass.buffer[_allpass.bufidx]; \
-  output = bufout-_input; \
-  _allpass.buffer[_allpass.bufidx] = _input + (bufout * _allpass.feedback); \
-  if (++_allpass.bufidx >= _allpass.bufsize) { \
-    _allpass.bufidx = 0; \
-  } \
-  _input = output; \
-}
-
 /*  fluid_real_t fluid_allpass_process(fluid_allpass* allpass, fluid_real_t input) */
 /*  { */
 /*    fluid_real_t output; */
@@ -196,17 +183,6 @@ fluid_comb_getfeedback(fluid_comb* comb)
   return comb->feedback;
 }
 
-#define fluid_comb_process(_comb, _input, _output) \
-{ \
-  fluid_real_t _tmp = _comb.buffer[_comb.bufidx]; \
-  _comb.filterstore = (_tmp * _comb.damp2) + (_comb.filterstore * _comb.damp1); \
-  _comb.buffer[_comb.bufidx] = _input + (_comb.filterstore * _comb.feedback); \
-  if (++_comb.bufidx >= _comb.bufsize) { \
-    _comb.bufidx = 0; \
-  } \
-  _output += _tmp; \
-}
-
 /* fluid_real_t fluid_comb_process(fluid_comb* comb, fluid_real_t input) */
 /* { */
 /*    fluid_real_t output; */
@@ -402,79 +378,162 @@ fluid_revmodel_reset(fluid_revmodel_t* rev)
   fluid_revmodel_init(rev);
 }
 
-void
-fluid_revmodel_processreplace(fluid_revmodel_t* rev, fluid_real_t *in,
-			     fluid_real_t *left_out, fluid_real_t *right_out)
+/* Block versions of the comb and allpass filters
+ *
+ * All delay lines are longer than FLUID_BUFSIZE, so a whole block can be
+ * read from a delay line before anything in that block gets written
+ * back. This lets us run each filter over the whole block in turn, with
+ * its state in local variables, instead of visiting every filter for
+ * every sample. For the allpass filters that leaves no dependency
+ * between samples at all, so the compiler can vectorise the loop. The
+ * comb filters still have their one-pole damping filter as a serial
+ * dependency. The summing order is the same as before, so the output
+ * doesn't change. */
+static void
+fluid_comb_processblock(fluid_comb* comb, const fluid_real_t* FLUID_RESTRICT in,
+			fluid_real_t* FLUID_RESTRICT out, int count)
 {
-  int i, k = 0;
-  fluid_real_t outL, outR, input;
+  fluid_real_t filterstore = comb->filterstore;
+  const fluid_real_t damp1 = comb->damp1;
+  const fluid_real_t damp2 = comb->damp2;
+  const fluid_real_t feedback = comb->feedback;
+  int bufidx = comb->bufidx;
+  int k = 0;
+
+  while (k < count) {
+    /* Process up to the end of the delay line, then wrap around */
+    int n = comb->bufsize - bufidx;
+    fluid_real_t* FLUID_RESTRICT delay = comb->buffer + bufidx;
+    int i;
+
+    if (n > count - k) {
+      n = count - k;
+    }
 
-  for (k = 0; k < FLUID_BUFSIZE; k++) {
+    for (i = 0; i < n; i++) {
+      fluid_real_t tmp = delay[i];
+      filterstore = (tmp * damp2) + (filterstore * damp1);
+      delay[i] = in[k + i] + (filterstore * feedback);
+      out[k + i] += tmp;
+    }
 
-    outL = outR = 0;
+    k += n;
+    bufidx += n;
+    if (bufidx >= comb->bufsize) {
+      bufidx = 0;
+    }
+  }
 
-    /* The original Freeverb code expects a stereo signal and 'input'
-     * is set to the sum of the left and right input sample. Since
-     * this code works on a mono signal, 'input' is set to twice the
-     * input sample. */
-    input = (2 * in[k] + DC_OFFSET) * rev->gain;
+  comb->filterstore = filterstore;
+  comb->bufidx = bufidx;
+}
 
-    /* Accumulate comb filters in parallel */
-    for (i = 0; i < numcombs; i++) {
-      fluid_comb_process(rev->combL[i], input, outL);
-      fluid_comb_process(rev->combR[i], input, outR);
-    }
-    /* Feed through allpasses in series */
-    for (i = 0; i < numallpasses; i++) {
-      fluid_allpass_process(rev->allpassL[i], outL);
-      fluid_allpass_process(rev->allpassR[i], outR);
+static void
+fluid_allpass_processblock(fluid_allpass* allpass, fluid_real_t* FLUID_RESTRICT io, int count)
+{
+  const fluid_real_t feedback = allpass->feedback;
+  int bufidx = allpass->bufidx;
+  int k = 0;
+
+  while (k < count) {
+    int n = allpass->bufsize - bufidx;
+    fluid_real_t* FLUID_RESTRICT delay = allpass->buffer + bufidx;
+    int i;
+
+    if (n > count - k) {
+      n = count - k;
     }
 
-    /* Remove the DC offset */
-    outL -= DC_OFFSET;
-    outR -= DC_OFFSET;
+    for (i = 0; i < n; i++) {
+      fluid_real_t bufout = delay[i];
+      fluid_real_t input = io[k + i];
+      delay[i] = input + (bufout * feedback);
+      io[k + i] = bufout - input;
+    }
 
-    /* Calculate output REPLACING anything already there */
-    left_out[k] = outL * rev->wet1 + outR * rev->wet2;
-    right_out[k] = outR * rev->wet1 + outL * rev->wet2;
+    k += n;
+    bufidx += n;
+    if (bufidx >= allpass->bufsize) {
+      bufidx = 0;
+    }
   }
+
+  allpass->bufidx = bufidx;
 }
 
-void
-fluid_revmodel_processmix(fluid_revmodel_t* rev, fluid_real_t *in,
-			 fluid_real_t *left_out, fluid_real_t *right_out)
+/* Runs the reverb over one block, leaving the wet signal in outL and outR */
+static void
+fluid_revmodel_processblock(fluid_revmodel_t* rev, const fluid_real_t* FLUID_RESTRICT in,
+			    fluid_real_t* FLUID_RESTRICT outL, fluid_real_t* FLUID_RESTRICT outR)
 {
-  int i, k = 0;
-  fluid_real_t outL, outR, input;
+  fluid_real_t input[FLUID_BUFSIZE];
+  const fluid_real_t gain = rev->gain;
+  int i, k;
+
+  /* The original Freeverb code expects a stereo signal and 'input'
+   * is set to the sum of the left and right input sample. Since
+   * this code works on a mono signal, 'input' is set to twice the
+   * input sample. */
+  for (k = 0; k < FLUID_BUFSIZE; k++) {
+    input[k] = (2 * in[k] + DC_OFFSET) * gain;
+    outL[k] = 0;
+    outR[k] = 0;
+  }
+
+  /* Accumulate comb filters in parallel */
+  for (i = 0; i < numcombs; i++) {
+    fluid_comb_processblock(&rev->combL[i], input, outL, FLUID_BUFSIZE);
+    fluid_comb_processblock(&rev->combR[i], input, outR, FLUID_BUFSIZE);
+  }
+
+  /* Feed through allpasses in series */
+  for (i = 0; i < numallpasses; i++) {
+    fluid_allpass_processblock(&rev->allpassL[i], outL, FLUID_BUFSIZE);
+    fluid_allpass_processblock(&rev->allpassR[i], outR, FLUID_BUFSIZE);
+  }
 
+  /* Remove the DC offset */
   for (k = 0; k < FLUID_BUFSIZE; k++) {
+    outL[k] -= DC_OFFSET;
+    outR[k] -= DC_OFFSET;
+  }
+}
+
+void
+fluid_revmodel_processreplace(fluid_revmodel_t* rev, fluid_real_t *in,
+			     fluid_real_t *left_out, fluid_real_t *right_out)
+{
+  fluid_real_t outL[FLUID_BUFSIZE];
+  fluid_real_t outR[FLUID_BUFSIZE];
+  const fluid_real_t wet1 = rev->wet1;
+  const fluid_real_t wet2 = rev->wet2;
+  int k;
 
-    outL = outR = 0;
+  fluid_revmodel_processblock(rev, in, outL, outR);
 
-    /* The original Freeverb code expects a stereo signal and 'input'
-     * is set to the sum of the left and right input sample. Since
-     * this code works on a mono signal, 'input' is set to twice the
-     * input sample. */
-    input = (2 * in[k] + DC_OFFSET) * rev->gain;
+  /* Calculate output REPLACING anything already there */
+  for (k = 0; k < FLUID_BUFSIZE; k++) {
+    left_out[k] = outL[k] * wet1 + outR[k] * wet2;
+    right_out[k] = outR[k] * wet1 + outL[k] * wet2;
+  }
+}
 
-    /* Accumulate comb filters in parallel */
-    for (i = 0; i < numcombs; i++) {
-	    fluid_comb_process(rev->combL[i], input, outL);
-	    fluid_comb_process(rev->combR[i], input, outR);
-    }
-    /* Feed through allpasses in series */
-    for (i = 0; i < numallpasses; i++) {
-      fluid_allpass_process(rev->allpassL[i], outL);
-      fluid_allpass_process(rev->allpassR[i], outR);
-    }
+void
+fluid_revmodel_processmix(fluid_revmodel_t* rev, fluid_real_t *in,
+			 fluid_real_t *left_out, fluid_real_t *right_out)
+{
+  fluid_real_t outL[FLUID_BUFSIZE];
+  fluid_real_t outR[FLUID_BUFSIZE];
+  const fluid_real_t wet1 = rev->wet1;
+  const fluid_real_t wet2 = rev->wet2;
+  int k;
 
-    /* Remove the DC offset */
-    outL -= DC_OFFSET;
-    outR -= DC_OFFSET;
+  fluid_revmodel_processblock(rev, in, outL, outR);
 
-    /* Calculate output MIXING with anything already there */
-    left_out[k] += outL * rev->wet1 + outR * rev->wet2;
-    right_out[k] += outR * rev->wet1 + outL * rev->wet2;
+  /* Calculate output MIXING with anything already there */
+  for (k = 0; k < FLUID_BUFSIZE; k++) {
+    left_out[k] += outL[k] * wet1 + outR[k] * wet2;
+    right_out[k] += outR[k] * wet1 + outL[k] * wet2;
   }
 }
 
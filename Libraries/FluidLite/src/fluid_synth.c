@@ -59,6 +59,7 @@ int fluid_synth_set_gen2(fluid_synth_t* synth, int chan,
 static int fluid_synth_initialized = 0;
 static void fluid_synth_init(void);
 static void init_dither(void);
+static fluid_real_t fluid_synth_voice_priority(fluid_synth_t* synth, fluid_voice_t* voice);
 
 static int fluid_synth_sysex_midi_tuning (fluid_synth_t *synth, const char *data,
                                           int len, char *response,
@@ -1798,15 +1799,55 @@ int fluid_synth_set_polyphony(fluid_synth_t* synth, int polyphony)
 {
   int i;
 
+  int j, playing;
+
   if (polyphony < 1 || polyphony > synth->nvoice) {
     return FLUID_FAILED;
   }
 
-  /* turn off any voices above the new limit */
-  for (i = polyphony; i < synth->nvoice; i++) {
-    fluid_voice_t* voice = synth->voice[i];
-    if (_PLAYING(voice)) {
-      fluid_voice_off(voice);
+  /* Count the voices that are still playing, including those above
+     the old limit */
+  playing = 0;
+  for (i = 0; i < synth->nvoice; i++) {
+    if (_PLAYING(synth->voice[i])) {
+      playing++;
+    }
+  }
+
+  /* When lowering the limit, kill the least important voices first
+     (released, sustained, old and quiet voices), instead of simply
+     turning off the voices above the new limit */
+  while (playing > polyphony) {
+    fluid_real_t best_prio = 999999.;
+    int best_voice_index = -1;
+
+    for (i = 0; i < synth->nvoice; i++) {
+      fluid_voice_t* voice = synth->voice[i];
+      if (_PLAYING(voice)) {
+        fluid_real_t this_voice_prio = fluid_synth_voice_priority(synth, voice);
+        if (this_voice_prio < best_prio) {
+          best_voice_index = i;
+          best_prio = this_voice_prio;
+        }
+      }
+    }
+
+    if (best_voice_index < 0) {
+      break;
+    }
+
+    fluid_voice_off(synth->voice[best_voice_index]);
+    playing--;
+  }
+
+  /* Move the surviving voices below the new limit, since the DSP loop
+     only looks at the first 'polyphony' voices */
+  for (i = 0, j = 0; i < synth->nvoice; i++) {
+    if (_PLAYING(synth->voice[i])) {
+      fluid_voice_t* voice = synth->voice[i];
+      synth->voice[i] = synth->voice[j];
+      synth->voice[j] = voice;
+      j++;
     }
   }
 
@@ -1815,6 +1856,22 @@ int fluid_synth_set_polyphony(fluid_synth_t* synth, int polyphony)
   return FLUID_OK;
 }
 
+/*
+ * fluid_synth_get_active_voice_count
+ */
+int fluid_synth_get_active_voice_count(fluid_synth_t* synth)
+{
+  int i, count = 0;
+
+  for (i = 0; i < synth->polyphony; i++) {
+    if (_PLAYING(synth->voice[i])) {
+      count++;
+    }
+  }
+
+  return count;
+}
+
 /*
  * fluid_synth_get_polyphony
  */
@@ -2005,6 +2062,8 @@ fluid_synth_nwrite_float(fluid_synth_t* synth, int len,
 }
 
 
+#define FLUID_PROCESS_STACK_CHANNELS 16
+
 int fluid_synth_process(fluid_synth_t* synth, int len,
 		       int nin, float** in,
 		       int nout, float** out)
@@ -2013,17 +2072,25 @@ int fluid_synth_process(fluid_synth_t* synth, int len,
     return fluid_synth_write_float(synth, len, out[0], 0, 1, out[1], 0, 1);
   }
   else {
-    float **left, **right;
+    /* This is usually called from the audio thread, so avoid
+       allocating the channel pointer arrays unless there are a lot of
+       channels */
+    float *left_stack[FLUID_PROCESS_STACK_CHANNELS], *right_stack[FLUID_PROCESS_STACK_CHANNELS];
+    float **left = left_stack, **right = right_stack;
     int i;
-    left = FLUID_ARRAY(float*, nout/2);
-    right = FLUID_ARRAY(float*, nout/2);
+    if (nout/2 > FLUID_PROCESS_STACK_CHANNELS) {
+      left = FLUID_ARRAY(float*, nout/2);
+      right = FLUID_ARRAY(float*, nout/2);
+    }
     for(i=0; i<nout/2; i++) {
       left[i] = out[2*i];
       right[i] = out[2*i+1];
     }
     fluid_synth_nwrite_float(synth, len, left, right, NULL, NULL);
-    FLUID_FREE(left);
-    FLUID_FREE(right);
+    if (left != left_stack) {
+      FLUID_FREE(left);
+      FLUID_FREE(right);
+    }
     return 0;
   }
 }
@@ -2037,7 +2104,7 @@ fluid_synth_write_float(fluid_synth_t* synth, int len,
 		       void* lout, int loff, int lincr,
 		       void* rout, int roff, int rincr)
 {
-  int i, j, k, l;
+  int i, j, k, l, m, n;
   float* left_out = (float*) lout;
   float* right_out = (float*) rout;
   fluid_real_t* left_in = synth->left_buf[0];
@@ -2050,15 +2117,36 @@ fluid_synth_write_float(fluid_synth_t* synth, int len,
 
   l = synth->cur;
 
-  for (i = 0, j = loff, k = roff; i < len; i++, l++, j += lincr, k += rincr) {
+  for (i = 0, j = loff, k = roff; i < len; i += n, l += n, j += n * lincr, k += n * rincr) {
     /* fill up the buffers as needed */
-      if (l == FLUID_BUFSIZE) {
-	fluid_synth_one_block(synth, 0);
-	l = 0;
-      }
+    if (l == FLUID_BUFSIZE) {
+      fluid_synth_one_block(synth, 0);
+      l = 0;
+    }
 
-      left_out[j] = (float) left_in[l];
-      right_out[k] = (float) right_in[l];
+    /* copy what's left of the internal buffer in one go */
+    n = FLUID_BUFSIZE - l;
+    if (n > len - i) {
+      n = len - i;
+    }
+
+    if ((lincr == 1) && (rincr == 1)) {
+      /* non-interleaved output, this loop can be vectorised */
+      float* FLUID_RESTRICT lo = left_out + j;
+      float* FLUID_RESTRICT ro = right_out + k;
+      const fluid_real_t* FLUID_RESTRICT li = left_in + l;
+      const fluid_real_t* FLUID_RESTRICT ri = right_in + l;
+
+      for (m = 0; m < n; m++) {
+	lo[m] = (float) li[m];
+	ro[m] = (float) ri[m];
+      }
+    } else {
+      for (m = 0; m < n; m++) {
+	left_out[j + m * lincr] = (float) left_in[l + m];
+	right_out[k + m * rincr] = (float) right_in[l + m];
+      }
+    }
   }
 
   synth->cur = l;
@@ -2337,8 +2425,36 @@ fluid_synth_free_voice_by_kill(fluid_synth_t* synth)
       return voice;
     }
 
-    /* Determine, how 'important' a voice is.
-     * Start with an arbitrary number */
+    this_voice_prio = fluid_synth_voice_priority(synth, voice);
+
+    /* check if this voice has less priority than the previous candidate. */
+    if (this_voice_prio < best_prio)
+      best_voice_index = i,
+      best_prio = this_voice_prio;
+  }
+
+  if (best_voice_index < 0) {
+    return NULL;
+  }
+
+  voice = synth->voice[best_voice_index];
+  fluid_voice_off(voice);
+
+  return voice;
+}
+
+/*
+ * fluid_synth_voice_priority
+ *
+ * Determines how 'important' a playing voice is. The voice with the
+ * lowest priority is the first to be killed when we run out of voices.
+ */
+static fluid_real_t
+fluid_synth_voice_priority(fluid_synth_t* synth, fluid_voice_t* voice)
+{
+    fluid_real_t this_voice_prio;
+
+    /* Start with an arbitrary number */
     this_voice_prio = 10000.;
 
     /* Is this voice on the drum channel?
@@ -2377,20 +2493,7 @@ fluid_synth_free_voice_by_kill(fluid_synth_t* synth)
       this_voice_prio += voice->volenv_val * 1000.;
     }
 
-    /* check if this voice has less priority than the previous candidate. */
-    if (this_voice_prio < best_prio)
-      best_voice_index = i,
-      best_prio = this_voice_prio;
-  }
-
-  if (best_voice_index < 0) {
-    return NULL;
-  }
-
-  voice = synth->voice[best_voice_index];
-  fluid_voice_off(voice);
-
-  return voice;
+    return this_voice_prio;
 }
 
 /*
@@ -47,10 +47,10 @@
 
 //removed inline
 static void fluid_voice_effects (fluid_voice_t *voice, int count,
-				        fluid_real_t* dsp_left_buf,
-				        fluid_real_t* dsp_right_buf,
-				        fluid_real_t* dsp_reverb_buf,
-				        fluid_real_t* dsp_chorus_buf);
+				        fluid_real_t* FLUID_RESTRICT dsp_left_buf,
+				        fluid_real_t* FLUID_RESTRICT dsp_right_buf,
+				        fluid_real_t* FLUID_RESTRICT dsp_reverb_buf,
+				        fluid_real_t* FLUID_RESTRICT dsp_chorus_buf);
 /*
  * new_fluid_voice
  */
@@ -638,8 +638,8 @@ fluid_voice_write(fluid_voice_t* voice,
  */
 static void
 fluid_voice_effects (fluid_voice_t *voice, int count,
-		     fluid_real_t* dsp_left_buf, fluid_real_t* dsp_right_buf,
-		     fluid_real_t* dsp_reverb_buf, fluid_real_t* dsp_chorus_buf)
+		     fluid_real_t* FLUID_RESTRICT dsp_left_buf, fluid_real_t* FLUID_RESTRICT dsp_right_buf,
+		     fluid_real_t* FLUID_RESTRICT dsp_reverb_buf, fluid_real_t* FLUID_RESTRICT dsp_chorus_buf)
 {
   /* IIR filter sample history */
   fluid_real_t dsp_hist1 = voice->hist1;
@@ -658,9 +658,19 @@ fluid_voice_effects (fluid_voice_t *voice, int count,
 
   fluid_real_t *dsp_buf = voice->dsp_buf;
 
+  /* Mixing gains. These are copied to local variables, because the
+   * output buffers could otherwise alias the voice struct, and the
+   * compiler would have to reload them for every sample. With local
+   * copies and restrict qualified buffers, the mixing loops below can
+   * be vectorised. */
+  const fluid_real_t amp_left = voice->amp_left;
+  const fluid_real_t amp_right = voice->amp_right;
+  const fluid_real_t amp_reverb = voice->amp_reverb;
+  const fluid_real_t amp_chorus = voice->amp_chorus;
+  const fluid_real_t* FLUID_RESTRICT dsp_out;
+
   fluid_real_t dsp_centernode;
   int dsp_i;
-  float v;
 
   /* filter (implement the voice filter according to SoundFont standard) */
 
@@ -708,43 +718,45 @@ fluid_voice_effects (fluid_voice_t *voice, int count,
   * it's close to 0.  voice->amp_left and voice->amp_right are then the
   * same, and we can save one multiplication per voice and sample.
   */
+  dsp_out = dsp_buf;
+
   if ((-0.5 < voice->pan) && (voice->pan < 0.5))
   {
-    /* The voice is centered. Use voice->amp_left twice. */
+    /* The voice is centered. Use amp_left twice. */
     for (dsp_i = 0; dsp_i < count; dsp_i++)
     {
-      v = voice->amp_left * dsp_buf[dsp_i];
+      fluid_real_t v = amp_left * dsp_out[dsp_i];
       dsp_left_buf[dsp_i] += v;
       dsp_right_buf[dsp_i] += v;
     }
   }
   else	/* The voice is not centered. Stereo samples have one side zero. */
   {
-    if (voice->amp_left != 0.0)
+    if (amp_left != 0.0)
     {
       for (dsp_i = 0; dsp_i < count; dsp_i++)
-	dsp_left_buf[dsp_i] += voice->amp_left * dsp_buf[dsp_i];
+	dsp_left_buf[dsp_i] += amp_left * dsp_out[dsp_i];
     }
 
-    if (voice->amp_right != 0.0)
+    if (amp_right != 0.0)
     {
       for (dsp_i = 0; dsp_i < count; dsp_i++)
-	dsp_right_buf[dsp_i] += voice->amp_right * dsp_buf[dsp_i];
+	dsp_right_buf[dsp_i] += amp_right * dsp_out[dsp_i];
     }
   }
 
   /* reverb send. Buffer may be NULL. */
-  if ((dsp_reverb_buf != NULL) && (voice->amp_reverb != 0.0))
+  if ((dsp_reverb_buf != NULL) && (amp_reverb != 0.0))
   {
     for (dsp_i = 0; dsp_i < count; dsp_i++)
-      dsp_reverb_buf[dsp_i] += voice->amp_reverb * dsp_buf[dsp_i];
+      dsp_reverb_buf[dsp_i] += amp_reverb * dsp_out[dsp_i];
   }
 
   /* chorus send. Buffer may be NULL. */
-  if ((dsp_chorus_buf != NULL) && (voice->amp_chorus != 0))
+  if ((dsp_chorus_buf != NULL) && (amp_chorus != 0))
   {
     for (dsp_i = 0; dsp_i < count; dsp_i++)
-      dsp_chorus_buf[dsp_i] += voice->amp_chorus * dsp_buf[dsp_i];
+      dsp_chorus_buf[dsp_i] += amp_chorus * dsp_out[dsp_i];
   }
 
   voice->hist1 = dsp_hist1;
@@ -47,6 +47,16 @@ typedef double fluid_real_t;
 #endif
 
 
+/* Tells the compiler that buffers don't overlap, so it can vectorise the DSP loops */
+#if defined(_MSC_VER)
+#define FLUID_RESTRICT __restrict
+#elif defined(__GNUC__) || defined(__clang__)
+#define FLUID_RESTRICT __restrict__
+#else
+#define FLUID_RESTRICT
+#endif
+
+
 typedef enum {
   FLUID_OK = 0,
   FLUID_FAILED = -1
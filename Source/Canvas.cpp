@@ -23,6 +23,8 @@
 
 #include "Dialogs/Dialogs.h"
 #include "Components/GraphArea.h"
+#include "Components/DSPCostOverlay.h"
+#include "Components/MessageRateOverlay.h"
 #include "Utility/RateReducer.h"
 
 extern "C" {
@@ -78,6 +80,7 @@ Canvas::Canvas(PluginEditor* parent, pd::Patch::Ptr p, Component* parentGraph)
         canvasViewport->setViewedComponent(this, false);
 
         canvasViewport->onScroll = [this]() {
+            updateVisibleArea();
             if (suggestor) {
                 suggestor->updateBounds();
             }
@@ -205,6 +208,26 @@ void Canvas::updateOverlays()
     showBorder = overlayState & Border;
     showOrigin = overlayState & Origin;
 
+    if (auto* canvasViewport = dynamic_cast<CanvasViewport*>(viewport.get())) {
+        canvasViewport->showRenderStats(overlayState & RenderStats);
+    }
+
+    if ((overlayState & DSPCost) && !isGraph && !dspCostOverlay) {
+        dspCostOverlay = std::make_unique<DSPCostOverlay>(this);
+        addAndMakeVisible(dspCostOverlay.get());
+        dspCostOverlay->setBounds(getLocalBounds());
+    } else if (!(overlayState & DSPCost)) {
+        dspCostOverlay.reset();
+    }
+
+    if ((overlayState & MessageRate) && !isGraph && !messageRateOverlay) {
+        messageRateOverlay = std::make_unique<MessageRateOverlay>(this);
+        addAndMakeVisible(messageRateOverlay.get());
+        messageRateOverlay->setBounds(getLocalBounds());
+    } else if (!(overlayState & MessageRate)) {
+        messageRateOverlay.reset();
+    }
+
     for (auto* object : objects) {
         object->updateOverlays(overlayState);
     }
@@ -263,6 +286,8 @@ void Canvas::zoomToFitAll()
 
 void Canvas::lookAndFeelChanged()
 {
+    gridTile.image = Image();
+
     lasso.setColour(LassoComponent<Object>::lassoFillColourId, findColour(PlugDataColour::objectSelectedOutlineColourId).withAlpha(0.075f));
     lasso.setColour(LassoComponent<Object>::lassoOutlineColourId, findColour(PlugDataColour::canvasBackgroundColourId).interpolatedWith(findColour(PlugDataColour::objectSelectedOutlineColourId), 0.65f));
 }
@@ -295,40 +320,28 @@ void Canvas::paint(Graphics& g)
     auto scale = ::getValue<float>(zoomScale);
 
     if (!getValue<bool>(locked)) {
+        auto physicalScale = g.getInternalContext().getPhysicalPixelScaleFactor();
+        updateGridTile(scale, physicalScale);
+
+        if (gridTile.image.isValid()) {
+            g.saveState();
+
+            // Don't draw over origin or border line
+            if (showBorder || showOrigin) {
+                auto originLineWidth = showOrigin ? clipBounds.getRight() - canvasOrigin.x : getValue<int>(patchWidth);
+                auto originLineHeight = showOrigin ? clipBounds.getBottom() - canvasOrigin.y : getValue<int>(patchHeight);
+                g.excludeClipRegion(Rectangle<int>(canvasOrigin.x - 2, canvasOrigin.y - 2, 4, originLineHeight + 4));
+                g.excludeClipRegion(Rectangle<int>(canvasOrigin.x - 2, canvasOrigin.y - 2, originLineWidth + 4, 4));
+            }
 
-        auto startX = (canvasOrigin.x % objectGrid.gridSize);
-        startX += ((clipBounds.getX() / objectGrid.gridSize) * objectGrid.gridSize);
-
-        auto startY = (canvasOrigin.y % objectGrid.gridSize);
-        startY += ((clipBounds.getY() / objectGrid.gridSize) * objectGrid.gridSize);
-
-        g.setColour(findColour(PlugDataColour::canvasDotsColourId));
-
-        for (int x = startX; x < clipBounds.getRight(); x += objectGrid.gridSize) {
-            // calculate the x here, once per iteration, as it won't change for y
-            const auto gridSpacing = objectGrid.gridSize * 4;
-            const auto xGridSpacing = (x - canvasOrigin.x) % gridSpacing == 0;
-
-            for (int y = startY; y < clipBounds.getBottom(); y += objectGrid.gridSize) {
+            // The tile starts half a grid step before the origin, so the dots don't get cut off at the tile edges
+            auto tileSize = static_cast<float>(objectGrid.gridSize * 4);
+            auto tileOrigin = canvasOrigin.toFloat() - Point<float>(objectGrid.gridSize / 2.0f, objectGrid.gridSize / 2.0f);
+            auto tileTransform = AffineTransform::scale(tileSize / static_cast<float>(gridTile.image.getWidth())).translated(tileOrigin);
 
-                // Don't draw over origin or border line
-                if (showBorder || showOrigin) {
-                    if ((x == canvasOrigin.x && y >= canvasOrigin.y && (showOrigin || (y <= patchHeightCanvas))) || (y == canvasOrigin.y && x >= canvasOrigin.x && (showOrigin || (x <= patchWidthCanvas))))
-                        continue;
-                }
-                auto dotWidth = 1.0f;
-                if (scale < 1.0f) {
-                    if (((y - canvasOrigin.y) % gridSpacing == 0) || xGridSpacing) {
-                        dotWidth = 1.0f / jmap(scale, 0.3f, 1.0f, 0.4f, 1.0f);
-                    } else {
-                        // TIM: draw the dot's differently for some grid sizes, or not at all?
-                        if (objectGrid.gridSize == 5)
-                            continue;
-                    }
-                }
-                auto halfDotWidth = dotWidth * 0.5f;
-                g.fillRect(static_cast<float>(x) - halfDotWidth, static_cast<float>(y) - halfDotWidth, dotWidth, dotWidth);
-            }
+            g.setFillType(FillType(gridTile.image, tileTransform));
+            g.fillRect(clipBounds);
+            g.restoreState();
         }
     }
 
@@ -385,6 +398,48 @@ void Canvas::paint(Graphics& g)
     }
 }
 
+void Canvas::updateGridTile(float scale, float physicalScale)
+{
+    auto dotsColour = findColour(PlugDataColour::canvasDotsColourId);
+    auto gridSize = objectGrid.gridSize;
+
+    if (gridTile.image.isValid() && gridTile.scale == scale && gridTile.physicalScale == physicalScale && gridTile.gridSize == gridSize && gridTile.colour == dotsColour)
+        return;
+
+    gridTile.scale = scale;
+    gridTile.physicalScale = physicalScale;
+    gridTile.gridSize = gridSize;
+    gridTile.colour = dotsColour;
+
+    // One tile covers a full period of the larger grid dots that we show when zoomed out
+    auto const gridSpacing = gridSize * 4;
+    auto const tileSize = std::max(1, roundToInt(gridSpacing * physicalScale));
+    auto const pixelScale = tileSize / static_cast<float>(gridSpacing);
+
+    gridTile.image = Image(Image::ARGB, tileSize, tileSize, true);
+    Graphics g(gridTile.image);
+    g.addTransform(AffineTransform::scale(pixelScale));
+    g.setColour(dotsColour);
+
+    for (int x = 0; x < gridSpacing; x += gridSize) {
+        for (int y = 0; y < gridSpacing; y += gridSize) {
+            auto dotWidth = 1.0f;
+            if (scale < 1.0f) {
+                if (x == 0 || y == 0) {
+                    dotWidth = 1.0f / jmap(scale, 0.3f, 1.0f, 0.4f, 1.0f);
+                } else {
+                    // TIM: draw the dot's differently for some grid sizes, or not at all?
+                    if (gridSize == 5)
+                        continue;
+                }
+            }
+            auto halfDotWidth = dotWidth * 0.5f;
+            auto centre = gridSize / 2.0f;
+            g.fillRect(x + centre - halfDotWidth, y + centre - halfDotWidth, dotWidth, dotWidth);
+        }
+    }
+}
+
 TabComponent* Canvas::getTabbar()
 {
     for (auto* split : editor->splitView.splits) {
@@ -594,6 +649,101 @@ void Canvas::updateDrawables()
     }
 }
 
+static void setCulled(Component* component, bool shouldBeCulled)
+{
+    if (auto* object = dynamic_cast<Object*>(component)) {
+        object->setCulled(shouldBeCulled);
+    } else if (auto* connection = dynamic_cast<Connection*>(component)) {
+        connection->setCulled(shouldBeCulled);
+    }
+}
+
+void Canvas::updateVisibleArea()
+{
+    // Graphs don't have a viewport, their parent object gets culled instead
+    if (!viewport)
+        return;
+
+    // In plugin mode, the canvas is not inside the viewport, so we can't cull anything
+    if (viewport->getViewedComponent() == this) {
+        visibleArea = viewport->getViewArea().transformedBy(getTransform().inverted()).expanded(cullingMargin);
+    } else {
+        visibleArea = getLocalBounds();
+    }
+
+    std::unordered_set<Component*> nowVisible;
+    nowVisible.reserve(visibleComponents.size());
+
+    spatialIndex.findItemsInArea(visibleArea, [&nowVisible](Component* component) {
+        nowVisible.insert(component);
+        setCulled(component, false);
+    });
+
+    for (auto* component : visibleComponents) {
+        if (nowVisible.count(component))
+            continue;
+
+        // Don't hide an object while its being edited
+        if (component->hasKeyboardFocus(true)) {
+            nowVisible.insert(component);
+            continue;
+        }
+
+        setCulled(component, true);
+    }
+
+    visibleComponents.swap(nowVisible);
+}
+
+// Called by objects and connections when their bounds change
+void Canvas::updateCulling(Component* component)
+{
+    if (!viewport)
+        return;
+
+    auto bounds = component->getBounds();
+    spatialIndex.insert(component, bounds);
+
+    auto shouldBeVisible = visibleArea.intersects(bounds) || component->hasKeyboardFocus(true);
+
+    if (shouldBeVisible) {
+        visibleComponents.insert(component);
+    } else {
+        visibleComponents.erase(component);
+    }
+
+    setCulled(component, !shouldBeVisible);
+}
+
+void Canvas::removeFromCulling(Component* component)
+{
+    spatialIndex.remove(component);
+    visibleComponents.erase(component);
+}
+
+bool Canvas::isLowDetail() const
+{
+    return lowDetail;
+}
+
+void Canvas::updateLevelOfDetail()
+{
+    auto shouldUseLowDetail = !pd->isInPluginMode() && getValue<float>(zoomScale) < lowDetailZoom;
+
+    if (shouldUseLowDetail == lowDetail)
+        return;
+
+    lowDetail = shouldUseLowDetail;
+
+    for (auto* object : objects) {
+        object->updateLevelOfDetail();
+    }
+
+    for (auto* connection : connections) {
+        connection->repaint();
+    }
+}
+
 void Canvas::commandKeyChanged(bool isHeld)
 {
     commandLocked = isHeld;
@@ -1647,6 +1797,8 @@ void Canvas::valueChanged(Value& v)
         // Without this, future calls to getViewPosition() will give wrong results
         viewport->resized();
 
+        updateLevelOfDetail();
+
         // set and trigger the zoom labsetValueExcludingListenerel popup in the bottom left corner
         // TODO: move this to viewport, and have one per viewport?
         editor->setZoomLabelLevel(newScaleFactor);
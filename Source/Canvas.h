@@ -6,9 +6,12 @@
 
 #pragma once
 
+#include <unordered_set>
+
 #include "ObjectGrid.h"          // move to impl
 #include "Utility/RateReducer.h" // move to impl
 #include "Utility/ModifierKeyListener.h"
+#include "Utility/SpatialIndex.h"
 #include "Components/CheckedTooltip.h"
 #include "Pd/MessageListener.h"
 #include "Pd/Patch.h"
@@ -29,6 +32,8 @@ class PluginProcessor;
 class ConnectionPathUpdater;
 class ConnectionBeingCreated;
 class TabComponent;
+class DSPCostOverlay;
+class MessageRateOverlay;
 
 struct ObjectDragState {
     bool wasDragDuplicated = false;
@@ -85,6 +90,13 @@ public:
 
     void updateDrawables();
 
+    // Viewport culling: objects and connections outside of the visible area are hidden, so they don't paint or repaint
+    void updateVisibleArea();
+    void updateCulling(Component* component);
+    void removeFromCulling(Component* component);
+
+    bool isLowDetail() const;
+
     bool keyPressed(KeyPress const& key) override;
     void valueChanged(Value& v) override;
 
@@ -167,6 +179,12 @@ public:
 
     // Needs to be allocated before object and connection so they can deselect themselves in the destructor
     SelectedItemSet<WeakReference<Component>> selectedComponents;
+
+    // Same for the culling state, objects and connections remove themselves in the destructor
+    SpatialIndex<Component> spatialIndex;
+    std::unordered_set<Component*> visibleComponents;
+    Rectangle<int> visibleArea;
+
     OwnedArray<Object> objects;
     OwnedArray<Connection> connections;
     OwnedArray<ConnectionBeingCreated> connectionsBeingCreated;
@@ -213,11 +231,36 @@ public:
 
     inline static constexpr int infiniteCanvasSize = 128000;
 
+    // Below this zoom level, objects are drawn as plain boxes and connections as straight lines
+    inline static constexpr float lowDetailZoom = 0.5f;
+
+    // Extra space around the visible area, so objects are already shown when they scroll into view
+    inline static constexpr int cullingMargin = 100;
+
 private:
+    void updateGridTile(float scale, float physicalScale);
+    void updateLevelOfDetail();
+
     LassoComponent<WeakReference<Component>> lasso;
 
+    // Only exists while the DSP cost overlay is shown, because it keeps the profiler running
+    std::unique_ptr<DSPCostOverlay> dspCostOverlay;
+    std::unique_ptr<MessageRateOverlay> messageRateOverlay;
+
+    // The grid dots are rendered once into a tile, which gets repeated over the canvas
+    // The tile needs to be re-rendered when any of the properties it was rendered with change
+    struct GridTile {
+        Image image;
+        float scale = 0.0f;
+        float physicalScale = 0.0f;
+        int gridSize = 0;
+        Colour colour;
+    } gridTile;
+
     RateReducer canvasRateReducer = RateReducer(90);
 
+    bool lowDetail = false;
+
     // Properties that can be shown in the inspector by right-clicking on canvas
     ObjectParameters parameters;
 
@@ -17,6 +17,8 @@
 #include "PluginProcessor.h"
 
 #include "Utility/SettingsFile.h"
+#include "Utility/StackShadow.h"
+#include "Utility/WidgetLayerCache.h"
 
 // Special viewport that shows scrollbars on top of content instead of next to it
 class CanvasViewport : public Viewport {
@@ -47,8 +49,14 @@ class CanvasViewport : public Viewport {
             downPosition = viewport->getViewPosition();
             downCanvasOrigin = viewport->cnv->canvasOrigin;
 
-            for (auto* object : viewport->cnv->objects)
-                object->setBufferedToImage(true);
+            // Only buffer the objects that are visible, culled objects won't paint anyway
+            // In low detail mode, drawing the plain boxes is cheaper than caching them
+            if (!viewport->cnv->isLowDetail()) {
+                for (auto* object : viewport->cnv->objects) {
+                    if (object->isVisible())
+                        object->setBufferedToImage(true);
+                }
+            }
         }
 
         void mouseDrag(MouseEvent const& e) override
@@ -285,6 +293,64 @@ class CanvasViewport : public Viewport {
         int inset;
     };
 
+    // Shows how well the shared render caches are doing, for finding out why a patch draws slowly
+    class RenderStatsOverlay : public Component
+        , private ::Timer {
+    public:
+        RenderStatsOverlay()
+        {
+            setInterceptsMouseClicks(false, false);
+        }
+
+        void visibilityChanged() override
+        {
+            if (isVisible())
+                startTimer(500);
+            else
+                stopTimer();
+        }
+
+        void timerCallback() override
+        {
+            repaint();
+        }
+
+        void paint(Graphics& g) override
+        {
+            auto hitRate = [](uint64 hits, uint64 misses) {
+                auto total = hits + misses;
+                return total ? String(100.0 * hits / total, 1) + "%" : String("-");
+            };
+
+            auto text = TextLayoutCache::getStats();
+            auto shadow = NinePatchShadow::getStats();
+            auto layers = WidgetLayerCache::getStats();
+            auto locks = pd::WeakReference::getLockStats();
+
+            StringArray lines;
+            lines.add("Text cache: " + String(text.numEntries) + " entries, " + hitRate(text.hits, text.misses) + " hits");
+            lines.add("  " + String(text.hits) + " hits, " + String(text.misses) + " misses, " + String(text.evictions) + " evicted");
+            lines.add("Shadow cache: " + String(shadow.numImages) + " images, " + hitRate(shadow.hits, shadow.misses) + " hits");
+            lines.add("  " + String(shadow.hits) + " hits, " + String(shadow.misses) + " misses, " + String(shadow.numBytes / 1024) + " KB");
+            lines.add("Widget layers: " + String(layers.numImages) + " images, " + hitRate(layers.hits, layers.misses) + " hits");
+            lines.add("  " + String(layers.hits) + " hits, " + String(layers.misses) + " misses, " + String(layers.numBytes / 1024) + " KB");
+            lines.add("Pd lock: " + String(locks.numLocks) + " GUI locks, " + String(locks.numContendedLocks) + " had to wait");
+
+            g.setColour(findColour(PlugDataColour::popupMenuBackgroundColourId).withAlpha(0.9f));
+            g.fillRoundedRectangle(getLocalBounds().toFloat(), Corners::defaultCornerRadius);
+            g.setColour(findColour(PlugDataColour::outlineColourId));
+            g.drawRoundedRectangle(getLocalBounds().toFloat().reduced(0.5f), Corners::defaultCornerRadius, 1.0f);
+
+            // Draw without the text cache, otherwise we'd be measuring ourselves
+            g.setColour(findColour(PlugDataColour::popupMenuTextColourId));
+            g.setFont(Fonts::getMonospaceFont().withHeight(11));
+            auto bounds = getLocalBounds().reduced(8, 6);
+            for (auto& line : lines) {
+                g.drawText(line, bounds.removeFromTop(16), Justification::centredLeft, true);
+            }
+        }
+    };
+
 public:
     CanvasViewport(PluginEditor* parent, Canvas* cnv)
         : editor(parent)
@@ -298,6 +364,13 @@ public:
 
         addAndMakeVisible(vbar);
         addAndMakeVisible(hbar);
+        addChildComponent(renderStats);
+    }
+
+    void showRenderStats(bool shouldShow)
+    {
+        renderStats.setVisible(shouldShow);
+        renderStats.toFront(false);
     }
 
     void lookAndFeelChanged() override
@@ -385,6 +458,7 @@ public:
     {
         vbar.setVisible(isVerticalScrollBarShown());
         hbar.setVisible(isHorizontalScrollBarShown());
+        renderStats.setBounds(8, 8, 340, 124);
 
         if (editor->pd->isInPluginMode())
             return;
@@ -432,4 +506,5 @@ private:
     MousePanner panner = MousePanner(this);
     ViewportScrollBar vbar = ViewportScrollBar(true, this);
     ViewportScrollBar hbar = ViewportScrollBar(false, this);
+    RenderStatsOverlay renderStats;
 };
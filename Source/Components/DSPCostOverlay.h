@@ -0,0 +1,86 @@
+/*
+ // Copyright (c) 2021-2022 Timothy Schoen
+ // For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ // WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+
+#pragma once
+
+// Heat map of the DSP cost of every object on a canvas
+// Profiling runs for as long as this overlay exists, the results are updated once per second
+class DSPCostOverlay : public Component
+    , private Timer {
+public:
+    explicit DSPCostOverlay(Canvas* canvas)
+        : cnv(canvas)
+    {
+        setInterceptsMouseClicks(false, false);
+        setAlwaysOnTop(true);
+
+        cnv->pd->startDSPProfiling();
+        startTimer(1000);
+    }
+
+    ~DSPCostOverlay() override
+    {
+        cnv->pd->stopDSPProfiling();
+    }
+
+    void timerCallback() override
+    {
+        costs.clear();
+        for (auto const& cost : cnv->pd->getDSPCosts()) {
+            costs[&cost.object->te_g] = cost.isCanvas ? cost.totalLoad : cost.load;
+        }
+
+        repaint();
+    }
+
+    void paint(Graphics& g) override
+    {
+        if (costs.empty())
+            return;
+
+        // Scale the colours to the most expensive object on this canvas, so there is always something to compare to
+        auto maxLoad = 0.0f;
+        for (auto* object : cnv->objects) {
+            if (auto it = costs.find(object->getPointer()); it != costs.end())
+                maxLoad = std::max(maxLoad, it->second);
+        }
+
+        if (maxLoad <= 0.0f)
+            return;
+
+        auto const cold = Colours::yellow;
+        auto const hot = Colours::red;
+
+        g.setFont(Fonts::getMonospaceFont().withHeight(11));
+
+        for (auto* object : cnv->objects) {
+            auto it = costs.find(object->getPointer());
+            if (it == costs.end())
+                continue;
+
+            auto const load = it->second;
+            auto const heat = std::sqrt(load / maxLoad);
+            auto const bounds = getLocalArea(object, object->getLocalBounds().reduced(Object::margin)).toFloat();
+
+            g.setColour(cold.interpolatedWith(hot, heat).withAlpha(0.15f + 0.35f * heat));
+            g.fillRoundedRectangle(bounds, Corners::objectCornerRadius);
+
+            auto const label = String(load, load < 10.0f ? 2 : 1) + "%";
+            auto const labelBounds = Rectangle<float>(bounds.getX(), bounds.getBottom() + 1.0f, std::max(bounds.getWidth(), 48.0f), 14.0f);
+
+            g.setColour(findColour(PlugDataColour::canvasBackgroundColourId).withAlpha(0.8f));
+            g.fillRoundedRectangle(labelBounds.withWidth(g.getCurrentFont().getStringWidthFloat(label) + 8.0f), Corners::objectCornerRadius);
+            g.setColour(findColour(PlugDataColour::canvasTextColourId));
+            g.drawText(label, labelBounds.withTrimmedLeft(4.0f), Justification::centredLeft, false);
+        }
+    }
+
+private:
+    Canvas* cnv;
+    std::map<t_gobj*, float> costs;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DSPCostOverlay)
+};
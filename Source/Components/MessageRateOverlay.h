@@ -0,0 +1,95 @@
+/*
+ // Copyright (c) 2021-2022 Timothy Schoen
+ // For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ // WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+
+#pragma once
+
+// Updates the message rates of the connections on a canvas, and marks objects that are part of a busy feedback loop
+// Message tracing runs for as long as this overlay exists
+class MessageRateOverlay : public Component
+    , private Timer {
+public:
+    explicit MessageRateOverlay(Canvas* canvas)
+        : cnv(canvas)
+    {
+        setInterceptsMouseClicks(false, false);
+        setAlwaysOnTop(true);
+
+        cnv->pd->startMessageTracing();
+        startTimer(1000);
+    }
+
+    ~MessageRateOverlay() override
+    {
+        cnv->pd->stopMessageTracing();
+    }
+
+    void timerCallback() override
+    {
+        for (auto* connection : cnv->connections) {
+            connection->updateMessageRate();
+        }
+
+        auto const newLoopRates = getLoopRates();
+        if (newLoopRates != loopRates) {
+            loopRates = newLoopRates;
+            repaint();
+        }
+    }
+
+    void paint(Graphics& g) override
+    {
+        if (loopRates.empty())
+            return;
+
+        g.setFont(Fonts::getMonospaceFont().withHeight(11));
+
+        for (auto* object : cnv->objects) {
+            auto it = loopRates.find(object->getPointer());
+            if (it == loopRates.end())
+                continue;
+
+            auto const bounds = getLocalArea(object, object->getLocalBounds().reduced(Object::margin)).toFloat();
+
+            Path outline;
+            outline.addRoundedRectangle(bounds.expanded(3.0f), Corners::objectCornerRadius);
+
+            Path dashedOutline;
+            float const dashes[2] = { 4.0f, 3.0f };
+            PathStrokeType(1.5f).createDashedStroke(dashedOutline, outline, dashes, 2);
+
+            g.setColour(Colours::red.withAlpha(0.8f));
+            g.fillPath(dashedOutline);
+
+            auto const rate = it->second;
+            auto const label = "loop " + (rate >= 1000.0f ? String(rate / 1000.0f, 1) + "k" : String(roundToInt(rate))) + "/s";
+            auto const labelBounds = Rectangle<float>(bounds.getX(), bounds.getY() - 18.0f, g.getCurrentFont().getStringWidthFloat(label) + 8.0f, 14.0f);
+
+            g.setColour(Colours::red.withAlpha(0.8f));
+            g.fillRoundedRectangle(labelBounds, Corners::objectCornerRadius);
+            g.setColour(Colours::white);
+            g.drawText(label, labelBounds, Justification::centred, false);
+        }
+    }
+
+private:
+    std::map<t_gobj*, float> getLoopRates() const
+    {
+        std::map<t_gobj*, float> rates;
+        for (auto const& loop : cnv->pd->getMessageTrace().loops) {
+            for (auto* object : loop.objects) {
+                auto& rate = rates[&object->te_g];
+                rate = std::max(rate, loop.rate);
+            }
+        }
+
+        return rates;
+    }
+
+    Canvas* cnv;
+    std::map<t_gobj*, float> loopRates;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MessageRateOverlay)
+};
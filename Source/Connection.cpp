@@ -88,6 +88,7 @@ Connection::~Connection()
 {
     cnv->pd->unregisterMessageListener(ptr.getRawUnchecked<void>(), this);
     cnv->selectedComponents.removeChangeListener(this);
+    cnv->removeFromCulling(this);
 
     if (outlet) {
         outlet->repaint();
@@ -115,10 +116,34 @@ void Connection::changeListenerCallback(ChangeBroadcaster* source)
 void Connection::valueChanged(Value& v)
 {
     if (v.refersToSameSourceAs(presentationMode)) {
-        setVisible(presentationMode != var(true) && !cnv->isGraph);
+        updateVisibility();
     }
 }
 
+void Connection::updateVisibility()
+{
+    setVisible(!isCulled && presentationMode != var(true) && !cnv->isGraph);
+}
+
+void Connection::setCulled(bool shouldBeCulled)
+{
+    if (isCulled == shouldBeCulled)
+        return;
+
+    isCulled = shouldBeCulled;
+    updateVisibility();
+}
+
+void Connection::moved()
+{
+    cnv->updateCulling(this);
+}
+
+void Connection::resized()
+{
+    cnv->updateCulling(this);
+}
+
 void Connection::lookAndFeelChanged()
 {
     updatePath();
@@ -394,11 +419,26 @@ void Connection::updateOverlays(int overlay)
     showDirection = overlay & Overlay::Direction;
     showConnectionOrder = overlay & Overlay::Order;
     showActiveState = overlay & Overlay::ActivationState;
+    showMessageRate = overlay & Overlay::MessageRate;
+    if (!showMessageRate)
+        messageRate = 0.0f;
+
     updatePath();
     resizeToFit();
     repaint();
 }
 
+void Connection::updateMessageRate()
+{
+    auto const newRate = cnv->pd->getMessageRate(ptr.getRawUnchecked<void>());
+
+    // Only repaint when the rate changes enough to be visible
+    if (std::abs(newRate - messageRate) > messageRate * 0.05f + 0.5f) {
+        messageRate = newRate;
+        repaint();
+    }
+}
+
 void Connection::forceUpdate()
 {
     updatePath();
@@ -408,6 +448,16 @@ void Connection::forceUpdate()
 
 void Connection::paint(Graphics& g)
 {
+    // When zoomed out far, a straight line is enough and much cheaper than stroking the path
+    if (cnv->isLowDetail()) {
+        auto isSignal = outlet != nullptr && outlet->isSignal;
+        auto colour = selectedFlag ? findColour(isSignal ? PlugDataColour::signalColourId : PlugDataColour::dataColourId) : findColour(PlugDataColour::connectionColourId);
+
+        g.setColour(colour);
+        g.drawLine(Line<float>(getLocalPoint(cnv, getStartPoint()), getLocalPoint(cnv, getEndPoint())), 1.0f);
+        return;
+    }
+
     renderConnectionPath(g,
         cnv,
         toDrawLocalSpace,
@@ -422,6 +472,15 @@ void Connection::paint(Graphics& g)
         getMultiConnectNumber(),
         getNumSignalChannels());
 
+    // Busier connections get hotter and thicker, on a log scale up to 10k messages per second
+    if (showMessageRate && messageRate > 0.0f) {
+        auto const heat = jlimit(0.0f, 1.0f, std::log10(messageRate + 1.0f) / 4.0f);
+        auto const colour = findColour(PlugDataColour::dataColourId).interpolatedWith(Colours::red, heat);
+
+        g.setColour(colour.withAlpha(0.4f + 0.5f * heat));
+        g.strokePath(toDrawLocalSpace, PathStrokeType(1.5f + 3.5f * heat, PathStrokeType::mitered, PathStrokeType::rounded));
+    }
+
     /* ENABLE_CONNECTION_GRAPHICS_DEBUGGING_REPAINT
         static Random rng;
 
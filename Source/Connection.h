@@ -44,6 +44,9 @@ public:
 
     void updateOverlays(int overlay);
 
+    // Fetches the latest rate from the message tracer, while the message rate overlay is shown
+    void updateMessageRate();
+
     static void renderConnectionPath(Graphics& g,
         Canvas* cnv,
         Path const& connectionPath,
@@ -61,6 +64,10 @@ public:
     static Path getNonSegmentedPath(Point<float> start, Point<float> end);
 
     void paint(Graphics&) override;
+    void moved() override;
+    void resized() override;
+
+    void setCulled(bool shouldBeCulled);
 
     bool isSegmented() const;
     void setSegmented(bool segmented);
@@ -126,11 +133,14 @@ private:
 
     void setSelected(bool shouldBeSelected);
 
+    void updateVisibility();
+
     Array<SafePointer<Connection>> reconnecting;
     Rectangle<float> startReconnectHandle, endReconnectHandle, endCableOrderDisplay;
 
     bool selectedFlag = false;
     bool segmented = false;
+    bool isCulled = false;
 
     PathPlan currentPlan;
 
@@ -140,6 +150,9 @@ private:
     bool showDirection = false;
     bool showConnectionOrder = false;
     bool showActiveState = false;
+    bool showMessageRate = false;
+
+    float messageRate = 0.0f;
 
     Canvas* cnv;
 
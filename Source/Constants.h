@@ -396,7 +396,10 @@ enum Overlay {
     Coordinate = 8,
     ActivationState = 16,
     Order = 32,
-    Direction = 64
+    Direction = 64,
+    RenderStats = 128,
+    DSPCost = 256,
+    MessageRate = 512
 };
 
 enum OverlayItem {
@@ -405,7 +408,10 @@ enum OverlayItem {
     OverlayIndex,
     OverlayActivationState,
     OverlayDirection,
-    OverlayOrder
+    OverlayOrder,
+    OverlayRenderStats,
+    OverlayDSPCost,
+    OverlayMessageRate
 };
 
 enum Align {
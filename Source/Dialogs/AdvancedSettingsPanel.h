@@ -112,8 +112,20 @@ public:
         centreSidepanelButtons = settingsFile->getPropertyAsValue("centre_sidepanel_buttons");
         otherProperties.add(new PropertiesPanel::BoolComponent("Centre canvas sidepanel selectors", centreSidepanelButtons, { "No", "Yes" }));
 
+        fadeGraphChanges = settingsFile->getPropertyAsValue("fade_graph_changes");
+        fadeGraphChanges.addListener(this);
+        otherProperties.add(new PropertiesPanel::BoolComponent("Fade audio when loading patches", fadeGraphChanges, { "No", "Yes" }));
+
         propertiesPanel.addSection("Other", otherProperties);
 
+        Array<PropertiesPanelProperty*> experimentalProperties;
+
+        parallelDSP = settingsFile->getPropertyAsValue("parallel_dsp");
+        parallelDSP.addListener(this);
+        experimentalProperties.add(new PropertiesPanel::BoolComponent("Run independent patches in parallel", parallelDSP, { "No", "Yes" }));
+
+        propertiesPanel.addSection("Experimental", experimentalProperties);
+
         addAndMakeVisible(propertiesPanel);
     }
 
@@ -154,6 +166,16 @@ public:
             SettingsFile::getInstance()->setProperty("default_zoom", zoom);
             defaultZoom = zoom;
         }
+        if (v.refersToSameSourceAs(parallelDSP)) {
+            if (auto* pluginEditor = dynamic_cast<PluginEditor*>(editor)) {
+                pluginEditor->pd->setParallelDSP(getValue<bool>(parallelDSP));
+            }
+        }
+        if (v.refersToSameSourceAs(fadeGraphChanges)) {
+            if (auto* pluginEditor = dynamic_cast<PluginEditor*>(editor)) {
+                pluginEditor->pd->graphSwap.setFadeEnabled(getValue<bool>(fadeGraphChanges));
+            }
+        }
     }
     Component* editor;
 
@@ -164,6 +186,8 @@ public:
     Value defaultZoom;
     Value centreResized;
     Value centreSidepanelButtons;
+    Value parallelDSP;
+    Value fadeGraphChanges;
         
     Value showPalettesValue;
     Value autoPatchingValue;
@@ -470,7 +470,7 @@ public:
 
         latencyValue.addListener(this);
 
-        latencyValue = proc->getLatencySamples();
+        latencyValue = proc->getUserLatency();
 
         latencyNumberBox = new PropertiesPanel::EditableComponent<int>("Latency (samples)", latencyValue);
         tailLengthNumberBox = new PropertiesPanel::EditableComponent<float>("Tail length (seconds)", tailLengthValue);
@@ -495,7 +495,7 @@ public:
     void valueChanged(Value& v) override
     {
         if (v.refersToSameSourceAs(latencyValue)) {
-            processor->setLatencySamples(getValue<int>(latencyValue));
+            dynamic_cast<PluginProcessor*>(processor)->setUserLatency(getValue<int>(latencyValue));
         }
     }
 
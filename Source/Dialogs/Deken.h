@@ -6,6 +6,8 @@
 
 #pragma once
 
+#include "Utility/PackageDownloader.h"
+
 struct Spinner : public Component
     , public Timer {
 
@@ -78,97 +80,61 @@ class PackageManager : public Thread
     , public DeletedAtShutdown {
 
 public:
-    struct DownloadTask : public Thread {
+    // Downloads run on a shared pool of threads, so installing many packages at once doesn't open too many connections
+    // While one package is being extracted, the next one can already be downloading
+    struct DownloadTask : public ThreadPoolJob {
         PackageManager& manager;
         PackageInfo packageInfo;
 
-        std::unique_ptr<InputStream> instream;
-
         DownloadTask(PackageManager& m, PackageInfo& info)
-            : Thread("Download Thread")
+            : ThreadPoolJob("Download Thread")
             , manager(m)
             , packageInfo(info)
         {
-            int statusCode = 0;
-            instream = URL(info.url).createInputStream(URL::InputStreamOptions(URL::ParameterHandling::inAddress)
-                                                           .withConnectionTimeoutMs(10000)
-                                                           .withStatusCode(&statusCode));
-
-            if (instream != nullptr && statusCode == 200) {
-                startThread();
-            } else {
-                finish(Result::fail("Failed to start download"));
-                return;
-            }
         }
 
-        ~DownloadTask() override
+        JobStatus runJob() override
         {
-            stopThread(-1);
-        }
-
-        void run() override
-        {
-            MemoryBlock dekData;
-
-            int64 totalBytes = instream->getTotalLength();
-            int64 bytesDownloaded = 0;
-
-            MemoryOutputStream mo(dekData, true);
-
-            while (true) {
-                if (threadShouldExit()) {
-                    finish(Result::fail("Download cancelled"));
-                    return;
-                }
-
-                auto written = mo.writeFromInputStream(*instream, 8192);
-
-                if (written == 0)
-                    break;
-
-                bytesDownloaded += written;
-
-                float progress = static_cast<long double>(bytesDownloaded) / static_cast<long double>(totalBytes);
-
-                MessageManager::callAsync([this, progress]() mutable {
-                    onProgress(progress);
+            File archive;
+            auto result = manager.downloader.fetch(packageInfo.url, archive, [this](float progress) {
+                MessageManager::callAsync([_this = this, progress]() {
+                    if (_this->onProgress)
+                        _this->onProgress(progress);
                 });
-            }
-
-            MemoryInputStream input(dekData, false);
-            ZipFile zip(input);
+                return !shouldExit();
+            });
 
-            /* This check produces false positives sometimes, so I've disabled it
-             if (zip.getNumEntries() == 0) {
-             finish(Result::fail("The downloaded file was not a valid Deken package"));
-             return;
-             } */
-
-            auto extractedPath = filesystem.getChildFile(packageInfo.name).getFullPathName();
-            auto result = zip.uncompressTo(filesystem);
-
-            if (!result.wasOk()) {
-                finish(result);
-                return;
+            if (result.wasOk()) {
+                result = PackageDownloader::extract(archive, filesystem);
             }
 
-            // Tell deken about the newly installed package
-            manager.addPackageToRegister(packageInfo, extractedPath);
-
-            finish(Result::ok());
+            finish(result);
+            return jobHasFinished;
         }
 
         void finish(Result result)
         {
+            // The package manager is shutting down, there's nobody left to tell
+            if (shouldExit())
+                return;
+
+            auto extractedPath = filesystem.getChildFile(packageInfo.name).getFullPathName();
+
             MessageManager::callAsync(
-                [this, result, finishCopy = onFinish]() mutable {
-                    waitForThreadToExit(-1);
+                [this, result, extractedPath]() mutable {
+                    manager.installPool.waitForJobToFinish(this, -1);
+
+                    // Tell deken about the newly installed package
+                    if (result.wasOk())
+                        manager.addPackageToRegister(packageInfo, extractedPath);
+
+                    auto finishCopy = onFinish;
 
                     // Self-destruct
                     manager.downloads.removeObject(this);
 
-                    finishCopy(result);
+                    if (finishCopy)
+                        finishCopy(result);
                 });
         }
 
@@ -197,6 +163,7 @@ public:
     {
         if (webstream)
             webstream->cancel();
+        installPool.removeAllJobs(true, -1);
         downloads.clear();
         stopThread(500);
         clearSingletonInstance();
@@ -226,18 +193,25 @@ public:
         // This saves a lot of work that plugdata would have to do on startup!
 
         auto triplet = os + "-" + machine + "-" + floatsize;
-        auto repoForArchitecture = "https://raw.githubusercontent.com/plugdata-team/plugdata-deken/main/bin/" + triplet + ".bin";
+        auto repoForArchitecture = downloader.resolve("https://raw.githubusercontent.com/plugdata-team/plugdata-deken/main/bin/" + triplet + ".bin");
 
-        webstream = std::make_unique<WebInputStream>(URL(repoForArchitecture), false);
-        webstream->connect(nullptr);
+        MemoryBlock block;
+        if (repoForArchitecture.startsWith("file://")) {
+            if (!URL(repoForArchitecture).getLocalFile().loadFileAsData(block)) {
+                sendActionMessage("Failed to read package list from mirror");
+                return {};
+            }
+        } else {
+            webstream = std::make_unique<WebInputStream>(URL(repoForArchitecture), false);
+            webstream->connect(nullptr);
 
-        if (webstream->isError()) {
-            sendActionMessage("Failed to connect to server");
-            return {};
-        }
+            if (webstream->isError()) {
+                sendActionMessage("Failed to connect to server");
+                return {};
+            }
 
-        MemoryBlock block;
-        webstream->readIntoMemoryBlock(block);
+            webstream->readIntoMemoryBlock(block);
+        }
 
         // Parse tree that was downloaded
         auto tree = ValueTree::readFromData(block.getData(), block.getSize());
@@ -313,7 +287,10 @@ public:
     {
         // Make sure https is used
         packageInfo.url = packageInfo.url.replaceFirstOccurrenceOf("http://", "https://");
-        return downloads.add(new DownloadTask(*this, packageInfo));
+
+        auto* task = downloads.add(new DownloadTask(*this, packageInfo));
+        installPool.addJob(task, false);
+        return task;
     }
 
     void addPackageToRegister(PackageInfo const& info, String path)
@@ -361,9 +338,16 @@ public:
     // Package state tree, keeps track of which packages are installed and saves it to pkgInfo
     ValueTree packageState = ValueTree("pkg_info");
 
-    // Thread for unzipping and installing packages
+    // Downloads that are queued or in progress
     OwnedArray<DownloadTask> downloads;
 
+    static constexpr int maxConcurrentDownloads = 3;
+    ThreadPool installPool = ThreadPool(maxConcurrentDownloads);
+
+    // Downloaded archives are kept here, so reinstalling doesn't need the network
+    // Set "deken_mirror" in the settings to a url like "file:///path/to/mirror/" to install from a local folder instead
+    PackageDownloader downloader = PackageDownloader(filesystem.getChildFile(".cache"), SettingsFile::getInstance()->getProperty<String>("deken_mirror"));
+
     std::unique_ptr<WebInputStream> webstream;
 
     static inline const String floatsize = String(PD_FLOATSIZE);
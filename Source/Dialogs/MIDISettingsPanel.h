@@ -57,7 +57,8 @@ public:
 };
 
 class StandaloneMIDISettings : public SettingsDialogPanel
-    , private ChangeListener {
+    , private ChangeListener
+    , private Value::Listener {
 public:
     StandaloneMIDISettings(PluginProcessor* audioProcessor, AudioDeviceManager& audioDeviceManager)
         : processor(audioProcessor)
@@ -65,6 +66,12 @@ public:
     {
         addAndMakeVisible(midiProperties);
 
+        auto* settingsFile = processor->settingsFile;
+        synthPolyphony = polyphonyOptions.indexOf(settingsFile->getProperty<int>("internal_synth_polyphony")) + 1;
+        synthCPUBudget = cpuBudgetOptions.indexOf(settingsFile->getProperty<int>("internal_synth_cpu_budget")) + 1;
+        synthPolyphony.addListener(this);
+        synthCPUBudget.addListener(this);
+
         deviceManager.addChangeListener(this);
         ProjectInfo::getMidiDeviceManager()->updateMidiDevices();
         updateDevices();
@@ -117,6 +124,17 @@ private:
 
         midiOutputProperties.add(new InternalSynthToggle(processor));
 
+        StringArray polyphonyNames;
+        for (auto voices : polyphonyOptions)
+            polyphonyNames.add(String(voices) + " voices");
+
+        StringArray cpuBudgetNames;
+        for (auto percentage : cpuBudgetOptions)
+            cpuBudgetNames.add(String(percentage) + "%");
+
+        midiOutputProperties.add(new PropertiesPanel::ComboComponent("Internal GM Synth polyphony", synthPolyphony, polyphonyNames));
+        midiOutputProperties.add(new PropertiesPanel::ComboComponent("Internal GM Synth CPU budget", synthCPUBudget, cpuBudgetNames));
+
         midiProperties.addSection("MIDI Inputs", midiInputProperties);
         midiProperties.addSection("MIDI Outputs", midiOutputProperties);
     }
@@ -126,6 +144,26 @@ private:
         updateDevices();
     }
 
+    void valueChanged(Value& v) override
+    {
+        auto* settingsFile = processor->settingsFile;
+        if (v.refersToSameSourceAs(synthPolyphony)) {
+            auto voices = polyphonyOptions[std::clamp(getValue<int>(synthPolyphony) - 1, 0, polyphonyOptions.size() - 1)];
+            settingsFile->setProperty("internal_synth_polyphony", voices);
+            processor->internalSynth->setPolyphony(voices);
+        } else if (v.refersToSameSourceAs(synthCPUBudget)) {
+            auto percentage = cpuBudgetOptions[std::clamp(getValue<int>(synthCPUBudget) - 1, 0, cpuBudgetOptions.size() - 1)];
+            settingsFile->setProperty("internal_synth_cpu_budget", percentage);
+            processor->internalSynth->setCPUBudget(percentage / 100.0f);
+        }
+    }
+
+    Array<int> const polyphonyOptions = { 16, 32, 64, 128, 256 };
+    Array<int> const cpuBudgetOptions = { 25, 50, 75, 100 };
+
+    Value synthPolyphony;
+    Value synthCPUBudget;
+
     PluginProcessor* processor;
     AudioDeviceManager& deviceManager;
     PropertiesPanel midiProperties;
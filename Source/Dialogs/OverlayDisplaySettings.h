@@ -37,7 +37,7 @@ public:
             , group(groupType)
         {
             auto controlVisibility = [this](String const& mode) {
-                if (settingName == "origin" || settingName == "border" || mode == "edit" || mode == "lock" || mode == "alt") {
+                if (settingName == "origin" || settingName == "border" || settingName == "render_stats" || settingName == "dsp_cost" || settingName == "message_rate" || mode == "edit" || mode == "lock" || mode == "alt") {
                     return true;
                 } else {
                     return false;
@@ -139,6 +139,9 @@ public:
         buttonGroups.add(new OverlaySelector(overlayTree, ActivationState, "activation_state", "Activity", "Show object activity"));
         buttonGroups.add(new OverlaySelector(overlayTree, Direction, "direction", "Direction", "Direction of connection"));
         buttonGroups.add(new OverlaySelector(overlayTree, Order, "order", "Order", "Trigger order of multiple outlets"));
+        buttonGroups.add(new OverlaySelector(overlayTree, RenderStats, "render_stats", "Render stats", "Hit rates of the shared render caches, and how often the GUI waited for the Pd lock"));
+        buttonGroups.add(new OverlaySelector(overlayTree, DSPCost, "dsp_cost", "DSP cost", "CPU time of every signal object, measured while the overlay is shown"));
+        buttonGroups.add(new OverlaySelector(overlayTree, MessageRate, "message_rate", "Message rate", "Colour connections by how many messages they carry, and mark busy feedback loops"));
 
         for (auto* buttonGroup : buttonGroups) {
             addAndMakeVisible(buttonGroup);
@@ -157,6 +160,7 @@ public:
         canvasLabel.setBounds(bounds.removeFromTop(labelHeight));
         buttonGroups[OverlayOrigin]->setBounds(bounds.removeFromTop(itemHeight));
         buttonGroups[OverlayBorder]->setBounds(bounds.removeFromTop(itemHeight));
+        buttonGroups[OverlayRenderStats]->setBounds(bounds.removeFromTop(itemHeight));
 
         bounds.removeFromTop(spacing);
         objectLabel.setBounds(bounds.removeFromTop(labelHeight));
@@ -165,28 +169,37 @@ public:
         // doesn't exist yet
         // buttonGroups[OverlayCoordinate].setBounds(bounds.removeFromTop(28));
         buttonGroups[OverlayActivationState]->setBounds(bounds.removeFromTop(itemHeight));
+        buttonGroups[OverlayDSPCost]->setBounds(bounds.removeFromTop(itemHeight));
 
         bounds.removeFromTop(spacing);
         connectionLabel.setBounds(bounds.removeFromTop(labelHeight));
         buttonGroups[OverlayDirection]->setBounds(bounds.removeFromTop(itemHeight));
         buttonGroups[OverlayOrder]->setBounds(bounds.removeFromTop(itemHeight));
+        buttonGroups[OverlayMessageRate]->setBounds(bounds.removeFromTop(itemHeight));
         setSize(200, bounds.getY() + 5);
     }
     
     void paint(Graphics& g) override
     {
-        auto firstPanelBounds = buttonGroups[OverlayOrigin]->getBounds().getUnion(buttonGroups[OverlayBorder]->getBounds());
-        auto secondPanelBounds = buttonGroups[OverlayIndex]->getBounds().getUnion(buttonGroups[OverlayActivationState]->getBounds());
-        auto thirdPanelBounds = buttonGroups[OverlayDirection]->getBounds().getUnion(buttonGroups[OverlayOrder]->getBounds());
+        auto panels = std::vector<std::vector<OverlayItem>> {
+            { OverlayOrigin, OverlayBorder, OverlayRenderStats },
+            { OverlayIndex, OverlayActivationState, OverlayDSPCost },
+            { OverlayDirection, OverlayOrder, OverlayMessageRate }
+        };
         
-        for(auto& bounds : std::vector<Rectangle<int>>{firstPanelBounds, secondPanelBounds, thirdPanelBounds})
+        for(auto& items : panels)
         {
+            auto bounds = buttonGroups[items.front()]->getBounds().getUnion(buttonGroups[items.back()]->getBounds());
             g.setColour(findColour(PlugDataColour::popupMenuBackgroundColourId).contrasting(0.035f));
             g.fillRoundedRectangle(bounds.toFloat(), Corners::largeCornerRadius);
 
             g.setColour(findColour(PlugDataColour::toolbarOutlineColourId));
             g.drawRoundedRectangle(bounds.toFloat(), Corners::largeCornerRadius, 1.0f);
-            g.drawHorizontalLine(bounds.getCentreY(), bounds.getX(), bounds.getRight());
+            
+            // Separators between the items
+            for (int i = 1; i < items.size(); i++) {
+                g.drawHorizontalLine(buttonGroups[items[i]]->getY(), bounds.getX(), bounds.getRight());
+            }
         }
     }
 
@@ -14,6 +14,7 @@
 #include <utility>
 
 #include "Constants.h"
+#include "Utility/LineRope.h"
 
 #define GUTTER_WIDTH 48.f
 #define CURSOR_WIDTH 3.f
@@ -230,7 +231,9 @@ private:
 
 /**
  This class wraps a StringArray and memoizes the evaluation of glyph
- arrangements derived from the associated strings.
+ arrangements derived from the associated strings. Lines are only laid
+ out when they're drawn or measured, so loading a large document only
+ lays out the lines that are visible.
  */
 class GlyphArrangementArray {
 public:
@@ -241,6 +244,9 @@ public:
     void removeRange(int startIndex, int numberToRemove) { lines.removeRange(startIndex, numberToRemove); }
     String const& operator[](int index) const;
 
+    /** Width of a line, estimated from its length if it wasn't laid out yet. */
+    float getWidth(int index) const;
+
     int getToken(int row, int col, int defaultIfOutOfBounds) const;
     void clearTokens(int index);
     void applyTokens(int index, Selection zone);
@@ -253,8 +259,13 @@ private:
     friend class TextDocument;
     friend class PlugDataTextEditor;
     Font font;
+    float averageCharacterWidth = 8.f;
     bool cacheGlyphArrangement = true;
 
+    // Widest line that was laid out since the document last looked, its width may be larger than the estimate
+    mutable float widestMeasuredWidth = 0.f;
+
+    void setFont(Font const& fontToUse);
     void ensureValid(int index) const;
     void invalidateAll();
 
@@ -268,10 +279,11 @@ private:
         GlyphArrangement glyphsWithTrailingSpace;
         GlyphArrangement glyphs;
         Array<int> tokens;
+        float width = 0.f;
         bool glyphsAreDirty = true;
         bool tokensAreDirty = true;
     };
-    mutable Array<Entry> lines;
+    mutable LineRope<Entry> lines;
 };
 
 class TextDocument {
@@ -369,7 +381,8 @@ public:
     void setFont(Font const& fontToUse)
     {
         font = fontToUse;
-        lines.font = fontToUse;
+        lines.setFont(fontToUse);
+        cachedBounds = {};
     }
 
     StringArray getText() const;
@@ -377,6 +390,9 @@ public:
     /** Replace the whole document content. */
     void replaceAll(String const& content);
 
+    /** Add text to the end of the document, the first line of it continues the last line of the document. */
+    void appendText(String const& content);
+
     /** Replace the list of selections with a new one. */
     void setSelections(Array<Selection> const& newSelections) { selections = newSelections; }
 
@@ -583,6 +599,7 @@ public:
     void setFont(Font const& font);
 
     void setText(String const& text);
+    void appendText(String const& text);
     String getText() const;
 
     void translateView(float dx, float dy);
@@ -633,7 +650,7 @@ private:
 
 // IMPLEMENTATIONS
 
-Caret::Caret(TextDocument const& document)
+inline Caret::Caret(TextDocument const& document)
     : document(document)
 {
     setInterceptsMouseClicks(false, false);
@@ -642,19 +659,19 @@ Caret::Caret(TextDocument const& document)
 #endif
 }
 
-void Caret::setViewTransform(AffineTransform const& transformToUse)
+inline void Caret::setViewTransform(AffineTransform const& transformToUse)
 {
     transform = transformToUse;
     repaint();
 }
 
-void Caret::updateSelections()
+inline void Caret::updateSelections()
 {
     phase = 0.f;
     repaint();
 }
 
-void Caret::paint(Graphics& g)
+inline void Caret::paint(Graphics& g)
 {
     g.setColour(getParentComponent()->findColour(CaretComponent::caretColourId).withAlpha(squareWave(phase)));
 
@@ -662,14 +679,14 @@ void Caret::paint(Graphics& g)
         g.fillRect(r);
 }
 
-float Caret::squareWave(float wt)
+inline float Caret::squareWave(float wt)
 {
     float const delta = 0.222f;
     float const A = 1.0;
     return 0.5f + A / 3.14159f * std::atan(std::cos(wt) / delta);
 }
 
-void Caret::timerCallback()
+inline void Caret::timerCallback()
 {
     phase += 3.2e-1;
 
@@ -677,7 +694,7 @@ void Caret::timerCallback()
         repaint(r.getSmallestIntegerContainer());
 }
 
-Array<Rectangle<float>> Caret::getCaretRectangles() const
+inline Array<Rectangle<float>> Caret::getCaretRectangles() const
 {
     Array<Rectangle<float>> rectangles;
 
@@ -692,25 +709,25 @@ Array<Rectangle<float>> Caret::getCaretRectangles() const
     return rectangles;
 }
 
-GutterComponent::GutterComponent(TextDocument const& document)
+inline GutterComponent::GutterComponent(TextDocument const& document)
     : document(document)
     , memoizedGlyphArrangements([this](int row) { return getLineNumberGlyphs(row); })
 {
     setInterceptsMouseClicks(false, false);
 }
 
-void GutterComponent::setViewTransform(AffineTransform const& transformToUse)
+inline void GutterComponent::setViewTransform(AffineTransform const& transformToUse)
 {
     transform = transformToUse;
     repaint();
 }
 
-void GutterComponent::updateSelections()
+inline void GutterComponent::updateSelections()
 {
     repaint();
 }
 
-void GutterComponent::paint(Graphics& g)
+inline void GutterComponent::paint(Graphics& g)
 {
     /*
      Draw the gutter background, shadow, and outline
@@ -760,7 +777,7 @@ void GutterComponent::paint(Graphics& g)
     }
 }
 
-GlyphArrangement GutterComponent::getLineNumberGlyphs(int row) const
+inline GlyphArrangement GutterComponent::getLineNumberGlyphs(int row) const
 {
     GlyphArrangement glyphs;
     glyphs.addLineOfText(document.getFont().withHeight(12.f),
@@ -769,13 +786,13 @@ GlyphArrangement GutterComponent::getLineNumberGlyphs(int row) const
     return glyphs;
 }
 
-HighlightComponent::HighlightComponent(TextDocument const& document)
+inline HighlightComponent::HighlightComponent(TextDocument const& document)
     : document(document)
 {
     setInterceptsMouseClicks(false, false);
 }
 
-void HighlightComponent::setViewTransform(AffineTransform const& transformToUse)
+inline void HighlightComponent::setViewTransform(AffineTransform const& transformToUse)
 {
     transform = transformToUse;
 
@@ -788,7 +805,7 @@ void HighlightComponent::setViewTransform(AffineTransform const& transformToUse)
     repaint(outlinePath.getBounds().getSmallestIntegerContainer());
 }
 
-void HighlightComponent::updateSelections()
+inline void HighlightComponent::updateSelections()
 {
     outlinePath.clear();
     auto clip = getLocalBounds().toFloat().transformedBy(transform.inverted());
@@ -799,7 +816,7 @@ void HighlightComponent::updateSelections()
     repaint(outlinePath.getBounds().getSmallestIntegerContainer());
 }
 
-void HighlightComponent::paint(Graphics& g)
+inline void HighlightComponent::paint(Graphics& g)
 {
     g.addTransform(transform);
     auto highlight = getParentComponent()->findColour(CodeEditorComponent::highlightColourId);
@@ -811,7 +828,7 @@ void HighlightComponent::paint(Graphics& g)
     g.strokePath(outlinePath, PathStrokeType(1.f));
 }
 
-Path HighlightComponent::getOutlinePath(Array<Rectangle<float>> const& rectangles)
+inline Path HighlightComponent::getOutlinePath(Array<Rectangle<float>> const& rectangles)
 {
     auto p = Path();
     auto rect = rectangles.begin();
@@ -836,7 +853,7 @@ Path HighlightComponent::getOutlinePath(Array<Rectangle<float>> const& rectangle
     return p.createPathWithRoundedCorners(4.f);
 }
 
-Selection::Selection(String const& content)
+inline Selection::Selection(String const& content)
 {
     int rowSpan = 0;
     int n = 0, lastLineStart = 0;
@@ -855,12 +872,12 @@ Selection::Selection(String const& content)
     tail = { rowSpan, content.length() - lastLineStart };
 }
 
-bool Selection::isOriented() const
+inline bool Selection::isOriented() const
 {
     return !(head.x > tail.x || (head.x == tail.x && head.y > tail.y));
 }
 
-Selection Selection::oriented() const
+inline Selection Selection::oriented() const
 {
     if (!isOriented())
         return swapped();
@@ -868,14 +885,14 @@ Selection Selection::oriented() const
     return *this;
 }
 
-Selection Selection::swapped() const
+inline Selection Selection::swapped() const
 {
     Selection s = *this;
     std::swap(s.head, s.tail);
     return s;
 }
 
-Selection Selection::horizontallyMaximized(TextDocument const& document) const
+inline Selection Selection::horizontallyMaximized(TextDocument const& document) const
 {
     Selection s = *this;
 
@@ -889,7 +906,7 @@ Selection Selection::horizontallyMaximized(TextDocument const& document) const
     return s;
 }
 
-Selection Selection::measuring(String const& content) const
+inline Selection Selection::measuring(String const& content) const
 {
     Selection s(content);
 
@@ -900,7 +917,7 @@ Selection Selection::measuring(String const& content) const
     }
 }
 
-Selection Selection::startingFrom(Point<int> index) const
+inline Selection Selection::startingFrom(Point<int> index) const
 {
     Selection s = *this;
 
@@ -917,19 +934,19 @@ Selection Selection::startingFrom(Point<int> index) const
     return s;
 }
 
-void Selection::pullBy(Selection disappearingSelection)
+inline void Selection::pullBy(Selection disappearingSelection)
 {
     disappearingSelection.pull(head);
     disappearingSelection.pull(tail);
 }
 
-void Selection::pushBy(Selection appearingSelection)
+inline void Selection::pushBy(Selection appearingSelection)
 {
     appearingSelection.push(head);
     appearingSelection.push(tail);
 }
 
-void Selection::pull(Point<int>& index) const
+inline void Selection::pull(Point<int>& index) const
 {
     auto const S = oriented();
 
@@ -956,7 +973,7 @@ void Selection::pull(Point<int>& index) const
     }
 }
 
-void Selection::push(Point<int>& index) const
+inline void Selection::push(Point<int>& index) const
 {
     auto const S = oriented();
 
@@ -982,30 +999,46 @@ void Selection::push(Point<int>& index) const
     }
 }
 
-String const& GlyphArrangementArray::operator[](int index) const
+inline String const& GlyphArrangementArray::operator[](int index) const
 {
     if (isPositiveAndBelow(index, lines.size())) {
-        return lines.getReference(index).string;
+        return lines[index].string;
     }
 
     static String empty;
     return empty;
 }
 
-int GlyphArrangementArray::getToken(int row, int col, int defaultIfOutOfBounds) const
+inline float GlyphArrangementArray::getWidth(int index) const
+{
+    if (!isPositiveAndBelow(index, lines.size()))
+        return 0.f;
+
+    auto const& entry = lines[index];
+    return entry.glyphsAreDirty ? entry.string.length() * averageCharacterWidth : entry.width;
+}
+
+inline void GlyphArrangementArray::setFont(Font const& fontToUse)
+{
+    font = fontToUse;
+    averageCharacterWidth = font.getStringWidthFloat("abcdefghijklmnopqrstuvwxyz0123456789") / 36.f;
+    invalidateAll();
+}
+
+inline int GlyphArrangementArray::getToken(int row, int col, int defaultIfOutOfBounds) const
 {
     if (!isPositiveAndBelow(row, lines.size())) {
         return defaultIfOutOfBounds;
     }
-    return lines.getReference(row).tokens[col];
+    return lines[row].tokens[col];
 }
 
-void GlyphArrangementArray::clearTokens(int index)
+inline void GlyphArrangementArray::clearTokens(int index)
 {
     if (!isPositiveAndBelow(index, lines.size()))
         return;
 
-    auto& entry = lines.getReference(index);
+    auto& entry = lines[index];
 
     ensureValid(index);
 
@@ -1014,12 +1047,12 @@ void GlyphArrangementArray::clearTokens(int index)
     }
 }
 
-void GlyphArrangementArray::applyTokens(int index, Selection zone)
+inline void GlyphArrangementArray::applyTokens(int index, Selection zone)
 {
     if (!isPositiveAndBelow(index, lines.size()))
         return;
 
-    auto& entry = lines.getReference(index);
+    auto& entry = lines[index];
     auto range = zone.getColumnRangeOnRow(index, entry.tokens.size());
 
     ensureValid(index);
@@ -1029,7 +1062,7 @@ void GlyphArrangementArray::applyTokens(int index, Selection zone)
     }
 }
 
-GlyphArrangement GlyphArrangementArray::getGlyphs(int index,
+inline GlyphArrangement GlyphArrangementArray::getGlyphs(int index,
     float baseline,
     int token,
     bool withTrailingSpace) const
@@ -1044,7 +1077,7 @@ GlyphArrangement GlyphArrangementArray::getGlyphs(int index,
     }
     ensureValid(index);
 
-    auto& entry = lines.getReference(index);
+    auto& entry = lines[index];
     auto glyphSource = withTrailingSpace ? entry.glyphsWithTrailingSpace : entry.glyphs;
     auto glyphs = GlyphArrangement();
 
@@ -1058,39 +1091,63 @@ GlyphArrangement GlyphArrangementArray::getGlyphs(int index,
     return glyphs;
 }
 
-void GlyphArrangementArray::ensureValid(int index) const
+inline void GlyphArrangementArray::ensureValid(int index) const
 {
     if (!isPositiveAndBelow(index, lines.size()))
         return;
 
-    auto& entry = lines.getReference(index);
+    auto& entry = lines[index];
 
     if (entry.glyphsAreDirty) {
         entry.tokens.resize(entry.string.length());
+        entry.glyphs.clear();
         entry.glyphs.addLineOfText(font, entry.string, 0.f, 0.f);
+        entry.glyphsWithTrailingSpace.clear();
         entry.glyphsWithTrailingSpace.addLineOfText(font, entry.string + " ", 0.f, 0.f);
+        entry.width = entry.glyphs.getBoundingBox(0, -1, true).getRight();
         entry.glyphsAreDirty = !cacheGlyphArrangement;
+        widestMeasuredWidth = jmax(widestMeasuredWidth, entry.width);
     }
 }
 
-void GlyphArrangementArray::invalidateAll()
+inline void GlyphArrangementArray::invalidateAll()
 {
-    for (auto& entry : lines) {
+    lines.forEach([](Entry& entry) {
         entry.glyphsAreDirty = true;
         entry.tokensAreDirty = true;
-    }
+    });
 }
 
-void TextDocument::replaceAll(String const& content)
+inline void TextDocument::replaceAll(String const& content)
 {
     lines.clear();
+    cachedBounds = {};
 
     for (auto const& line : StringArray::fromLines(content)) {
         lines.add(line);
     }
 }
 
-StringArray TextDocument::getText() const
+inline void TextDocument::appendText(String const& content)
+{
+    // Same as replacing everything with getText() + content, but only the last line is touched
+    String lastLine;
+    if (lines.size() > 0) {
+        lastLine = lines[lines.size() - 1];
+        lines.removeRange(lines.size() - 1, 1);
+    }
+
+    auto width = cachedBounds.getWidth();
+    for (auto const& line : StringArray::fromLines(lastLine + content)) {
+        lines.add(line);
+        width = jmax(width, lines.getWidth(lines.size() - 1));
+    }
+
+    if (!cachedBounds.isEmpty())
+        cachedBounds = cachedBounds.withWidth(width).withHeight(getHeight());
+}
+
+inline StringArray TextDocument::getText() const
 {
     StringArray text;
     for (int i = 0; i < lines.size(); i++) {
@@ -1100,17 +1157,17 @@ StringArray TextDocument::getText() const
     return text;
 }
 
-int TextDocument::getNumRows() const
+inline int TextDocument::getNumRows() const
 {
     return lines.size();
 }
 
-int TextDocument::getNumColumns(int row) const
+inline int TextDocument::getNumColumns(int row) const
 {
     return lines[row].length();
 }
 
-float TextDocument::getVerticalPosition(int row, Metric metric) const
+inline float TextDocument::getVerticalPosition(int row, Metric metric) const
 {
     float lineHeight = font.getHeight() * lineSpacing;
     float gap = font.getHeight() * (lineSpacing - 1.f) * 0.5f;
@@ -1131,12 +1188,12 @@ float TextDocument::getVerticalPosition(int row, Metric metric) const
     }
 }
 
-Point<float> TextDocument::getPosition(Point<int> index, Metric metric) const
+inline Point<float> TextDocument::getPosition(Point<int> index, Metric metric) const
 {
     return { getGlyphBounds(index).getX(), getVerticalPosition(index.x, metric) };
 }
 
-Array<Rectangle<float>> TextDocument::getSelectionRegion(Selection selection, Rectangle<float> clip) const
+inline Array<Rectangle<float>> TextDocument::getSelectionRegion(Selection selection, Rectangle<float> clip) const
 {
     Array<Rectangle<float>> patches;
     Selection s = selection.oriented();
@@ -1168,20 +1225,27 @@ Array<Rectangle<float>> TextDocument::getSelectionRegion(Selection selection, Re
     return patches;
 }
 
-Rectangle<float> TextDocument::getBounds() const
+inline Rectangle<float> TextDocument::getBounds() const
 {
     if (cachedBounds.isEmpty()) {
-        auto bounds = Rectangle<float>();
-
+        // Lines that weren't laid out yet are estimated from their length, so we don't lay out the whole document here
+        auto width = 0.f;
         for (int n = 0; n < getNumRows(); ++n) {
-            bounds = bounds.getUnion(getBoundsOnRow(n, Range<int>(0, std::max(1, getNumColumns(n)))));
+            width = jmax(width, lines.getWidth(n));
         }
-        return cachedBounds = bounds;
+        lines.widestMeasuredWidth = 0.f;
+        return cachedBounds = Rectangle<float>(TEXT_INDENT, 0.f, width, getHeight());
     }
+
+    // A line that was laid out since then can turn out to be wider than we estimated
+    if (lines.widestMeasuredWidth > cachedBounds.getWidth())
+        cachedBounds.setWidth(lines.widestMeasuredWidth);
+
+    lines.widestMeasuredWidth = 0.f;
     return cachedBounds;
 }
 
-Rectangle<float> TextDocument::getBoundsOnRow(int row, Range<int> columns) const
+inline Rectangle<float> TextDocument::getBoundsOnRow(int row, Range<int> columns) const
 {
     return getGlyphsForRow(row, -1, true)
         .getBoundingBox(columns.getStart(), columns.getLength(), true)
@@ -1189,13 +1253,13 @@ Rectangle<float> TextDocument::getBoundsOnRow(int row, Range<int> columns) const
         .withBottom(getVerticalPosition(row, Metric::bottom));
 }
 
-Rectangle<float> TextDocument::getGlyphBounds(Point<int> index) const
+inline Rectangle<float> TextDocument::getGlyphBounds(Point<int> index) const
 {
     index.y = jlimit(0, getNumColumns(index.x), index.y);
     return getBoundsOnRow(index.x, Range<int>(index.y, index.y + 1));
 }
 
-GlyphArrangement TextDocument::getGlyphsForRow(int row, int token, bool withTrailingSpace) const
+inline GlyphArrangement TextDocument::getGlyphsForRow(int row, int token, bool withTrailingSpace) const
 {
     return lines.getGlyphs(row,
         getVerticalPosition(row, Metric::baseline),
@@ -1203,7 +1267,7 @@ GlyphArrangement TextDocument::getGlyphsForRow(int row, int token, bool withTrai
         withTrailingSpace);
 }
 
-GlyphArrangement TextDocument::findGlyphsIntersecting(Rectangle<float> area, int token) const
+inline GlyphArrangement TextDocument::findGlyphsIntersecting(Rectangle<float> area, int token) const
 {
     auto range = getRangeOfRowsIntersecting(area);
     auto rows = Array<RowData>();
@@ -1215,7 +1279,7 @@ GlyphArrangement TextDocument::findGlyphsIntersecting(Rectangle<float> area, int
     return glyphs;
 }
 
-Range<int> TextDocument::getRangeOfRowsIntersecting(Rectangle<float> area) const
+inline Range<int> TextDocument::getRangeOfRowsIntersecting(Rectangle<float> area) const
 {
     auto lineHeight = font.getHeight() * lineSpacing;
     auto row0 = jlimit(0, jmax(getNumRows() - 1, 0), int(area.getY() / lineHeight));
@@ -1223,7 +1287,7 @@ Range<int> TextDocument::getRangeOfRowsIntersecting(Rectangle<float> area) const
     return { row0, row1 + 1 };
 }
 
-Array<TextDocument::RowData> TextDocument::findRowsIntersecting(Rectangle<float> area,
+inline Array<TextDocument::RowData> TextDocument::findRowsIntersecting(Rectangle<float> area,
     bool computeHorizontalExtent) const
 {
     auto range = getRangeOfRowsIntersecting(area);
@@ -1253,7 +1317,7 @@ Array<TextDocument::RowData> TextDocument::findRowsIntersecting(Rectangle<float>
     return rows;
 }
 
-Point<int> TextDocument::findIndexNearestPosition(Point<float> position) const
+inline Point<int> TextDocument::findIndexNearestPosition(Point<float> position) const
 {
     auto lineHeight = font.getHeight() * lineSpacing;
     auto row = jlimit(0, jmax(getNumRows() - 1, 0), int(position.y / lineHeight));
@@ -1273,12 +1337,12 @@ Point<int> TextDocument::findIndexNearestPosition(Point<float> position) const
     return { row, col };
 }
 
-Point<int> TextDocument::getEnd() const
+inline Point<int> TextDocument::getEnd() const
 {
     return { getNumRows(), 0 };
 }
 
-bool TextDocument::next(Point<int>& index) const
+inline bool TextDocument::next(Point<int>& index) const
 {
     if (index.y < getNumColumns(index.x)) {
         index.y += 1;
@@ -1291,7 +1355,7 @@ bool TextDocument::next(Point<int>& index) const
     return false;
 }
 
-bool TextDocument::prev(Point<int>& index) const
+inline bool TextDocument::prev(Point<int>& index) const
 {
     if (index.y > 0) {
         index.y -= 1;
@@ -1304,7 +1368,7 @@ bool TextDocument::prev(Point<int>& index) const
     return false;
 }
 
-bool TextDocument::nextRow(Point<int>& index) const
+inline bool TextDocument::nextRow(Point<int>& index) const
 {
     if (index.x < getNumRows()) {
         index.x += 1;
@@ -1314,7 +1378,7 @@ bool TextDocument::nextRow(Point<int>& index) const
     return false;
 }
 
-bool TextDocument::prevRow(Point<int>& index) const
+inline bool TextDocument::prevRow(Point<int>& index) const
 {
     if (index.x > 0) {
         index.x -= 1;
@@ -1324,7 +1388,7 @@ bool TextDocument::prevRow(Point<int>& index) const
     return false;
 }
 
-void TextDocument::navigate(Point<int>& i, Target target, Direction direction) const
+inline void TextDocument::navigate(Point<int>& i, Target target, Direction direction) const
 {
     std::function<bool(Point<int>&)> advance;
     std::function<juce_wchar(Point<int>&)> get;
@@ -1394,7 +1458,7 @@ void TextDocument::navigate(Point<int>& i, Target target, Direction direction) c
     }
 }
 
-void TextDocument::navigateSelections(Target target, Direction direction, Selection::Part part)
+inline void TextDocument::navigateSelections(Target target, Direction direction, Selection::Part part)
 {
     for (auto& selection : selections) {
         switch (part) {
@@ -1412,7 +1476,7 @@ void TextDocument::navigateSelections(Target target, Direction direction, Select
     }
 }
 
-Selection TextDocument::search(Point<int> start, String const& target) const
+inline Selection TextDocument::search(Point<int> start, String const& target) const
 {
     while (start != getEnd()) {
         auto y = lines[start.x].indexOf(start.y, target);
@@ -1426,7 +1490,7 @@ Selection TextDocument::search(Point<int> start, String const& target) const
     return {};
 }
 
-juce_wchar TextDocument::getCharacter(Point<int> index) const
+inline juce_wchar TextDocument::getCharacter(Point<int> index) const
 {
     jassert(0 <= index.x && index.x <= lines.size());
     jassert(0 <= index.y && index.y <= lines[index.x].length());
@@ -1437,17 +1501,17 @@ juce_wchar TextDocument::getCharacter(Point<int> index) const
     return lines[index.x].getCharPointer()[index.y];
 }
 
-Selection const& TextDocument::getSelection(int index) const
+inline Selection const& TextDocument::getSelection(int index) const
 {
     return selections.getReference(index);
 }
 
-Array<Selection> const& TextDocument::getSelections() const
+inline Array<Selection> const& TextDocument::getSelections() const
 {
     return selections;
 }
 
-String TextDocument::getSelectionContent(Selection s) const
+inline String TextDocument::getSelectionContent(Selection s) const
 {
     s = s.oriented();
 
@@ -1464,10 +1528,8 @@ String TextDocument::getSelectionContent(Selection s) const
     }
 }
 
-Transaction TextDocument::fulfill(Transaction const& transaction)
+inline Transaction TextDocument::fulfill(Transaction const& transaction)
 {
-    cachedBounds = {}; // invalidate the bounds
-
     auto const t = transaction.accountingForSpecialCharacters(*this);
     auto const s = t.selection.oriented();
     auto const L = getSelectionContent(s.horizontallyMaximized(*this));
@@ -1480,6 +1542,12 @@ Transaction TextDocument::fulfill(Transaction const& transaction)
         existingSelection.pushBy(Selection(t.content).startingFrom(s.head));
     }
 
+    // Only the edited lines are replaced, the others keep their layout
+    auto removedWidth = 0.f;
+    for (int n = s.head.x; n <= s.tail.x; ++n) {
+        removedWidth = jmax(removedWidth, lines.getWidth(n));
+    }
+
     lines.removeRange(s.head.x, s.tail.x - s.head.x + 1);
     int row = s.head.x;
 
@@ -1490,6 +1558,17 @@ Transaction TextDocument::fulfill(Transaction const& transaction)
         lines.insert(row++, line);
     }
 
+    // The bounds only have to be measured again if the widest line might have been removed
+    if (!cachedBounds.isEmpty() && removedWidth < cachedBounds.getWidth()) {
+        auto width = cachedBounds.getWidth();
+        for (int n = s.head.x; n < row; ++n) {
+            width = jmax(width, lines.getWidth(n));
+        }
+        cachedBounds = cachedBounds.withWidth(width).withHeight(getHeight());
+    } else {
+        cachedBounds = {};
+    }
+
     using D = Transaction::Direction;
     auto inf = std::numeric_limits<float>::max();
 
@@ -1502,14 +1581,14 @@ Transaction TextDocument::fulfill(Transaction const& transaction)
     return r;
 }
 
-void TextDocument::clearTokens(Range<int> rows)
+inline void TextDocument::clearTokens(Range<int> rows)
 {
     for (int n = rows.getStart(); n < rows.getEnd(); ++n) {
         lines.clearTokens(n);
     }
 }
 
-void TextDocument::applyTokens(Range<int> rows, Array<Selection> const& zones)
+inline void TextDocument::applyTokens(Range<int> rows, Array<Selection> const& zones)
 {
     for (int n = rows.getStart(); n < rows.getEnd(); ++n) {
         for (auto const& zone : zones) {
@@ -1547,7 +1626,7 @@ public:
     Transaction reverse;
 };
 
-Transaction Transaction::accountingForSpecialCharacters(TextDocument const& document) const
+inline Transaction Transaction::accountingForSpecialCharacters(TextDocument const& document) const
 {
     Transaction t = *this;
     auto& s = t.selection;
@@ -1569,12 +1648,12 @@ Transaction Transaction::accountingForSpecialCharacters(TextDocument const& docu
     return t;
 }
 
-UndoableAction* Transaction::on(TextDocument& document, Callback callback)
+inline UndoableAction* Transaction::on(TextDocument& document, Callback callback)
 {
     return new Undoable(document, std::move(callback), *this);
 }
 
-PlugDataTextEditor::PlugDataTextEditor()
+inline PlugDataTextEditor::PlugDataTextEditor()
     : caret(document)
     , gutter(document)
     , highlight(document)
@@ -1592,31 +1671,37 @@ PlugDataTextEditor::PlugDataTextEditor()
     addAndMakeVisible(gutter);
 }
 
-void PlugDataTextEditor::paintOverChildren(Graphics& g)
+inline void PlugDataTextEditor::paintOverChildren(Graphics& g)
 {
     g.setColour(findColour(PlugDataColour::outlineColourId));
     g.drawHorizontalLine(0, 0, getWidth());
     g.drawHorizontalLine(getHeight() - 1, 0, getWidth());
 }
 
-void PlugDataTextEditor::setFont(Font const& font)
+inline void PlugDataTextEditor::setFont(Font const& font)
 {
     document.setFont(font);
     repaint();
 }
 
-void PlugDataTextEditor::setText(String const& text)
+inline void PlugDataTextEditor::setText(String const& text)
 {
     document.replaceAll(text);
     repaint();
 }
 
-String PlugDataTextEditor::getText() const
+inline void PlugDataTextEditor::appendText(String const& text)
+{
+    document.appendText(text);
+    repaint();
+}
+
+inline String PlugDataTextEditor::getText() const
 {
     return document.getText().joinIntoString("\r");
 }
 
-void PlugDataTextEditor::translateView(float dx, float dy)
+inline void PlugDataTextEditor::translateView(float dx, float dy)
 {
     auto W = viewScaleFactor * document.getBounds().getWidth();
     auto H = viewScaleFactor * document.getBounds().getHeight();
@@ -1627,7 +1712,7 @@ void PlugDataTextEditor::translateView(float dx, float dy)
     updateViewTransform();
 }
 
-void PlugDataTextEditor::scaleView(float scaleFactorMultiplier, float verticalCenter)
+inline void PlugDataTextEditor::scaleView(float scaleFactorMultiplier, float verticalCenter)
 {
     auto newS = viewScaleFactor * scaleFactorMultiplier;
     auto fixedy = Point<float>(0, verticalCenter).transformedBy(transform.inverted()).y;
@@ -1637,7 +1722,7 @@ void PlugDataTextEditor::scaleView(float scaleFactorMultiplier, float verticalCe
     updateViewTransform();
 }
 
-void PlugDataTextEditor::updateViewTransform()
+inline void PlugDataTextEditor::updateViewTransform()
 {
     transform = AffineTransform::scale(viewScaleFactor).translated(translation.x, translation.y);
     highlight.setViewTransform(transform);
@@ -1646,14 +1731,14 @@ void PlugDataTextEditor::updateViewTransform()
     repaint();
 }
 
-void PlugDataTextEditor::updateSelections()
+inline void PlugDataTextEditor::updateSelections()
 {
     highlight.updateSelections();
     caret.updateSelections();
     gutter.updateSelections();
 }
 
-void PlugDataTextEditor::translateToEnsureCaretIsVisible()
+inline void PlugDataTextEditor::translateToEnsureCaretIsVisible()
 {
     auto i = document.getSelections().getLast().head;
     auto t = Point<float>(0.f, document.getVerticalPosition(i.x, TextDocument::Metric::top)).transformedBy(transform);
@@ -1666,14 +1751,14 @@ void PlugDataTextEditor::translateToEnsureCaretIsVisible()
     }
 }
 
-void PlugDataTextEditor::resized()
+inline void PlugDataTextEditor::resized()
 {
     highlight.setBounds(getLocalBounds());
     caret.setBounds(getLocalBounds());
     gutter.setBounds(getLocalBounds());
 }
 
-void PlugDataTextEditor::paint(Graphics& g)
+inline void PlugDataTextEditor::paint(Graphics& g)
 {
     g.fillAll(findColour(PlugDataColour::canvasBackgroundColourId));
 
@@ -1695,7 +1780,7 @@ void PlugDataTextEditor::paint(Graphics& g)
     }
 }
 
-void PlugDataTextEditor::mouseDown(MouseEvent const& e)
+inline void PlugDataTextEditor::mouseDown(MouseEvent const& e)
 {
     if (e.getNumberOfClicks() > 1) {
         return;
@@ -1716,7 +1801,7 @@ void PlugDataTextEditor::mouseDown(MouseEvent const& e)
     updateSelections();
 }
 
-void PlugDataTextEditor::mouseDrag(MouseEvent const& e)
+inline void PlugDataTextEditor::mouseDrag(MouseEvent const& e)
 {
     if (e.mouseWasDraggedSinceMouseDown()) {
         auto selection = document.getSelections().getFirst();
@@ -1727,7 +1812,7 @@ void PlugDataTextEditor::mouseDrag(MouseEvent const& e)
     }
 }
 
-void PlugDataTextEditor::mouseDoubleClick(MouseEvent const& e)
+inline void PlugDataTextEditor::mouseDoubleClick(MouseEvent const& e)
 {
     if (e.getNumberOfClicks() == 2) {
         document.navigateSelections(TextDocument::Target::whitespace, TextDocument::Direction::backwardCol, Selection::Part::head);
@@ -1741,7 +1826,7 @@ void PlugDataTextEditor::mouseDoubleClick(MouseEvent const& e)
     updateSelections();
 }
 
-void PlugDataTextEditor::mouseWheelMove(MouseEvent const& e, MouseWheelDetails const& d)
+inline void PlugDataTextEditor::mouseWheelMove(MouseEvent const& e, MouseWheelDetails const& d)
 {
     float dx = d.deltaX;
     /*
@@ -1753,12 +1838,12 @@ void PlugDataTextEditor::mouseWheelMove(MouseEvent const& e, MouseWheelDetails c
     translateView(dx * 400, d.deltaY * 800);
 }
 
-void PlugDataTextEditor::mouseMagnify(MouseEvent const& e, float scaleFactor)
+inline void PlugDataTextEditor::mouseMagnify(MouseEvent const& e, float scaleFactor)
 {
     scaleView(scaleFactor, e.position.y);
 }
 
-bool PlugDataTextEditor::keyPressed(KeyPress const& key)
+inline bool PlugDataTextEditor::keyPressed(KeyPress const& key)
 {
 
     using Target = TextDocument::Target;
@@ -1897,7 +1982,7 @@ bool PlugDataTextEditor::keyPressed(KeyPress const& key)
     return false;
 }
 
-bool PlugDataTextEditor::insert(String const& content)
+inline bool PlugDataTextEditor::insert(String const& content)
 {
     double now = Time::getApproximateMillisecondCounter();
 
@@ -1934,12 +2019,12 @@ bool PlugDataTextEditor::insert(String const& content)
     return true;
 }
 
-MouseCursor PlugDataTextEditor::getMouseCursor()
+inline MouseCursor PlugDataTextEditor::getMouseCursor()
 {
     return getMouseXYRelative().x < GUTTER_WIDTH ? MouseCursor::NormalCursor : MouseCursor::IBeamCursor;
 }
 
-void PlugDataTextEditor::renderTextUsingAttributedStringSingle(Graphics& g)
+inline void PlugDataTextEditor::renderTextUsingAttributedStringSingle(Graphics& g)
 {
     g.saveState();
     g.addTransform(transform);
@@ -1978,7 +2063,7 @@ void PlugDataTextEditor::renderTextUsingAttributedStringSingle(Graphics& g)
     g.restoreState();
 }
 
-void PlugDataTextEditor::renderTextUsingAttributedString(Graphics& g)
+inline void PlugDataTextEditor::renderTextUsingAttributedString(Graphics& g)
 {
     /*
      Credit to chrisboy2000 for this
@@ -2023,7 +2108,7 @@ void PlugDataTextEditor::renderTextUsingAttributedString(Graphics& g)
     }
 }
 
-void PlugDataTextEditor::renderTextUsingGlyphArrangement(Graphics& g)
+inline void PlugDataTextEditor::renderTextUsingGlyphArrangement(Graphics& g)
 {
     g.saveState();
     g.addTransform(transform);
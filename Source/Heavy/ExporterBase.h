@@ -211,6 +211,54 @@ struct ExporterBase : public Component
         return metadata.getFullPathName();
     }
 
+protected:
+    // Runs make on a folder generated with hvcc's pdext generator
+    // Used by both the Pd external exporter and the live preview
+    void buildPdExternal(File const& outputFile)
+    {
+        auto workingDir = File::getCurrentWorkingDirectory();
+
+        outputFile.setAsCurrentWorkingDirectory();
+
+        auto bin = Toolchain::dir.getChildFile("bin");
+        auto make = bin.getChildFile("make" + exeSuffix);
+
+#if JUCE_MAC
+        Toolchain::startShellScript("make -j4", this);
+#elif JUCE_WINDOWS
+        File pdDll;
+        if (ProjectInfo::isStandalone) {
+            pdDll = File::getSpecialLocation(File::currentApplicationFile).getParentDirectory();
+        } else {
+            pdDll = File::getSpecialLocation(File::globalApplicationsDirectory).getChildFile("plugdata");
+        }
+
+        auto path = "export PATH=\"$PATH:" + Toolchain::dir.getChildFile("bin").getFullPathName().replaceCharacter('\\', '/') + "\"\n";
+        auto cc = "CC=" + Toolchain::dir.getChildFile("bin").getChildFile("gcc.exe").getFullPathName().replaceCharacter('\\', '/') + " ";
+        auto cxx = "CXX=" + Toolchain::dir.getChildFile("bin").getChildFile("g++.exe").getFullPathName().replaceCharacter('\\', '/') + " ";
+        auto pdbindir = "PDBINDIR=" + pdDll.getFullPathName().replaceCharacter('\\', '/') + " ";
+
+        Toolchain::startShellScript(path + cc + cxx + pdbindir + make.getFullPathName().replaceCharacter('\\', '/') + " -j4", this);
+
+#else // Linux or BSD
+        auto prepareEnvironmentScript = Toolchain::dir.getChildFile("scripts").getChildFile("anywhere-setup.sh").getFullPathName() + "\n";
+
+        auto buildScript = prepareEnvironmentScript
+            + make.getFullPathName()
+            + " -j4";
+
+        Toolchain::startShellScript(buildScript, this);
+#endif
+
+        waitForProcessToFinish(-1);
+        exportingView->flushConsole();
+
+        // Delay to get correct exit code
+        Time::waitForMillisecondCounter(Time::getMillisecondCounter() + 300);
+
+        workingDir.setAsCurrentWorkingDirectory();
+    }
+
 private:
     virtual bool performExport(String pdPatch, String outdir, String name, String copyright, StringArray searchPaths) = 0;
 };
@@ -11,6 +11,9 @@
 #include "HeavyExportDialog.h"
 
 #include "PluginEditor.h"
+#include "Canvas.h"
+#include "Object.h"
+#include "Objects/ObjectBase.h"
 #include "Components/PropertiesPanel.h"
 #include "Utility/OSUtils.h"
 
@@ -27,6 +30,7 @@
 #include "DPFExporter.h"
 #include "DaisyExporter.h"
 #include "PdExporter.h"
+#include "PreviewExporter.h"
 
 class ExporterSettingsPanel : public Component
     , private ListBoxModel {
@@ -44,7 +48,8 @@ public:
         "C++ Code",
         "Electro-Smith Daisy",
         "DPF Audio Plugin",
-        "Pd External"
+        "Pd External",
+        "Live Preview"
     };
 
     ExporterSettingsPanel(PluginEditor* editor, ExportingProgressView* exportingView)
@@ -53,6 +58,7 @@ public:
         addChildComponent(views.add(new DaisyExporter(editor, exportingView)));
         addChildComponent(views.add(new DPFExporter(editor, exportingView)));
         addChildComponent(views.add(new PdExporter(editor, exportingView)));
+        addChildComponent(views.add(new PreviewExporter(editor, exportingView)));
 
         addAndMakeVisible(listBox);
 
@@ -90,10 +96,9 @@ public:
         if(heavyState.isValid())
         {
             this->setState(heavyState);
-            views[0]->setState(heavyState);
-            views[1]->setState(heavyState);
-            views[2]->setState(heavyState);
-            views[3]->setState(heavyState);
+            for (auto* view : views) {
+                view->setState(heavyState);
+            }
         }
     }
 
@@ -101,10 +106,9 @@ public:
     {
         ValueTree state("HeavyState");
         state.appendChild(this->getState(), nullptr);
-        state.appendChild(views[0]->getState(), nullptr);
-        state.appendChild(views[1]->getState(), nullptr);
-        state.appendChild(views[2]->getState(), nullptr);
-        state.appendChild(views[3]->getState(), nullptr);
+        for (auto* view : views) {
+            state.appendChild(view->getState(), nullptr);
+        }
 
         auto settingsTree = SettingsFile::getInstance()->getValueTree();
 
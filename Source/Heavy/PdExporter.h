@@ -105,48 +105,7 @@ public:
         bool generationExitCode = getExitCode();
         // Check if we need to compile
         if (!generationExitCode && getValue<int>(exportTypeValue) == 2) {
-            auto workingDir = File::getCurrentWorkingDirectory();
-
-            outputFile.setAsCurrentWorkingDirectory();
-
-            auto bin = Toolchain::dir.getChildFile("bin");
-            auto make = bin.getChildFile("make" + exeSuffix);
-            auto makefile = outputFile.getChildFile("Makefile");
-
-#if JUCE_MAC
-            Toolchain::startShellScript("make -j4", this);
-#elif JUCE_WINDOWS
-            File pdDll;
-            if (ProjectInfo::isStandalone) {
-                pdDll = File::getSpecialLocation(File::currentApplicationFile).getParentDirectory();
-            } else {
-                pdDll = File::getSpecialLocation(File::globalApplicationsDirectory).getChildFile("plugdata");
-            }
-
-            auto path = "export PATH=\"$PATH:" + Toolchain::dir.getChildFile("bin").getFullPathName().replaceCharacter('\\', '/') + "\"\n";
-            auto cc = "CC=" + Toolchain::dir.getChildFile("bin").getChildFile("gcc.exe").getFullPathName().replaceCharacter('\\', '/') + " ";
-            auto cxx = "CXX=" + Toolchain::dir.getChildFile("bin").getChildFile("g++.exe").getFullPathName().replaceCharacter('\\', '/') + " ";
-            auto pdbindir = "PDBINDIR=" + pdDll.getFullPathName().replaceCharacter('\\', '/') + " ";
-
-            Toolchain::startShellScript(path + cc + cxx + pdbindir + make.getFullPathName().replaceCharacter('\\', '/') + " -j4", this);
-
-#else // Linux or BSD
-            auto prepareEnvironmentScript = Toolchain::dir.getChildFile("scripts").getChildFile("anywhere-setup.sh").getFullPathName() + "\n";
-
-            auto buildScript = prepareEnvironmentScript
-                + make.getFullPathName()
-                + " -j4";
-
-            Toolchain::startShellScript(buildScript, this);
-#endif
-
-            waitForProcessToFinish(-1);
-            exportingView->flushConsole();
-
-            // Delay to get correct exit code
-            Time::waitForMillisecondCounter(Time::getMillisecondCounter() + 300);
-
-            workingDir.setAsCurrentWorkingDirectory();
+            buildPdExternal(outputFile);
 
 #if JUCE_MAC
             auto external = outputFile.getChildFile(name + "~.pd_darwin");
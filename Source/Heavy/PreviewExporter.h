@@ -0,0 +1,244 @@
+/*
+ // Copyright (c) 2022 Timothy Schoen and Wasted Audio
+ // For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ // WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+
+// Compiles the selected subpatch into a Pd external with hvcc, and swaps it into the running patch
+// The external is loaded by Pd's own loader from an absolute path, so the compiled object takes
+// the place of the subpatch with its connections intact. Undo will bring back the interpreted subpatch,
+// so the two versions can be compared by using undo/redo
+class PreviewExporter : public ExporterBase {
+public:
+    Component::SafePointer<Object> previewTarget;
+    File previewPatchFile;
+
+    PreviewExporter(PluginEditor* editor, ExportingProgressView* exportingView)
+        : ExporterBase(editor, exportingView)
+    {
+        exportButton.setButtonText("Compile");
+
+        // The preview always uses the subpatch that is selected when compiling, not the patch chooser
+        exportButton.onClick = [this]() {
+            previewTarget = findSelectedSubpatch();
+            if (!previewTarget) {
+                exportingView->logToConsole("Select a subpatch to preview\n");
+                exportingView->showState(ExportingProgressView::Failure);
+                return;
+            }
+
+            auto content = previewTarget->gui->getPatch()->getCanvasContent();
+            if (auto error = findUnsupportedObjects(content); error.isNotEmpty()) {
+                exportingView->logToConsole(error + "\n");
+                exportingView->showState(ExportingProgressView::Failure);
+                return;
+            }
+
+            previewPatchFile = File::createTempFile(".pd");
+            Toolchain::deleteTempFileLater(previewPatchFile);
+            previewPatchFile.replaceWithText(convertIolets(content), false, false, "\n");
+
+            startExport(getPreviewDirectory().getChildFile(getPreviewName()));
+        };
+    }
+
+    ValueTree getState() override
+    {
+        ValueTree stateTree("Preview");
+        stateTree.setProperty("projectNameValue", getValue<String>(projectNameValue), nullptr);
+        return stateTree;
+    }
+
+    void setState(ValueTree& stateTree) override
+    {
+        auto tree = stateTree.getChildWithName("Preview");
+        projectNameValue = tree.getProperty("projectNameValue");
+    }
+
+    void valueChanged(Value& v) override
+    {
+        // The patch chooser doesn't apply here, so don't let it disable the compile button
+        ExporterBase::valueChanged(v);
+        exportButton.setEnabled(true);
+    }
+
+    // Compiled previews are kept until the next session, because undo/redo might need to load them again
+    static File getPreviewDirectory()
+    {
+        return File::getSpecialLocation(File::tempDirectory).getChildFile("plugdata_heavy_preview");
+    }
+
+    // Pd can't replace a class that was already loaded, so every build needs a unique name
+    static String getPreviewName()
+    {
+        static int previewCount = 0;
+        return "preview_" + String::toHexString(static_cast<int>(Time::currentTimeMillis() & 0xFFFFFF)) + "_" + String(previewCount++);
+    }
+
+    // Only signal iolets are converted, so the compiled object would lose the connections of control iolets
+    // Parameters change the inlets of the compiled object too, so subpatches with either of them can't take the subpatch's place
+    static String findUnsupportedObjects(String const& patchContent)
+    {
+        int canvasDepth = 0;
+        for (auto const& line : StringArray::fromLines(patchContent)) {
+            auto tokens = StringArray::fromTokens(line.upToLastOccurrenceOf(";", false, false), true);
+
+            if (tokens[0] == "#N" && tokens[1] == "canvas") {
+                canvasDepth++;
+            } else if (tokens[0] == "#X" && tokens[1] == "restore") {
+                canvasDepth--;
+            } else if (tokens[0] == "#X" && tokens[1] == "obj") {
+                if (canvasDepth == 1 && (tokens[4] == "inlet" || tokens[4] == "outlet"))
+                    return "Can't preview subpatches with control " + tokens[4] + "s";
+                if (tokens.contains("@hv_param"))
+                    return "Can't preview subpatches with @hv_param receivers";
+            }
+        }
+
+        return {};
+    }
+
+    // Signal iolets of a subpatch have no meaning in a top-level Heavy patch, so we turn them into adc~ and dac~ channels
+    // Pd sorts iolets by their x position, so we sort them the same way to keep the channel order equal to the iolet order
+    static String convertIolets(String const& patchContent)
+    {
+        auto lines = StringArray::fromLines(patchContent);
+
+        // Subpatch content ends with a restore message that we don't need
+        for (int i = lines.size() - 1; i >= 0; i--) {
+            if (lines[i].startsWith("#X restore")) {
+                lines.removeRange(i, lines.size() - i);
+                break;
+            }
+            if (lines[i].trim().isNotEmpty())
+                break;
+        }
+
+        Array<std::pair<int, int>> signalInlets;
+        Array<std::pair<int, int>> signalOutlets;
+
+        int canvasDepth = 0;
+        for (int i = 0; i < lines.size(); i++) {
+            auto tokens = StringArray::fromTokens(lines[i].upToLastOccurrenceOf(";", false, false), true);
+
+            if (tokens[0] == "#N" && tokens[1] == "canvas") {
+                canvasDepth++;
+            } else if (tokens[0] == "#X" && tokens[1] == "restore") {
+                canvasDepth--;
+            } else if (canvasDepth == 1 && tokens[0] == "#X" && tokens[1] == "obj") {
+                if (tokens[4] == "inlet~")
+                    signalInlets.add({ tokens[2].getIntValue(), i });
+                if (tokens[4] == "outlet~")
+                    signalOutlets.add({ tokens[2].getIntValue(), i });
+            }
+        }
+
+        auto replaceIolets = [&lines](Array<std::pair<int, int>>& iolets, String const& replacement) {
+            std::stable_sort(iolets.begin(), iolets.end(), [](auto const& a, auto const& b) {
+                return a.first < b.first;
+            });
+
+            for (int channel = 0; channel < iolets.size(); channel++) {
+                auto tokens = StringArray::fromTokens(lines[iolets[channel].second].upToLastOccurrenceOf(";", false, false), true);
+                auto newLine = tokens[0] + " " + tokens[1] + " " + tokens[2] + " " + tokens[3] + " " + replacement + " " + String(channel + 1);
+
+                // Keep the width, if it was set
+                auto width = lines[iolets[channel].second].fromLastOccurrenceOf(", f ", true, false);
+                lines.set(iolets[channel].second, newLine + (width.isNotEmpty() ? width : ";"));
+            }
+        };
+
+        replaceIolets(signalInlets, "adc~");
+        replaceIolets(signalOutlets, "dac~");
+
+        return lines.joinIntoString("\n");
+    }
+
+private:
+    Object* findSelectedSubpatch() const
+    {
+        auto* cnv = editor->getCurrentCanvas();
+        if (!cnv)
+            return nullptr;
+
+        for (auto* object : cnv->getSelectionOfType<Object>()) {
+            if (!object->gui)
+                continue;
+
+            auto subpatch = object->gui->getPatch();
+            if (subpatch && subpatch->isSubpatch())
+                return object;
+        }
+
+        return nullptr;
+    }
+
+    bool performExport(String pdPatch, String outdir, String name, String copyright, StringArray searchPaths) override
+    {
+        exportingView->showState(ExportingProgressView::Busy);
+
+        auto outputFile = File(outdir);
+        outputFile.createDirectory();
+
+        // The folder name is unique, we use it as the name of the compiled object
+        name = outputFile.getFileName();
+
+        StringArray args = { heavyExecutable.getFullPathName(), previewPatchFile.getFullPathName(), "-o" + outdir };
+
+        args.add("-n" + name);
+        args.add("-v");
+        args.add("-gpdext");
+
+        String paths = "-p";
+        for (auto& path : searchPaths) {
+            paths += " " + path;
+        }
+
+        args.add(paths);
+
+        if (shouldQuit)
+            return true;
+
+        start(args.joinIntoString(" "));
+
+        waitForProcessToFinish(-1);
+        exportingView->flushConsole();
+
+        if (shouldQuit)
+            return true;
+
+        outputFile.getChildFile("ir").deleteRecursively();
+        outputFile.getChildFile("hv").deleteRecursively();
+
+        // Delay to get correct exit code
+        Time::waitForMillisecondCounter(Time::getMillisecondCounter() + 300);
+
+        if (getExitCode())
+            return true;
+
+        buildPdExternal(outputFile);
+
+        if (shouldQuit || getExitCode())
+            return true;
+
+        // Pd accepts absolute paths as object names, and will dlopen the external from there
+        auto externalPath = outputFile.getChildFile(name + "~").getFullPathName().replaceCharacter('\\', '/');
+
+        MessageManager::callAsync([_this = SafePointer(this), externalPath]() {
+            if (!_this || !_this->previewTarget) {
+                return;
+            }
+
+            auto* object = _this->previewTarget.getComponent();
+            auto* cnv = object->cnv;
+
+            cnv->patch.startUndoSequence("HeavyPreview");
+            object->setType(externalPath);
+            cnv->patch.endUndoSequence("HeavyPreview");
+
+            cnv->pd->logMessage("Heavy preview loaded, use undo to switch back to the original subpatch");
+        });
+
+        return false;
+    }
+};
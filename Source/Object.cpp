@@ -20,6 +20,7 @@
 #include "PluginProcessor.h"
 #include "ObjectGrid.h"
 #include "Objects/ObjectBase.h"
+#include "Utility/StackShadow.h"
 
 #include "Dialogs/Dialogs.h"
 #include "Heavy/CompatibleObjects.h"
@@ -68,6 +69,7 @@ Object::~Object()
 {
     hideEditor(); // Make sure the editor is not still open, that could lead to issues with listeners attached to the editor (i.e. suggestioncomponent)
     cnv->selectedComponents.removeChangeListener(this);
+    cnv->removeFromCulling(this);
 }
 
 Rectangle<int> Object::getObjectBounds()
@@ -160,7 +162,7 @@ void Object::valueChanged(Value& v)
     } else if (v.refersToSameSourceAs(cnv->presentationMode)) {
         // else it was a lock/unlock/presentation mode action
         // Hide certain objects in GOP
-        setVisible(!((cnv->isGraph || cnv->presentationMode == var(true)) && gui && gui->hideInGraph()));
+        updateVisibility();
     } else if (v.refersToSameSourceAs(cnv->locked) || v.refersToSameSourceAs(cnv->commandLocked)) {
         if (gui) {
             gui->lock(cnv->isGraph || locked == var(true) || commandLocked == var(true));
@@ -360,6 +362,7 @@ void Object::setType(String const& newType, t_gobj* existingObject)
         gui->lock(cnv->isGraph || locked == var(true) || commandLocked == var(true));
         gui->addMouseListener(this, true);
         addAndMakeVisible(gui.get());
+        gui->setVisible(!cnv->isLowDetail());
     }
 
     isHvccCompatible = checkIfHvccCompatible();
@@ -468,7 +471,7 @@ void Object::paintOverChildren(Graphics& g)
         int halfHeight = 5;
 
         auto text = String(cnv->objects.indexOf(this));
-        int textWidth = Fonts::getMonospaceFont().withHeight(10).getStringWidth(text) + 5;
+        int textWidth = TextLayoutCache::getStringWidth(text, Fonts::getMonospaceFont().withHeight(10)) + 5;
         int left = std::min<int>(getWidth() - (1.5 * margin), getWidth() - textWidth);
 
         auto indexBounds = Rectangle<int>(left, (getHeight() / 2) - halfHeight, getWidth() - left, halfHeight * 2);
@@ -502,11 +505,26 @@ void Object::triggerOverlayActiveState()
 
 void Object::paint(Graphics& g)
 {
+    // Low detail mode: the gui is hidden, so we only draw a plain box in its place
+    if (gui && !gui->isVisible() && cnv->isLowDetail()) {
+        auto bounds = getLocalBounds().reduced(margin).toFloat();
+
+        g.setColour(findColour(PlugDataColour::textObjectBackgroundColourId));
+        g.fillRect(bounds);
+
+        g.setColour(findColour(selectedFlag ? PlugDataColour::objectSelectedOutlineColourId : PlugDataColour::objectOutlineColourId));
+        g.drawRect(bounds, 1.0f);
+        return;
+    }
+
     if ((showActiveState || isTimerRunning())) {
-        g.setOpacity(activeStateAlpha);
         // show activation state glow
-        g.drawImage(activityOverlayImage, getLocalBounds().toFloat());
-        g.setOpacity(1.0f);
+        // The glow image is shared between all objects, and stretched to fit
+        g.saveState();
+        g.excludeClipRegion(getLocalBounds().reduced(Object::margin + 1));
+        g.setOpacity(activeStateAlpha);
+        NinePatchShadow::drawRoundedRectangle(g, getLocalBounds().reduced(Object::margin - 2).toFloat(), Corners::objectCornerRadius, 5, findColour(PlugDataColour::dataColourId), false);
+        g.restoreState();
     }
     if ((selectedFlag && !cnv->isGraph) || newObjectEditor) {
         if (newObjectEditor) {
@@ -543,9 +561,39 @@ void Object::paint(Graphics& g)
     }
 }
 
+void Object::updateVisibility()
+{
+    setVisible(!isCulled && !((cnv->isGraph || cnv->presentationMode == var(true)) && gui && gui->hideInGraph()));
+}
+
+void Object::setCulled(bool shouldBeCulled)
+{
+    if (isCulled == shouldBeCulled)
+        return;
+
+    isCulled = shouldBeCulled;
+    updateVisibility();
+}
+
+// When zoomed out far, we skip painting the gui and draw a plain box instead
+void Object::updateLevelOfDetail()
+{
+    if (gui) {
+        gui->setVisible(!cnv->isLowDetail() || hasKeyboardFocus(true));
+    }
+
+    repaint();
+}
+
+void Object::moved()
+{
+    cnv->updateCulling(this);
+}
+
 void Object::resized()
 {
-    setVisible(!((cnv->isGraph || cnv->presentationMode == var(true)) && gui && gui->hideInGraph()));
+    cnv->updateCulling(this);
+    updateVisibility();
 
     if (gui) {
         gui->setBounds(getLocalBounds().reduced(margin));
@@ -595,20 +643,6 @@ void Object::resized()
 
         index++;
     }
-
-    if (!getLocalBounds().isEmpty() && activityOverlayImage.getBounds() != getLocalBounds()) {
-        // Pre-render activity state overlay here since it'll always look the same for the same object size
-        activityOverlayImage = Image(Image::ARGB, getWidth(), getHeight(), true);
-        Graphics g(activityOverlayImage);
-        g.saveState();
-
-        g.excludeClipRegion(getLocalBounds().reduced(Object::margin + 1));
-
-        Path objectShadow;
-        objectShadow.addRoundedRectangle(getLocalBounds().reduced(Object::margin - 2), Corners::objectCornerRadius);
-        StackShadow::renderDropShadow(g, objectShadow, findColour(PlugDataColour::dataColourId), 5, { 0, 0 }, 0);
-        g.restoreState();
-    }
 }
 
 void Object::updateTooltips()
@@ -1332,7 +1366,7 @@ void Object::textEditorTextChanged(TextEditor& ed)
     }
 
     // For resize-while-typing behaviour
-    auto width = Font(15).getStringWidth(currentText) + 14.0f;
+    auto width = TextLayoutCache::getStringWidth(currentText, Font(15)) + 14.0f;
 
     width += Object::doubleMargin;
 
@@ -1361,9 +1395,7 @@ void Object::openHelpPatch() const
             return;
         }
 
-        cnv->pd->lockAudioThread();
         cnv->pd->loadPatch(file, cnv->editor, -1);
-        cnv->pd->unlockAudioThread();
 
         return;
     }
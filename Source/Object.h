@@ -40,9 +40,13 @@ public:
     void paint(Graphics&) override;
     void paintOverChildren(Graphics&) override;
     void resized() override;
+    void moved() override;
 
     void updateIolets();
 
+    void setCulled(bool shouldBeCulled);
+    void updateLevelOfDetail();
+
     void setType(String const& newType, t_gobj* existingObject = nullptr);
     void updateBounds();
     void applyBounds();
@@ -116,6 +120,8 @@ private:
 
     void updateTooltips();
 
+    void updateVisibility();
+
     void openNewObjectEditor();
 
     bool checkIfHvccCompatible();
@@ -128,6 +134,7 @@ private:
     bool wasLockedOnMouseDown = false;
     bool indexShown = false;
     bool isHvccCompatible = true;
+    bool isCulled = false;
 
     bool showActiveState = false;
     float activeStateAlpha = 0.0f;
@@ -135,8 +142,6 @@ private:
     bool isObjectMouseActive = false;
     bool isInsideUndoSequence = false;
 
-    Image activityOverlayImage;
-
     ObjectDragState& ds;
 
     RateReducer rateReducer = RateReducer(ACTIVITY_UPDATE_RATE);
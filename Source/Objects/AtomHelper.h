@@ -321,7 +321,7 @@ public:
         auto objectBounds = object->getBounds().reduced(Object::margin);
         int fontHeight = getAtomHeight() - 6;
 
-        int labelLength = Font(fontHeight).getStringWidth(getExpandedLabelText());
+        int labelLength = TextLayoutCache::getStringWidth(getExpandedLabelText(), Font(fontHeight));
 
         int labelPosition = 0;
         if (auto atom = ptr.get<t_fake_gatom>()) {
@@ -175,7 +175,7 @@ public:
 
     Rectangle<int> getPdBounds() override
     {
-        return atomHelper.getPdBounds(input.getFont().getStringWidth(DraggableNumber::formatNumber(input.getText(true).getDoubleValue())));
+        return atomHelper.getPdBounds(TextLayoutCache::getStringWidth(DraggableNumber::formatNumber(input.getText(true).getDoubleValue()), input.getFont()));
     }
 
     void setPdBounds(Rectangle<int> b) override
@@ -310,7 +310,7 @@ public:
             t_symbol const* sym = canvas_realizedollar(iemgui->x_glist, iemgui->x_lab);
             if (sym) {
                 int fontHeight = getFontHeight();
-                int labelLength = Font(fontHeight).getStringWidth(getExpandedLabelText());
+                int labelLength = TextLayoutCache::getStringWidth(getExpandedLabelText(), Font(fontHeight));
 
                 int const posx = objectBounds.getX() + iemgui->x_ldx + 4;
                 int const posy = objectBounds.getY() + iemgui->x_ldy;
@@ -408,6 +408,38 @@ public:
         return Colour();
     }
 
+    // Draws the background, the outline and any decorations that don't depend on the value of the object
+    // These come from a shared image, so repainting when only the value changed is cheap
+    // Decorations are drawn in the internal outline colour, pass anything else they depend on besides the size as parameters
+    void drawStaticLayer(Graphics& g, char const* name, bool withOutline = true, std::function<void(Graphics&)> const& drawDecorations = nullptr, std::initializer_list<float> parameters = {}) const
+    {
+        bool selected = object->isSelected() && !cnv->isGraph;
+        auto backgroundColour = getBackgroundColour();
+        auto internalOutlineColour = object->findColour(PlugDataColour::guiObjectInternalOutlineColour);
+        auto outlineColour = withOutline ? object->findColour(selected ? PlugDataColour::objectSelectedOutlineColourId : objectOutlineColourId) : Colours::transparentBlack;
+
+        auto width = gui->getWidth();
+        auto height = gui->getHeight();
+        auto style = WidgetLayerCache::makeStyle(name, { backgroundColour, internalOutlineColour, outlineColour }, parameters);
+
+        WidgetLayerCache::draw(g, style, width, height, [&](Graphics& layer) {
+            auto bounds = Rectangle<float>(width, height).reduced(0.5f);
+
+            layer.setColour(backgroundColour);
+            layer.fillRoundedRectangle(bounds, Corners::objectCornerRadius);
+
+            if (drawDecorations) {
+                layer.setColour(internalOutlineColour);
+                drawDecorations(layer);
+            }
+
+            if (withOutline) {
+                layer.setColour(outlineColour);
+                layer.drawRoundedRectangle(bounds, Corners::objectCornerRadius, 1.0f);
+            }
+        });
+    }
+
     void setBackgroundColour(Colour colour) const
     {
         if (auto iemgui = ptr.get<t_iemgui>()) {
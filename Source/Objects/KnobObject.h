@@ -79,16 +79,25 @@ public:
 
         startAngle = std::clamp(startAngle, endAngle - MathConstants<float>::twoPi, endAngle + MathConstants<float>::twoPi);
 
-        if (drawArc) {
-            // draw range arc
-            g.setColour(arcColour);
-            auto arcBounds = bounds.reduced(lineThickness);
-            auto arcRadius = arcBounds.getWidth() * 0.5;
-            auto arcWidth = (arcRadius - lineThickness) / arcRadius;
-            Path rangeArc;
-            rangeArc.addPieSegment(arcBounds, startAngle, endAngle, arcWidth);
-            g.fillPath(rangeArc);
+        auto arcBounds = bounds.reduced(lineThickness);
+        auto arcRadius = arcBounds.getWidth() * 0.5;
+        auto arcWidth = (arcRadius - lineThickness) / arcRadius;
+
+        // The range arc and the ticks don't depend on the value, so they come from a shared image
+        auto style = WidgetLayerCache::makeStyle("knob", { fgColour, arcColour }, { startAngle, endAngle, static_cast<float>(numberOfTicks), static_cast<float>(drawArc) });
+        WidgetLayerCache::draw(g, style, getWidth(), getHeight(), [&](Graphics& layer) {
+            if (drawArc) {
+                // draw range arc
+                layer.setColour(arcColour);
+                Path rangeArc;
+                rangeArc.addPieSegment(arcBounds, startAngle, endAngle, arcWidth);
+                layer.fillPath(rangeArc);
+            }
+
+            drawTicks(layer, bounds, startAngle, endAngle, lineThickness);
+        });
 
+        if (drawArc) {
             // draw arc
             auto centre = jmap<double>(arcStart, startAngle, endAngle);
 
@@ -106,8 +115,6 @@ public:
         wiperPath.lineTo(line.getPointAlongLine(wiperRadius - lineThickness * 1.5));
         g.setColour(fgColour);
         g.strokePath(wiperPath, PathStrokeType(lineThickness, PathStrokeType::JointStyle::curved, PathStrokeType::EndCapStyle::rounded));
-
-        drawTicks(g, bounds, startAngle, endAngle, lineThickness);
     }
 
     void setFgColour(Colour newFgColour)
@@ -457,24 +464,32 @@ public:
         bool selected = object->isSelected() && !cnv->isGraph;
         auto outlineColour = object->findColour(selected ? PlugDataColour::objectSelectedOutlineColourId : objectOutlineColourId);
 
-        if (::getValue<bool>(outline)) {
-            g.setColour(Colour::fromString(secondaryColour.toString()));
-            g.fillRoundedRectangle(getLocalBounds().toFloat().reduced(0.5f), Corners::objectCornerRadius);
+        auto backgroundColour = Colour::fromString(secondaryColour.toString());
+        auto drawOutline = ::getValue<bool>(outline);
+        auto width = getWidth();
+        auto height = getHeight();
 
-            g.setColour(outlineColour);
-            g.drawRoundedRectangle(getLocalBounds().toFloat().reduced(0.5f), Corners::objectCornerRadius, 1.0f);
-        } else {
+        auto style = WidgetLayerCache::makeStyle("knob_background", { backgroundColour, outlineColour }, { static_cast<float>(drawOutline) });
+        WidgetLayerCache::draw(g, style, width, height, [&](Graphics& layer) {
+            if (drawOutline) {
+                layer.setColour(backgroundColour);
+                layer.fillRoundedRectangle(Rectangle<float>(width, height).reduced(0.5f), Corners::objectCornerRadius);
 
-            auto bounds = getLocalBounds().toFloat().reduced(getWidth() * 0.13f);
-            auto const lineThickness = std::max(bounds.getWidth() * 0.07f, 1.5f);
-            bounds = bounds.reduced(lineThickness - 0.5f);
+                layer.setColour(outlineColour);
+                layer.drawRoundedRectangle(Rectangle<float>(width, height).reduced(0.5f), Corners::objectCornerRadius, 1.0f);
+            } else {
 
-            g.setColour(Colour::fromString(secondaryColour.toString()));
-            g.fillEllipse(bounds);
+                auto bounds = Rectangle<float>(width, height).reduced(width * 0.13f);
+                auto const lineThickness = std::max(bounds.getWidth() * 0.07f, 1.5f);
+                bounds = bounds.reduced(lineThickness - 0.5f);
 
-            g.setColour(outlineColour);
-            g.drawEllipse(bounds, 1.0f);
-        }
+                layer.setColour(backgroundColour);
+                layer.fillEllipse(bounds);
+
+                layer.setColour(outlineColour);
+                layer.drawEllipse(bounds, 1.0f);
+            }
+        });
     }
 
     void resized() override
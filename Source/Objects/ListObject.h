@@ -138,7 +138,7 @@ public:
 
     Rectangle<int> getPdBounds() override
     {
-        return atomHelper.getPdBounds(listLabel.getFont().getStringWidth(listLabel.getText(true)));
+        return atomHelper.getPdBounds(TextLayoutCache::getStringWidth(listLabel.getText(true), listLabel.getFont()));
     }
 
     void setPdBounds(Rectangle<int> b) override
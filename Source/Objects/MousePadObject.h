@@ -11,6 +11,9 @@ class MousePadObject final : public ObjectBase {
     Point<int> lastPosition;
     Value sizeProperty = SynchronousValue();
 
+    // Copied from the object, so painting doesn't have to touch it
+    Colour fillColour;
+
 public:
     MousePadObject(t_gobj* ptr, Object* object)
         : ObjectBase(ptr, object)
@@ -87,8 +90,6 @@ public:
 
     void paint(Graphics& g) override
     {
-        auto* x = ptr.getRaw<t_fake_pad>();
-        auto fillColour = Colour(x->x_color[0], x->x_color[1], x->x_color[2]);
         g.setColour(fillColour);
         g.fillRoundedRectangle(getLocalBounds().toFloat().reduced(0.5f), Corners::objectCornerRadius);
 
@@ -131,6 +132,7 @@ public:
     {
         if (auto pad = ptr.get<t_fake_pad>()) {
             sizeProperty = Array<var> { var(pad->x_w), var(pad->x_h) };
+            fillColour = Colour(pad->x_color[0], pad->x_color[1], pad->x_color[2]);
         }
     }
 
@@ -185,6 +187,10 @@ public:
     {
         switch (hash(symbol)) {
         case hash("color"): {
+            t_fake_pad pad;
+            if (ptr.snapshot(pad)) {
+                fillColour = Colour(pad.x_color[0], pad.x_color[1], pad.x_color[2]);
+            }
             repaint();
             break;
         }
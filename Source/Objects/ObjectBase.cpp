@@ -9,6 +9,7 @@
 
 #include "Utility/Config.h"
 #include "Utility/Fonts.h"
+#include "Utility/WidgetLayerCache.h"
 
 #include "ObjectBase.h"
 
@@ -169,6 +170,8 @@ ObjectBase::ObjectBase(t_gobj* obj, Object* parent)
 ObjectBase::~ObjectBase()
 {
     pd->unregisterMessageListener(ptr.getRawUnchecked<void>(), this);
+    if (abstractionFile != File())
+        pd->unregisterAbstractionInstance(abstractionFile, object);
     object->removeComponentListener(&objectSizeListener);
 
     auto* lnf = &getLookAndFeel();
@@ -185,6 +188,10 @@ void ObjectBase::initialise()
 
     pd->registerMessageListener(ptr.getRawUnchecked<void>(), this);
 
+    abstractionFile = getAbstractionFile();
+    if (abstractionFile != File())
+        pd->registerAbstractionInstance(abstractionFile, object);
+
     for (auto& [name, type, cat, value, list, valueDefault, customComponent] : objectParameters.getParameters()) {
         if(value) {
             value->addListener(this);
@@ -228,6 +235,18 @@ String ObjectBase::getText()
     return "";
 }
 
+File ObjectBase::getAbstractionFile() const
+{
+    if (auto obj = ptr.get<t_pd>()) {
+        if (pd_class(obj.get()) == canvas_class && canvas_isabstraction(obj.cast<t_glist>())) {
+            auto* glist = obj.cast<t_glist>();
+            return File(String::fromUTF8(canvas_getdir(glist)->s_name)).getChildFile(String::fromUTF8(glist->gl_name->s_name)).withFileExtension("pd");
+        }
+    }
+
+    return {};
+}
+
 String ObjectBase::getType() const
 {
     if (auto obj = ptr.get<t_pd>()) {
@@ -339,7 +358,7 @@ void ObjectBase::openSubpatch()
     File path;
 
     if (abstraction) {
-        path = File(String::fromUTF8(canvas_getdir(glist)->s_name)).getChildFile(String::fromUTF8(glist->gl_name->s_name)).withFileExtension("pd");
+        path = getAbstractionFile();
     }
 
     // Check if subpatch is already opened
@@ -126,6 +126,9 @@ public:
     virtual Canvas* getCanvas();
     virtual pd::Patch::Ptr getPatch();
 
+    // If this object is an abstraction, returns the file that it was loaded from
+    File getAbstractionFile() const;
+
     // Override if you want a part of your object to ignore mouse clicks
     virtual bool canReceiveMouseEvent(int x, int y);
 
@@ -231,6 +234,9 @@ protected:
 
     std::function<void()> onConstrainerCreate = []() {};
 
+    // The file that we registered this abstraction instance under, so we can still unregister it after Pd has freed the object
+    File abstractionFile;
+
     virtual std::unique_ptr<ComponentBoundsConstrainer> createConstrainer();
 
     std::unique_ptr<ObjectLabel> label;
@@ -19,7 +19,7 @@ public:
             editor.reset(TextObjectHelper::createTextEditor(object, 15));
 
             auto font = editor->getFont();
-            auto textWidth = font.getStringWidth(objectText) + 20;
+            auto textWidth = TextLayoutCache::getStringWidth(objectText, font) + 20;
             editor->setBorder(border);
             editor->setBounds(getLocalBounds().withWidth(textWidth));
             object->setSize(textWidth + Object::doubleMargin, getHeight() + Object::doubleMargin);
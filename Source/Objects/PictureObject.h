@@ -4,8 +4,110 @@
  // WARRANTIES, see the file, "LICENSE.txt," in this distribution.
  */
 
+// Decodes images for pic objects on a background thread, and shares them between objects that show the same file
+// Next to the full image, we keep a chain of downscaled copies, so we can draw the one that matches the size on screen
+// Images are only kept in memory while an object uses them
+class PictureCache {
+public:
+    struct Listener {
+        virtual ~Listener() = default;
+        virtual void pictureLoaded() = 0;
+    };
+
+    // Only use this from the message thread
+    class Picture {
+    public:
+        bool isLoaded() const { return loaded; }
+
+        int getWidth() const { return levels.empty() ? 0 : levels.front().getWidth(); }
+        int getHeight() const { return levels.empty() ? 0 : levels.front().getHeight(); }
+
+        // Returns the smallest version of the image that still has enough pixels for the given scale
+        // The scale should include both the zoom level and the display scale
+        Image const& getImageForScale(float scale) const
+        {
+            auto const neededWidth = getWidth() * scale;
+            for (auto it = levels.rbegin(); it != levels.rend(); ++it) {
+                if (it->getWidth() >= neededWidth)
+                    return *it;
+            }
+            return levels.front();
+        }
+
+        ListenerList<Listener> listeners;
+
+    private:
+        friend class PictureCache;
+
+        // Full size image first, every next level is half the size of the previous one
+        std::vector<Image> levels;
+        bool loaded = false;
+    };
+
+    using PicturePtr = std::shared_ptr<Picture>;
+
+    // Objects that show the same version of a file get the same picture
+    PicturePtr getPicture(File const& file)
+    {
+        JUCE_ASSERT_MESSAGE_THREAD
+
+        // Forget pictures that are no longer used
+        for (auto it = pictures.begin(); it != pictures.end();) {
+            it = it->second.expired() ? pictures.erase(it) : std::next(it);
+        }
+
+        auto key = file.getFullPathName() + ":" + String(file.getLastModificationTime().toMilliseconds());
+        if (auto existing = pictures[key].lock())
+            return existing;
+
+        auto picture = std::make_shared<Picture>();
+        pictures[key] = picture;
+
+        pool.addJob([file, weakPicture = std::weak_ptr<Picture>(picture)]() {
+            // The object may already be gone by the time we get here
+            if (weakPicture.expired())
+                return;
+
+            auto levels = decode(file);
+            MessageManager::callAsync([weakPicture, levels]() {
+                if (auto picture = weakPicture.lock()) {
+                    picture->levels = levels;
+                    picture->loaded = true;
+                    picture->listeners.call(&Listener::pictureLoaded);
+                }
+            });
+        });
+
+        return picture;
+    }
+
+private:
+    static std::vector<Image> decode(File const& file)
+    {
+        std::vector<Image> levels;
+
+        auto image = ImageFileFormat::loadFrom(file);
+        if (!image.isValid())
+            return levels;
+
+        levels.push_back(image);
+        while (std::max(image.getWidth(), image.getHeight()) > minimumLevelSize) {
+            image = image.rescaled(std::max(1, image.getWidth() / 2), std::max(1, image.getHeight() / 2), Graphics::mediumResamplingQuality);
+            levels.push_back(image);
+        }
+
+        return levels;
+    }
+
+    static constexpr int minimumLevelSize = 64;
+
+    std::map<String, std::weak_ptr<Picture>> pictures;
+    ThreadPool pool { 2 };
+};
+
 // ELSE pic
-class PictureObject final : public ObjectBase {
+class PictureObject final : public ObjectBase
+    , public PictureCache::Listener {
 
     Value path = SynchronousValue();
     Value latch = SynchronousValue();
@@ -16,7 +118,9 @@ class PictureObject final : public ObjectBase {
     Value sizeProperty = SynchronousValue();
 
     File imageFile;
-    Image img;
+
+    SharedResourcePointer<PictureCache> pictureCache;
+    PictureCache::PicturePtr picture;
 
 public:
     PictureObject(t_gobj* ptr, Object* object)
@@ -44,6 +148,12 @@ public:
         objectParameters.addParamSendSymbol(&sendSymbol);
     }
 
+    ~PictureObject() override
+    {
+        if (picture)
+            picture->listeners.remove(this);
+    }
+
     void mouseDown(MouseEvent const& e) override
     {
         if (!e.mods.isLeftButtonDown())
@@ -126,8 +236,15 @@ public:
 
     void paint(Graphics& g) override
     {
-        if (imageFile.existsAsFile()) {
-            g.drawImageAt(img, 0, 0);
+        if (picture && picture->isLoaded()) {
+            if (picture->getWidth() > 0) {
+                auto const& image = picture->getImageForScale(g.getInternalContext().getPhysicalPixelScaleFactor());
+                g.drawImage(image, 0, 0, picture->getWidth(), picture->getHeight(), 0, 0, image.getWidth(), image.getHeight());
+            }
+        } else if (picture) {
+            // Placeholder while the image is being decoded
+            g.setColour(object->findColour(PlugDataColour::canvasTextColourId).withAlpha(0.08f));
+            g.fillRoundedRectangle(getLocalBounds().toFloat(), Corners::objectCornerRadius);
         } else {
             Fonts::drawText(g, "?", getLocalBounds(), object->findColour(PlugDataColour::canvasTextColourId), 30, Justification::centred);
         }
@@ -259,18 +376,45 @@ public:
         auto* rawFileName = fileNameString.toRawUTF8();
         auto* rawPath = pathString.toRawUTF8();
 
-        img = ImageFileFormat::loadFrom(imageFile);
-
         if (auto pic = ptr.get<t_fake_pic>()) {
             pic->x_filename = pd->generateSymbol(rawFileName);
             pic->x_fullname = pd->generateSymbol(rawPath);
-            pic->x_width = img.getWidth();
-            pic->x_height = img.getHeight();
+        }
+
+        if (picture)
+            picture->listeners.remove(this);
+
+        // Decoding happens in the background, we'll show a placeholder until it's done
+        picture = imageFile.existsAsFile() ? pictureCache->getPicture(imageFile) : nullptr;
+
+        if (!picture) {
+            setImageSize(0, 0);
+            return;
+        }
+
+        picture->listeners.add(this);
+        if (picture->isLoaded()) {
+            pictureLoaded();
+        } else {
+            repaint();
+        }
+    }
+
+    void pictureLoaded() override
+    {
+        setImageSize(picture->getWidth(), picture->getHeight());
+    }
+
+    void setImageSize(int width, int height)
+    {
+        if (auto pic = ptr.get<t_fake_pic>()) {
+            pic->x_width = width;
+            pic->x_height = height;
 
             if (getValue<bool>(reportSize)) {
                 t_atom coordinates[2];
-                SETFLOAT(coordinates, img.getWidth());
-                SETFLOAT(coordinates + 1, img.getHeight());
+                SETFLOAT(coordinates, width);
+                SETFLOAT(coordinates + 1, height);
                 outlet_list(pic->x_outlet, pd->generateSymbol("list"), 2, coordinates);
             }
         }
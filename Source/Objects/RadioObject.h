@@ -181,20 +181,18 @@ public:
 
     void paint(Graphics& g) override
     {
-        g.setColour(iemHelper.getBackgroundColour());
-        g.fillRoundedRectangle(getLocalBounds().toFloat().reduced(0.5f), Corners::objectCornerRadius);
-
         float size = (isVertical ? static_cast<float>(getHeight()) / numItems : static_cast<float>(getWidth()) / numItems);
 
-        g.setColour(object->findColour(PlugDataColour::guiObjectInternalOutlineColour));
-
-        for (int i = 1; i < numItems; i++) {
-            if (isVertical) {
-                g.drawLine(0, i * size, size, i * size);
-            } else {
-                g.drawLine(i * size, 0, i * size, size);
+        // The outline is drawn in paintOverChildren
+        iemHelper.drawStaticLayer(g, "radio", false, [&](Graphics& layer) {
+            for (int i = 1; i < numItems; i++) {
+                if (isVertical) {
+                    layer.drawLine(0, i * size, size, i * size);
+                } else {
+                    layer.drawLine(i * size, 0, i * size, size);
+                }
             }
-        }
+        }, { static_cast<float>(numItems), static_cast<float>(isVertical) });
 
         g.setColour(iemHelper.getForegroundColour());
 
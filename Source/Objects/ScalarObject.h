@@ -73,6 +73,76 @@ public:
 
     virtual void update() = 0;
 
+    // Copies the words of this scalar, the contents of its text fields, and optionally the elements of the array at arrayOnset, so we can draw from the copy
+    // Taking the copy is the only part of an update that needs the audio lock, the paths are built without holding it
+    // Returns false if neither the data nor the canvas changed since the last update: the drawable is still up-to-date, so nothing needs to be rebuilt or repainted
+    bool takeSnapshot(int arrayOnset = -1)
+    {
+        std::swap(words, previousWords);
+        std::swap(arrayElements, previousArrayElements);
+        std::swap(texts, previousTexts);
+
+        pd->lockAudioThread();
+
+        words.assign(data, data + templ->t_n);
+
+        // A text field only holds a pointer to its binbuf, so comparing the words doesn't tell us if the text changed
+        texts.clearQuick();
+        for (int i = 0; i < templ->t_n; i++) {
+            if (templ->t_vec[i].ds_type != DT_TEXT) {
+                texts.add({});
+                continue;
+            }
+
+            char* text;
+            int size;
+            binbuf_gettext(data[i].w_binbuf, &text, &size);
+            texts.add(String::fromUTF8(text, size));
+            t_freebytes(text, size);
+        }
+
+        if (arrayOnset >= 0) {
+            auto* array = *reinterpret_cast<t_array**>(reinterpret_cast<char*>(data) + arrayOnset);
+            arrayElements.assign(array->a_vec, array->a_vec + array->a_n * array->a_elemsize);
+            numArrayElements = array->a_n;
+        } else {
+            arrayElements.clear();
+            numArrayElements = 0;
+        }
+
+        pd->unlockAudioThread();
+
+        auto transform = getCanvasTransform();
+
+        auto changed = !hasSnapshot || transform != lastTransform || arrayElements != previousArrayElements || texts != previousTexts || words.size() != previousWords.size() || std::memcmp(words.data(), previousWords.data(), words.size() * sizeof(t_word)) != 0;
+
+        lastTransform = transform;
+        hasSnapshot = true;
+
+        return changed;
+    }
+
+    t_word* getSnapshot()
+    {
+        return words.data();
+    }
+
+    // Returns the text of the DT_TEXT field at this onset, as it was when the snapshot was taken
+    String const& getTextSnapshot(int onset) const
+    {
+        return texts.getReference(onset / static_cast<int>(sizeof(t_word)));
+    }
+
+    char* getArraySnapshot()
+    {
+        return arrayElements.data();
+    }
+
+    int getArraySnapshotSize() const
+    {
+        return numArrayElements;
+    }
+
     t_float xToPixels(t_float xval)
     {
         if (auto x = canvas->patch.getPointer()) {
@@ -146,6 +216,40 @@ public:
 
         return Colour(red, green, blue);
     }
+
+private:
+    // Everything that xToPixels and yToPixels depend on
+    struct CanvasTransform {
+        t_float x1 = 0, y1 = 0, x2 = 0, y2 = 0;
+        int screenX1 = 0, screenY1 = 0, screenX2 = 0, screenY2 = 0;
+        int pixWidth = 0, pixHeight = 0, xMargin = 0, yMargin = 0;
+        int zoom = 1;
+        bool isGraphChild = false, isGraph = false;
+        Point<int> origin;
+
+        bool operator==(CanvasTransform const&) const = default;
+    };
+
+    CanvasTransform getCanvasTransform()
+    {
+        CanvasTransform transform;
+        if (auto x = canvas->patch.getPointer()) {
+            transform = { x->gl_x1, x->gl_y1, x->gl_x2, x->gl_y2,
+                x->gl_screenx1, x->gl_screeny1, x->gl_screenx2, x->gl_screeny2,
+                x->gl_pixwidth, x->gl_pixheight, x->gl_xmargin, x->gl_ymargin,
+                glist_getzoom(x.get()), getValue<bool>(canvas->isGraphChild), canvas->isGraph, canvas->canvasOrigin };
+        }
+        return transform;
+    }
+
+    // Two copies, so we can compare against the previous update without allocating
+    std::vector<t_word> words, previousWords;
+    std::vector<char> arrayElements, previousArrayElements;
+    int numArrayElements = 0;
+    StringArray texts, previousTexts;
+
+    CanvasTransform lastTransform;
+    bool hasSnapshot = false;
 };
 
 class DrawableCurve final : public DrawableTemplate
@@ -236,6 +340,11 @@ public:
         if (!glist)
             return;
 
+        // Nothing changed since we last drew this, so there's no need to rebuild the path or repaint
+        if (!takeSnapshot())
+            return;
+
+        auto* scalarData = getSnapshot();
         auto* x = reinterpret_cast<t_fake_curve*>(object);
         int n = x->x_npoints;
 
@@ -243,7 +352,7 @@ public:
             scalar_getbasexy(s, &baseX, &baseY);
         }
 
-        if (!fielddesc_getfloat(&x->x_vis, templ, data, 0)) {
+        if (!fielddesc_getfloat(&x->x_vis, templ, scalarData, 0)) {
             setPath(Path());
             return;
         }
@@ -252,37 +361,33 @@ public:
             int flags = x->x_flags;
             int closed = flags & CLOSED;
 
-            t_float width = fielddesc_getfloat(&x->x_width, templ, data, 1);
+            t_float width = fielddesc_getfloat(&x->x_width, templ, scalarData, 1);
 
             int pix[200];
             if (n > 100)
                 n = 100;
 
-            canvas->pd->lockAudioThread();
-
             for (int i = 0; i < n; i++) {
                 auto* f = x->x_vec + (i * 2);
 
-                float xCoord = xToPixels(baseX + fielddesc_getcoord((t_fielddesc*)f, templ, data, 1));
-                float yCoord = yToPixels(baseY + fielddesc_getcoord((t_fielddesc*)(f + 1), templ, data, 1));
+                float xCoord = xToPixels(baseX + fielddesc_getcoord((t_fielddesc*)f, templ, scalarData, 1));
+                float yCoord = yToPixels(baseY + fielddesc_getcoord((t_fielddesc*)(f + 1), templ, scalarData, 1));
 
                 pix[2 * i] = xCoord + canvas->canvasOrigin.x;
                 pix[2 * i + 1] = yCoord + canvas->canvasOrigin.y;
             }
 
-            canvas->pd->unlockAudioThread();
-
             if (width < 1)
                 width = 1;
             if (glist->gl_isgraph)
                 width *= glist_getzoom(glist);
 
-            auto strokeColour = numberToColour(fielddesc_getfloat(&x->x_outlinecolor, templ, data, 1));
+            auto strokeColour = numberToColour(fielddesc_getfloat(&x->x_outlinecolor, templ, scalarData, 1));
             setStrokeFill(strokeColour);
             setStrokeThickness(width);
 
             if (closed) {
-                auto fillColour = numberToColour(fielddesc_getfloat(&x->x_fillcolor, templ, data, 1));
+                auto fillColour = numberToColour(fielddesc_getfloat(&x->x_fillcolor, templ, scalarData, 1));
                 setFill(fillColour);
             } else {
                 setFill(Colours::transparentBlack);
@@ -410,17 +515,21 @@ public:
         if (!s || !s->sc_template)
             return;
 
+        if (!takeSnapshot())
+            return;
+
+        auto* scalarData = getSnapshot();
         auto* x = reinterpret_cast<t_fake_drawnumber*>(object);
 
-        if (!fielddesc_getfloat(&x->x_vis, templ, data, 0)) {
+        if (!fielddesc_getfloat(&x->x_vis, templ, scalarData, 0)) {
             setText("");
             return;
         }
         
         int xloc = 0, yloc = 0;
         if (auto glist = canvas->patch.getPointer()) {
-            xloc = xToPixels(baseX + fielddesc_getcoord((t_fielddesc*)&x->x_xloc, templ, data, 0)) + canvas->canvasOrigin.x;
-            yloc = yToPixels(baseY + fielddesc_getcoord((t_fielddesc*)&x->x_yloc, templ, data, 0)) + canvas->canvasOrigin.y;
+            xloc = xToPixels(baseX + fielddesc_getcoord((t_fielddesc*)&x->x_xloc, templ, scalarData, 0)) + canvas->canvasOrigin.x;
+            yloc = yToPixels(baseY + fielddesc_getcoord((t_fielddesc*)&x->x_yloc, templ, scalarData, 0)) + canvas->canvasOrigin.y;
         }
         
         char buf[DRAWNUMBER_BUFSIZE];
@@ -439,32 +548,30 @@ public:
             buf[DRAWNUMBER_BUFSIZE - 1] = 0;
             nchars = (int)strlen(buf);
             if (type == DT_TEXT) {
-                char* buf2;
-                int size2, ncopy;
-                binbuf_gettext(((t_word*)((char*)data + onset))->w_binbuf,
-                    &buf2, &size2);
+                // The binbuf can be changed or freed by Pd, so we draw from the text we copied with the snapshot
+                auto* buf2 = getTextSnapshot(onset).toRawUTF8();
+                int size2 = (int)strlen(buf2), ncopy;
                 ncopy = (size2 > DRAWNUMBER_BUFSIZE - 1 - nchars ? DRAWNUMBER_BUFSIZE - 1 - nchars : size2);
                 memcpy(buf + nchars, buf2, ncopy);
                 buf[nchars + ncopy] = 0;
                 if (nchars + ncopy == DRAWNUMBER_BUFSIZE - 1)
                     strcpy(buf + (DRAWNUMBER_BUFSIZE - 4), "...");
-                t_freebytes(buf2, size2);
             } else {
                 t_atom at;
                 if (type == DT_FLOAT)
-                    SETFLOAT(&at, ((t_word*)((char*)data + onset))->w_float);
+                    SETFLOAT(&at, ((t_word*)((char*)scalarData + onset))->w_float);
                 else
-                    SETSYMBOL(&at, ((t_word*)((char*)data + onset))->w_symbol);
+                    SETSYMBOL(&at, ((t_word*)((char*)scalarData + onset))->w_symbol);
                 atom_string(&at, buf + nchars, DRAWNUMBER_BUFSIZE - nchars);
             }
         }
 
-        auto symbolColour = numberToColour(fielddesc_getfloat(&x->x_color, templ, data, 1));
+        auto symbolColour = numberToColour(fielddesc_getfloat(&x->x_color, templ, scalarData, 1));
         setColour(symbolColour);
         auto text = String::fromUTF8(buf);
         auto font = getFont();
 
-        setBoundingBox(Parallelogram<float>(Rectangle<float>(xloc, yloc, font.getStringWidthFloat(text) + 4.0f, font.getHeight() + 4.0f)));
+        setBoundingBox(Parallelogram<float>(Rectangle<float>(xloc, yloc, TextLayoutCache::getStringWidthFloat(text, font) + 4.0f, font.getHeight() + 4.0f)));
         if (auto glist = canvas->patch.getPointer()) {
             setFontHeight(sys_hostfontsize(glist_getfont(glist.get()), glist_getzoom(glist.get())));
         }
@@ -694,7 +801,17 @@ public:
          might want to optimize this somehow.  Ditto the "vis()" routines
          for other drawing instructions. */
 
-        if (readOwnerTemplate(x, data, templ,
+        int arrayonset, type;
+        if (x->x_data.fd_type != A_ARRAY || !x->x_data.fd_var || !template_find_field(templ, x->x_data.fd_un.fd_varsym, &arrayonset, &type, &elemtemplatesym) || type != DT_ARRAY)
+            arrayonset = -1;
+
+        // Copy the array under the audio lock, and only rebuild the path if any of its elements changed
+        if (!takeSnapshot(arrayonset))
+            return;
+
+        auto* scalarData = getSnapshot();
+
+        if (readOwnerTemplate(x, scalarData, templ,
                 &elemtemplatesym, &array, &linewidth, &xloc, &xinc, &yloc, &style,
                 &vis, &scalarvis, &edit, &xfielddesc, &yfielddesc, &wfielddesc)
             || array_getfields(elemtemplatesym, &elemtemplatecanvas,
@@ -702,8 +819,8 @@ public:
                 &xonset, &yonset, &wonset))
             return;
 
-        nelem = array->a_n;
-        elem = (char*)array->a_vec;
+        nelem = getArraySnapshotSize();
+        elem = getArraySnapshot();
 
         if (glist->gl_isgraph)
             linewidth *= glist_getzoom(glist);
@@ -717,7 +834,7 @@ public:
         if (static_cast<int>(style) == PLOTSTYLE_POINTS) {
             t_float minyval = 1e20, maxyval = -1e20;
             int ndrawn = 0;
-            Colour colour = numberToColour(fielddesc_getfloat(&x->x_outlinecolor, templ, data, 1));
+            Colour colour = numberToColour(fielddesc_getfloat(&x->x_outlinecolor, templ, scalarData, 1));
 
             setStrokeFill(Colours::transparentBlack);
             setFill(colour);
@@ -759,7 +876,7 @@ public:
             }
         } else {
             Colour outline = numberToColour(
-                fielddesc_getfloat(&x->x_outlinecolor, templ, data, 1));
+                fielddesc_getfloat(&x->x_outlinecolor, templ, scalarData, 1));
 
             setStrokeFill(outline);
             setFill(Colours::transparentBlack);
@@ -81,7 +81,7 @@ public:
 
     Rectangle<int> getPdBounds() override
     {
-        return atomHelper.getPdBounds(input.getFont().getStringWidth(input.getText(true)));
+        return atomHelper.getPdBounds(TextLayoutCache::getStringWidth(input.getText(true), input.getFont()));
     }
 
     void setPdBounds(Rectangle<int> b) override
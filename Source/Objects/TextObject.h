@@ -132,39 +132,14 @@ struct TextObjectHelper {
 
     static int getIdealWidthForText(String const& text, int fontHeight)
     {
-        auto lines = StringArray::fromLines(text);
-        int w = minWidth;
-
-        for (auto& line : lines) {
-            w = std::max<int>(Font(fontHeight).getStringWidthFloat(line) + 14.0f, w);
-        }
-
-        return w;
+        return std::max<int>(TextLayoutCache::getWidestLineWidth(text, Font(fontHeight)) + 14.0f, minWidth);
     }
 
     // Used by text objects for estimating best text height for a set width
     static int getNumLines(String const& text, int width, int fontSize)
     {
-        int numLines = 1;
-
-        Array<int> glyphs;
-        Array<float> xOffsets;
-
-        auto font = Font(fontSize);
-        font.getGlyphPositions(text.trimCharactersAtEnd(";\n"), glyphs, xOffsets);
-
-        wchar_t lastChar;
-        for (int i = 0; i < xOffsets.size(); i++) {
-            if ((xOffsets[i] + 12) >= static_cast<float>(width) || (text.getCharPointer()[i] == '\n' && lastChar == ';')) {
-                for (int j = i + 1; j < xOffsets.size(); j++) {
-                    xOffsets.getReference(j) -= xOffsets[i];
-                }
-                numLines++;
-            }
-            lastChar = text.getCharPointer()[i];
-        }
-
-        return numLines;
+        // Leave some room for the text padding
+        return TextLayoutCache::getNumLines(text, Font(fontSize), static_cast<float>(width) - 12.0f);
     }
 
     static TextEditor* createTextEditor(Object* object, int fontHeight)
@@ -9,6 +9,10 @@ class VUMeterObject final : public ObjectBase {
     IEMHelper iemHelper;
     Value sizeProperty = SynchronousValue();
 
+    // Copied from the object, so painting doesn't have to touch it
+    float peak = 0.0f;
+    float rms = 0.0f;
+
 public:
     VUMeterObject(t_gobj* ptr, Object* object)
         : ObjectBase(ptr, object)
@@ -75,6 +79,8 @@ public:
     {
         if (auto vu = ptr.get<t_vu>()) {
             sizeProperty = Array<var> { var(vu->x_gui.x_w), var(vu->x_gui.x_h) };
+            peak = vu->x_fp;
+            rms = vu->x_fr;
         }
 
         iemHelper.update();
@@ -92,14 +98,11 @@ public:
 
     void paint(Graphics& g) override
     {
-        auto values = std::vector<float> { ptr.getRaw<t_vu>()->x_fp, ptr.getRaw<t_vu>()->x_fr };
+        auto values = std::vector<float> { peak, rms };
 
         int height = getHeight();
         int width = getWidth();
 
-        g.setColour(object->findColour(PlugDataColour::guiObjectBackgroundColourId));
-        g.fillRoundedRectangle(getLocalBounds().toFloat().reduced(0.5f), Corners::objectCornerRadius);
-
         auto outerBorderWidth = 2.0f;
         auto totalBlocks = 30;
         auto spacingFraction = 0.05f;
@@ -110,24 +113,46 @@ public:
         auto blockRectHeight = (1.0f - 2.0f * spacingFraction) * blockHeight;
         auto blockRectSpacing = spacingFraction * blockHeight;
         auto blockCornerSize = 0.1f * blockHeight;
-        auto c = Colour(0xff42a2c8);
+
+        auto drawBlocks = [=](Graphics& layer) {
+            for (auto i = 0; i < totalBlocks; ++i) {
+                layer.fillRoundedRectangle(outerBorderWidth, outerBorderWidth + ((totalBlocks - i) * blockHeight) + blockRectSpacing, blockWidth, blockRectHeight, blockCornerSize);
+            }
+        };
+
+        bool selected = object->isSelected() && !cnv->isGraph;
+        auto outlineColour = object->findColour(selected ? PlugDataColour::objectSelectedOutlineColourId : objectOutlineColourId);
+        auto backgroundColour = object->findColour(PlugDataColour::guiObjectBackgroundColourId);
+
+        // Background, outline and unlit blocks don't depend on the level
+        WidgetLayerCache::draw(g, WidgetLayerCache::makeStyle("vu_background", { backgroundColour, outlineColour }), width, height, [=](Graphics& layer) {
+            layer.setColour(backgroundColour);
+            layer.fillRoundedRectangle(Rectangle<float>(width, height).reduced(0.5f), Corners::objectCornerRadius);
+
+            layer.setColour(Colours::darkgrey);
+            drawBlocks(layer);
+
+            layer.setColour(outlineColour);
+            layer.drawRoundedRectangle(Rectangle<float>(width, height).reduced(0.5f), Corners::objectCornerRadius, 1.0f);
+        });
 
         float rms = Decibels::decibelsToGain(values[1] - 12.0f);
 
         float lvl = (float)std::exp(std::log(rms) / 3.0) * (rms > 0.002);
         auto numBlocks = roundToInt(totalBlocks * lvl);
 
-        auto verticalGradient = ColourGradient(c, 0, getHeight(), Colours::red, 0, 0, false);
-        verticalGradient.addColour(0.5f, c);
-        verticalGradient.addColour(0.75f, Colours::orange);
-
-        for (auto i = 0; i < totalBlocks; ++i) {
-            if (i >= numBlocks)
-                g.setColour(Colours::darkgrey);
-            else
-                g.setGradientFill(verticalGradient);
-
-            g.fillRoundedRectangle(outerBorderWidth, outerBorderWidth + ((totalBlocks - i) * blockHeight) + blockRectSpacing, blockWidth, blockRectHeight, blockCornerSize);
+        // The lit blocks are one prerendered strip, of which we only show the part below the level
+        if (numBlocks > 0) {
+            auto levelY = outerBorderWidth + (totalBlocks - numBlocks + 1) * blockHeight;
+            WidgetLayerCache::drawRegion(g, WidgetLayerCache::makeStyle("vu_strip", {}), width, height, { 0.0f, levelY, static_cast<float>(width), height - levelY }, [=](Graphics& layer) {
+                auto c = Colour(0xff42a2c8);
+                auto verticalGradient = ColourGradient(c, 0, height, Colours::red, 0, 0, false);
+                verticalGradient.addColour(0.5f, c);
+                verticalGradient.addColour(0.75f, Colours::orange);
+
+                layer.setGradientFill(verticalGradient);
+                drawBlocks(layer);
+            });
         }
 
         float peak = Decibels::decibelsToGain(values[0] - 12.0f);
@@ -140,21 +165,23 @@ public:
         // Get text value with 2 and 0 decimals
         // Prevent going past -100 for size reasons
         String textValue = String(std::max(values[1], -96.0f), 2);
-
-        if (getWidth() > g.getCurrentFont().getStringWidth(textValue + " dB")) {
-            // Check noscale flag, otherwise display next to slider
-            Fonts::drawFittedText(g, textValue + " dB", Rectangle<int>(getLocalBounds().removeFromBottom(20)).reduced(2), Colours::white, 1, 1.0f, 11, Justification::centred);
-        } else if (getWidth() > g.getCurrentFont().getStringWidth(textValue)) {
-            Fonts::drawFittedText(g, textValue, Rectangle<int>(getLocalBounds().removeFromBottom(20)).reduced(2), Colours::white, 1, 1.0f, 11, Justification::centred);
+        auto valueFont = Fonts::getCurrentFont().withHeight(11);
+
+        // The value changes all the time, so pick the format based on the widest possible value
+        // This keeps the format from jumping around, and only the two templates end up in the text cache
+        String text;
+        if (getWidth() > TextLayoutCache::getStringWidth("-88.88 dB", valueFont)) {
+            text = textValue + " dB";
+        } else if (getWidth() > TextLayoutCache::getStringWidth("-88.88", valueFont)) {
+            text = textValue;
         } else {
-            Fonts::drawFittedText(g, String(std::max(values[1], -96.0f), 0), Rectangle<int>(getLocalBounds().removeFromBottom(20)).reduced(2), Colours::white, 1, 1.0f, 11, Justification::centred);
+            text = String(std::max(values[1], -96.0f), 0);
         }
 
-        bool selected = object->isSelected() && !cnv->isGraph;
-        auto outlineColour = object->findColour(selected ? PlugDataColour::objectSelectedOutlineColourId : objectOutlineColourId);
-
-        g.setColour(outlineColour);
-        g.drawRoundedRectangle(getLocalBounds().toFloat().reduced(0.5f), Corners::objectCornerRadius, 1.0f);
+        // Don't use the cached layouts for the value itself, it would only push useful entries out of the cache
+        g.setFont(valueFont);
+        g.setColour(Colours::white);
+        g.drawFittedText(text, getLocalBounds().removeFromBottom(20).reduced(2), Justification::centred, 1, 1.0f);
     }
 
     std::vector<hash32> getAllMessages() override
@@ -169,6 +196,12 @@ public:
     {
         switch (hash(symbol)) {
         case hash("float"): {
+            // This arrives for every level update, so we try not to take the Pd lock here
+            t_vu vu;
+            if (ptr.snapshot(vu)) {
+                peak = vu.x_fp;
+                rms = vu.x_fr;
+            }
             repaint();
             break;
         }
@@ -0,0 +1,387 @@
+/*
+ // Copyright (c) 2021-2022 Timothy Schoen
+ // For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ // WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+
+#include <juce_gui_basics/juce_gui_basics.h>
+
+#include <set>
+
+#include "DSPProfiler.h"
+#include "Instance.h"
+
+extern "C" {
+#include <m_imp.h>
+#include <g_canvas.h>
+
+struct _dspcontext;
+
+void ugen_start(void);
+struct _dspcontext* ugen_start_graph(int toplevel, t_signal** sp, int ninlets, int noutlets);
+void ugen_add(struct _dspcontext* dc, t_object* x);
+void ugen_connect(struct _dspcontext* dc, t_object* x1, int outno, t_object* x2, int inno);
+void ugen_done_graph(struct _dspcontext* dc);
+void canvas_update_dsp(void);
+
+t_glist* clone_get_instance(t_gobj*, int);
+int clone_get_n(t_gobj*);
+}
+
+// Only the start of this struct is used, the rest is private to d_ugen.c
+struct t_fake_instanceugen {
+    t_int* u_dspchain;
+    int u_dspchainsize;
+};
+
+namespace pd {
+
+static t_methodentry* findDspMethod(t_class* pdClass)
+{
+#ifdef PDINSTANCE
+    auto* methods = pdClass->c_methods[pd_this->pd_instanceno];
+#else
+    auto* methods = pdClass->c_methods;
+#endif
+
+    auto* dspSymbol = gensym("dsp");
+    for (int i = 0; i < pdClass->c_nmethod; i++) {
+        if (methods[i].me_name == dspSymbol)
+            return &methods[i];
+    }
+
+    return nullptr;
+}
+
+static void collectClasses(t_canvas* cnv, std::set<t_class*>& classes)
+{
+    classes.insert(canvas_class);
+
+    for (t_gobj* y = cnv->gl_list; y; y = y->g_next) {
+        auto* pdClass = pd_class(&y->g_pd);
+        classes.insert(pdClass);
+
+        if (pdClass == canvas_class) {
+            collectClasses(reinterpret_cast<t_canvas*>(y), classes);
+        } else if (pdClass == clone_class) {
+            for (int i = 0; i < clone_get_n(y); i++) {
+                collectClasses(clone_get_instance(y, i), classes);
+            }
+        }
+    }
+}
+
+static String getObjectText(t_object* object)
+{
+    if (!object->te_binbuf)
+        return {};
+
+    char* text = nullptr;
+    int length = 0;
+    binbuf_gettext(object->te_binbuf, &text, &length);
+    auto result = String::fromUTF8(text, length);
+    freebytes(text, static_cast<size_t>(length));
+    return result;
+}
+
+DSPProfiler::DSPProfiler(Instance* parentInstance)
+    : instance(parentInstance)
+{
+}
+
+DSPProfiler::~DSPProfiler()
+{
+    setEnabled(false);
+}
+
+void DSPProfiler::setEnabled(bool shouldBeEnabled)
+{
+    if (enabled == shouldBeEnabled)
+        return;
+
+    enabled = shouldBeEnabled;
+
+    if (enabled) {
+        instance->lockAudioThread();
+        rebuildChain();
+        instance->unlockAudioThread();
+
+        lastStatsTime = Time::getMillisecondCounterHiRes();
+        startTimerHz(10);
+    } else {
+        stopTimer();
+        restoreSerialChain();
+
+        ScopedLock lock(statsLock);
+        costs.clear();
+    }
+}
+
+bool DSPProfiler::isEnabled() const
+{
+    return enabled;
+}
+
+Array<DSPProfiler::ObjectCost> DSPProfiler::getCosts()
+{
+    ScopedLock lock(statsLock);
+    return costs;
+}
+
+Result DSPProfiler::exportCosts(File const& file)
+{
+    Array<var> objects;
+    for (auto const& cost : getCosts()) {
+        auto* object = new DynamicObject();
+        object->setProperty("name", cost.name);
+        object->setProperty("path", cost.path);
+        object->setProperty("load", cost.load);
+        object->setProperty("total_load", cost.totalLoad);
+        objects.add(var(object));
+    }
+
+    auto* profile = new DynamicObject();
+    profile->setProperty("timestamp", Time::getCurrentTime().toISO8601(true));
+    profile->setProperty("sample_rate", sys_getsr());
+    profile->setProperty("block_size", DEFDACBLKSIZE);
+    profile->setProperty("objects", objects);
+
+    if (!file.replaceWithText(JSON::toString(var(profile))))
+        return Result::fail("Couldn't write to " + file.getFullPathName());
+
+    return Result::ok();
+}
+
+void DSPProfiler::timerCallback()
+{
+    // Pd rebuilds its own chain whenever the DSP graph changes, we add our profiling to it again after that
+    instance->lockAudioThread();
+    instance->setThis();
+
+    if (!isChainActive() && pd_this->pd_dspstate) {
+        rebuildChain();
+    }
+
+    instance->unlockAudioThread();
+
+    // Update the results once per second
+    auto now = Time::getMillisecondCounterHiRes();
+    if (now - lastStatsTime < 1000.0)
+        return;
+
+    lastStatsTime = now;
+
+    ScopedLock lock(statsLock);
+
+    if (owners.empty())
+        return;
+
+    auto const numSampledTicks = sampledTicks.exchange(0);
+    auto const tickDuration = DEFDACBLKSIZE / jmax(1.0f, sys_getsr());
+
+    std::vector<float> loads(owners.size()), totalLoads(owners.size());
+    for (size_t i = 0; i < owners.size(); i++) {
+        auto busySeconds = Time::highResolutionTicksToSeconds(busyTicks[i].exchange(0));
+        loads[i] = numSampledTicks ? static_cast<float>(busySeconds / (numSampledTicks * tickDuration)) * 100.0f : 0.0f;
+        totalLoads[i] = loads[i];
+    }
+
+    // Owners are always added after the owner that contains them, so we can add up the totals back to front
+    for (auto i = owners.size() - 1; i > 0; i--) {
+        totalLoads[owners[i].parent] += totalLoads[i];
+    }
+
+    costs.clearQuick();
+    for (size_t i = 1; i < owners.size(); i++) {
+        auto const& owner = owners[i];
+        costs.add({ owner.object, owner.canvas, owner.name, owner.path, owner.isCanvas, loads[i], totalLoads[i] });
+    }
+}
+
+bool DSPProfiler::isChainActive() const
+{
+    auto const* ugen = reinterpret_cast<t_fake_instanceugen*>(pd_this->pd_ugen);
+    return ugen->u_dspchain && ugen->u_dspchainsize > 1 && ugen->u_dspchain[0] == reinterpret_cast<t_int>(profilePerform);
+}
+
+void DSPProfiler::rebuildChain()
+{
+    instance->setThis();
+
+    if (!pd_this->pd_dspstate)
+        return;
+
+    ScopedLock lock(statsLock);
+
+    // Owner 0 is the chain itself, for the entries that don't belong to an object
+    owners.clear();
+    owners.push_back({ nullptr, nullptr, -1, false, {}, {} });
+    entryOwners.clear();
+    ownerStack = { 0 };
+    lastMarkedEntry = 0;
+
+    // While we build the chain, every dsp method goes through profiledDsp first, so we know which object adds which perform routines
+    // This is only done for our own pd instance, and the original methods are put back right after
+    std::set<t_class*> classes;
+    for (auto* cnv = pd_getcanvaslist(); cnv; cnv = cnv->gl_next) {
+        collectClasses(cnv, classes);
+    }
+
+    originalDspMethods.clear();
+    for (auto* pdClass : classes) {
+        if (auto* method = findDspMethod(pdClass)) {
+            originalDspMethods[pdClass] = method->me_fun;
+            method->me_fun = reinterpret_cast<t_gotfn>(profiledDsp);
+        }
+    }
+
+    rebuildingProfiler = this;
+
+    // Build the chain like canvas_start_dsp does, but starting with our own perform routine
+    ugen_start();
+    dsp_add(profilePerform, 1, this);
+
+    for (auto* cnv = pd_getcanvaslist(); cnv; cnv = cnv->gl_next) {
+        enterOwner(&cnv->gl_obj, true);
+
+        // Same as canvas_dodsp in g_canvas.c, which is not exported
+        auto* context = ugen_start_graph(1, nullptr, 0, 0);
+        for (t_gobj* y = cnv->gl_list; y; y = y->g_next) {
+            auto* object = pd_checkobject(&y->g_pd);
+            if (object && zgetfn(&y->g_pd, gensym("dsp")))
+                ugen_add(context, object);
+        }
+
+        t_linetraverser t;
+        linetraverser_start(&t, cnv);
+        while (linetraverser_next(&t)) {
+            if (obj_issignaloutlet(t.tr_ob, t.tr_outno))
+                ugen_connect(context, t.tr_ob, t.tr_outno, t.tr_ob2, t.tr_inno);
+        }
+        ugen_done_graph(context);
+
+        exitOwner();
+    }
+
+    rebuildingProfiler = nullptr;
+
+    for (auto& [pdClass, method] : originalDspMethods) {
+        findDspMethod(pdClass)->me_fun = method;
+    }
+    originalDspMethods.clear();
+
+    // The chain can be reallocated while adding to it, so we only take pointers once it's done
+    auto const* ugen = reinterpret_cast<t_fake_instanceugen*>(pd_this->pd_ugen);
+    markEntries();
+    entryOwners.resize(static_cast<size_t>(ugen->u_dspchainsize), 0);
+
+    chainStart = ugen->u_dspchain;
+    chainEnd = ugen->u_dspchain + ugen->u_dspchainsize - 1;
+
+    busyTicks.reset(new std::atomic<int64>[owners.size()]());
+    sampledTicks = 0;
+}
+
+void DSPProfiler::restoreSerialChain()
+{
+    instance->lockAudioThread();
+    instance->setThis();
+
+    if (isChainActive()) {
+        canvas_update_dsp();
+    }
+
+    instance->unlockAudioThread();
+}
+
+// Assigns the entries that were added to the chain since the last call to the current owner
+void DSPProfiler::markEntries()
+{
+    auto const* ugen = reinterpret_cast<t_fake_instanceugen*>(pd_this->pd_ugen);
+    auto const end = ugen->u_dspchainsize - 1;
+
+    entryOwners.resize(static_cast<size_t>(jmax(end, 0)), 0);
+    for (int i = lastMarkedEntry; i < end; i++) {
+        entryOwners[static_cast<size_t>(i)] = ownerStack.back();
+    }
+
+    lastMarkedEntry = jmax(lastMarkedEntry, end);
+}
+
+void DSPProfiler::enterOwner(t_object* object, bool isCanvas)
+{
+    markEntries();
+
+    auto const parentIndex = ownerStack.back();
+    auto const& parent = owners[static_cast<size_t>(parentIndex)];
+
+    Owner owner;
+    owner.object = object;
+    owner.parent = parentIndex;
+    owner.isCanvas = isCanvas;
+
+    if (parentIndex == 0) {
+        // Top-level patch
+        owner.canvas = nullptr;
+        owner.name = String::fromUTF8(reinterpret_cast<t_canvas*>(object)->gl_name->s_name);
+    } else {
+        owner.canvas = parent.isCanvas ? reinterpret_cast<t_canvas*>(parent.object) : parent.canvas;
+        owner.name = getObjectText(object);
+        owner.path = parent.path.isEmpty() ? parent.name : parent.path + " > " + parent.name;
+    }
+
+    owners.push_back(std::move(owner));
+    ownerStack.push_back(static_cast<int>(owners.size()) - 1);
+}
+
+void DSPProfiler::exitOwner()
+{
+    markEntries();
+    ownerStack.pop_back();
+}
+
+// Called from the first entry in Pd's DSP chain, on the audio thread
+void DSPProfiler::performTick(t_int* ip)
+{
+    // Most ticks just run the chain, so profiling hardly adds to the load we're measuring
+    if (tickCounter.fetch_add(1, std::memory_order_relaxed) % sampleInterval != 0) {
+        while (ip && ip != chainEnd) {
+            ip = (*reinterpret_cast<t_perfroutine>(*ip))(ip);
+        }
+        return;
+    }
+
+    sampledTicks.fetch_add(1, std::memory_order_relaxed);
+
+    auto lastTime = Time::getHighResolutionTicks();
+    while (ip && ip != chainEnd) {
+        auto const owner = entryOwners[static_cast<size_t>(ip - chainStart)];
+        ip = (*reinterpret_cast<t_perfroutine>(*ip))(ip);
+
+        auto const now = Time::getHighResolutionTicks();
+        busyTicks[owner].fetch_add(now - lastTime, std::memory_order_relaxed);
+        lastTime = now;
+    }
+}
+
+t_int* DSPProfiler::profilePerform(t_int* w)
+{
+    auto* profiler = reinterpret_cast<DSPProfiler*>(w[1]);
+    profiler->performTick(w + 2);
+
+    // We've run the whole chain already, skip to the final dsp_done entry
+    return profiler->chainEnd;
+}
+
+// Takes the place of an object's dsp method while we rebuild the chain
+void DSPProfiler::profiledDsp(t_object* x, t_signal** sp)
+{
+    auto* profiler = rebuildingProfiler;
+    auto* pdClass = pd_class(&x->te_g.g_pd);
+
+    profiler->enterOwner(x, pdClass == canvas_class);
+    reinterpret_cast<void (*)(t_object*, t_signal**)>(profiler->originalDspMethods[pdClass])(x, sp);
+    profiler->exitOwner();
+}
+
+}
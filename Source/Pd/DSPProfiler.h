@@ -0,0 +1,100 @@
+/*
+ // Copyright (c) 2021-2022 Timothy Schoen
+ // For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ // WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <map>
+
+#include <m_pd.h>
+
+namespace pd {
+
+class Instance;
+
+// Measures how much time every object spends in its perform routines
+// While enabled, the DSP chain starts with our own perform routine, which runs the rest of the chain itself. On every
+// sampleInterval-th tick it times each perform routine, and adds the time to the object that added it to the chain.
+// When disabled, Pd builds its own chain again, so profiling costs nothing unless it's being used.
+class DSPProfiler : private Timer {
+public:
+    struct ObjectCost {
+        t_object* object;
+        t_canvas* canvas; // The patch or subpatch that contains the object, nullptr for top-level patches
+        String name;
+        String path; // Names of the patches and subpatches that contain the object
+        bool isCanvas;
+
+        // Percentage of the time available for one DSP tick, averaged over the last second
+        float load;      // In the object's own perform routines
+        float totalLoad; // For subpatches, abstractions and clones, including everything inside of them
+    };
+
+    explicit DSPProfiler(Instance* instance);
+    ~DSPProfiler() override;
+
+    void setEnabled(bool shouldBeEnabled);
+    bool isEnabled() const;
+
+    Array<ObjectCost> getCosts();
+
+    // Writes the last results as JSON, so profiles can be compared offline
+    Result exportCosts(File const& file);
+
+    static constexpr int sampleInterval = 8;
+
+private:
+    struct Owner {
+        t_object* object;
+        t_canvas* canvas;
+        int parent;
+        bool isCanvas;
+        String name;
+        String path;
+    };
+
+    void timerCallback() override;
+
+    bool isChainActive() const;
+    void rebuildChain();
+    void restoreSerialChain();
+
+    void markEntries();
+    void enterOwner(t_object* object, bool isCanvas);
+    void exitOwner();
+
+    void performTick(t_int* ip);
+
+    static t_int* profilePerform(t_int* w);
+    static void profiledDsp(t_object* x, t_signal** sp);
+
+    Instance* instance;
+    bool enabled = false;
+
+    // Built on the message thread while holding the audio lock, read by the audio thread
+    std::vector<Owner> owners;
+    std::vector<int> entryOwners; // For every offset in the chain, the owner that added it
+    std::unique_ptr<std::atomic<int64>[]> busyTicks;
+    t_int* chainStart = nullptr;
+    t_int* chainEnd = nullptr;
+
+    std::atomic<int> tickCounter = 0;
+    std::atomic<int> sampledTicks = 0;
+
+    // Only used while rebuilding the chain
+    std::vector<int> ownerStack;
+    std::map<t_class*, t_gotfn> originalDspMethods;
+    int lastMarkedEntry = 0;
+    static inline DSPProfiler* rebuildingProfiler = nullptr;
+
+    CriticalSection statsLock;
+    Array<ObjectCost> costs;
+    double lastStatsTime = 0.0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(DSPProfiler)
+};
+
+}
@@ -0,0 +1,191 @@
+/*
+ // Copyright (c) 2021-2022 Timothy Schoen
+ // For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ // WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+
+#include <juce_gui_basics/juce_gui_basics.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+
+#include <set>
+
+#include "GraphSwap.h"
+#include "Instance.h"
+
+extern "C" {
+int canvas_suspend_dsp(void);
+void canvas_resume_dsp(int oldstate);
+}
+
+namespace pd {
+
+GraphSwap::GraphSwap(Instance* parentInstance)
+    : instance(parentInstance)
+{
+}
+
+void GraphSwap::beginChange(bool rebuildsDSP)
+{
+    // Changes from different threads (for example setStateInformation from the host) are handled one by one
+    changeLock.enter();
+
+    if (changeDepth++ > 0) {
+        instance->lockAudioThread();
+        return;
+    }
+
+    // Without DSP running, Pd doesn't build a chain at all, so there is nothing to suspend
+    // Otherwise, Pd only rebuilds the chain for changes to signal objects, the rest can be done while holding the lock
+    instance->setThis();
+    suspendedDSP = rebuildsDSP && pd_getdspstate();
+
+    if (!suspendedDSP) {
+        instance->lockAudioThread();
+        return;
+    }
+
+    waitForAudioThread();
+
+    instance->lockAudioThread();
+    instance->setThis();
+
+    // Stops Pd from rebuilding the DSP chain for every object we create or delete
+    dspWasRunning = canvas_suspend_dsp();
+}
+
+void GraphSwap::endChange()
+{
+    jassert(changeDepth > 0);
+
+    auto const shouldResume = --changeDepth == 0 && suspendedDSP;
+
+    if (shouldResume) {
+        // Build the new DSP chain in one go
+        instance->setThis();
+        canvas_resume_dsp(dspWasRunning);
+    }
+
+    instance->unlockAudioThread();
+
+    // The audio thread picks up the new chain at the start of its next block
+    if (shouldResume) {
+        state.store(Resuming, std::memory_order_release);
+    }
+
+    changeLock.exit();
+}
+
+static bool findSignalObjects(File const& patchFile, std::set<String>& visited)
+{
+    if (!visited.insert(patchFile.getFullPathName()).second)
+        return false;
+
+    // Every message in a patch file ends with a semicolon, object names are the 5th atom of "#X obj x y name"
+    for (auto const& message : StringArray::fromTokens(patchFile.loadFileAsString(), ";", "")) {
+        auto atoms = StringArray::fromTokens(message.trim(), true);
+        if (atoms.size() < 5 || atoms[0] != "#X" || atoms[1] != "obj")
+            continue;
+
+        auto const& name = atoms[4];
+        if (name.endsWithChar('~') || name == "clone")
+            return true;
+
+        // Abstractions next to the patch are checked too
+        auto abstraction = patchFile.getSiblingFile(name + ".pd");
+        if (abstraction.existsAsFile() && findSignalObjects(abstraction, visited))
+            return true;
+    }
+
+    return false;
+}
+
+bool GraphSwap::containsSignalObjects(File const& patchFile)
+{
+    std::set<String> visited;
+    return findSignalObjects(patchFile, visited);
+}
+
+void GraphSwap::waitForAudioThread()
+{
+    state.store(FadingOut, std::memory_order_release);
+
+    auto const startTime = Time::getMillisecondCounter();
+    while (state.load(std::memory_order_acquire) != Suspended) {
+        auto const now = Time::getMillisecondCounter();
+
+        // If the audio isn't running, or the audio thread is stuck waiting for a lock that we hold, don't wait for it
+        // In that case, the audio thread will just wait for the audio lock, like it would for any other change
+        if (now - lastBlockTime.load(std::memory_order_relaxed) > audioTimeout || now - startTime > audioTimeout * 2) {
+            auto expected = static_cast<int>(FadingOut);
+            state.compare_exchange_strong(expected, Suspended);
+            return;
+        }
+
+        Thread::sleep(1);
+    }
+}
+
+void GraphSwap::setFadeEnabled(bool shouldFade)
+{
+    fadeEnabled = shouldFade;
+}
+
+void GraphSwap::prepareToPlay(double sampleRate)
+{
+    // Audio isn't running yet, so a change that finished before this doesn't need to fade in
+    // Otherwise, every offline render of a patch we just loaded would start with a fade
+    auto expected = static_cast<int>(Resuming);
+    state.compare_exchange_strong(expected, Running);
+
+    fadeGain.reset(sampleRate, fadeLength);
+    fadeGain.setCurrentAndTargetValue(state.load() == Running ? 1.0f : 0.0f);
+}
+
+bool GraphSwap::beginBlock()
+{
+    switch (state.load(std::memory_order_acquire)) {
+    case Running:
+        return true;
+    case FadingOut: {
+        if (fadeEnabled && fadeGain.getCurrentValue() > 0.0f) {
+            fadeGain.setTargetValue(0.0f);
+            return true;
+        }
+
+        // Without a fade, we can suspend straight away
+        fadeGain.setCurrentAndTargetValue(0.0f);
+        auto expected = static_cast<int>(FadingOut);
+        state.compare_exchange_strong(expected, Suspended);
+        return false;
+    }
+    case Resuming: {
+        auto expected = static_cast<int>(Resuming);
+        if (!state.compare_exchange_strong(expected, Running))
+            return false;
+
+        if (fadeEnabled) {
+            fadeGain.setTargetValue(1.0f);
+        } else {
+            fadeGain.setCurrentAndTargetValue(1.0f);
+        }
+        return true;
+    }
+    default:
+        return false;
+    }
+}
+
+void GraphSwap::endBlock(AudioBuffer<float>& buffer)
+{
+    lastBlockTime.store(Time::getMillisecondCounter(), std::memory_order_relaxed);
+
+    fadeGain.applyGain(buffer, buffer.getNumSamples());
+
+    // Once the fade out is complete, tell the waiting thread that we won't touch Pd anymore
+    if (!fadeGain.isSmoothing() && fadeGain.getCurrentValue() == 0.0f) {
+        auto expected = static_cast<int>(FadingOut);
+        state.compare_exchange_strong(expected, Suspended);
+    }
+}
+
+}
@@ -0,0 +1,86 @@
+/*
+ // Copyright (c) 2021-2022 Timothy Schoen
+ // For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ // WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+
+#pragma once
+
+#include <atomic>
+
+namespace pd {
+
+class Instance;
+
+// Lets us make large changes to the patch, like opening patches, loading a preset or reloading abstractions,
+// without stalling the audio thread on the audio lock
+// Before the change, the output fades out and the audio thread stops calling into Pd. It keeps returning silence
+// until the change is done, instead of waiting for the lock. While changing the patch, Pd's DSP chain is suspended,
+// so it only gets rebuilt once when the change is finished. After that, the output fades back in on the new chain.
+// Changes that don't rebuild the DSP chain skip all of this and just take the audio lock, so nothing goes silent.
+class GraphSwap {
+public:
+    explicit GraphSwap(Instance* instance);
+
+    // Call these from a thread that doesn't hold the audio lock
+    // Changes can be nested, only the outermost change decides whether to fade and rebuild the DSP chain
+    void beginChange(bool rebuildsDSP = true);
+    void endChange();
+
+    // Whether opening this patch would add signal objects, including the ones in abstractions next to it
+    static bool containsSignalObjects(File const& patchFile);
+
+    void setFadeEnabled(bool shouldFade);
+    void prepareToPlay(double sampleRate);
+
+    // Called from the audio thread around every block
+    // If beginBlock returns false, Pd should not be processed for this block
+    bool beginBlock();
+    void endBlock(AudioBuffer<float>& buffer);
+
+    struct ScopedChange {
+        explicit ScopedChange(GraphSwap& swap, bool rebuildsDSP = true)
+            : graphSwap(swap)
+        {
+            graphSwap.beginChange(rebuildsDSP);
+        }
+
+        ~ScopedChange()
+        {
+            graphSwap.endChange();
+        }
+
+        GraphSwap& graphSwap;
+    };
+
+private:
+    enum State {
+        Running,
+        FadingOut,
+        Suspended,
+        Resuming
+    };
+
+    void waitForAudioThread();
+
+    Instance* instance;
+
+    std::atomic<int> state = Running;
+    std::atomic<bool> fadeEnabled = true;
+    std::atomic<uint32> lastBlockTime = 0;
+
+    // Only used on the audio thread
+    SmoothedValue<float> fadeGain = 1.0f;
+
+    CriticalSection changeLock;
+    int changeDepth = 0;
+    int dspWasRunning = 0;
+    bool suspendedDSP = false;
+
+    static constexpr double fadeLength = 0.02;
+    static constexpr uint32 audioTimeout = 100;
+
+    JUCE_DECLARE_NON_COPYABLE(GraphSwap)
+};
+
+}
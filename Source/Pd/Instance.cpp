@@ -129,14 +129,22 @@ struct pd::Instance::internal {
 namespace pd {
 
 Instance::Instance(String const& symbol)
-    : consoleHandler(this)
+    : graphSwap(this)
+    , consoleHandler(this)
 {
     pd::Setup::initialisePd();
     objectImplementations = std::make_unique<::ObjectImplementationManager>(this);
+    parallelDSP = std::make_unique<ParallelDSP>(this);
+    dspProfiler = std::make_unique<DSPProfiler>(this);
+    messageTracer = std::make_unique<MessageTracer>(this);
 }
 
 Instance::~Instance()
 {
+    // Make sure Pd's DSP chain doesn't point to the profiler or the parallel DSP anymore
+    dspProfiler.reset();
+    parallelDSP.reset();
+
     pd_free(static_cast<t_pd*>(messageReceiver));
     pd_free(static_cast<t_pd*>(midiReceiver));
     pd_free(static_cast<t_pd*>(printReceiver));
@@ -158,12 +166,12 @@ void Instance::initialisePd(String& pdlua_version)
     libpd_set_instance(static_cast<t_pdinstance*>(instance));
 
     set_instance_lock(
-        static_cast<void const*>(&audioLock),
-        [](void* lock) {
-            static_cast<CriticalSection*>(lock)->enter();
+        static_cast<void const*>(this),
+        [](void* instance) {
+            static_cast<pd::Instance*>(instance)->lockAudioThread();
         },
-        [](void* lock) {
-            static_cast<CriticalSection*>(lock)->exit();
+        [](void* instance) {
+            static_cast<pd::Instance*>(instance)->unlockAudioThread();
         },
         [](void* instance, void* ref) {
             static_cast<pd::Instance*>(instance)->clearWeakReferences(ref);
@@ -248,6 +256,9 @@ void Instance::initialisePd(String& pdlua_version)
     };
 
     auto message_trigger = [](void* instance, void* target, t_symbol* symbol, int argc, t_atom* argv) {
+        // Counted before taking the listener lock, so tracing doesn't slow down the messages it's measuring
+        static_cast<Instance*>(instance)->messageTracer->countMessage(target);
+
         ScopedLock lock(static_cast<Instance*>(instance)->messageListenerLock);
 
         auto& listeners = static_cast<Instance*>(instance)->messageListeners;
@@ -347,6 +358,73 @@ void Instance::performDSP(float const* inputs, float* outputs)
     libpd_process_raw(inputs, outputs);
 }
 
+void Instance::setParallelDSP(bool enabled)
+{
+    wantsParallelDSP = enabled;
+
+    // Both replace Pd's DSP chain, so parallel DSP waits until profiling is done
+    if (!dspProfiler->isEnabled())
+        parallelDSP->setEnabled(enabled);
+}
+
+Array<ParallelDSP::ComponentStats> Instance::getParallelDSPStats()
+{
+    if (!parallelDSP->isEnabled())
+        return {};
+
+    return parallelDSP->getComponentStats();
+}
+
+void Instance::startDSPProfiling()
+{
+    if (numProfilingClients++ > 0)
+        return;
+
+    parallelDSP->setEnabled(false);
+    dspProfiler->setEnabled(true);
+}
+
+void Instance::stopDSPProfiling()
+{
+    if (numProfilingClients == 0 || --numProfilingClients > 0)
+        return;
+
+    dspProfiler->setEnabled(false);
+    parallelDSP->setEnabled(wantsParallelDSP);
+}
+
+Array<DSPProfiler::ObjectCost> Instance::getDSPCosts()
+{
+    return dspProfiler->getCosts();
+}
+
+Result Instance::exportDSPProfile(File const& file)
+{
+    return dspProfiler->exportCosts(file);
+}
+
+void Instance::startMessageTracing()
+{
+    if (numTracingClients++ == 0)
+        messageTracer->setEnabled(true);
+}
+
+void Instance::stopMessageTracing()
+{
+    if (numTracingClients > 0 && --numTracingClients == 0)
+        messageTracer->setEnabled(false);
+}
+
+float Instance::getMessageRate(void* connection)
+{
+    return messageTracer->getConnectionRate(connection);
+}
+
+MessageTracer::Summary Instance::getMessageTrace()
+{
+    return messageTracer->getSummary();
+}
+
 void Instance::sendNoteOn(int const channel, int const pitch, int const velocity) const
 {
     libpd_set_instance(static_cast<t_pdinstance*>(instance));
@@ -538,36 +616,34 @@ void Instance::unregisterMessageListener(void* object, MessageListener* messageL
         messageListeners.erase(object);
 }
 
-void Instance::registerWeakReference(void* ptr, pd_weak_reference* ref)
+std::shared_ptr<WeakReferenceBlock> Instance::registerWeakReference(void* ptr)
 {
-    weakReferenceMutex.lock();
-    pdWeakReferences[ptr].push_back(ref);
-    weakReferenceMutex.unlock();
+    std::lock_guard<std::mutex> lock(weakReferenceMutex);
+
+    auto& block = pdWeakReferences[ptr];
+    if (!block)
+        block = std::make_shared<WeakReferenceBlock>();
+
+    return block;
 }
 
-void Instance::unregisterWeakReference(void* ptr, pd_weak_reference const* ref)
+void Instance::clearWeakReferences(void* ptr)
 {
-    weakReferenceMutex.lock();
+    objectFreeGeneration.fetch_add(1, std::memory_order_relaxed);
 
-    auto& refs = pdWeakReferences[ptr];
+    std::shared_ptr<WeakReferenceBlock> block;
+    {
+        std::lock_guard<std::mutex> lock(weakReferenceMutex);
 
-    auto it = std::find(refs.begin(), refs.end(), ref);
+        auto it = pdWeakReferences.find(ptr);
+        if (it == pdWeakReferences.end())
+            return;
 
-    if (it != refs.end()) {
-        pdWeakReferences[ptr].erase(it);
+        block = std::move(it->second);
+        pdWeakReferences.erase(it);
     }
 
-    weakReferenceMutex.unlock();
-}
-
-void Instance::clearWeakReferences(void* ptr)
-{
-    weakReferenceMutex.lock();
-    for (auto* ref : pdWeakReferences[ptr]) {
-        *ref = false;
-    }
-    pdWeakReferences.erase(ptr);
-    weakReferenceMutex.unlock();
+    block->alive.store(false);
 }
 
 void Instance::enqueueFunctionAsync(std::function<void(void)> const& fn)
@@ -774,11 +850,20 @@ bool Instance::loadLibrary(String const& libraryToLoad)
 void Instance::lockAudioThread()
 {
     audioLock.enter();
+
+    if (audioLockDepth++ == 0) {
+        audioLockGeneration.fetch_add(1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+    }
 }
 
 bool Instance::tryLockAudioThread()
 {
     if (audioLock.tryEnter()) {
+        if (audioLockDepth++ == 0) {
+            audioLockGeneration.fetch_add(1, std::memory_order_relaxed);
+            std::atomic_thread_fence(std::memory_order_release);
+        }
         return true;
     }
 
@@ -787,6 +872,9 @@ bool Instance::tryLockAudioThread()
 
 void Instance::unlockAudioThread()
 {
+    if (--audioLockDepth == 0)
+        audioLockGeneration.fetch_add(1, std::memory_order_release);
+
     audioLock.exit();
 }
 
@@ -16,6 +16,10 @@ extern "C" {
 #include "Utility/StringUtils.h"
 #include "Patch.h"
 #include "Ofelia.h"
+#include "ParallelDSP.h"
+#include "DSPProfiler.h"
+#include "MessageTracer.h"
+#include "GraphSwap.h"
 
 class ObjectImplementationManager;
 
@@ -162,6 +166,21 @@ public:
     void performDSP(float const* inputs, float* outputs);
     int getBlockSize() const;
 
+    void setParallelDSP(bool enabled);
+    Array<ParallelDSP::ComponentStats> getParallelDSPStats();
+
+    // Profiling runs as long as at least one client (an overlay or the profiler panel) has started it
+    void startDSPProfiling();
+    void stopDSPProfiling();
+    Array<DSPProfiler::ObjectCost> getDSPCosts();
+    Result exportDSPProfile(File const& file);
+
+    // Message tracing also runs as long as at least one client has started it
+    void startMessageTracing();
+    void stopMessageTracing();
+    float getMessageRate(void* connection);
+    MessageTracer::Summary getMessageTrace();
+
     void sendNoteOn(int channel, int const pitch, int velocity) const;
     void sendControlChange(int channel, int const controller, int value) const;
     void sendProgramChange(int channel, int value) const;
@@ -197,10 +216,18 @@ public:
     void registerMessageListener(void* object, MessageListener* messageListener);
     void unregisterMessageListener(void* object, MessageListener* messageListener);
 
-    void registerWeakReference(void* ptr, pd_weak_reference* ref);
-    void unregisterWeakReference(void* ptr, pd_weak_reference const* ref);
+    // All weak references to the same object share one block, which stays registered until Pd frees the object
+    std::shared_ptr<WeakReferenceBlock> registerWeakReference(void* ptr);
     void clearWeakReferences(void* ptr);
 
+    // Bumped every time Pd frees an object, to tell apart an object from a new one that was allocated at the same address
+    std::atomic<uint32> objectFreeGeneration = 0;
+
+    // Bumped when the audio lock is taken and when it's released, so it's odd while someone holds it
+    // Pd only writes to its objects under that lock, which lets WeakReference::snapshot copy them without it
+    std::atomic<uint32> audioLockGeneration = 0;
+    int audioLockDepth = 0; // Only used by the thread that holds the lock
+
     virtual void receiveDSPState(bool dsp) { }
 
     virtual void updateConsole(int numMessages, bool newWarning) { }
@@ -277,12 +304,21 @@ public:
     bool isPerformingGlobalSync = false;
     CriticalSection const audioLock;
 
+    // Use this when opening patches or making other large changes, so the audio thread doesn't have to wait for them
+    GraphSwap graphSwap;
+
 private:
     std::mutex weakReferenceMutex;
-    std::unordered_map<void*, std::vector<pd_weak_reference*>> pdWeakReferences;
+    std::unordered_map<void*, std::shared_ptr<WeakReferenceBlock>> pdWeakReferences;
     std::unordered_map<void*, std::vector<juce::WeakReference<MessageListener>>> messageListeners;
 
     std::unique_ptr<ObjectImplementationManager> objectImplementations;
+    std::unique_ptr<ParallelDSP> parallelDSP;
+    std::unique_ptr<DSPProfiler> dspProfiler;
+    int numProfilingClients = 0;
+    bool wantsParallelDSP = false;
+    std::unique_ptr<MessageTracer> messageTracer;
+    int numTracingClients = 0;
 
     CriticalSection messageListenerLock;
 
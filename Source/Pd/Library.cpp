@@ -25,6 +25,7 @@ extern "C" {
 #include <utility>
 #include "Library.h"
 #include "Instance.h"
+#include "Utility/SettingsFile.h"
 #include "Pd/Interface.h"
 
 struct _canvasenvironment {
@@ -39,8 +40,10 @@ namespace pd {
 
 void Library::updateLibrary()
 {
-    auto settingsTree = ValueTree::fromXml(ProjectInfo::appDataDir.getChildFile(".settings").loadFileAsString());
-    auto pathTree = settingsTree.getChildWithName("Paths");
+    // The settings file on disk can be behind on the changes in its journal, so ask SettingsFile
+    auto pathTree = SettingsFile::getInstance()->getPathsTree();
+
+    updateWatchedFolders(pathTree);
 
     sys_lock();
 
@@ -106,7 +109,8 @@ Library::Library(pd::Instance* instance)
         }
     }
 
-    watcher.addFolder(ProjectInfo::appDataDir);
+    // These folders hold thousands of files that don't change which objects are available
+    watcher.addFolder(ProjectInfo::appDataDir, { ProjectInfo::appDataDir.getChildFile("Toolchain"), ProjectInfo::appDataDir.getChildFile("Documentation"), ProjectInfo::appDataDir.getChildFile("Versions") });
     watcher.addListener(this);
 
     // Paths to search
@@ -274,9 +278,57 @@ StringArray Library::getAllCategories()
     return allCategories;
 }
 
-void Library::fsChangeCallback()
+// Only patches, externals and folders can change which objects are available
+static bool isLibraryFile(File const& file)
+{
+    if (file.getFileName().startsWithChar('.'))
+        return false;
+
+    return file.isDirectory() || !file.getFileName().containsChar('.') || file.hasFileExtension("pd;lua;pd_lua;pd_linux;pd_darwin;pd_freebsd;dll;so;dylib;d_fat;d_amd64;d_arm64;d_i386;l_amd64;l_arm64;l_arm;l_i386;m_amd64;m_arm64;m_i386");
+}
+
+void Library::fsChangeCallback(Array<FileSystemWatcher::Change> const& changes)
+{
+    bool settingsChanged = false;
+    bool libraryChanged = false;
+
+    for (auto const& change : changes) {
+        if (change.event == FileSystemWatcher::folderNeedsRescan) {
+            // We don't know what changed, so assume that everything did
+            settingsChanged = true;
+            libraryChanged = true;
+            break;
+        }
+
+        if (SettingsFile::isSettingsFile(change.file)) {
+            settingsChanged = true;
+        } else if (isLibraryFile(change.file)) {
+            libraryChanged = true;
+        }
+    }
+
+    if (appDirChanged && (settingsChanged || libraryChanged))
+        appDirChanged(settingsChanged, libraryChanged);
+}
+
+// Besides our own folders, also watch the search paths that the user added in the settings
+void Library::updateWatchedFolders(ValueTree const& pathTree)
 {
-    appDirChanged();
+    Array<File> searchPaths;
+    for (auto path : pathTree) {
+        auto file = File(path.getProperty("Path").toString());
+        if (file.isDirectory() && !file.isAChildOf(ProjectInfo::appDataDir))
+            searchPaths.add(file);
+    }
+
+    for (auto const& folder : watcher.getWatchedFolders()) {
+        if (folder != ProjectInfo::appDataDir && !searchPaths.contains(folder))
+            watcher.removeFolder(folder);
+    }
+
+    for (auto const& folder : searchPaths) {
+        watcher.addFolder(folder);
+    }
 }
 
 File Library::findHelpfile(t_gobj* obj, File const& parentPatchFile) const
@@ -31,7 +31,7 @@ public:
 
     static std::array<StringArray, 2> parseIoletTooltips(ValueTree const& iolets, String const& name, int numIn, int numOut);
 
-    void fsChangeCallback() override;
+    void fsChangeCallback(Array<FileSystemWatcher::Change> const& changes) override;
 
     File findHelpfile(t_gobj* obj, File const& parentPatchFile) const;
 
@@ -42,7 +42,8 @@ public:
 
     Array<File> helpPaths;
 
-    std::function<void()> appDirChanged;
+    // Called when the settings file, or any patches, externals or folders that can change the available objects were changed outside of plugdata
+    std::function<void(bool settingsChanged, bool libraryChanged)> appDirChanged;
 
     static inline Array<File> const defaultPaths = {
         ProjectInfo::appDataDir.getChildFile("Abstractions").getChildFile("else"),
@@ -57,6 +58,8 @@ public:
     static inline StringArray objectOrigins = { "vanilla", "ELSE", "cyclone", "heavylib", "pdlua" };
 
 private:
+    void updateWatchedFolders(ValueTree const& pathTree);
+
     StringArray allObjects;
     StringArray allCategories;
 
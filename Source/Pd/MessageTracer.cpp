@@ -0,0 +1,468 @@
+/*
+ // Copyright (c) 2021-2022 Timothy Schoen
+ // For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ // WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+
+#include <juce_gui_basics/juce_gui_basics.h>
+
+#include <map>
+
+#include "MessageTracer.h"
+#include "Instance.h"
+
+extern "C" {
+#include <m_imp.h>
+#include <g_canvas.h>
+
+t_glist* clone_get_instance(t_gobj*, int);
+int clone_get_n(t_gobj*);
+}
+
+namespace pd {
+
+static String getObjectText(t_object* object)
+{
+    if (!object->te_binbuf)
+        return {};
+
+    char* text = nullptr;
+    int length = 0;
+    binbuf_gettext(object->te_binbuf, &text, &length);
+    auto result = String::fromUTF8(text, length);
+    freebytes(text, static_cast<size_t>(length));
+    return result;
+}
+
+static String getCanvasPath(t_canvas* cnv)
+{
+    StringArray names;
+    for (auto* parent = cnv; parent; parent = parent->gl_owner) {
+        names.insert(0, String::fromUTF8(parent->gl_name->s_name));
+    }
+
+    return names.joinIntoString(" > ");
+}
+
+// The symbol of a [send] or [receive] object, if it was created with one
+static t_symbol* getBusSymbol(t_object* object)
+{
+    if (!object->te_binbuf || binbuf_getnatom(object->te_binbuf) < 2)
+        return nullptr;
+
+    auto* atoms = binbuf_getvec(object->te_binbuf);
+    return atoms[1].a_type == A_SYMBOL ? atoms[1].a_w.w_symbol : nullptr;
+}
+
+void MessageTracer::Counters::count(void* key)
+{
+    // Only the thread that owns these counters may clear them, so that's done here when the tracer asks for it
+    if (needsClear.load(std::memory_order_relaxed)) {
+        clear();
+        needsClear.store(false, std::memory_order_relaxed);
+    }
+
+    auto const hash = static_cast<uint64>(reinterpret_cast<pointer_sized_uint>(key)) * 0x9E3779B97F4A7C15ull;
+    auto const start = static_cast<int>(hash >> 50); // Top 14 bits, matches the capacity
+
+    for (int i = 0; i < maxProbes; i++) {
+        auto const slot = (start + i) & (capacity - 1);
+        auto* slotKey = keys[slot].load(std::memory_order_relaxed);
+
+        if (slotKey == key) {
+            counts[slot].fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        if (slotKey == nullptr) {
+            keys[slot].store(key, std::memory_order_release);
+            counts[slot].fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+
+    dropped.fetch_add(1, std::memory_order_relaxed);
+}
+
+void MessageTracer::Counters::clear()
+{
+    for (int i = 0; i < capacity; i++) {
+        keys[i].store(nullptr, std::memory_order_relaxed);
+        counts[i].store(0, std::memory_order_relaxed);
+    }
+    dropped.store(0, std::memory_order_relaxed);
+}
+
+MessageTracer::MessageTracer(Instance* parentInstance)
+    : instance(parentInstance)
+    , id(nextId.fetch_add(1))
+{
+}
+
+MessageTracer::~MessageTracer()
+{
+    setEnabled(false);
+}
+
+void MessageTracer::setEnabled(bool shouldBeEnabled)
+{
+    if (enabled == shouldBeEnabled)
+        return;
+
+    if (shouldBeEnabled) {
+        // Only done once, so the tables never change while a thread could be counting into them
+        if (!counterTables)
+            counterTables = std::make_unique<Counters[]>(maxThreads);
+
+        // Counts from an earlier session might belong to connections that have been deleted since
+        for (int i = 0; i < maxThreads; i++) {
+            counterTables[i].needsClear = true;
+        }
+        droppedMessages = 0;
+
+        lastMergeTime = Time::getMillisecondCounterHiRes();
+        startTimer(1000);
+    } else {
+        stopTimer();
+
+        ScopedLock lock(summaryLock);
+        connectionRates.clear();
+        summary = Summary();
+    }
+
+    enabled = shouldBeEnabled;
+}
+
+bool MessageTracer::isEnabled() const
+{
+    return enabled;
+}
+
+MessageTracer::Counters* MessageTracer::getCounters()
+{
+    struct CachedCounters {
+        uint64 tracerId = 0;
+        Counters* counters = nullptr;
+    };
+
+    // A host usually runs all plugin instances on the same audio thread, so the cache has room for one entry per instance
+    // A miss isn't expensive either: it's a scan over the tables, without a lock
+    thread_local std::array<CachedCounters, 32> cache;
+    thread_local size_t nextCacheSlot = 0;
+
+    for (auto const& cached : cache) {
+        if (cached.tracerId == id)
+            return cached.counters;
+    }
+
+    // Tables are claimed in order and never released, so our own table always comes before the first free one
+    auto const thread = Thread::getCurrentThreadId();
+    Counters* counters = nullptr;
+    for (int i = 0; i < maxThreads && !counters; i++) {
+        auto owner = counterTables[i].owner.load(std::memory_order_acquire);
+        if (owner == thread || (owner == nullptr && counterTables[i].owner.compare_exchange_strong(owner, thread)))
+            counters = &counterTables[i];
+    }
+
+    if (!counters)
+        return nullptr;
+
+    cache[nextCacheSlot] = { id, counters };
+    nextCacheSlot = (nextCacheSlot + 1) % cache.size();
+    return counters;
+}
+
+float MessageTracer::getConnectionRate(void* connection)
+{
+    ScopedLock lock(summaryLock);
+
+    if (auto it = connectionRates.find(connection); it != connectionRates.end())
+        return it->second;
+
+    return 0.0f;
+}
+
+MessageTracer::Summary MessageTracer::getSummary()
+{
+    ScopedLock lock(summaryLock);
+    return summary;
+}
+
+void MessageTracer::timerCallback()
+{
+    auto const now = Time::getMillisecondCounterHiRes();
+    auto const seconds = jmax(0.001, (now - lastMergeTime) / 1000.0);
+    lastMergeTime = now;
+
+    std::unordered_map<void*, uint32> counts;
+    int64 dropped = droppedMessages.exchange(0, std::memory_order_relaxed);
+
+    for (int table = 0; table < maxThreads; table++) {
+        auto& counters = counterTables[table];
+        if (!counters.owner.load(std::memory_order_acquire))
+            continue;
+
+        for (int i = 0; i < Counters::capacity; i++) {
+            auto* key = counters.keys[i].load(std::memory_order_acquire);
+            if (!key)
+                continue;
+
+            if (auto count = counters.counts[i].exchange(0, std::memory_order_relaxed))
+                counts[key] += count;
+        }
+        dropped += counters.dropped.exchange(0, std::memory_order_relaxed);
+    }
+
+    updateSummary(counts, seconds);
+
+    ScopedLock lock(summaryLock);
+    summary.droppedMessages = dropped;
+}
+
+void MessageTracer::updateSummary(std::unordered_map<void*, uint32> const& counts, double seconds)
+{
+    struct Edge {
+        t_object* from;
+        int outlet;
+        t_object* to;
+        int inlet;
+        t_canvas* canvas;
+        float rate;
+    };
+
+    std::vector<Edge> edges;
+    std::unordered_map<void*, float> newConnectionRates;
+    std::unordered_map<t_object*, t_canvas*> objectCanvases;
+    std::unordered_map<t_object*, t_symbol*> sendSymbols;
+    std::unordered_map<t_symbol*, std::vector<t_object*>> receivers;
+
+    Summary newSummary;
+
+    // We only hold the audio lock while we collect the connections, and later while we read the names of the results
+    instance->lockAudioThread();
+    instance->setThis();
+
+    // Counts for pointers that aren't connections anymore are left out here
+    auto* sendSymbol = gensym("send");
+    auto* receiveSymbol = gensym("receive");
+
+    std::function<void(t_canvas*)> findConnections = [&](t_canvas* cnv) {
+        for (t_gobj* y = cnv->gl_list; y; y = y->g_next) {
+            auto* pdClass = pd_class(&y->g_pd);
+            if (pdClass == canvas_class) {
+                findConnections(reinterpret_cast<t_canvas*>(y));
+            } else if (pdClass == clone_class) {
+                for (int i = 0; i < clone_get_n(y); i++) {
+                    findConnections(clone_get_instance(y, i));
+                }
+            } else if (pdClass->c_name == sendSymbol || pdClass->c_name == receiveSymbol) {
+                auto* object = pd_checkobject(&y->g_pd);
+                auto* symbol = object ? getBusSymbol(object) : nullptr;
+                if (!symbol)
+                    continue;
+
+                objectCanvases[object] = cnv;
+                if (pdClass->c_name == sendSymbol)
+                    sendSymbols[object] = symbol;
+                else
+                    receivers[symbol].push_back(object);
+            }
+        }
+
+        t_linetraverser t;
+        linetraverser_start(&t, cnv);
+        while (auto* connection = linetraverser_next(&t)) {
+            auto it = counts.find(connection);
+            if (it == counts.end())
+                continue;
+
+            auto const rate = static_cast<float>(it->second / seconds);
+            edges.push_back({ t.tr_ob, t.tr_outno, t.tr_ob2, t.tr_inno, cnv, rate });
+            newConnectionRates[connection] = rate;
+            newSummary.totalRate += rate;
+        }
+    };
+
+    if (!counts.empty()) {
+        for (auto* cnv = pd_getcanvaslist(); cnv; cnv = cnv->gl_next) {
+            findConnections(cnv);
+        }
+    }
+
+    auto const freeGeneration = instance->objectFreeGeneration.load(std::memory_order_relaxed);
+    instance->unlockAudioThread();
+
+    // Every message on an outlet goes over all its connections, so the busiest connection tells us the rate of the outlet
+    std::map<std::pair<t_object*, int>, std::pair<float, t_canvas*>> outletRates;
+    std::map<t_symbol*, SymbolRate> symbolRates;
+
+    for (auto const& edge : edges) {
+        auto& outletRate = outletRates[{ edge.from, edge.outlet }];
+        outletRate = { jmax(outletRate.first, edge.rate), edge.canvas };
+
+        if (edge.inlet == 0) {
+            if (auto it = sendSymbols.find(edge.to); it != sendSymbols.end()) {
+                auto& symbolRate = symbolRates[it->second];
+                symbolRate.symbol = String::fromUTF8(it->second->s_name);
+                symbolRate.numSenders++;
+                symbolRate.rate += edge.rate;
+            }
+        }
+    }
+
+    for (auto const& [outlet, rate] : outletRates) {
+        newSummary.topOutlets.add({ outlet.first, rate.second, {}, {}, outlet.second, rate.first });
+    }
+    std::sort(newSummary.topOutlets.begin(), newSummary.topOutlets.end(), [](auto const& a, auto const& b) { return a.rate > b.rate; });
+    newSummary.topOutlets.removeRange(maxTopEntries, newSummary.topOutlets.size());
+
+    for (auto const& [symbol, rate] : symbolRates) {
+        newSummary.topSymbols.add(rate);
+    }
+    std::sort(newSummary.topSymbols.begin(), newSummary.topSymbols.end(), [](auto const& a, auto const& b) { return a.rate > b.rate; });
+    newSummary.topSymbols.removeRange(maxTopEntries, newSummary.topSymbols.size());
+
+    // Find feedback loops: cycles in the graph of busy connections, where a busy [send] also leads to all its [receive]s
+    std::unordered_map<t_object*, int> nodeIndices;
+    std::vector<t_object*> nodes;
+    std::vector<std::vector<std::pair<int, float>>> adjacency;
+
+    auto getNode = [&](t_object* object) {
+        auto [it, inserted] = nodeIndices.try_emplace(object, static_cast<int>(nodes.size()));
+        if (inserted) {
+            nodes.push_back(object);
+            adjacency.emplace_back();
+        }
+        return it->second;
+    };
+
+    std::unordered_map<t_object*, float> sendRates;
+    for (auto const& edge : edges) {
+        objectCanvases.try_emplace(edge.from, edge.canvas);
+        objectCanvases.try_emplace(edge.to, edge.canvas);
+
+        if (edge.rate < loopThreshold)
+            continue;
+
+        adjacency[getNode(edge.from)].emplace_back(getNode(edge.to), edge.rate);
+
+        if (edge.inlet == 0 && sendSymbols.count(edge.to))
+            sendRates[edge.to] += edge.rate;
+    }
+
+    for (auto const& [send, rate] : sendRates) {
+        if (rate < loopThreshold)
+            continue;
+
+        auto const sendNode = getNode(send);
+        for (auto* receiver : receivers[sendSymbols[send]]) {
+            auto const receiverNode = getNode(receiver);
+            adjacency[sendNode].emplace_back(receiverNode, rate);
+        }
+    }
+
+    // Tarjan's strongly connected components, without recursion because the graph can be very deep
+    auto const numNodes = nodes.size();
+    std::vector<int> index(numNodes, -1), lowLink(numNodes, 0);
+    std::vector<bool> onStack(numNodes, false);
+    std::vector<int> stack;
+    int counter = 0;
+
+    for (size_t root = 0; root < numNodes; root++) {
+        if (index[root] >= 0)
+            continue;
+
+        std::vector<std::pair<int, size_t>> callStack = { { static_cast<int>(root), 0 } };
+        index[root] = lowLink[root] = counter++;
+        stack.push_back(static_cast<int>(root));
+        onStack[root] = true;
+
+        while (!callStack.empty()) {
+            auto const node = callStack.back().first;
+            auto& nextEdge = callStack.back().second;
+
+            if (nextEdge < adjacency[node].size()) {
+                auto const next = adjacency[node][nextEdge++].first;
+                if (index[next] < 0) {
+                    index[next] = lowLink[next] = counter++;
+                    stack.push_back(next);
+                    onStack[next] = true;
+                    callStack.emplace_back(next, 0);
+                } else if (onStack[next]) {
+                    lowLink[node] = std::min(lowLink[node], index[next]);
+                }
+                continue;
+            }
+
+            callStack.pop_back();
+            if (!callStack.empty()) {
+                auto const parent = callStack.back().first;
+                lowLink[parent] = std::min(lowLink[parent], lowLink[node]);
+            }
+
+            if (lowLink[node] != index[node])
+                continue;
+
+            std::vector<int> component;
+            int member;
+            do {
+                member = stack.back();
+                stack.pop_back();
+                onStack[member] = false;
+                component.push_back(member);
+            } while (member != node);
+
+            auto const hasSelfLoop = std::any_of(adjacency[node].begin(), adjacency[node].end(), [node](auto const& edge) { return edge.first == node; });
+            if (component.size() < 2 && !hasSelfLoop)
+                continue;
+
+            FeedbackLoop loop;
+            loop.rate = 0.0f;
+            for (auto const componentNode : component) {
+                for (auto const& [target, rate] : adjacency[componentNode]) {
+                    if (std::find(component.begin(), component.end(), target) != component.end())
+                        loop.rate = jmax(loop.rate, rate);
+                }
+            }
+
+            // Tarjan finds the members back to front
+            std::reverse(component.begin(), component.end());
+            for (auto const componentNode : component) {
+                loop.objects.add(nodes[componentNode]);
+            }
+
+            newSummary.loops.add(std::move(loop));
+        }
+    }
+
+    std::sort(newSummary.loops.begin(), newSummary.loops.end(), [](auto const& a, auto const& b) { return a.rate > b.rate; });
+    newSummary.loops.removeRange(maxTopEntries, newSummary.loops.size());
+
+    // The names are only read for the entries we show. If Pd freed any object since we collected the connections,
+    // some of our pointers could be dangling, so we leave out the outlets and loops until the next update
+    instance->lockAudioThread();
+    if (instance->objectFreeGeneration.load(std::memory_order_relaxed) == freeGeneration) {
+        instance->setThis();
+
+        for (auto& outlet : newSummary.topOutlets) {
+            outlet.name = getObjectText(outlet.object);
+            outlet.path = getCanvasPath(outlet.canvas);
+        }
+
+        for (auto& loop : newSummary.loops) {
+            for (auto* object : loop.objects) {
+                loop.names.add(getObjectText(object));
+            }
+            loop.path = getCanvasPath(objectCanvases[loop.objects.getFirst()]);
+        }
+    } else {
+        newSummary.topOutlets.clear();
+        newSummary.loops.clear();
+    }
+    instance->unlockAudioThread();
+
+    ScopedLock lock(summaryLock);
+    connectionRates = std::move(newConnectionRates);
+    summary = std::move(newSummary);
+}
+
+}
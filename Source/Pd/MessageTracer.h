@@ -0,0 +1,123 @@
+/*
+ // Copyright (c) 2021-2022 Timothy Schoen
+ // For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ // WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+#include <unordered_map>
+
+#include <m_pd.h>
+
+namespace pd {
+
+class Instance;
+
+// Counts control messages per connection, to find message storms and feedback loops
+// Every thread that sends messages claims its own table, so counting never takes a lock or allocates. The tables are merged
+// on the message thread once per second, where the counts are turned into rates per connection, per outlet and per
+// send symbol. When disabled, counting is a single atomic load per message.
+class MessageTracer : private Timer {
+public:
+    struct OutletRate {
+        t_object* object;
+        t_canvas* canvas;
+        String name;
+        String path;
+        int outlet;
+        float rate; // Messages per second
+    };
+
+    struct SymbolRate {
+        String symbol;
+        int numSenders;
+        float rate;
+    };
+
+    // A cycle of connections (or send/receive pairs) that all carry at least loopThreshold messages per second
+    struct FeedbackLoop {
+        Array<t_object*> objects;
+        StringArray names;
+        String path;
+        float rate; // Rate of the busiest connection in the loop
+    };
+
+    struct Summary {
+        Array<OutletRate> topOutlets;
+        Array<SymbolRate> topSymbols;
+        Array<FeedbackLoop> loops;
+        float totalRate = 0.0f;
+        int64 droppedMessages = 0; // Messages that didn't fit in the counting tables
+    };
+
+    explicit MessageTracer(Instance* instance);
+    ~MessageTracer() override;
+
+    void setEnabled(bool shouldBeEnabled);
+    bool isEnabled() const;
+
+    // Called by pd for every message sent over a connection, on the thread that sends it
+    void countMessage(void* connection)
+    {
+        if (enabled.load(std::memory_order_acquire)) {
+            if (auto* counters = getCounters())
+                counters->count(connection);
+            else
+                droppedMessages.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    // Messages per second over the last second, for a t_outconnect
+    float getConnectionRate(void* connection);
+    Summary getSummary();
+
+    static constexpr int maxTopEntries = 50;
+    static constexpr float loopThreshold = 500.0f;
+
+private:
+    // Open addressing hash table, written by one thread only
+    struct Counters {
+        static constexpr int capacity = 1 << 14;
+        static constexpr int maxProbes = 16;
+
+        void count(void* key);
+        void clear();
+
+        std::atomic<void*> keys[capacity] = {};
+        std::atomic<uint32> counts[capacity] = {};
+        std::atomic<uint32> dropped = 0;
+        std::atomic<bool> needsClear = false;
+        std::atomic<Thread::ThreadID> owner = nullptr;
+    };
+
+    // Allocated when tracing is first enabled, threads claim a table with a compare-and-swap on its owner
+    // A thread that finds all tables taken counts its messages as dropped
+    static constexpr int maxThreads = 8;
+
+    Counters* getCounters();
+
+    void timerCallback() override;
+    void updateSummary(std::unordered_map<void*, uint32> const& counts, double seconds);
+
+    Instance* instance;
+    std::atomic<bool> enabled = false;
+
+    // Unique for every tracer, so the thread-local lookups can't mix up tracers that were allocated at the same address
+    uint64 const id;
+    static inline std::atomic<uint64> nextId = 1;
+
+    std::unique_ptr<Counters[]> counterTables;
+    std::atomic<uint32> droppedMessages = 0;
+
+    CriticalSection summaryLock;
+    std::unordered_map<void*, float> connectionRates;
+    Summary summary;
+    double lastMergeTime = 0.0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(MessageTracer)
+};
+
+}
@@ -0,0 +1,583 @@
+/*
+ // Copyright (c) 2021-2022 Timothy Schoen
+ // For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ // WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+
+#include <juce_gui_basics/juce_gui_basics.h>
+
+#include <map>
+#include <set>
+#include <numeric>
+
+#include "ParallelDSP.h"
+#include "Instance.h"
+
+extern "C" {
+#include <m_imp.h>
+#include <g_canvas.h>
+
+struct _dspcontext;
+
+void ugen_start(void);
+struct _dspcontext* ugen_start_graph(int toplevel, t_signal** sp, int ninlets, int noutlets);
+void ugen_add(struct _dspcontext* dc, t_object* x);
+void ugen_connect(struct _dspcontext* dc, t_object* x1, int outno, t_object* x2, int inno);
+void ugen_done_graph(struct _dspcontext* dc);
+void canvas_update_dsp(void);
+int sys_get_outchannels(void);
+
+t_glist* clone_get_instance(t_gobj*, int);
+int clone_get_n(t_gobj*);
+}
+
+// Only the start of this struct is used, the rest is private to d_ugen.c
+struct t_fake_instanceugen {
+    t_int* u_dspchain;
+    int u_dspchainsize;
+};
+
+// Start of t_garray from g_array.c, we only need the name
+struct t_fake_garray_name {
+    t_gobj x_gobj;
+    t_scalar* x_scalar;
+    t_glist* x_glist;
+    t_symbol* x_name;
+    t_symbol* x_realname;
+};
+
+namespace pd {
+
+// One pool of workers for the whole process
+// Every plugin instance has its own ParallelDSP, a pool for each of them would start more high-priority threads than there are cores
+class ParallelDSP::WorkerPool {
+public:
+    WorkerPool()
+    {
+        auto numWorkers = jlimit(1, 31, SystemStats::getNumCpus() - 1);
+        for (int i = 0; i < numWorkers; i++) {
+            workers.add(new Worker(*this));
+        }
+    }
+
+    ~WorkerPool()
+    {
+        for (auto* worker : workers) {
+            worker->signalThreadShouldExit();
+        }
+        wakeWorkers();
+        workers.clear();
+    }
+
+    static std::shared_ptr<WorkerPool> getInstance()
+    {
+        static CriticalSection instanceLock;
+        static std::weak_ptr<WorkerPool> sharedInstance;
+
+        ScopedLock lock(instanceLock);
+        auto pool = sharedInstance.lock();
+        if (!pool) {
+            pool = std::make_shared<WorkerPool>();
+            sharedInstance = pool;
+        }
+        return pool;
+    }
+
+    // Called by the audio thread at the start of a tick, returns the slot the tick was posted to
+    // If all slots are taken, this returns -1 and the audio thread runs all segments by itself
+    int post(ParallelDSP* dsp)
+    {
+        for (int i = 0; i < maxJobs; i++) {
+            ParallelDSP* expected = nullptr;
+            if (jobs[i].compare_exchange_strong(expected, dsp)) {
+                wakeWorkers();
+                return i;
+            }
+        }
+        return -1;
+    }
+
+    // Called by the audio thread once all segments of the tick are done
+    void finish(int slot)
+    {
+        jobs[slot].store(nullptr);
+    }
+
+    // Called when a ParallelDSP stops using the pool, after its last tick has finished
+    // A worker could still be looking at that tick, so we wait until none of them is
+    void waitUntilUnused(ParallelDSP* dsp)
+    {
+        for (auto* worker : workers) {
+            while (worker->currentJob.load() == dsp) {
+                Thread::yield();
+            }
+        }
+    }
+
+private:
+    class Worker : public Thread {
+    public:
+        explicit Worker(WorkerPool& parent)
+            : Thread("Parallel DSP worker")
+            , pool(parent)
+        {
+            startThread(Thread::Priority::highest);
+        }
+
+        ~Worker() override
+        {
+            stopThread(1000);
+        }
+
+        void run() override
+        {
+            // Perform routines expect the same floating point state as on the audio thread
+            ScopedNoDenormals noDenormals;
+
+            auto lastTick = pool.ticksPosted.load();
+            while (!threadShouldExit()) {
+                pool.waitForTick(lastTick);
+                lastTick = pool.ticksPosted.load();
+                pool.runJobs(currentJob);
+            }
+        }
+
+        // The ParallelDSP this worker is running segments for, if any
+        std::atomic<ParallelDSP*> currentJob = nullptr;
+
+    private:
+        WorkerPool& pool;
+    };
+
+    // There is no mutex on the audio thread: notify_all wakes the workers through a futex (or the platform equivalent)
+    void wakeWorkers()
+    {
+        ticksPosted.fetch_add(1);
+        ticksPosted.notify_all();
+    }
+
+    void waitForTick(uint32 lastTick)
+    {
+        // Ticks come in bursts of one audio block, so we spin for a while before going to sleep
+        for (int i = 0; i < spinCount; i++) {
+            if (ticksPosted.load(std::memory_order_acquire) != lastTick)
+                return;
+        }
+
+        ticksPosted.wait(lastTick);
+    }
+
+    void runJobs(std::atomic<ParallelDSP*>& currentJob)
+    {
+        for (auto& job : jobs) {
+            auto* dsp = job.load();
+            if (!dsp)
+                continue;
+
+            // Publish the job before checking that it's still posted, so waitUntilUnused can't miss us
+            currentJob.store(dsp);
+            if (job.load() == dsp) {
+                // pd_this is thread-local, perform routines that use the scheduler need to see the right instance
+                dsp->instance->setThis();
+                dsp->runSegments();
+            }
+            currentJob.store(nullptr);
+        }
+    }
+
+    static constexpr int maxJobs = 32;
+    static constexpr int spinCount = 4096;
+
+    std::atomic<ParallelDSP*> jobs[maxJobs] = {};
+    std::atomic<uint32> ticksPosted = 0;
+
+    OwnedArray<Worker> workers;
+};
+
+ParallelDSP::ParallelDSP(Instance* parentInstance)
+    : instance(parentInstance)
+{
+}
+
+ParallelDSP::~ParallelDSP()
+{
+    setEnabled(false);
+}
+
+void ParallelDSP::setEnabled(bool shouldBeEnabled)
+{
+    if (enabled == shouldBeEnabled)
+        return;
+
+    enabled = shouldBeEnabled;
+
+    if (enabled) {
+        pool = WorkerPool::getInstance();
+
+        instance->lockAudioThread();
+        rebuildChain();
+        instance->unlockAudioThread();
+
+        startTimerHz(10);
+    } else {
+        stopTimer();
+        restoreSerialChain();
+        pool->waitUntilUnused(this);
+        pool.reset();
+    }
+}
+
+bool ParallelDSP::isEnabled() const
+{
+    return enabled;
+}
+
+Array<ParallelDSP::ComponentStats> ParallelDSP::getComponentStats()
+{
+    ScopedLock lock(statsLock);
+
+    Array<ComponentStats> stats;
+    for (auto* segment : segments) {
+        stats.add({ segment->patchNames, segment->averageLoad });
+    }
+
+    return stats;
+}
+
+void ParallelDSP::timerCallback()
+{
+    // Pd rebuilds its own serial chain whenever the DSP graph changes, we split it up again after that
+    // Every rebuild starts with ugen_start, which replaces our first entry, so that is all we need to check
+    instance->lockAudioThread();
+    instance->setThis();
+
+    if (!isChainActive() && pd_this->pd_dspstate) {
+        rebuildChain();
+    }
+
+    instance->unlockAudioThread();
+
+    // Update the load statistics once per second
+    auto now = Time::getMillisecondCounterHiRes();
+    if (now - lastStatsTime < 1000.0)
+        return;
+
+    auto elapsedTicks = numTicks.exchange(0);
+    auto tickDuration = DEFDACBLKSIZE / jmax(1.0f, sys_getsr());
+
+    ScopedLock lock(statsLock);
+    for (auto* segment : segments) {
+        auto busySeconds = Time::highResolutionTicksToSeconds(segment->busyTicks.exchange(0));
+        segment->averageLoad = elapsedTicks ? static_cast<float>(busySeconds / (elapsedTicks * tickDuration)) * 100.0f : 0.0f;
+    }
+
+    lastStatsTime = now;
+}
+
+bool ParallelDSP::isChainActive() const
+{
+    auto const* ugen = reinterpret_cast<t_fake_instanceugen*>(pd_this->pd_ugen);
+    return ugen->u_dspchain && ugen->u_dspchainsize > 1 && ugen->u_dspchain[0] == reinterpret_cast<t_int>(parallelPerform);
+}
+
+// Collects the names of everything that lets a patch exchange data with other patches during DSP
+static void collectSharedNames(t_canvas* cnv, std::set<String>& names)
+{
+    // Objects that share state through a name in their first argument
+    static std::set<String> const namedClasses = {
+        "send~", "s~", "receive~", "r~", "throw~", "catch~",
+        "tabread~", "tabread4~", "tabwrite~", "tabplay~", "tabreceive~", "tabosc4~",
+        "delwrite~", "delread~", "delread4~", "vd~",
+        "value", "v", "table"
+    };
+
+    // Signal objects whose perform routines only touch their own state or the buffers named by their arguments
+    // Any other signal object could set clocks, post to the console or touch global state from its perform routine,
+    // which is not thread-safe, so patches that contain one all end up in the same serial component
+    static std::set<String> const threadSafeClasses = {
+        "+~", "-~", "*~", "/~", "max~", "min~", ">~", "<~", ">=~", "<=~", "==~", "!=~", "&&~", "||~", "%~",
+        "sig~", "line~", "osc~", "cos~", "phasor~", "noise~", "snapshot~", "samphold~", "wrap~", "abs~", "sqrt~", "rsqrt~",
+        "exp~", "log~", "pow~", "mtof~", "ftom~", "dbtorms~", "rmstodb~", "dbtopow~", "powtodb~", "clip~",
+        "lop~", "hip~", "bp~", "vcf~", "biquad~", "slop~", "rpole~", "rzero~", "rzero_rev~", "cpole~", "czero~", "czero_rev~",
+        "fft~", "ifft~", "rfft~", "rifft~", "framp~", "lrshift~", "inlet~", "outlet~", "block~", "switch~", "dac~", "adc~",
+        "send~", "receive~", "throw~", "catch~", "tabread~", "tabread4~", "tabreceive~", "tabosc4~",
+        "delwrite~", "delread~", "delread4~", "expr~", "fexpr~"
+    };
+
+    auto getArgument = [cnv](t_binbuf* binbuf, int index) -> String {
+        if (!binbuf || binbuf_getnatom(binbuf) <= index)
+            return {};
+
+        auto* atom = binbuf_getvec(binbuf) + index;
+        if (atom->a_type == A_FLOAT)
+            return {};
+
+        char buf[MAXPDSTRING];
+        atom_string(atom, buf, MAXPDSTRING);
+        return String::fromUTF8(canvas_realizedollar(cnv, gensym(buf))->s_name);
+    };
+
+    for (t_gobj* y = cnv->gl_list; y; y = y->g_next) {
+        auto* pdClass = pd_class(&y->g_pd);
+
+        if (pdClass == canvas_class) {
+            collectSharedNames(reinterpret_cast<t_canvas*>(y), names);
+            continue;
+        }
+        if (pdClass == clone_class) {
+            for (int i = 0; i < clone_get_n(y); i++) {
+                collectSharedNames(clone_get_instance(y, i), names);
+            }
+            continue;
+        }
+
+        auto className = String::fromUTF8(class_getname(pdClass));
+
+        // Arrays inside graphs
+        if (className == "array") {
+            names.insert(String::fromUTF8(reinterpret_cast<t_fake_garray_name*>(y)->x_realname->s_name));
+            continue;
+        }
+
+        auto* object = pd_checkobject(&y->g_pd);
+        if (!object)
+            continue;
+
+        auto* binbuf = object->te_binbuf;
+
+        if (zgetfn(&y->g_pd, gensym("dsp")) && !threadSafeClasses.count(className)) {
+            names.insert("__serial__");
+
+            // Objects like tabsend~ or array players from externals name their buffer in the first argument,
+            // patches that read the same buffer with a thread-safe object must not run next to them
+            names.insert(getArgument(binbuf, 1));
+        }
+
+        if (namedClasses.count(className)) {
+            names.insert(getArgument(binbuf, 1));
+        } else if (getArgument(binbuf, 0) == "array") {
+            // [array define], [array get], [array set] etc.
+            names.insert(getArgument(binbuf, 2));
+        } else if (className == "expr~" || className == "fexpr~" || className == "expr") {
+            // Expressions can access arrays and values by name, we add every word in the expression
+            for (int i = 1; i < binbuf_getnatom(binbuf); i++) {
+                for (auto& token : StringArray::fromTokens(getArgument(binbuf, i), "()[]+-*/%,=<>!&|^ ", "")) {
+                    if (token.isNotEmpty() && !token.startsWithChar('$') && !CharacterFunctions::isDigit(token[0]))
+                        names.insert(token);
+                }
+            }
+        }
+    }
+
+    // A "set" message changes the name of a named signal object without a DSP rebuild, so the components we built
+    // would no longer match. Messages can only reach them through a control connection, so if a patch has one
+    // into a named signal object, it has to run in the serial component.
+    t_linetraverser t;
+    linetraverser_start(&t, cnv);
+    while (linetraverser_next(&t)) {
+        auto* target = &t.tr_ob2->ob_pd;
+        if (!obj_issignaloutlet(t.tr_ob, t.tr_outno) && zgetfn(target, gensym("dsp")) && namedClasses.count(String::fromUTF8(class_getname(pd_class(target))))) {
+            names.insert("__serial__");
+            break;
+        }
+    }
+
+    names.erase(String());
+}
+
+void ParallelDSP::rebuildChain()
+{
+    instance->setThis();
+
+    if (!pd_this->pd_dspstate)
+        return;
+
+    // Group the top-level patches using a union-find over their shared names
+    Array<t_canvas*> canvases;
+    for (auto* cnv = pd_getcanvaslist(); cnv; cnv = cnv->gl_next) {
+        canvases.add(cnv);
+    }
+
+    std::vector<int> parents(canvases.size());
+    std::iota(parents.begin(), parents.end(), 0);
+
+    std::function<int(int)> findRoot = [&parents, &findRoot](int i) {
+        return parents[i] == i ? i : parents[i] = findRoot(parents[i]);
+    };
+
+    std::map<String, int> nameOwners;
+    for (int i = 0; i < canvases.size(); i++) {
+        std::set<String> names;
+        collectSharedNames(canvases[i], names);
+
+        for (auto& name : names) {
+            auto [owner, inserted] = nameOwners.insert({ name, i });
+            if (!inserted) {
+                parents[findRoot(i)] = findRoot(owner->second);
+            }
+        }
+    }
+
+    std::map<int, Array<t_canvas*>> components;
+    for (int i = 0; i < canvases.size(); i++) {
+        components[findRoot(i)].add(canvases[i]);
+    }
+
+    ScopedLock lock(statsLock);
+
+    // Make sure no worker picks up a segment while we rebuild
+    numSegments = 0;
+    segments.clear();
+
+    numOutputChannels = sys_get_outchannels();
+
+    // Build the chain like canvas_start_dsp does, but with all patches of a component next to each other
+    // The chain starts with our own perform routine, which runs all segments and then skips to the end
+    // Every segment ends with a routine that returns a null pointer, so a worker stops there
+    // We also do this for a single component, so a chain without our first entry always means Pd rebuilt it
+    ugen_start();
+    dsp_add(parallelPerform, 1, this);
+
+    auto* ugen = reinterpret_cast<t_fake_instanceugen*>(pd_this->pd_ugen);
+    Array<int> segmentOffsets;
+
+    for (auto& [root, componentCanvases] : components) {
+        auto* segment = segments.add(new Segment());
+        segment->soundOut.calloc(jmax(1, numOutputChannels * DEFDACBLKSIZE));
+
+        // dac~ adds into the output buffer, which would be a data race between components
+        // So every component gets its own output buffer, and we sum them after each tick
+        auto* soundOut = STUFF->st_soundout;
+        STUFF->st_soundout = segment->soundOut.get();
+
+        segmentOffsets.add(ugen->u_dspchainsize - 1);
+
+        for (auto* cnv : componentCanvases) {
+            segment->patchNames.add(String::fromUTF8(cnv->gl_name->s_name));
+
+            // Same as canvas_dodsp in g_canvas.c, which is not exported
+            auto* context = ugen_start_graph(1, nullptr, 0, 0);
+            for (t_gobj* y = cnv->gl_list; y; y = y->g_next) {
+                auto* object = pd_checkobject(&y->g_pd);
+                if (object && zgetfn(&y->g_pd, gensym("dsp")))
+                    ugen_add(context, object);
+            }
+
+            t_linetraverser t;
+            linetraverser_start(&t, cnv);
+            while (linetraverser_next(&t)) {
+                if (obj_issignaloutlet(t.tr_ob, t.tr_outno))
+                    ugen_connect(context, t.tr_ob, t.tr_outno, t.tr_ob2, t.tr_inno);
+            }
+            ugen_done_graph(context);
+        }
+
+        STUFF->st_soundout = soundOut;
+
+        dsp_add(segmentDone, 0);
+    }
+
+    // The chain can be reallocated while adding to it, so we only take pointers once it's done
+    for (int i = 0; i < segments.size(); i++) {
+        segments[i]->start = ugen->u_dspchain + segmentOffsets[i];
+    }
+
+    chainEnd = ugen->u_dspchain + ugen->u_dspchainsize - 1;
+
+    nextSegment = noSegmentsAvailable;
+    numSegments = segments.size();
+}
+
+void ParallelDSP::restoreSerialChain()
+{
+    instance->lockAudioThread();
+    instance->setThis();
+
+    if (isChainActive()) {
+        canvas_update_dsp();
+    }
+
+    instance->unlockAudioThread();
+}
+
+// Called from the first entry in Pd's DSP chain, on the audio thread
+void ParallelDSP::performTick()
+{
+    auto const bufferSize = numOutputChannels * DEFDACBLKSIZE;
+    for (auto* segment : segments) {
+        FloatVectorOperations::clear(segment->soundOut.get(), bufferSize);
+    }
+
+    // Reset the done counter first, a worker could already pick up a segment when nextSegment resets
+    auto const total = numSegments.load(std::memory_order_relaxed);
+    segmentsDone.store(0, std::memory_order_relaxed);
+    nextSegment.store(0, std::memory_order_release);
+
+    // The audio thread claims segments as well, so we only need the workers if there is more than one
+    auto const slot = total > 1 ? pool->post(this) : -1;
+
+    runSegments();
+
+    constexpr int maxSpins = 4096;
+    for (int spins = 0; segmentsDone.load(std::memory_order_acquire) < total; spins++) {
+        // The remaining segments are already running, so this is usually short
+        // If it isn't, a worker was preempted, and yielding gives it a chance to get its core back
+        if (spins > maxSpins)
+            Thread::yield();
+    }
+
+    // A worker that wakes up late must not find anything to claim, even if the segments get rebuilt in the meantime
+    nextSegment.store(noSegmentsAvailable, std::memory_order_release);
+
+    if (slot >= 0)
+        pool->finish(slot);
+
+    // Sum the output of every component, in a fixed order
+    auto* soundOut = STUFF->st_soundout;
+    for (auto* segment : segments) {
+        FloatVectorOperations::add(soundOut, segment->soundOut.get(), bufferSize);
+    }
+
+    numTicks.fetch_add(1, std::memory_order_relaxed);
+}
+
+void ParallelDSP::runSegments()
+{
+    while (true) {
+        // Only claim a segment if there is one left, so nextSegment never grows past the number of segments
+        // The number of segments is read after nextSegment, so it always belongs to the tick we're claiming from
+        auto index = nextSegment.load(std::memory_order_acquire);
+        do {
+            if (index >= numSegments.load(std::memory_order_acquire))
+                return;
+        } while (!nextSegment.compare_exchange_weak(index, index + 1, std::memory_order_acq_rel, std::memory_order_acquire));
+
+        auto* segment = segments.getUnchecked(index);
+
+        auto startTime = Time::getHighResolutionTicks();
+
+        t_int* ip = segment->start;
+        while (ip) {
+            ip = (*reinterpret_cast<t_perfroutine>(*ip))(ip);
+        }
+
+        segment->busyTicks.fetch_add(Time::getHighResolutionTicks() - startTime, std::memory_order_relaxed);
+        segmentsDone.fetch_add(1, std::memory_order_release);
+    }
+}
+
+t_int* ParallelDSP::parallelPerform(t_int* w)
+{
+    auto* dsp = reinterpret_cast<ParallelDSP*>(w[1]);
+    dsp->performTick();
+
+    // Jump over all segments to the final dsp_done entry
+    return dsp->chainEnd;
+}
+
+t_int* ParallelDSP::segmentDone(t_int* w)
+{
+    return nullptr;
+}
+
+}
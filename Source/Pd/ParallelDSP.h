@@ -0,0 +1,86 @@
+/*
+ // Copyright (c) 2021-2022 Timothy Schoen
+ // For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ // WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+
+#pragma once
+
+#include <atomic>
+#include <memory>
+
+#include <m_pd.h>
+
+namespace pd {
+
+class Instance;
+
+// Runs the DSP of independent top-level patches concurrently
+// Top-level patches are grouped into components: two patches end up in the same component if they share a
+// send~/receive~ or throw~/catch~ bus, an array, a delay line or a value. Every component gets its own segment
+// of Pd's DSP chain, and the segments are executed by a pool of worker threads that all instances share. Each
+// 64-sample tick waits until all segments are done, so the rest of Pd still sees a single DSP tick.
+class ParallelDSP : private Timer {
+public:
+    struct ComponentStats {
+        StringArray patchNames;
+        float load; // Percentage of the time available for one DSP tick
+    };
+
+    explicit ParallelDSP(Instance* instance);
+    ~ParallelDSP() override;
+
+    void setEnabled(bool shouldBeEnabled);
+    bool isEnabled() const;
+
+    // Returns the CPU load of every component, averaged over the last second
+    Array<ComponentStats> getComponentStats();
+
+private:
+    struct Segment {
+        t_int* start = nullptr;
+        StringArray patchNames;
+        HeapBlock<t_sample> soundOut;
+
+        std::atomic<int64> busyTicks = 0;
+        float averageLoad = 0.0f;
+    };
+
+    class WorkerPool;
+
+    void timerCallback() override;
+
+    bool isChainActive() const;
+    void rebuildChain();
+    void restoreSerialChain();
+
+    void performTick();
+    void runSegments();
+
+    static t_int* parallelPerform(t_int* w);
+    static t_int* segmentDone(t_int* w);
+
+    Instance* instance;
+    bool enabled = false;
+
+    OwnedArray<Segment> segments;
+    std::shared_ptr<WorkerPool> pool;
+
+    // nextSegment holds this between ticks, so workers can only claim segments while a tick is running
+    static constexpr int noSegmentsAvailable = std::numeric_limits<int>::max();
+
+    t_int* chainEnd = nullptr;
+    int numOutputChannels = 0;
+
+    std::atomic<int> numSegments = 0;
+    std::atomic<int> nextSegment = noSegmentsAvailable;
+    std::atomic<int> segmentsDone = 0;
+    std::atomic<int> numTicks = 0;
+
+    CriticalSection statsLock;
+    double lastStatsTime = 0.0;
+
+    JUCE_DECLARE_NON_COPYABLE_WITH_LEAK_DETECTOR(ParallelDSP)
+};
+
+}
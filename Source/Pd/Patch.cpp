@@ -89,14 +89,19 @@ void Patch::savePatch(File const& location)
     auto* dir = instance->generateSymbol(fullPathname.replace("\\", "/"));
     auto* file = instance->generateSymbol(filename);
 
+    t_glist* savedPatch = nullptr;
     if (auto patch = ptr.get<t_glist>()) {
         setTitle(filename);
         untitledPatchNum = 0;
         canvas_dirty(patch.get(), 0);
 
         pd::Interface::saveToFile(patch.get(), file, dir);
+        savedPatch = patch.get();
+    }
 
-        instance->reloadAbstractions(location, patch.get());
+    // Reloading takes the audio lock by itself, after fading out the audio
+    if (savedPatch) {
+        instance->reloadAbstractions(location, savedPatch);
     }
 
     currentFile = location;
@@ -146,9 +151,7 @@ void Patch::savePatch()
     }
 
     MessageManager::callAsync([this, patch = ptr.getRaw<t_glist>()]() {
-        sys_lock();
         instance->reloadAbstractions(currentFile, patch);
-        sys_unlock();
     });
 }
 
@@ -103,6 +103,12 @@ public:
         return ptr.get<t_canvas>();
     }
 
+    // Checks if Pd hasn't freed the patch yet, without taking the Pd lock
+    bool isAlive() const
+    {
+        return ptr.isAlive();
+    }
+
     // Gets the objects of the patch.
     std::vector<t_gobj*> getObjects();
 
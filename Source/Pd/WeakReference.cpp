@@ -18,7 +18,8 @@ pd::WeakReference::WeakReference(void* p, Instance* instance)
     : ptr(p)
     , pd(instance)
 {
-    pd->registerWeakReference(ptr, &weakRef);
+    if (ptr)
+        block = pd->registerWeakReference(ptr);
 }
 
 pd::WeakReference::WeakReference(Instance* instance)
@@ -27,30 +28,40 @@ pd::WeakReference::WeakReference(Instance* instance)
 {
 }
 
-pd::WeakReference::~WeakReference()
+void pd::WeakReference::setThis() const
 {
-    pd->unregisterWeakReference(ptr, &weakRef);
+    pd->setThis();
 }
 
-pd::WeakReference& pd::WeakReference::operator=(pd::WeakReference const& other)
+void pd::WeakReference::lock(Instance* instance)
 {
-    if (this != &other) // Check for self-assignment
-    {
-        if (ptr)
-            pd->unregisterWeakReference(ptr, &other.weakRef);
-
-        // Use atomic exchange to safely copy the weakRef value
-        weakRef.store(other.weakRef.load());
-        ptr = other.ptr;
-        pd = other.pd;
+    numLocks.fetch_add(1, std::memory_order_relaxed);
 
-        pd->registerWeakReference(ptr, &weakRef);
+    if (!instance->tryLockAudioThread()) {
+        numContendedLocks.fetch_add(1, std::memory_order_relaxed);
+        instance->lockAudioThread();
     }
+}
 
-    return *this;
+void pd::WeakReference::unlock(Instance* instance)
+{
+    instance->unlockAudioThread();
 }
 
-void pd::WeakReference::setThis() const
+bool pd::WeakReference::tryReadSnapshot(void* destination, size_t size) const
 {
-    pd->setThis();
+    // Same as the reading side of a seqlock, with the generation of the Pd lock as the sequence number
+    auto const generation = pd->audioLockGeneration.load(std::memory_order_acquire);
+    if ((generation & 1) || !isAlive())
+        return false;
+
+    std::memcpy(destination, ptr, size);
+    std::atomic_thread_fence(std::memory_order_acquire);
+
+    return pd->audioLockGeneration.load(std::memory_order_relaxed) == generation;
+}
+
+pd::WeakReference::LockStats pd::WeakReference::getLockStats()
+{
+    return { numLocks.load(std::memory_order_relaxed), numContendedLocks.load(std::memory_order_relaxed) };
 }
@@ -5,57 +5,62 @@
  */
 #pragma once
 
+#include <atomic>
 #include <functional>
+#include <memory>
 #include <unordered_map>
 #include <mutex>
+#include <type_traits>
 
 #include <m_pd.h>
 
-using pd_weak_reference = std::atomic<bool>;
-
 namespace pd {
 
+// Shared by all weak references to the same Pd object, and invalidated by the instance when Pd frees that object
+// Checking if an object is still alive is a single atomic load, so it doesn't need the Pd lock
+struct WeakReferenceBlock {
+    std::atomic<bool> alive = true;
+};
+
 class Instance;
 struct WeakReference {
     WeakReference(void* p, Instance* instance);
 
     WeakReference(Instance* instance);
 
-    ~WeakReference();
-
-    WeakReference& operator=(WeakReference const& other);
-
     void setThis() const;
 
+    // Mutating access: holds the Pd lock for as long as the Ptr exists
     template<typename T>
     struct Ptr {
 
-        Ptr(T* pointer, pd_weak_reference const& ref)
-            : weakRef(ref)
+        Ptr(T* pointer, WeakReferenceBlock const* referenceBlock, Instance* instance)
+            : block(referenceBlock)
             , ptr(pointer)
+            , pd(instance)
         {
-            sys_lock();
+            lock(pd);
         }
 
         ~Ptr()
         {
-            sys_unlock();
+            unlock(pd);
         }
 
         operator bool() const
         {
-            return weakRef && (ptr != nullptr);
+            return isAlive() && (ptr != nullptr);
         }
 
         T* get()
         {
-            return weakRef ? ptr : nullptr;
+            return isAlive() ? ptr : nullptr;
         }
 
         template<typename C>
         C* cast()
         {
-            return weakRef ? reinterpret_cast<C*>(ptr) : nullptr;
+            return isAlive() ? reinterpret_cast<C*>(ptr) : nullptr;
         }
 
         T* operator->()
@@ -63,8 +68,15 @@ struct WeakReference {
             return ptr;
         }
 
-        pd_weak_reference const& weakRef;
+        bool isAlive() const
+        {
+            // We hold the Pd lock, so the object can't be freed while we're using it
+            return block && block->alive.load(std::memory_order_relaxed);
+        }
+
+        WeakReferenceBlock const* block;
         T* ptr;
+        Instance* pd;
 
         JUCE_DECLARE_NON_COPYABLE(Ptr)
     };
@@ -73,14 +85,19 @@ struct WeakReference {
     Ptr<T> get() const
     {
         setThis();
-        return Ptr<T>(reinterpret_cast<T*>(ptr), weakRef);
+        return Ptr<T>(reinterpret_cast<T*>(ptr), block.get(), pd);
+    }
+
+    bool isAlive() const
+    {
+        return block && block->alive.load(std::memory_order_acquire);
     }
 
     template<typename T>
     T* getRaw() const
     {
         setThis();
-        return weakRef ? reinterpret_cast<T*>(ptr) : nullptr;
+        return isAlive() ? reinterpret_cast<T*>(ptr) : nullptr;
     }
 
     template<typename T>
@@ -89,10 +106,48 @@ struct WeakReference {
         return reinterpret_cast<T*>(ptr);
     }
 
+    // Read-only access: copies the object without taking the Pd lock, for the GUI to paint from
+    // The copy is only kept if Pd didn't hold its lock while we were copying, since Pd only writes to objects under that lock
+    // If Pd keeps the lock busy, this waits for the lock instead. Returns false if the object has been freed.
+    template<typename T>
+    bool snapshot(T& copy) const
+    {
+        static_assert(std::is_trivially_copyable_v<T>, "Snapshots are copied byte by byte");
+
+        for (int attempt = 0; attempt < maxSnapshotAttempts; attempt++) {
+            if (tryReadSnapshot(&copy, sizeof(T)))
+                return true;
+        }
+
+        auto locked = get<T>();
+        if (!locked)
+            return false;
+
+        copy = *locked.get();
+        return true;
+    }
+
+    // Number of times that mutating access had to wait for the Pd lock, and the total number of times it was taken
+    struct LockStats {
+        uint64 numLocks = 0;
+        uint64 numContendedLocks = 0;
+    };
+
+    static LockStats getLockStats();
+
 private:
+    static void lock(Instance* instance);
+    static void unlock(Instance* instance);
+
+    bool tryReadSnapshot(void* destination, size_t size) const;
+    static constexpr int maxSnapshotAttempts = 4;
+
     void* ptr;
     Instance* pd;
-    pd_weak_reference weakRef = true;
+    std::shared_ptr<WeakReferenceBlock> block;
+
+    static inline std::atomic<uint64> numLocks = 0;
+    static inline std::atomic<uint64> numContendedLocks = 0;
 };
 
 }
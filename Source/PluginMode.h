@@ -116,6 +116,7 @@ public:
         addAndMakeVisible(content);
 
         cnv->setTopLeftPosition(-cnv->canvasOrigin);
+        cnv->updateVisibleArea();
         setWidthAndHeight(1.0f);
     }
 
@@ -122,9 +122,6 @@ PluginProcessor::PluginProcessor()
     midiBufferCopy.ensureSize(2048);
     midiBufferInternalSynth.ensureSize(2048);
 
-    atoms_playhead.reserve(3);
-    atoms_playhead.resize(1);
-
     sendMessagesFromQueue();
 
     auto themeName = settingsFile->getProperty<String>("theme");
@@ -140,9 +137,12 @@ PluginProcessor::PluginProcessor()
     settingsFile->saveSettings();
 
     oversampling = settingsFile->getProperty<int>("oversampling");
+    oversamplingFilter = settingsFile->getProperty<int>("oversampling_filter");
 
     setProtectedMode(settingsFile->getProperty<int>("protected"));
     enableInternalSynth = settingsFile->getProperty<int>("internal_synth");
+    internalSynth->setPolyphony(settingsFile->getProperty<int>("internal_synth_polyphony"));
+    internalSynth->setCPUBudget(settingsFile->getProperty<int>("internal_synth_cpu_budget") / 100.0f);
 
     auto currentThemeTree = settingsFile->getCurrentTheme();
 
@@ -153,24 +153,58 @@ PluginProcessor::PluginProcessor()
 
     updateSearchPaths();
 
+    // Look up the playhead symbols once, instead of on every block
+    playheadReceiver = generateSymbol("playhead");
+    for (auto [message, selector] : std::initializer_list<std::pair<PlayheadMessage, char const*>> {
+             { PlayheadPlaying, "playing" },
+             { PlayheadRecording, "recording" },
+             { PlayheadLooping, "looping" },
+             { PlayheadEditTime, "edittime" },
+             { PlayheadFrameRate, "framerate" },
+             { PlayheadBpm, "bpm" },
+             { PlayheadLastBar, "lastbar" },
+             { PlayheadTimeSignature, "timesig" },
+             { PlayheadPosition, "position" } }) {
+        playheadSelectors[message] = generateSymbol(selector);
+    }
+
+    lockAudioThread();
+    setThis();
+    playheadBindingClock = clock_new(this, reinterpret_cast<t_method>(updatePlayheadBinding));
+    clock_setunit(playheadBindingClock, Instance::getBlockSize(), 1);
+    clock_delay(playheadBindingClock, 0);
+    unlockAudioThread();
+
+    setParallelDSP(settingsFile->getProperty<int>("parallel_dsp"));
+    graphSwap.setFadeEnabled(settingsFile->getProperty<int>("fade_graph_changes"));
+
     objectLibrary = std::make_unique<pd::Library>(this);
-    objectLibrary->appDirChanged = [this]() {
-        // If we changed the settings from within the app, don't reload
-        settingsFile->reloadSettings();
-        auto newTheme = settingsFile->getProperty<String>("theme");
-        if (PlugDataLook::currentTheme != newTheme) {
-            setTheme(newTheme);
+    objectLibrary->appDirChanged = [this](bool settingsChanged, bool libraryChanged) {
+        // Our own changes to the settings are skipped here, only reload if another process changed them
+        if (settingsChanged && settingsFile->reloadSettings()) {
+            auto newTheme = settingsFile->getProperty<String>("theme");
+            if (PlugDataLook::currentTheme != newTheme) {
+                setTheme(newTheme);
+            }
+            libraryChanged = true;
         }
 
-        updateSearchPaths();
-        objectLibrary->updateLibrary();
+        if (libraryChanged) {
+            updateSearchPaths();
+            objectLibrary->updateLibrary();
+        }
     };
 
-    setLatencySamples(pd::Instance::getBlockSize());
+    setUserLatency(pd::Instance::getBlockSize());
 }
 
 PluginProcessor::~PluginProcessor()
 {
+    lockAudioThread();
+    setThis();
+    clock_free(playheadBindingClock);
+    unlockAudioThread();
+
     // Deleting the pd instance in ~PdInstance() will also free all the Pd patches
     patches.clear();
 }
@@ -392,6 +426,39 @@ void PluginProcessor::setOversampling(int amount)
     suspendProcessing(false);
 }
 
+void PluginProcessor::setOversamplingFilter(int filter)
+{
+    if (oversamplingFilter == filter)
+        return;
+
+    settingsFile->setProperty("oversampling_filter", var(filter));
+
+    oversamplingFilter = filter;
+
+    // Only the filters change, so we don't need to prepare Pd again
+    suspendProcessing(true);
+    auto maxChannels = std::max(getTotalNumInputChannels(), getTotalNumOutputChannels());
+    oversampler.prepare(maxChannels, oversampling, static_cast<Oversampler::Filter>(filter), AudioProcessor::getBlockSize());
+    updateLatency();
+    suspendProcessing(false);
+}
+
+void PluginProcessor::setUserLatency(int latency)
+{
+    userLatency = latency;
+    updateLatency();
+}
+
+int PluginProcessor::getUserLatency() const
+{
+    return userLatency;
+}
+
+void PluginProcessor::updateLatency()
+{
+    setLatencySamples(userLatency + oversampler.getLatencyInSamples());
+}
+
 void PluginProcessor::setProtectedMode(bool enabled)
 {
     protectedMode = enabled;
@@ -404,12 +471,13 @@ void PluginProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
 
     prepareDSP(getTotalNumInputChannels(), getTotalNumOutputChannels(), sampleRate * oversampleFactor, samplesPerBlock * oversampleFactor);
 
-    oversampler = std::make_unique<dsp::Oversampling<float>>(std::max(1, maxChannels), oversampling, dsp::Oversampling<float>::filterHalfBandPolyphaseIIR, false);
+    oversampler.prepare(maxChannels, oversampling, static_cast<Oversampler::Filter>(oversamplingFilter.load()), samplesPerBlock);
+    updateLatency();
 
-    oversampler->initProcessing(samplesPerBlock);
+    graphSwap.prepareToPlay(sampleRate);
 
     if (enableInternalSynth && ProjectInfo::isStandalone) {
-        internalSynth->prepare(sampleRate, samplesPerBlock, maxChannels);
+        internalSynth->prepare(sampleRate, samplesPerBlock);
     }
 
     audioAdvancement = 0;
@@ -423,6 +491,8 @@ void PluginProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
     midiBufferIn.clear();
     midiBufferOut.clear();
     midiBufferTemp.clear();
+    suspendedMidi.clear();
+    suspendedMidi.ensureSize(maxSuspendedMidiBytes);
 
     midiByteIndex = 0;
     midiByteBuffer[0] = 0;
@@ -437,7 +507,7 @@ void PluginProcessor::prepareToPlay(double sampleRate, int samplesPerBlock)
     statusbarSource->setBufferSize(samplesPerBlock);
     statusbarSource->prepareToPlay(getTotalNumOutputChannels());
 
-    limiter.prepare({ sampleRate, static_cast<uint32>(samplesPerBlock), std::max(1u, static_cast<uint32>(maxChannels)) });
+    limiter.prepare(sampleRate, samplesPerBlock);
 
     smoothedGain.reset(AudioProcessor::getSampleRate(), 0.02);
 }
@@ -491,9 +561,27 @@ void PluginProcessor::processBlock(AudioBuffer<float>& buffer, MidiBuffer& midiM
     auto totalNumInputChannels = getTotalNumInputChannels();
     auto totalNumOutputChannels = getTotalNumOutputChannels();
 
+    // While a patch is being loaded, we output silence instead of waiting for Pd
+    auto const shouldProcessPd = graphSwap.beginBlock();
+
     setThis();
-    sendPlayhead();
-    sendParameters();
+    if (shouldProcessPd) {
+        sendPlayhead();
+        sendParameters();
+    }
+
+    // MIDI that arrives while Pd is suspended is sent at the start of the next block that Pd processes
+    if (!shouldProcessPd) {
+        for (auto const event : midiMessages) {
+            if (suspendedMidi.data.size() + event.numBytes + midiEventHeaderSize <= maxSuspendedMidiBytes)
+                suspendedMidi.addEvent(event.data, event.numBytes, 0);
+        }
+        midiMessages.clear();
+    } else if (!suspendedMidi.isEmpty()) {
+        // Copy instead of swapping, so suspendedMidi keeps the storage we reserved for it in prepareToPlay
+        midiMessages.addEvents(suspendedMidi, 0, -1, 0);
+        suspendedMidi.clear();
+    }
 
     for (int i = totalNumInputChannels; i < totalNumOutputChannels; ++i) {
         buffer.clear(i, 0, buffer.getNumSamples());
@@ -503,14 +591,18 @@ void PluginProcessor::processBlock(AudioBuffer<float>& buffer, MidiBuffer& midiM
     midiBufferCopy.addEvents(midiMessages, 0, buffer.getNumSamples(), audioAdvancement);
 
     auto targetBlock = dsp::AudioBlock<float>(buffer);
-    auto blockOut = oversampling > 0 ? oversampler->processSamplesUp(targetBlock) : targetBlock;
-
-    process(blockOut, midiMessages);
+    auto blockOut = oversampler.processSamplesUp(targetBlock);
 
-    if (oversampling > 0) {
-        oversampler->processSamplesDown(targetBlock);
+    if (shouldProcessPd) {
+        process(blockOut, midiMessages);
+    } else {
+        blockOut.clear();
     }
 
+    oversampler.processSamplesDown(targetBlock);
+
+    graphSwap.endBlock(buffer);
+
     auto targetGain = volume->load();
     float mappedTargetGain = 0.0f;
 
@@ -562,25 +654,23 @@ void PluginProcessor::processBlock(AudioBuffer<float>& buffer, MidiBuffer& midiM
         }
 
         // If the internalSynth is enabled and loaded, let it process the midi
-        if (enableInternalSynth && internalSynth->isReady()) {
+        // The synth gets loaded and unloaded on a background thread, so these calls never block
+        if (enableInternalSynth) {
+            internalSynth->prepare(getSampleRate(), AudioProcessor::getBlockSize());
             internalSynth->process(buffer, midiBufferInternalSynth);
-        } else if (!enableInternalSynth && internalSynth->isReady()) {
+        } else {
             internalSynth->unprepare();
-        } else if (enableInternalSynth && !internalSynth->isReady()) {
-            internalSynth->prepare(getSampleRate(), AudioProcessor::getBlockSize(), std::max(totalNumInputChannels, totalNumOutputChannels));
         }
         midiBufferInternalSynth.clear();
     }
 
     if (protectedMode && buffer.getNumChannels() > 0) {
 
-        // Take out inf and NaN values
+        // Take out inf, NaN and denormal values
         auto* const* writePtr = buffer.getArrayOfWritePointers();
         for (int ch = 0; ch < buffer.getNumChannels(); ch++) {
-            for (int n = 0; n < buffer.getNumSamples(); n++) {
-                if (!std::isfinite(writePtr[ch][n])) {
-                    writePtr[ch][n] = 0.0f;
-                }
+            if (auto numFaults = SafetyLimiter::sanitise(writePtr[ch], buffer.getNumSamples())) {
+                statusbarSource->addSanitisedSamples(ch, numFaults);
             }
         }
 
@@ -710,86 +800,129 @@ void PluginProcessor::process(dsp::AudioBlock<float> buffer, MidiBuffer& midiMes
 
 void PluginProcessor::sendPlayhead()
 {
+    // Nothing in the patch listens to the playhead, so we don't even need to ask the host for it
+    if (!playheadBound.load(std::memory_order_relaxed))
+        return;
+
     AudioPlayHead* playhead = getPlayHead();
 
     if (!playhead)
         return;
 
     auto infos = playhead->getPosition();
+    if (!infos.hasValue())
+        return;
 
     setThis();
-    if (infos.hasValue()) {
-        atoms_playhead[0] = static_cast<float>(infos->getIsPlaying());
-        sendMessage("playhead", "playing", atoms_playhead);
 
-        atoms_playhead[0] = static_cast<float>(infos->getIsRecording());
-        sendMessage("playhead", "recording", atoms_playhead);
+    // Receivers are created and freed while holding the lock, so we need it before looking at them
+    lockAudioThread();
 
-        atoms_playhead[0] = static_cast<float>(infos->getIsLooping());
+    // The receivers could have been freed since the clock last checked
+    auto* receiver = playheadReceiver->s_thing;
+    if (!receiver) {
+        lastPlayheadBinding = nullptr;
+        unlockAudioThread();
+        return;
+    }
 
-        auto loopPoints = infos->getLoopPoints();
-        if (loopPoints.hasValue()) {
-            atoms_playhead.emplace_back(static_cast<float>(loopPoints->ppqStart));
-            atoms_playhead.emplace_back(static_cast<float>(loopPoints->ppqEnd));
-        } else {
-            atoms_playhead.emplace_back(0.0f);
-            atoms_playhead.emplace_back(0.0f);
+    // When something new starts listening, it should get the full transport state, not only the next change
+    // A receiver that replaced a freed one can have the same address and count, so we also check if anything was freed
+    auto numBindings = countBindings(receiver);
+    auto freeGeneration = objectFreeGeneration.load(std::memory_order_relaxed);
+    if (receiver != lastPlayheadBinding || numBindings != lastPlayheadNumBindings || freeGeneration != lastPlayheadFreeGeneration) {
+        for (auto& values : lastPlayheadValues) {
+            values.fill(std::numeric_limits<float>::quiet_NaN());
         }
-        sendMessage("playhead", "looping", atoms_playhead);
+        lastPlayheadBinding = receiver;
+        lastPlayheadNumBindings = numBindings;
+        lastPlayheadFreeGeneration = freeGeneration;
+    }
 
-        if (infos->getEditOriginTime().hasValue()) {
-            atoms_playhead.resize(1);
-            atoms_playhead[0] = static_cast<float>(*infos->getEditOriginTime());
-            sendMessage("playhead", "edittime", atoms_playhead);
-        }
+    sendPlayheadMessage(PlayheadPlaying, { static_cast<float>(infos->getIsPlaying()) }, 1);
+    sendPlayheadMessage(PlayheadRecording, { static_cast<float>(infos->getIsRecording()) }, 1);
 
-        if (infos->getFrameRate().hasValue()) {
-            atoms_playhead.resize(1);
-            atoms_playhead[0] = static_cast<float>(infos->getFrameRate()->getEffectiveRate());
-            sendMessage("playhead", "framerate", atoms_playhead);
-        }
+    auto loopPoints = infos->getLoopPoints();
+    sendPlayheadMessage(PlayheadLooping, { static_cast<float>(infos->getIsLooping()), loopPoints.hasValue() ? static_cast<float>(loopPoints->ppqStart) : 0.0f, loopPoints.hasValue() ? static_cast<float>(loopPoints->ppqEnd) : 0.0f }, 3);
 
-        if (infos->getBpm().hasValue()) {
-            atoms_playhead.resize(1);
-            atoms_playhead[0] = static_cast<float>(*infos->getBpm());
-            sendMessage("playhead", "bpm", atoms_playhead);
-        }
+    if (infos->getEditOriginTime().hasValue()) {
+        sendPlayheadMessage(PlayheadEditTime, { static_cast<float>(*infos->getEditOriginTime()) }, 1);
+    }
 
-        if (infos->getPpqPositionOfLastBarStart().hasValue()) {
-            atoms_playhead.resize(1);
-            atoms_playhead[0] = static_cast<float>(*infos->getPpqPositionOfLastBarStart());
-            sendMessage("playhead", "lastbar", atoms_playhead);
-        }
+    if (infos->getFrameRate().hasValue()) {
+        sendPlayheadMessage(PlayheadFrameRate, { static_cast<float>(infos->getFrameRate()->getEffectiveRate()) }, 1);
+    }
 
-        if (infos->getTimeSignature().hasValue()) {
-            atoms_playhead.resize(1);
-            atoms_playhead[0] = static_cast<float>(infos->getTimeSignature()->numerator);
-            atoms_playhead.emplace_back(static_cast<float>(infos->getTimeSignature()->denominator));
-            sendMessage("playhead", "timesig", atoms_playhead);
-        }
+    if (infos->getBpm().hasValue()) {
+        sendPlayheadMessage(PlayheadBpm, { static_cast<float>(*infos->getBpm()) }, 1);
+    }
 
-        if (infos->getPpqPosition().hasValue()) {
+    if (infos->getPpqPositionOfLastBarStart().hasValue()) {
+        sendPlayheadMessage(PlayheadLastBar, { static_cast<float>(*infos->getPpqPositionOfLastBarStart()) }, 1);
+    }
 
-            atoms_playhead[0] = static_cast<float>(*infos->getPpqPosition());
-        } else {
-            atoms_playhead[0] = 0.0f;
-        }
+    if (infos->getTimeSignature().hasValue()) {
+        sendPlayheadMessage(PlayheadTimeSignature, { static_cast<float>(infos->getTimeSignature()->numerator), static_cast<float>(infos->getTimeSignature()->denominator) }, 2);
+    }
 
-        if (infos->getTimeInSamples().hasValue()) {
-            atoms_playhead[1] = static_cast<float>(*infos->getTimeInSamples());
-        } else {
-            atoms_playhead[1] = 0.0f;
-        }
+    auto ppqPosition = infos->getPpqPosition().hasValue() ? static_cast<float>(*infos->getPpqPosition()) : 0.0f;
+    auto timeInSamples = infos->getTimeInSamples().hasValue() ? static_cast<float>(*infos->getTimeInSamples()) : 0.0f;
+    auto timeInSeconds = infos->getTimeInSeconds().hasValue() ? static_cast<float>(*infos->getTimeInSeconds()) : 0.0f;
+    sendPlayheadMessage(PlayheadPosition, { ppqPosition, timeInSamples, timeInSeconds }, 3);
 
-        if (infos->getTimeInSeconds().hasValue()) {
-            atoms_playhead.emplace_back(static_cast<float>(*infos->getTimeInSeconds()));
-        } else {
-            atoms_playhead.emplace_back(0.0f);
-        }
+    unlockAudioThread();
+}
+
+void PluginProcessor::sendPlayheadMessage(PlayheadMessage message, std::array<float, 3> values, int numValues)
+{
+    auto& lastValues = lastPlayheadValues[message];
+    if (std::equal(values.begin(), values.begin() + numValues, lastValues.begin()))
+        return;
+
+    lastValues = values;
+
+    // A receiver could unbind itself in response to the previous message, so check again
+    auto* receiver = playheadReceiver->s_thing;
+    if (!receiver)
+        return;
+
+    for (int i = 0; i < numValues; i++) {
+        SETFLOAT(playheadAtoms + i, values[i]);
+    }
+
+    pd_typedmess(receiver, playheadSelectors[message], numValues, playheadAtoms);
+}
+
+// Called by Pd on every tick, with the audio lock held
+void PluginProcessor::updatePlayheadBinding(PluginProcessor* processor)
+{
+    processor->playheadBound.store(processor->playheadReceiver->s_thing != nullptr, std::memory_order_relaxed);
+    clock_delay(processor->playheadBindingClock, 1);
+}
+
+// Returns the number of objects that are bound to a symbol
+int PluginProcessor::countBindings(t_pd* thing)
+{
+    // Start of t_bindlist and t_bindelem from m_pd.c
+    struct t_fake_bindelem {
+        t_pd* e_who;
+        t_fake_bindelem* e_next;
+    };
+    struct t_fake_bindlist {
+        t_pd b_pd;
+        t_fake_bindelem* b_list;
+    };
 
-        sendMessage("playhead", "position", atoms_playhead);
-        atoms_playhead.resize(1);
+    // A single receiver is bound directly, multiple receivers are put in a bindlist
+    if (std::strcmp(class_getname(pd_class(thing)), "bindlist") != 0)
+        return 1;
+
+    int numBindings = 0;
+    for (auto* element = reinterpret_cast<t_fake_bindlist*>(thing)->b_list; element; element = element->e_next) {
+        numBindings++;
     }
+
+    return numBindings;
 }
 
 void PluginProcessor::sendParameters()
@@ -959,7 +1092,7 @@ void PluginProcessor::getStateInformation(MemoryBlock& destData)
     }
     unlockAudioThread();
 
-    ostream.writeInt(getLatencySamples());
+    ostream.writeInt(userLatency);
     ostream.writeInt(oversampling);
     ostream.writeFloat(getValue<float>(tailLength));
 
@@ -969,7 +1102,8 @@ void PluginProcessor::getStateInformation(MemoryBlock& destData)
     // In the future, we're gonna load everything from xml, to make it easier to add new properties
     // By putting this here, we can prepare for making this change without breaking existing DAW saves
     xml.setAttribute("Oversampling", oversampling);
-    xml.setAttribute("Latency", getLatencySamples());
+    xml.setAttribute("OversamplingFilter", oversamplingFilter.load());
+    xml.setAttribute("Latency", userLatency);
     xml.setAttribute("TailLength", getValue<float>(tailLength));
     xml.setAttribute("Legacy", false);
 
@@ -1029,7 +1163,7 @@ void PluginProcessor::setStateInformation(void const* data, int sizeInBytes)
         }
     });
 
-    lockAudioThread();
+    graphSwap.beginChange();
 
     setThis();
     patches.clear();
@@ -1120,12 +1254,13 @@ void PluginProcessor::setStateInformation(void const* data, int sizeInBytes)
         auto versionString = String("0.6.1"); // latest version that didn't have version inside the daw state
 
         if (!xmlState->hasAttribute("Legacy") || xmlState->getBoolAttribute("Legacy")) {
-            setLatencySamples(legacyLatency);
+            setUserLatency(legacyLatency);
             setOversampling(legacyOversampling);
             tailLength = legacyTail;
         } else {
             setOversampling(xmlState->getDoubleAttribute("Oversampling"));
-            setLatencySamples(xmlState->getDoubleAttribute("Latency"));
+            setOversamplingFilter(xmlState->getIntAttribute("OversamplingFilter", Oversampler::IIR));
+            setUserLatency(xmlState->getDoubleAttribute("Latency"));
             tailLength = xmlState->getDoubleAttribute("TailLength");
         }
 
@@ -1152,7 +1287,7 @@ void PluginProcessor::setStateInformation(void const* data, int sizeInBytes)
         parseDataBuffer(*xmlState);
     }
 
-    unlockAudioThread();
+    graphSwap.endChange();
 
     delete[] xmlData;
 
@@ -1189,13 +1324,13 @@ pd::Patch::Ptr PluginProcessor::loadPatch(File const& patchFile, PluginEditor* e
         }
     }
 
-    // Stop the audio callback when loading a new patch
-    // TODO: why though?
-    lockAudioThread();
+    // Fades out and suspends DSP while loading, so the audio thread doesn't have to wait for us
+    // Patches without signal objects don't touch the DSP chain, so the other patches can keep playing
+    graphSwap.beginChange(pd::GraphSwap::containsSignalObjects(patchFile));
 
     auto newPatch = openPatch(patchFile);
 
-    unlockAudioThread();
+    graphSwap.endChange();
 
     if (!newPatch->getPointer()) {
         logError("Couldn't open patch");
@@ -1653,37 +1788,66 @@ Array<PluginEditor*> PluginProcessor::getEditors() const
 
 void PluginProcessor::reloadAbstractions(File changedPatch, t_glist* except)
 {
-    setThis();
-
-    // Ensure that all messages are dequeued before we start deleting objects
-    sendMessagesFromQueue();
+    // Only the canvases that contain an instance of the changed file need to be updated, the others can keep their state
+    // Synchronising can potentially delete some other canvases, so make sure we use a safepointer
+    Array<Component::SafePointer<Canvas>> affectedCanvases;
+    if (auto it = abstractionInstances.find(changedPatch.getFullPathName()); it != abstractionInstances.end()) {
+        for (auto* instance : it->second) {
+            affectedCanvases.addIfNotAlreadyThere(instance->cnv);
+        }
+    }
 
     isPerformingGlobalSync = true;
 
-    pd::Patch::reloadPatch(changedPatch, except);
+    {
+        pd::GraphSwap::ScopedChange change(graphSwap, pd::GraphSwap::containsSignalObjects(changedPatch));
 
-    for (auto* editor : getEditors()) {
+        // Ensure that all messages are dequeued before we start deleting objects
+        sendMessagesFromQueue();
 
-        // Synchronising can potentially delete some other canvases, so make sure we use a safepointer
-        Array<Component::SafePointer<Canvas>> canvases;
+        pd::Patch::reloadPatch(changedPatch, except);
+    }
 
+    for (auto* editor : getEditors()) {
+        // Tabs that showed the inside of a reloaded instance now point to a patch that was freed
         for (auto* canvas : editor->canvases) {
-            canvases.add(canvas);
+            if (!canvas->patch.isAlive())
+                affectedCanvases.addIfNotAlreadyThere(canvas);
         }
+    }
 
-        for (auto& cnv : canvases) {
-            if (cnv.getComponent()) {
-                cnv->synchronise();
-                cnv->handleUpdateNowIfNeeded();
-            }
+    for (auto& cnv : affectedCanvases) {
+        if (cnv.getComponent()) {
+            cnv->synchronise();
+            cnv->handleUpdateNowIfNeeded();
         }
+    }
 
-        editor->updateCommandStatus();
+    if (!affectedCanvases.isEmpty()) {
+        for (auto* editor : getEditors()) {
+            editor->updateCommandStatus();
+        }
     }
 
     isPerformingGlobalSync = false;
 }
 
+void PluginProcessor::registerAbstractionInstance(File const& abstraction, Object* instance)
+{
+    abstractionInstances[abstraction.getFullPathName()].addIfNotAlreadyThere(instance);
+}
+
+void PluginProcessor::unregisterAbstractionInstance(File const& abstraction, Object* instance)
+{
+    auto it = abstractionInstances.find(abstraction.getFullPathName());
+    if (it == abstractionInstances.end())
+        return;
+
+    it->second.removeFirstMatchingValue(instance);
+    if (it->second.isEmpty())
+        abstractionInstances.erase(it);
+}
+
 void PluginProcessor::titleChanged()
 {
     for (auto* editor : getEditors()) {
@@ -9,7 +9,8 @@
 #include <juce_audio_devices/juce_audio_devices.h>
 #include <juce_dsp/juce_dsp.h>
 #include "Utility/Config.h"
-#include "Utility/Limiter.h"
+#include "Utility/SafetyLimiter.h"
+#include "Utility/Oversampler.h"
 
 #include "Pd/Instance.h"
 #include "Pd/Patch.h"
@@ -19,6 +20,7 @@ class Library;
 }
 
 class InternalSynth;
+class Object;
 class SettingsFile;
 class StatusbarSource;
 struct PlugDataLook;
@@ -33,6 +35,11 @@ public:
     static AudioProcessor::BusesProperties buildBusesProperties();
 
     void setOversampling(int amount);
+    void setOversamplingFilter(int filter);
+
+    // The latency we report to the host is the latency set by the user, plus the latency of the oversampling filters
+    void setUserLatency(int latency);
+    int getUserLatency() const;
     void setProtectedMode(bool enabled);
     void prepareToPlay(double sampleRate, int samplesPerBlock) override;
     void releaseResources() override;
@@ -78,6 +85,10 @@ public:
 
     void reloadAbstractions(File changedPatch, t_glist* except) override;
 
+    // Keeps track of which objects are instances of an abstraction, so a change to that abstraction only has to update the canvases that show it
+    void registerAbstractionInstance(File const& abstraction, Object* instance);
+    void unregisterAbstractionInstance(File const& abstraction, Object* instance);
+
     void process(dsp::AudioBlock<float>, MidiBuffer&);
 
     bool canAddBus(bool isInput) const override
@@ -156,6 +167,7 @@ public:
 
     // Zero means no oversampling
     std::atomic<int> oversampling = 0;
+    std::atomic<int> oversamplingFilter = Oversampler::IIR;
     int lastLeftTab = -1;
     int lastRightTab = -1;
 
@@ -166,6 +178,7 @@ public:
         
 private:
     void processInternal();
+    void updateLatency();
 
 
     SmoothedValue<float, ValueSmoothingTypes::Linear> smoothedGain;
@@ -180,18 +193,55 @@ private:
     MidiBuffer midiBufferCopy;
     MidiBuffer midiBufferInternalSynth;
 
+    // Incoming MIDI is kept here while Pd is suspended by a patch change, up to a fixed size so we never allocate
+    MidiBuffer suspendedMidi;
+    static constexpr int maxSuspendedMidiBytes = 16384;
+    static constexpr int midiEventHeaderSize = sizeof(int32) + sizeof(uint16); // MidiBuffer stores a timestamp and size before every event
+
     AudioProcessLoadMeasurer cpuLoadMeasurer;
 
     bool midiByteIsSysex = false;
     uint8 midiByteBuffer[512] = { 0 };
     size_t midiByteIndex = 0;
 
-    std::vector<pd::Atom> atoms_playhead;
+    enum PlayheadMessage {
+        PlayheadPlaying,
+        PlayheadRecording,
+        PlayheadLooping,
+        PlayheadEditTime,
+        PlayheadFrameRate,
+        PlayheadBpm,
+        PlayheadLastBar,
+        PlayheadTimeSignature,
+        PlayheadPosition,
+        NumPlayheadMessages
+    };
+
+    void sendPlayheadMessage(PlayheadMessage message, std::array<float, 3> values, int numValues);
+    static int countBindings(t_pd* thing);
+    static void updatePlayheadBinding(PluginProcessor* processor);
+
+    std::unordered_map<String, Array<Object*>> abstractionInstances;
+
+    // Transport info is only sent when it changes, so we remember what we sent last
+    t_symbol* playheadReceiver = nullptr;
+    std::array<t_symbol*, NumPlayheadMessages> playheadSelectors = {};
+    std::array<std::array<float, 3>, NumPlayheadMessages> lastPlayheadValues = {};
+    t_atom playheadAtoms[3];
+    t_pd* lastPlayheadBinding = nullptr;
+    int lastPlayheadNumBindings = 0;
+    uint32 lastPlayheadFreeGeneration = 0;
+
+    // Pd has no hook for binding a symbol, so a clock checks every tick if anything listens to the playhead
+    // That happens while Pd holds the audio lock, so sendPlayhead can skip the host and the lock with a single load
+    t_clock* playheadBindingClock = nullptr;
+    std::atomic<bool> playheadBound = false;
 
     int lastSetProgram = 0;
 
-    Limiter limiter;
-    std::unique_ptr<dsp::Oversampling<float>> oversampler;
+    SafetyLimiter limiter;
+    Oversampler oversampler;
+    int userLatency = 64;
 
     std::map<unsigned long, std::unique_ptr<Component>> textEditorDialogs;
 
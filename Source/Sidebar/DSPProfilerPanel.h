@@ -0,0 +1,211 @@
+/*
+ // Copyright (c) 2021-2022 Timothy Schoen.
+ // For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ // WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+
+#include "Components/Buttons.h"
+
+// Table of the DSP cost of every object in every open patch
+// The profiler only runs while this panel is visible
+class DSPProfilerPanel : public Component
+    , public TableListBoxModel
+    , private Timer {
+
+    enum Column {
+        ObjectColumn = 1,
+        PatchColumn,
+        LoadColumn,
+        TotalLoadColumn
+    };
+
+public:
+    explicit DSPProfilerPanel(pd::Instance* instance)
+        : pd(instance)
+    {
+        auto& header = table.getHeader();
+        header.addColumn("Object", ObjectColumn, 110, 50, -1, TableHeaderComponent::defaultFlags);
+        header.addColumn("Patch", PatchColumn, 110, 50, -1, TableHeaderComponent::defaultFlags);
+        header.addColumn("Self %", LoadColumn, 54, 40, 80, TableHeaderComponent::defaultFlags);
+        header.addColumn("Total %", TotalLoadColumn, 54, 40, 80, TableHeaderComponent::defaultFlags);
+        header.setSortColumnId(LoadColumn, false);
+        header.setStretchToFitActive(true);
+
+        table.setModel(this);
+        table.setRowHeight(24);
+        table.setOutlineThickness(0);
+        table.setColour(ListBox::backgroundColourId, Colours::transparentBlack);
+        table.getViewport()->setScrollBarsShown(true, false, false, false);
+        addAndMakeVisible(table);
+
+        emptyLabel.setText("Turn on DSP to see the cost of every signal object", dontSendNotification);
+        emptyLabel.setJustificationType(Justification::centred);
+        emptyLabel.setInterceptsMouseClicks(false, false);
+        addChildComponent(emptyLabel);
+    }
+
+    ~DSPProfilerPanel() override
+    {
+        if (profiling)
+            pd->stopDSPProfiling();
+    }
+
+    void visibilityChanged() override
+    {
+        updateProfiling();
+    }
+
+    // The sidebar collapses to zero width instead of hiding the panel
+    void updateProfiling()
+    {
+        auto const shouldProfile = isVisible() && getWidth() > 0;
+        if (shouldProfile && !profiling) {
+            pd->startDSPProfiling();
+            profiling = true;
+            startTimer(1000);
+            timerCallback();
+        } else if (!shouldProfile && profiling) {
+            stopTimer();
+            pd->stopDSPProfiling();
+            profiling = false;
+        }
+    }
+
+    void timerCallback() override
+    {
+        costs = pd->getDSPCosts();
+        sortCosts();
+
+        emptyLabel.setVisible(costs.isEmpty());
+        table.updateContent();
+        table.repaint();
+    }
+
+    void resized() override
+    {
+        table.setBounds(getLocalBounds());
+        emptyLabel.setBounds(getLocalBounds().reduced(8, 0));
+        updateProfiling();
+    }
+
+    void lookAndFeelChanged() override
+    {
+        emptyLabel.setColour(Label::textColourId, findColour(PlugDataColour::sidebarTextColourId).withAlpha(0.5f));
+    }
+
+    int getNumRows() override
+    {
+        return costs.size();
+    }
+
+    void paintRowBackground(Graphics& g, int row, int width, int height, bool rowIsSelected) override
+    {
+        if (rowIsSelected) {
+            g.setColour(findColour(PlugDataColour::sidebarActiveBackgroundColourId));
+            g.fillRoundedRectangle(Rectangle<float>(3, 1, width - 6, height - 2), Corners::defaultCornerRadius);
+        } else if (row % 2) {
+            g.setColour(findColour(PlugDataColour::sidebarBackgroundColourId).contrasting(0.03f));
+            g.fillRect(0, 0, width, height);
+        }
+    }
+
+    void paintCell(Graphics& g, int row, int columnId, int width, int height, bool rowIsSelected) override
+    {
+        if (!isPositiveAndBelow(row, costs.size()))
+            return;
+
+        auto const& cost = costs.getReference(row);
+
+        String text;
+        switch (columnId) {
+        case ObjectColumn:
+            text = cost.name;
+            break;
+        case PatchColumn:
+            text = cost.path;
+            break;
+        case LoadColumn:
+            text = String(cost.load, 2);
+            break;
+        case TotalLoadColumn:
+            text = cost.isCanvas ? String(cost.totalLoad, 2) : String();
+            break;
+        default:
+            break;
+        }
+
+        auto const textColour = findColour(PlugDataColour::sidebarTextColourId);
+        auto const textBounds = Rectangle<int>(6, 0, width - 12, height);
+
+        if (columnId == LoadColumn || columnId == TotalLoadColumn) {
+            g.setColour(textColour);
+            g.setFont(Fonts::getMonospaceFont().withHeight(12));
+            g.drawText(text, textBounds, Justification::centredRight, false);
+        } else {
+            Fonts::drawFittedText(g, text, textBounds, textColour, 1, 0.9f, 13.0f);
+        }
+    }
+
+    void sortOrderChanged(int newSortColumnId, bool isForwards) override
+    {
+        sortCosts();
+        table.updateContent();
+    }
+
+    std::unique_ptr<Component> getExtraSettingsComponent()
+    {
+        auto* exportButton = new SmallIconButton(Icons::ExportState);
+        exportButton->setTooltip("Export DSP profile as JSON");
+        exportButton->setConnectedEdges(12);
+        exportButton->onClick = [this]() {
+            saveChooser = std::make_unique<FileChooser>("Choose save location", File(SettingsFile::getInstance()->getProperty<String>("last_filechooser_path")).getChildFile("dsp_profile.json"), "*.json", SettingsFile::getInstance()->wantsNativeDialog());
+
+            saveChooser->launchAsync(FileBrowserComponent::saveMode | FileBrowserComponent::canSelectFiles | FileBrowserComponent::warnAboutOverwriting, [this](FileChooser const& f) {
+                auto file = f.getResult();
+                if (file == File())
+                    return;
+
+                auto result = pd->exportDSPProfile(file);
+                if (result.failed())
+                    pd->logError(result.getErrorMessage());
+            });
+        };
+
+        return std::unique_ptr<TextButton>(exportButton);
+    }
+
+private:
+    void sortCosts()
+    {
+        auto const& header = table.getHeader();
+        auto const column = header.getSortColumnId();
+        auto const forwards = header.isSortedForwards();
+
+        auto lessThan = [column](auto const& a, auto const& b) {
+            switch (column) {
+            case ObjectColumn:
+                return a.name.compareNatural(b.name) < 0;
+            case PatchColumn:
+                return a.path.compareNatural(b.path) < 0;
+            case TotalLoadColumn:
+                return a.totalLoad < b.totalLoad;
+            default:
+                return a.load < b.load;
+            }
+        };
+
+        std::stable_sort(costs.begin(), costs.end(), [&lessThan, forwards](auto const& a, auto const& b) {
+            return forwards ? lessThan(a, b) : lessThan(b, a);
+        });
+    }
+
+    pd::Instance* pd;
+    bool profiling = false;
+
+    Array<pd::DSPProfiler::ObjectCost> costs;
+
+    TableListBox table;
+    Label emptyLabel;
+
+    std::unique_ptr<FileChooser> saveChooser;
+};
@@ -0,0 +1,154 @@
+/*
+ // Copyright (c) 2021-2022 Timothy Schoen.
+ // For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ // WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+
+// Lists the busiest outlets and send symbols in all open patches, and the feedback loops that carry a lot of messages
+// Message tracing only runs while this panel is visible
+class MessageTracePanel : public Component
+    , public ListBoxModel
+    , private Timer {
+
+    struct Row {
+        bool isHeader;
+        String text;
+        String detail;
+        float rate;
+    };
+
+public:
+    explicit MessageTracePanel(pd::Instance* instance)
+        : pd(instance)
+    {
+        listBox.setModel(this);
+        listBox.setRowHeight(rowHeight);
+        listBox.setOutlineThickness(0);
+        listBox.setColour(ListBox::backgroundColourId, Colours::transparentBlack);
+        listBox.getViewport()->setScrollBarsShown(true, false, false, false);
+        addAndMakeVisible(listBox);
+
+        emptyLabel.setText("No messages were sent over connections in the last second", dontSendNotification);
+        emptyLabel.setJustificationType(Justification::centred);
+        emptyLabel.setInterceptsMouseClicks(false, false);
+        addChildComponent(emptyLabel);
+    }
+
+    ~MessageTracePanel() override
+    {
+        if (tracing)
+            pd->stopMessageTracing();
+    }
+
+    void visibilityChanged() override
+    {
+        updateTracing();
+    }
+
+    void timerCallback() override
+    {
+        auto const summary = pd->getMessageTrace();
+
+        rows.clear();
+
+        if (!summary.loops.isEmpty()) {
+            rows.push_back({ true, "Suspected feedback loops", {}, 0.0f });
+            for (auto const& loop : summary.loops) {
+                rows.push_back({ false, loop.names.joinIntoString(" > "), loop.path, loop.rate });
+            }
+        }
+
+        if (!summary.topOutlets.isEmpty()) {
+            rows.push_back({ true, "Busiest outlets", {}, 0.0f });
+            for (auto const& outlet : summary.topOutlets) {
+                rows.push_back({ false, outlet.name + " (outlet " + String(outlet.outlet) + ")", outlet.path, outlet.rate });
+            }
+        }
+
+        if (!summary.topSymbols.isEmpty()) {
+            rows.push_back({ true, "Busiest send symbols", {}, 0.0f });
+            for (auto const& symbol : summary.topSymbols) {
+                rows.push_back({ false, symbol.symbol, String(symbol.numSenders) + (symbol.numSenders == 1 ? " sender" : " senders"), symbol.rate });
+            }
+        }
+
+        if (summary.droppedMessages > 0) {
+            rows.push_back({ true, String(summary.droppedMessages) + " messages could not be counted", {}, 0.0f });
+        }
+
+        emptyLabel.setVisible(rows.empty());
+        listBox.updateContent();
+        listBox.repaint();
+    }
+
+    void resized() override
+    {
+        listBox.setBounds(getLocalBounds());
+        emptyLabel.setBounds(getLocalBounds().reduced(8, 0));
+        updateTracing();
+    }
+
+    void lookAndFeelChanged() override
+    {
+        emptyLabel.setColour(Label::textColourId, findColour(PlugDataColour::sidebarTextColourId).withAlpha(0.5f));
+    }
+
+    int getNumRows() override
+    {
+        return static_cast<int>(rows.size());
+    }
+
+    void paintListBoxItem(int rowNumber, Graphics& g, int width, int height, bool rowIsSelected) override
+    {
+        if (!isPositiveAndBelow(rowNumber, static_cast<int>(rows.size())))
+            return;
+
+        auto const& row = rows[rowNumber];
+        auto const textColour = findColour(PlugDataColour::sidebarTextColourId);
+        auto bounds = Rectangle<int>(8, 0, width - 16, height);
+
+        if (row.isHeader) {
+            Fonts::drawStyledText(g, row.text, bounds.withTrimmedTop(6), textColour, Semibold, 13, Justification::centredLeft);
+            return;
+        }
+
+        if (rowIsSelected) {
+            g.setColour(findColour(PlugDataColour::sidebarActiveBackgroundColourId));
+            g.fillRoundedRectangle(Rectangle<float>(3, 1, width - 6, height - 2), Corners::defaultCornerRadius);
+        }
+
+        auto rateText = (row.rate >= 1000.0f ? String(row.rate / 1000.0f, 1) + "k" : String(roundToInt(row.rate))) + "/s";
+        g.setColour(textColour);
+        g.setFont(Fonts::getMonospaceFont().withHeight(12));
+        g.drawText(rateText, bounds.removeFromRight(56), Justification::centredRight, false);
+
+        Fonts::drawFittedText(g, row.text, bounds.removeFromTop(height / 2 + 2).withTrimmedTop(3), textColour, 1, 0.9f, 13.0f);
+        Fonts::drawFittedText(g, row.detail, bounds.withTrimmedBottom(3), textColour.withAlpha(0.6f), 1, 0.9f, 11.0f);
+    }
+
+private:
+    // The sidebar collapses to zero width instead of hiding the panel
+    void updateTracing()
+    {
+        auto const shouldTrace = isVisible() && getWidth() > 0;
+        if (shouldTrace && !tracing) {
+            pd->startMessageTracing();
+            tracing = true;
+            startTimer(1000);
+        } else if (!shouldTrace && tracing) {
+            stopTimer();
+            pd->stopMessageTracing();
+            tracing = false;
+        }
+    }
+
+    static constexpr int rowHeight = 34;
+
+    pd::Instance* pd;
+    bool tracing = false;
+
+    std::vector<Row> rows;
+
+    ListBox listBox;
+    Label emptyLabel;
+};
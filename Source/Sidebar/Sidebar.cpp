@@ -20,6 +20,8 @@
 #include "DocumentationBrowser.h"
 #include "AutomationPanel.h"
 #include "SearchPanel.h"
+#include "DSPProfilerPanel.h"
+#include "MessageTracePanel.h"
 
 Sidebar::Sidebar(PluginProcessor* instance, PluginEditor* parent)
     : pd(instance)
@@ -31,6 +33,8 @@ Sidebar::Sidebar(PluginProcessor* instance, PluginEditor* parent)
     browser = std::make_unique<DocumentationBrowser>(pd);
     automationPanel = std::make_unique<AutomationPanel>(pd);
     searchPanel = std::make_unique<SearchPanel>(parent);
+    profilerPanel = std::make_unique<DSPProfilerPanel>(pd);
+    messageTracePanel = std::make_unique<MessageTracePanel>(pd);
 
     inspector->setAlwaysOnTop(true);
 
@@ -39,12 +43,16 @@ Sidebar::Sidebar(PluginProcessor* instance, PluginEditor* parent)
     addChildComponent(browser.get());
     addChildComponent(automationPanel.get());
     addChildComponent(searchPanel.get());
+    addChildComponent(profilerPanel.get());
+    addChildComponent(messageTracePanel.get());
 
     browser->addMouseListener(this, true);
     console->addMouseListener(this, true);
     automationPanel->addMouseListener(this, true);
     inspector->addMouseListener(this, true);
     searchPanel->addMouseListener(this, true);
+    profilerPanel->addMouseListener(this, true);
+    messageTracePanel->addMouseListener(this, true);
 
     consoleButton.setTooltip("Open console panel");
     consoleButton.setConnectedEdges(12);
@@ -77,6 +85,22 @@ Sidebar::Sidebar(PluginProcessor* instance, PluginEditor* parent)
     };
     addAndMakeVisible(searchButton);
 
+    profilerButton.setTooltip("Open DSP profiler");
+    profilerButton.setConnectedEdges(12);
+    profilerButton.setClickingTogglesState(true);
+    profilerButton.onClick = [this]() {
+        showPanel(4);
+    };
+    addAndMakeVisible(profilerButton);
+
+    messageTraceButton.setTooltip("Open message trace");
+    messageTraceButton.setConnectedEdges(12);
+    messageTraceButton.setClickingTogglesState(true);
+    messageTraceButton.onClick = [this]() {
+        showPanel(5);
+    };
+    addAndMakeVisible(messageTraceButton);
+
     panelPinButton.setTooltip("Pin panel");
     panelPinButton.setConnectedEdges(12);
     panelPinButton.setClickingTogglesState(true);
@@ -89,6 +113,8 @@ Sidebar::Sidebar(PluginProcessor* instance, PluginEditor* parent)
     automationButton.setRadioGroupId(hash("sidebar_button"));
     consoleButton.setRadioGroupId(hash("sidebar_button"));
     searchButton.setRadioGroupId(hash("sidebar_button"));
+    profilerButton.setRadioGroupId(hash("sidebar_button"));
+    messageTraceButton.setRadioGroupId(hash("sidebar_button"));
 
     consoleButton.setToggleState(true, dontSendNotification);
 
@@ -151,7 +177,7 @@ void Sidebar::resized()
     auto buttonBarBounds = bounds.removeFromRight(30).reduced(0, 1);
 
     if(SettingsFile::getInstance()->getProperty<bool>("centre_sidepanel_buttons")) {
-        buttonBarBounds = buttonBarBounds.withSizeKeepingCentre(30, 144);
+        buttonBarBounds = buttonBarBounds.withSizeKeepingCentre(30, 220);
     }
 
     consoleButton.setBounds(buttonBarBounds.removeFromTop(30));
@@ -161,6 +187,10 @@ void Sidebar::resized()
     automationButton.setBounds(buttonBarBounds.removeFromTop(30));
     buttonBarBounds.removeFromTop(8);
     searchButton.setBounds(buttonBarBounds.removeFromTop(30));
+    buttonBarBounds.removeFromTop(8);
+    profilerButton.setBounds(buttonBarBounds.removeFromTop(30));
+    buttonBarBounds.removeFromTop(8);
+    messageTraceButton.setBounds(buttonBarBounds.removeFromTop(30));
 
     auto panelTitleBarBounds = bounds.removeFromTop(30);
 
@@ -173,6 +203,8 @@ void Sidebar::resized()
     inspector->setBounds(bounds);
     automationPanel->setBounds(bounds);
     searchPanel->setBounds(bounds);
+    profilerPanel->setBounds(bounds);
+    messageTracePanel->setBounds(bounds);
 }
 
 void Sidebar::mouseDown(MouseEvent const& e)
@@ -222,6 +254,8 @@ void Sidebar::showPanel(int panelToShow)
     bool showBrowser = panelToShow == 1;
     bool showAutomation = panelToShow == 2;
     bool showSearch = panelToShow == 3;
+    bool showProfiler = panelToShow == 4;
+    bool showMessageTrace = panelToShow == 5;
 
     if (panelToShow == currentPanel && !sidebarHidden) {
 
@@ -229,6 +263,8 @@ void Sidebar::showPanel(int panelToShow)
         browserButton.setToggleState(false, dontSendNotification);
         automationButton.setToggleState(false, dontSendNotification);
         searchButton.setToggleState(false, dontSendNotification);
+        profilerButton.setToggleState(false, dontSendNotification);
+        messageTraceButton.setToggleState(false, dontSendNotification);
 
         showSidebar(false);
         return;
@@ -243,7 +279,7 @@ void Sidebar::showPanel(int panelToShow)
     browser->setVisible(showBrowser);
     browser->setInterceptsMouseClicks(showBrowser, showBrowser);
 
-    auto buttons = std::vector<TextButton*> { &consoleButton, &browserButton, &automationButton, &searchButton };
+    auto buttons = std::vector<TextButton*> { &consoleButton, &browserButton, &automationButton, &searchButton, &profilerButton, &messageTraceButton };
 
     for (int i = 0; i < buttons.size(); i++) {
         buttons[i]->setToggleState(i == panelToShow, dontSendNotification);
@@ -258,6 +294,12 @@ void Sidebar::showPanel(int panelToShow)
         searchPanel->grabFocus();
     searchPanel->setInterceptsMouseClicks(showSearch, showSearch);
 
+    profilerPanel->setVisible(showProfiler);
+    profilerPanel->setInterceptsMouseClicks(showProfiler, showProfiler);
+
+    messageTracePanel->setVisible(showMessageTrace);
+    messageTracePanel->setInterceptsMouseClicks(showMessageTrace, showMessageTrace);
+
     hideParameters();
 
     currentPanel = panelToShow;
@@ -343,6 +385,8 @@ void Sidebar::updateExtraSettingsButton()
         extraSettingsButton = console->getExtraSettingsComponent();
     } else if (browser->isVisible()) {
         extraSettingsButton = browser->getExtraSettingsComponent();
+    } else if (profilerPanel->isVisible()) {
+        extraSettingsButton = profilerPanel->getExtraSettingsComponent();
     } else {
         extraSettingsButton.reset(nullptr);
         return;
@@ -362,6 +406,8 @@ void Sidebar::showParameters()
         browser->setVisible(false);
         searchPanel->setVisible(false);
         automationPanel->setVisible(false);
+        profilerPanel->setVisible(false);
+        messageTracePanel->setVisible(false);
     }
 
     updateExtraSettingsButton();
@@ -15,6 +15,8 @@ class Inspector;
 class DocumentationBrowser;
 class AutomationPanel;
 class SearchPanel;
+class DSPProfilerPanel;
+class MessageTracePanel;
 class PluginProcessor;
 
 namespace pd {
@@ -132,6 +134,8 @@ private:
     SidebarSelectorButton browserButton = SidebarSelectorButton(Icons::Documentation);
     SidebarSelectorButton automationButton = SidebarSelectorButton(Icons::Parameters);
     SidebarSelectorButton searchButton = SidebarSelectorButton(Icons::Search);
+    SidebarSelectorButton profilerButton = SidebarSelectorButton(Icons::CPU);
+    SidebarSelectorButton messageTraceButton = SidebarSelectorButton(Icons::Message);
 
     std::unique_ptr<Component> extraSettingsButton;
     SmallIconButton panelPinButton = SmallIconButton(Icons::Pin);
@@ -141,8 +145,10 @@ private:
     std::unique_ptr<DocumentationBrowser> browser;
     std::unique_ptr<AutomationPanel> automationPanel;
     std::unique_ptr<SearchPanel> searchPanel;
+    std::unique_ptr<DSPProfilerPanel> profilerPanel;
+    std::unique_ptr<MessageTracePanel> messageTracePanel;
 
-    StringArray panelNames = { "Console", "Documentation Browser", "Automation Parameters", "Search" };
+    StringArray panelNames = { "Console", "Documentation Browser", "Automation Parameters", "Search", "DSP Profiler", "Message Trace" };
     int currentPanel = 0;
 
     int dragStartWidth = 0;
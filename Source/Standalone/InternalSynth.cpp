@@ -12,11 +12,36 @@
 #    include <StandaloneBinaryData.h>
 #endif
 
+struct InternalSynth::State {
+#ifdef PLUGDATA_STANDALONE
+    ~State()
+    {
+        if (synth)
+            delete_fluid_synth(synth);
+        if (settings)
+            delete_fluid_settings(settings);
+    }
+#endif
+
+    FluidSynth* synth = nullptr;
+    FluidSettings* settings = nullptr;
+
+    int sampleRate = 0;
+    int blockSize = 0;
+
+    // Fluidlite does not like setups with <2 channels, so we always render in stereo
+    AudioBuffer<float> buffer;
+
+    // Only used on the audio thread
+    int voiceLimit = 0;
+    int blocksOverBudget = 0;
+};
+
 // InternalSynth is an internal General MIDI synthesizer that can be used as a MIDI output device
 // The goal is to get something similar to the "AU DLS Synth" in Max/MSP on macOS, but cross-platform
 // Since fluidsynth is alraedy included for the sfont~ object, we can reuse it here to read a GM soundfont
 InternalSynth::InternalSynth()
-    : Thread("InternalSynthInit")
+    : Thread("Internal Synth")
 {
 #ifdef PLUGDATA_STANDALONE
     // Unpack soundfont
@@ -26,116 +51,132 @@ InternalSynth::InternalSynth()
         ostream.write(StandaloneBinaryData::GeneralUser_GS_sf3, StandaloneBinaryData::GeneralUser_GS_sf3Size);
         ostream.flush();
     }
+
+    startThread();
 #endif
 }
 
 InternalSynth::~InternalSynth()
 {
 #ifdef PLUGDATA_STANDALONE
-
     stopThread(6000);
-
-    if (ready) {
-        if (synth)
-            delete_fluid_synth(synth);
-        if (settings)
-            delete_fluid_settings(settings);
-    }
+    publishState(nullptr);
 #endif
 }
 
-// Initialise fluidsynth on another thread, because it takes a while
+// Keeps the fluidsynth state in line with what the audio thread asked for
 void InternalSynth::run()
 {
 #ifdef PLUGDATA_STANDALONE
-
-    unprepareLock.lock();
-
-    // Fluidlite does not like setups with <2 channels
-    internalBuffer.setSize(std::max(2, lastNumChannels.load()), lastBlockSize);
-    internalBuffer.clear();
-
-    // Check if soundfont exists to prevent crashing
-    if (soundFont.existsAsFile()) {
-        auto pathName = soundFont.getFullPathName();
-
-        // Initialise fluidsynth
-        settings = new_fluid_settings();
-        fluid_settings_setint(settings, "synth.ladspa.active", 0);
-        fluid_settings_setint(settings, "synth.midi-channels", 16);
-        fluid_settings_setnum(settings, "synth.gain", 0.9f);
-        fluid_settings_setnum(settings, "synth.audio-channels", lastNumChannels);
-        fluid_settings_setnum(settings, "synth.sample-rate", lastSampleRate);
-        synth = new_fluid_synth(settings); // Create fluidsynth instance:
-
-        // Load the soundfont
-        int ret = fluid_synth_sfload(synth, pathName.toRawUTF8(), 0);
-
-        if (ret >= 0) {
-            fluid_synth_program_reset(synth);
+    while (!threadShouldExit()) {
+        auto* state = currentState.load();
+
+        if (!shouldBeActive) {
+            if (state)
+                publishState(nullptr);
+        } else {
+            auto sampleRate = requestedSampleRate.load();
+            auto blockSize = requestedBlockSize.load();
+
+            if (sampleRate > 0 && blockSize > 0 && (!state || state->sampleRate != sampleRate || state->blockSize != blockSize)) {
+                if (auto* newState = createState(sampleRate, blockSize))
+                    publishState(newState);
+            }
         }
 
-        ready = true;
+        wait(50);
     }
-
-    unprepareLock.unlock();
-
 #endif
 }
 
-void InternalSynth::unprepare()
+InternalSynth::State* InternalSynth::createState(int sampleRate, int blockSize)
 {
 #ifdef PLUGDATA_STANDALONE
+    // Check if soundfont exists to prevent crashing
+    if (!soundFont.existsAsFile())
+        return nullptr;
+
+    auto* state = new State();
+    state->sampleRate = sampleRate;
+    state->blockSize = blockSize;
+    state->buffer.setSize(2, blockSize);
+    state->buffer.clear();
+
+    // Initialise fluidsynth
+    // We allocate the maximum number of voices up front, so the polyphony can be changed later without rebuilding the synth
+    state->settings = new_fluid_settings();
+    fluid_settings_setint(state->settings, "synth.ladspa.active", 0);
+    fluid_settings_setint(state->settings, "synth.midi-channels", 16);
+    fluid_settings_setint(state->settings, "synth.polyphony", maxPolyphony);
+    fluid_settings_setnum(state->settings, "synth.gain", 0.9f);
+    fluid_settings_setnum(state->settings, "synth.sample-rate", sampleRate);
+    state->synth = new_fluid_synth(state->settings); // Create fluidsynth instance:
+
+    // Load the soundfont
+    int ret = fluid_synth_sfload(state->synth, soundFont.getFullPathName().toRawUTF8(), 0);
+
+    if (ret >= 0) {
+        fluid_synth_program_reset(state->synth);
+    }
 
-    unprepareLock.lock();
-
-    if (ready) {
-        if (synth)
-            delete_fluid_synth(synth);
-        if (settings)
-            delete_fluid_settings(settings);
-
-        lastSampleRate = 0;
-        lastBlockSize = 0;
-        lastNumChannels = 0;
+    state->voiceLimit = polyphony;
+    fluid_synth_set_polyphony(state->synth, state->voiceLimit);
 
-        ready = false;
+    return state;
+#else
+    return nullptr;
+#endif
+}
 
-        synth = nullptr;
-        settings = nullptr;
-    }
+void InternalSynth::publishState(State* newState)
+{
+    auto* oldState = currentState.exchange(newState);
 
-    unprepareLock.unlock();
+    // The audio thread may still be rendering with the old state
+    while (audioThreadBusy.load())
+        Thread::yield();
 
-#endif
+    delete oldState;
 }
 
-void InternalSynth::prepare(int sampleRate, int blockSize, int numChannels)
+void InternalSynth::unprepare()
 {
-#ifdef PLUGDATA_STANDALONE
+    shouldBeActive = false;
+}
 
-    if (ready && !isThreadRunning() && sampleRate == lastSampleRate && blockSize == lastBlockSize && numChannels == lastNumChannels) {
-        return;
-    } else {
-        lastSampleRate = sampleRate;
-        lastBlockSize = blockSize;
-        lastNumChannels = numChannels;
+void InternalSynth::prepare(int sampleRate, int blockSize)
+{
+    requestedSampleRate = sampleRate;
+    requestedBlockSize = blockSize;
+    shouldBeActive = true;
+}
 
-        startThread();
-    }
+void InternalSynth::setPolyphony(int maxVoices)
+{
+    polyphony = jlimit(1, maxPolyphony, maxVoices);
+}
 
-#endif
+void InternalSynth::setCPUBudget(float fractionOfBlock)
+{
+    cpuBudget = jlimit(0.05f, 1.0f, fractionOfBlock);
 }
 
 void InternalSynth::process(AudioBuffer<float>& buffer, MidiBuffer& midiMessages)
 {
 #ifdef PLUGDATA_STANDALONE
 
-    if (buffer.getNumChannels() != lastNumChannels || buffer.getNumSamples() > lastBlockSize) {
-        unprepare();
+    // Tell the background thread we're using the current state, so it won't be deleted while we're rendering
+    audioThreadBusy = true;
+    auto* state = currentState.load();
+
+    if (!state) {
+        audioThreadBusy = false;
         return;
     }
 
+    auto* synth = state->synth;
+    auto startTicks = Time::getHighResolutionTicks();
+
     // Pass MIDI messages to fluidsynth
     for (auto const& event : midiMessages) {
         auto const message = event.getMessage();
@@ -169,12 +210,54 @@ void InternalSynth::process(AudioBuffer<float>& buffer, MidiBuffer& midiMessages
     }
 
     // Run audio through fluidsynth
-    fluid_synth_process(synth, buffer.getNumSamples(), internalBuffer.getNumChannels(), const_cast<float**>(internalBuffer.getArrayOfReadPointers()), internalBuffer.getNumChannels(), const_cast<float**>(internalBuffer.getArrayOfWritePointers()));
+    // The host may give us more samples than it said it would, so we render in chunks of the prepared block size
+    auto const numSamples = buffer.getNumSamples();
+    auto const numChannels = std::min(buffer.getNumChannels(), 2);
+    for (int start = 0; start < numSamples; start += state->blockSize) {
+        auto const numToRender = std::min(state->blockSize, numSamples - start);
+        auto* const* output = state->buffer.getArrayOfWritePointers();
+        fluid_synth_write_float(synth, numToRender, output[0], 0, 1, output[1], 0, 1);
+
+        for (int ch = 0; ch < numChannels; ch++) {
+            buffer.addFrom(ch, start, state->buffer, ch, 0, numToRender);
+        }
+    }
+
+    auto renderTime = Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - startTicks);
+    updateVoiceBudget(*state, renderTime, numSamples);
 
-    for (int ch = 0; ch < buffer.getNumChannels(); ch++) {
-        buffer.addFrom(ch, 0, internalBuffer, ch, 0, buffer.getNumSamples());
+    audioThreadBusy = false;
+
+#endif
+}
+
+// Lowers the number of voices when rendering takes too long, and slowly gives them back when there is time to spare
+// Fluidsynth kills the least important voices first: released, sustained, old and quiet voices go before the rest
+void InternalSynth::updateVoiceBudget(State& state, double renderTime, int numSamples)
+{
+#ifdef PLUGDATA_STANDALONE
+    auto const maxVoices = polyphony.load();
+    auto const budget = cpuBudget.load() * numSamples / static_cast<double>(state.sampleRate);
+    auto newLimit = std::min(state.voiceLimit, maxVoices);
+
+    if (renderTime > budget) {
+        // Single slow blocks can happen when the OS preempts us, so only react when we're over budget twice in a row
+        if (++state.blocksOverBudget >= 2) {
+            auto activeVoices = fluid_synth_get_active_voice_count(state.synth);
+            newLimit = std::min(maxVoices, std::max(minVoices, std::min(newLimit, activeVoices) * 3 / 4));
+            state.blocksOverBudget = 0;
+        }
+    } else {
+        state.blocksOverBudget = 0;
+        if (renderTime < budget * 0.5 && newLimit < maxVoices) {
+            newLimit++;
+        }
     }
 
+    if (newLimit != state.voiceLimit) {
+        state.voiceLimit = newLimit;
+        fluid_synth_set_polyphony(state.synth, newLimit);
+    }
 #endif
 }
 
@@ -183,6 +266,6 @@ bool InternalSynth::isReady()
 #ifndef PLUGDATA_STANDALONE
     return false;
 #else
-    return ready;
+    return currentState.load() != nullptr;
 #endif
 }
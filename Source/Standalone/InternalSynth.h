@@ -15,6 +15,8 @@
 typedef struct _fluid_synth_t FluidSynth;
 typedef struct _fluid_hashtable_t FluidSettings;
 
+// The fluidsynth instance is created and destroyed on a background thread, and handed to the audio thread with an atomic pointer
+// This way, the audio thread never has to wait for a lock, allocate memory or free the synth
 class InternalSynth final : public Thread {
 
 public:
@@ -25,27 +27,45 @@ public:
     // Initialise fluidsynth on another thread, because it takes a while
     void run() override;
 
+    // These only tell the background thread what we need, so they're safe to call from the audio thread
+    void prepare(int sampleRate, int blockSize);
     void unprepare();
 
-    void prepare(int sampleRate, int blockSize, int numChannels);
-
     void process(AudioBuffer<float>& buffer, MidiBuffer& midiMessages);
 
     bool isReady();
 
+    // Maximum number of voices that can play at the same time
+    void setPolyphony(int maxVoices);
+
+    // Share of the available time per block that the synth may use, before we start stealing voices
+    void setCPUBudget(float fractionOfBlock);
+
+    static constexpr int maxPolyphony = 256;
+
 private:
+    struct State;
+
+    State* createState(int sampleRate, int blockSize);
+
+    // Hands a new state to the audio thread, and frees the old one once the audio thread is done with it
+    void publishState(State* newState);
+
+    void updateVoiceBudget(State& state, double renderTime, int numSamples);
+
     File soundFont = ProjectInfo::appDataDir.getChildFile("Extra").getChildFile("GS").getChildFile("GeneralUser_GS.sf3");
 
-    // Fluidsynth state
-    FluidSynth* synth = nullptr;
-    FluidSettings* settings = nullptr;
+    std::atomic<State*> currentState = nullptr;
+    std::atomic<bool> audioThreadBusy = false;
 
-    std::atomic<bool> ready = false;
-    std::mutex unprepareLock;
+    // Requested configuration, written by the audio thread and picked up by the background thread
+    std::atomic<bool> shouldBeActive = false;
+    std::atomic<int> requestedSampleRate = 0;
+    std::atomic<int> requestedBlockSize = 0;
 
-    std::atomic<int> lastSampleRate = 0;
-    std::atomic<int> lastBlockSize = 0;
-    std::atomic<int> lastNumChannels = 0;
+    std::atomic<int> polyphony = 64;
+    std::atomic<float> cpuBudget = 0.5f;
 
-    AudioBuffer<float> internalBuffer;
+    // Don't steal voices below this limit, otherwise the synth becomes unusable
+    static constexpr int minVoices = 8;
 };
@@ -0,0 +1,180 @@
+/*
+ // Copyright (c) 2021-2023 Timothy Schoen
+ // For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ // WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+
+// Command line tool that renders patches into wav files, without an audio device or window
+// Usage: plugdata_render <patch.pd>... [options], run with --help for the options
+
+#include <juce_gui_basics/juce_gui_basics.h>
+#include <juce_audio_formats/juce_audio_formats.h>
+#include "Utility/Config.h"
+
+#include <iostream>
+
+#include "Utility/PatchRenderer.h"
+
+static void printUsage()
+{
+    std::cout << "Usage: plugdata_render <patch.pd>... [options]" << std::endl
+              << std::endl
+              << "  --output <file.wav>     Output file, when rendering a single patch" << std::endl
+              << "  --output-dir <folder>   Folder for the output files, named after the patches (default: next to the patch)" << std::endl
+              << "  --length <seconds>      Length of the render (default 10)" << std::endl
+              << "  --midi <file.mid>       MIDI file to send to the patches" << std::endl
+              << "  --automation <file>     Parameter automation, lines of \"<seconds> <parameter> <value>\"" << std::endl
+              << "  --sample-rate <hz>      Sample rate (default 44100)" << std::endl
+              << "  --block-size <samples>  Block size (default 256)" << std::endl
+              << "  --channels <n>          Number of output channels (default 2)" << std::endl
+              << "  --bit-depth <16|24|32>  Bit depth of the output files (default 24)" << std::endl
+              << "  --jobs <n>              Number of patches to render at the same time (default: number of cores)" << std::endl
+              << "  --json <file>           Write the render statistics as JSON" << std::endl
+              << "  --no-limiter            Don't apply the output limiter" << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+    StringArray patches;
+    StringPairArray options;
+    bool limiter = true;
+
+    for (int i = 1; i < argc; i++) {
+        auto const argument = String(argv[i]);
+        if (argument == "--help" || argument == "-h") {
+            printUsage();
+            return 0;
+        }
+        if (argument == "--no-limiter") {
+            limiter = false;
+        } else if (argument.startsWith("--")) {
+            if (i + 1 >= argc) {
+                std::cerr << "Missing value for " << argument << std::endl;
+                return 1;
+            }
+            options.set(argument.substring(2), String(argv[++i]));
+        } else {
+            patches.add(argument);
+        }
+    }
+
+    if (patches.isEmpty()) {
+        printUsage();
+        return 1;
+    }
+
+    if (patches.size() > 1 && options.containsKey("output")) {
+        std::cerr << "--output can only be used with a single patch, use --output-dir instead" << std::endl;
+        return 1;
+    }
+
+    auto const workingDirectory = File::getCurrentWorkingDirectory();
+    auto const getOption = [&options](String const& name, String const& defaultValue) {
+        return options.containsKey(name) ? options[name] : defaultValue;
+    };
+
+    ScopedJuceInitialiser_GUI gui;
+
+    OwnedArray<PatchRenderer> renderers;
+    bool failed = false;
+
+    for (auto const& patch : patches) {
+        PatchRenderer::Settings settings;
+        settings.patchFile = workingDirectory.getChildFile(patch);
+
+        if (options.containsKey("output"))
+            settings.outputFile = workingDirectory.getChildFile(options["output"]);
+        else if (options.containsKey("output-dir"))
+            settings.outputFile = workingDirectory.getChildFile(options["output-dir"]).getChildFile(settings.patchFile.getFileNameWithoutExtension() + ".wav");
+        else
+            settings.outputFile = settings.patchFile.withFileExtension(".wav");
+
+        if (options.containsKey("midi"))
+            settings.midiFile = workingDirectory.getChildFile(options["midi"]);
+        if (options.containsKey("automation"))
+            settings.automationFile = workingDirectory.getChildFile(options["automation"]);
+
+        settings.lengthInSeconds = jmax(0.0, getOption("length", "10").getDoubleValue());
+        settings.sampleRate = jmax(1.0, getOption("sample-rate", "44100").getDoubleValue());
+        settings.blockSize = jmax(1, getOption("block-size", "256").getIntValue());
+        settings.numChannels = jlimit(1, 32, getOption("channels", "2").getIntValue());
+        settings.bitDepth = getOption("bit-depth", "24").getIntValue();
+        settings.limiter = limiter;
+
+        settings.outputFile.getParentDirectory().createDirectory();
+
+        // Every renderer has its own pd instance, which has to be created on the message thread
+        auto* renderer = renderers.add(new PatchRenderer(settings));
+        auto result = renderer->prepare();
+        if (result.failed()) {
+            std::cerr << patch << ": " << result.getErrorMessage() << std::endl;
+            renderers.removeLast();
+            failed = true;
+        }
+    }
+
+    // Render on a pool of threads, while this thread keeps handling the messages that the patches post
+    std::vector<Result> results(static_cast<size_t>(renderers.size()), Result::ok());
+    {
+        auto const numJobs = jlimit(1, jmax(1, renderers.size()), getOption("jobs", String(SystemStats::getNumCpus())).getIntValue());
+        ThreadPool pool(numJobs);
+
+        for (int i = 0; i < renderers.size(); i++) {
+            pool.addJob([renderer = renderers[i], &result = results[static_cast<size_t>(i)]]() {
+                result = renderer->render();
+            });
+        }
+
+        while (pool.getNumJobs() > 0) {
+            MessageManager::getInstance()->runDispatchLoopUntil(20);
+        }
+    }
+
+    // Let the console catch up with what was posted during the render
+    MessageManager::getInstance()->runDispatchLoopUntil(50);
+
+    auto report = var(Array<var>());
+
+    for (int i = 0; i < renderers.size(); i++) {
+        auto const* renderer = renderers[i];
+        auto const& settings = renderer->getSettings();
+        auto const& result = results[static_cast<size_t>(i)];
+
+        for (auto const& error : renderer->getErrors()) {
+            std::cerr << settings.patchFile.getFileName() << ": " << error << std::endl;
+        }
+
+        if (result.failed()) {
+            std::cerr << settings.patchFile.getFileName() << ": " << result.getErrorMessage() << std::endl;
+            failed = true;
+            continue;
+        }
+
+        auto const& statistics = renderer->getStatistics();
+        std::cout << settings.patchFile.getFileName() << " -> " << settings.outputFile.getFullPathName() << std::endl
+                  << "    " << String(statistics.audioSeconds, 2) << "s rendered in " << String(statistics.renderSeconds, 2) << "s ("
+                  << String(statistics.getRealtimeFactor(), 1) << "x realtime), block " << String(statistics.meanBlockMs, 3) << " ms mean, "
+                  << String(statistics.maxBlockMs, 3) << " ms max, peak load " << String(statistics.peakLoad * 100.0, 1) << "%, "
+                  << statistics.numOverloadedBlocks << " overloaded blocks, peak level " << String(Decibels::gainToDecibels(statistics.peakLevel), 1) << " dBFS" << std::endl;
+
+        auto* entry = new DynamicObject();
+        entry->setProperty("patch", settings.patchFile.getFullPathName());
+        entry->setProperty("output", settings.outputFile.getFullPathName());
+        entry->setProperty("sample_rate", settings.sampleRate);
+        entry->setProperty("block_size", settings.blockSize);
+        entry->setProperty("channels", settings.numChannels);
+        entry->setProperty("statistics", statistics.toVar());
+        report.append(var(entry));
+    }
+
+    if (options.containsKey("json")) {
+        auto const jsonFile = workingDirectory.getChildFile(options["json"]);
+        if (!jsonFile.replaceWithText(JSON::toString(report))) {
+            std::cerr << "Couldn't write " << jsonFile.getFullPathName() << std::endl;
+            failed = true;
+        }
+    }
+
+    renderers.clear();
+    return failed ? 1 : 0;
+}
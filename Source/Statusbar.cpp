@@ -27,15 +27,21 @@ class OversampleSelector : public TextButton {
     class OversampleSettingsPopup : public Component {
     public:
         std::function<void(int)> onChange = [](int) {};
+        std::function<void(int)> onFilterChange = [](int) {};
         std::function<void()> onClose = []() {};
 
-        OversampleSettingsPopup(int currentSelection)
+        OversampleSettingsPopup(int currentSelection, int currentFilter)
         {
             title.setText("Oversampling factor", dontSendNotification);
             title.setFont(Fonts::getBoldFont().withHeight(14.0f));
             title.setJustificationType(Justification::centred);
             addAndMakeVisible(title);
 
+            filterTitle.setText("Filter", dontSendNotification);
+            filterTitle.setFont(Fonts::getBoldFont().withHeight(14.0f));
+            filterTitle.setJustificationType(Justification::centred);
+            addAndMakeVisible(filterTitle);
+
             one.setConnectedEdges(ConnectedOnRight);
             two.setConnectedEdges(ConnectedOnLeft | ConnectedOnRight);
             four.setConnectedEdges(ConnectedOnLeft | ConnectedOnRight);
@@ -63,7 +69,37 @@ class OversampleSelector : public TextButton {
 
             buttons[currentSelection]->setToggleState(true, dontSendNotification);
 
-            setSize(180, 50);
+            iir.setConnectedEdges(ConnectedOnRight);
+            fir.setConnectedEdges(ConnectedOnLeft | ConnectedOnRight);
+            firHighQuality.setConnectedEdges(ConnectedOnLeft);
+
+            iir.setTooltip("Minimum phase, lowest latency");
+            fir.setTooltip("Linear phase");
+            firHighQuality.setTooltip("Linear phase with steeper filters, adds more latency");
+
+            auto filterButtons = Array<TextButton*> { &iir, &fir, &firHighQuality };
+
+            i = 0;
+            for (auto* button : filterButtons) {
+                button->setRadioGroupId(hash("oversampling_filter_selector"));
+                button->setClickingTogglesState(true);
+                button->onClick = [this, i]() {
+                    onFilterChange(i);
+                };
+
+                button->setColour(TextButton::textColourOffId, findColour(PlugDataColour::popupMenuTextColourId));
+                button->setColour(TextButton::textColourOnId, findColour(PlugDataColour::popupMenuActiveTextColourId));
+                button->setColour(TextButton::buttonColourId, findColour(PlugDataColour::popupMenuBackgroundColourId).contrasting(0.04f));
+                button->setColour(TextButton::buttonOnColourId, findColour(PlugDataColour::popupMenuBackgroundColourId).contrasting(0.075f));
+                button->setColour(ComboBox::outlineColourId, Colours::transparentBlack);
+
+                addAndMakeVisible(button);
+                i++;
+            }
+
+            filterButtons[currentFilter]->setToggleState(true, dontSendNotification);
+
+            setSize(180, 94);
         }
 
         ~OversampleSettingsPopup()
@@ -81,17 +117,31 @@ class OversampleSelector : public TextButton {
 
             auto buttonWidth = b.getWidth() / 4;
 
-            one.setBounds(b.removeFromLeft(buttonWidth));
-            two.setBounds(b.removeFromLeft(buttonWidth).expanded(1, 0));
-            four.setBounds(b.removeFromLeft(buttonWidth).expanded(1, 0));
-            eight.setBounds(b.removeFromLeft(buttonWidth).expanded(1, 0));
+            auto factorBounds = b.removeFromTop(20);
+            one.setBounds(factorBounds.removeFromLeft(buttonWidth));
+            two.setBounds(factorBounds.removeFromLeft(buttonWidth).expanded(1, 0));
+            four.setBounds(factorBounds.removeFromLeft(buttonWidth).expanded(1, 0));
+            eight.setBounds(factorBounds.removeFromLeft(buttonWidth).expanded(1, 0));
+
+            filterTitle.setBounds(b.removeFromTop(22));
+
+            auto filterBounds = b.removeFromTop(20);
+            auto filterButtonWidth = filterBounds.getWidth() / 3;
+            iir.setBounds(filterBounds.removeFromLeft(filterButtonWidth));
+            fir.setBounds(filterBounds.removeFromLeft(filterButtonWidth).expanded(1, 0));
+            firHighQuality.setBounds(filterBounds.expanded(1, 0));
         }
 
         Label title;
+        Label filterTitle;
         TextButton one = TextButton("1x");
         TextButton two = TextButton("2x");
         TextButton four = TextButton("4x");
         TextButton eight = TextButton("8x");
+
+        TextButton iir = TextButton("IIR");
+        TextButton fir = TextButton("FIR");
+        TextButton firHighQuality = TextButton("FIR HQ");
     };
 
 public:
@@ -101,13 +151,16 @@ public:
             auto selection = log2(getButtonText().upToLastOccurrenceOf("x", false, false).getIntValue());
             auto* editor = findParentComponentOfClass<PluginEditor>();
 
-            auto oversampleSettings = std::make_unique<OversampleSettingsPopup>(selection);
+            auto oversampleSettings = std::make_unique<OversampleSettingsPopup>(selection, pd->oversamplingFilter.load());
             auto bounds = editor->getLocalArea(this, getLocalBounds());
 
             oversampleSettings->onChange = [this, pd](int result) {
                 setButtonText(String(1 << result) + "x");
                 pd->setOversampling(result);
             };
+            oversampleSettings->onFilterChange = [pd](int result) {
+                pd->setOversamplingFilter(result);
+            };
             oversampleSettings->onClose = [this]() {
                 repaint();
             };
@@ -181,7 +234,8 @@ private:
 
 class LevelMeter : public Component
     , public StatusbarSource::Listener
-    , public MultiTimer {
+    , public MultiTimer
+    , public SettableTooltipClient {
     float audioLevel[2] = { 0.0f, 0.0f };
     float peakLevel[2] = { 0.0f, 0.0f };
 
@@ -197,6 +251,9 @@ class LevelMeter : public Component
     float lastLevel[2] = { 0.0f };
     float repaintTheshold = 0.01f;
 
+    bool showSanitisedSamples = false;
+    static constexpr int sanitisedTimerID = 2;
+
 public:
     LevelMeter() = default;
 
@@ -236,8 +293,31 @@ public:
             repaint();
     }
 
+    // Protected mode had to take out NaN or Inf values, show which channels they were on
+    void sanitisedSamplesChanged(Array<int> const& samplesPerChannel) override
+    {
+        String tooltip = "Protected mode removed invalid samples:";
+        for (int ch = 0; ch < samplesPerChannel.size(); ch++) {
+            if (samplesPerChannel[ch] > 0)
+                tooltip += "\nChannel " + String(ch + 1) + ": " + String(samplesPerChannel[ch]) + " samples";
+        }
+
+        setTooltip(tooltip);
+        showSanitisedSamples = true;
+        startTimer(sanitisedTimerID, 3000);
+        repaint();
+    }
+
     void timerCallback(int timerID) override
     {
+        if (timerID == sanitisedTimerID) {
+            showSanitisedSamples = false;
+            setTooltip("");
+            stopTimer(sanitisedTimerID);
+            repaint();
+            return;
+        }
+
         peakBarsFade[timerID] = true;
     }
 
@@ -260,6 +340,11 @@ public:
         g.setColour(findColour(PlugDataColour::levelMeterBackgroundColourId));
         g.fillRoundedRectangle(x + outerBorderWidth + 4, outerBorderWidth, bgWidth - 8, bgHeight, Corners::defaultCornerRadius);
 
+        if (showSanitisedSamples) {
+            g.setColour(Colours::red);
+            g.drawRoundedRectangle(x + outerBorderWidth + 4, outerBorderWidth, bgWidth - 8, bgHeight, Corners::defaultCornerRadius, 1.0f);
+        }
+
         for (int ch = 0; ch < numChannels; ch++) {
             auto barYPos = outerBorderWidth + ((ch + 1) * (bgHeight / 3.0f)) - halfBarHeight;
             auto barLength = jmin(audioLevel[ch] * barWidth, barWidth);
@@ -545,9 +630,25 @@ public:
         cpuUsageLongHistory.add(lastCpuUsage);
         cpuUsageLongHistory.remove(0);
         updateCPUGraphLong();
+        updateParallelDSPTooltip();
         repaint();
     }
 
+    // When patches run in parallel, show how the load is spread over the components
+    void updateParallelDSPTooltip()
+    {
+        auto* editor = findParentComponentOfClass<PluginEditor>();
+        if (!editor)
+            return;
+
+        String tooltip = "CPU usage";
+        for (auto& component : editor->pd->getParallelDSPStats()) {
+            tooltip += "\n" + component.patchNames.joinIntoString(", ") + ": " + String(component.load, 1) + "%";
+        }
+
+        setTooltip(tooltip);
+    }
+
     bool hitTest(int x, int y) override
     {
         return getLocalBounds().contains(x, y);
@@ -912,6 +1013,19 @@ void StatusbarSource::timerCallback()
         listener->audioLevelChanged(peak);
         listener->cpuUsageChanged(cpuUsage);
     }
+
+    Array<int> sanitised;
+    bool hasSanitisedSamples = false;
+    for (int ch = 0; ch < std::min(numChannels, maxSanitisedChannels); ch++) {
+        auto numSanitised = sanitisedSamples[ch].exchange(0, std::memory_order_relaxed);
+        hasSanitisedSamples = hasSanitisedSamples || numSanitised > 0;
+        sanitised.add(numSanitised);
+    }
+
+    if (hasSanitisedSamples) {
+        for (auto* listener : listeners)
+            listener->sanitisedSamplesChanged(sanitised);
+    }
 }
 
 void StatusbarSource::addListener(Listener* l)
@@ -928,3 +1042,10 @@ void StatusbarSource::setCPUUsage(float cpu)
 {
     cpuUsage = cpu;
 }
+
+void StatusbarSource::addSanitisedSamples(int channel, int numSamples)
+{
+    if (isPositiveAndBelow(channel, maxSanitisedChannels)) {
+        sanitisedSamples[channel].fetch_add(numSamples, std::memory_order_relaxed);
+    }
+}
@@ -30,6 +30,7 @@ public:
         virtual void audioProcessedChanged(bool audioProcessed) { ignoreUnused(audioProcessed); }
         virtual void audioLevelChanged(Array<float> peak) { ignoreUnused(peak); }
         virtual void cpuUsageChanged(float newCpuUsage) { ignoreUnused(newCpuUsage); }
+        virtual void sanitisedSamplesChanged(Array<int> const& samplesPerChannel) { ignoreUnused(samplesPerChannel); }
         virtual void timerCallback() { }
     };
 
@@ -50,6 +51,9 @@ public:
 
     void setCPUUsage(float cpuUsage);
 
+    // Called from the audio thread when protected mode had to replace NaN or Inf values
+    void addSanitisedSamples(int channel, int numSamples);
+
     AudioSampleRingBuffer peakBuffer;
 
 private:
@@ -60,6 +64,9 @@ private:
     std::atomic<float> peakHold[2] = { 0 };
     std::atomic<float> cpuUsage;
 
+    static constexpr int maxSanitisedChannels = 32;
+    std::array<std::atomic<int>, maxSanitisedChannels> sanitisedSamples = {};
+
     int numChannels;
     int bufferSize;
 
@@ -8,6 +8,9 @@ For more information visit www.rabiensoftware.com
 #include <JuceHeader.h>
 #include "FileSystemWatcher.h"
 
+#include <set>
+#include <unordered_map>
+
 #ifdef  _WIN32
  #include <Windows.h>
  #include <ctime>
@@ -21,17 +24,30 @@ For more information visit www.rabiensoftware.com
 
 #if defined(__linux__) || JUCE_BSD
  #include <sys/inotify.h>
+ #include <poll.h>
  #include <limits.h>
  #include <unistd.h>
  #include <sys/stat.h>
  #include <sys/time.h>
 #endif
 
+// Exclusions only apply to the folder they were added with
+static bool isExcludedFrom (const File& file, const Array<File>& excludedFolders)
+{
+    for (auto& excluded : excludedFolders)
+    {
+        if (file == excluded || file.isAChildOf (excluded))
+            return true;
+    }
+
+    return false;
+}
+
 #if JUCE_MAC
 class FileSystemWatcher::Impl
 {
 public:
-    Impl (FileSystemWatcher& o, File f) : owner (o), folder (f)
+    Impl (FileSystemWatcher& o, File f, Array<File> excluded) : owner (o), folder (f), excludedFolders (std::move (excluded))
     {
         NSString* newPath = [NSString stringWithUTF8String:folder.getFullPathName().toRawUTF8()];
 
@@ -69,7 +85,6 @@ public:
         ignoreUnused (streamRef, numEvents, eventIds, eventPaths, eventFlags);
 
         Impl* impl = (Impl*)clientCallBackInfo;
-        impl->owner.folderChanged (impl->folder);
 
         char** files = (char**)eventPaths;
 
@@ -79,7 +94,12 @@ public:
             FSEventStreamEventFlags evt = eventFlags[i];
 
             File path = String::fromUTF8 (file);
-            if (evt & kFSEventStreamEventFlagItemModified)
+            if (isExcludedFrom (path, impl->excludedFolders))
+                continue;
+
+            if (evt & kFSEventStreamEventFlagMustScanSubDirs)
+                impl->owner.fileChanged (path, FileSystemEvent::folderNeedsRescan);
+            else if (evt & kFSEventStreamEventFlagItemModified)
                 impl->owner.fileChanged (path, FileSystemEvent::fileUpdated);
             else if (evt & kFSEventStreamEventFlagItemRemoved)
                 impl->owner.fileChanged (path, FileSystemEvent::fileDeleted);
@@ -92,6 +112,7 @@ public:
 
     FileSystemWatcher& owner;
     const File folder;
+    const Array<File> excludedFolders;
 
     NSArray* paths;
     FSEventStreamRef stream;
@@ -100,122 +121,214 @@ public:
 #endif
 
 #ifdef JUCE_LINUX
-#define BUF_LEN (10 * (sizeof(struct inotify_event) + NAME_MAX + 1))
-
+// inotify doesn't watch subfolders, so we add a watch for every folder in the tree, and keep them up to date as folders appear and disappear
 class FileSystemWatcher::Impl : public Thread,
                                 private AsyncUpdater
 {
 public:
-    struct Event
+    Impl (FileSystemWatcher& o, File f, Array<File> excluded)
+      : Thread ("FileSystemWatcher::Impl"), owner (o), folder (f), excludedFolders (std::move (excluded))
     {
-        Event () {}
-        Event (Event& other) = default;
-        Event (Event&& other) = default;
+        fd = inotify_init1 (IN_NONBLOCK | IN_CLOEXEC);
 
-        File file;
-        FileSystemEvent fsEvent;
+        if (fd >= 0)
+            startThread();
+    }
 
-        bool operator== (const Event& other) const
+    ~Impl() override
+    {
+        cancelPendingUpdate();
+        stopThread (1000);
+
+        // Closing the inotify instance also removes all of its watches
+        if (fd >= 0)
+            close (fd);
+    }
+
+    void run() override
+    {
         {
-            return file == other.file && fsEvent == other.fsEvent;
+            // Walking a large tree takes a while, so we do it here instead of on the message thread
+            ScopedLock sl (lock);
+            addWatches (folder, false);
         }
-    };
 
-    Impl (FileSystemWatcher& o, File f)
-      : Thread ("FileSystemWatcher::Impl"), owner (o), folder (f)
-    {
-        fd = inotify_init();
+        alignas (struct inotify_event) char buffer[64 * 1024];
 
-        wd = inotify_add_watch (fd,
-                                folder.getFullPathName().toRawUTF8(),
-                                IN_ATTRIB | IN_CREATE | IN_DELETE | IN_DELETE_SELF |
-                                IN_MODIFY | IN_MOVE_SELF | IN_MOVED_TO | IN_MOVED_FROM);
+        while (! threadShouldExit())
+        {
+            // Wake up regularly, so we notice when we need to stop
+            pollfd pfd { fd, POLLIN, 0 };
+            if (poll (&pfd, 1, 100) <= 0)
+                continue;
 
-        startThread();
+            auto numRead = read (fd, buffer, sizeof (buffer));
+            if (numRead <= 0)
+                continue;
+
+            ScopedLock sl (lock);
+
+            for (char* ptr = buffer; ptr < buffer + numRead;)
+            {
+                auto const* iNotifyEvent = reinterpret_cast<const struct inotify_event*> (ptr);
+                ptr += sizeof (struct inotify_event) + iNotifyEvent->len;
+
+                handleEvent (*iNotifyEvent);
+            }
+
+            if (! events.empty())
+                triggerAsyncUpdate();
+        }
     }
 
-    ~Impl()
+    void handleAsyncUpdate() override
     {
-        shouldQuit = true;
-        signalThreadShouldExit();
-        inotify_rm_watch (fd, wd);
-        close (fd);
+        std::map<String, FileSystemEvent> changes;
+        {
+            ScopedLock sl (lock);
+            std::swap (changes, events);
+        }
 
-        waitForThreadToExit (1000);
+        for (auto& [path, fsEvent] : changes)
+            owner.fileChanged (File (path), fsEvent);
     }
 
-    void run() override
+    FileSystemWatcher& owner;
+    const File folder;
+    const Array<File> excludedFolders;
+
+private:
+    void handleEvent (const struct inotify_event& iNotifyEvent)
     {
-        char buf[BUF_LEN];
+        if (iNotifyEvent.mask & IN_Q_OVERFLOW)
+        {
+            // The kernel dropped events, so we don't know what changed anymore
+            // Pick up any folders that we missed, and let the listeners rescan
+            addWatches (folder, false);
+            addEvent (folder, folderNeedsRescan);
+            return;
+        }
 
-        const struct inotify_event* iNotifyEvent;
-        char* ptr;
+        auto it = watchedDirectories.find (iNotifyEvent.wd);
+        if (it == watchedDirectories.end())
+            return;
 
-        while (!shouldQuit)
+        if (iNotifyEvent.mask & IN_IGNORED)
         {
-            int numRead = read (fd, buf, BUF_LEN);
+            // The folder was deleted or moved away, so the kernel removed its watch
+            watchedDirectories.erase (it);
+            return;
+        }
 
-            if (numRead <= 0 || threadShouldExit())
-                break;
+        auto const directory = it->second;
 
-            for (ptr = buf; ptr < buf + numRead; ptr += sizeof(struct inotify_event) + iNotifyEvent->len)
-            {
-                iNotifyEvent = (const struct inotify_event*)ptr;
-                Event e;
+        // Event for a watched folder itself: subfolders are already handled through the events of their parent
+        if (iNotifyEvent.len == 0)
+        {
+            if ((iNotifyEvent.mask & (IN_DELETE_SELF | IN_MOVE_SELF)) && directory == folder)
+                addEvent (folder, fileDeleted);
+            return;
+        }
 
-                e.file = File {folder.getFullPathName() + '/' + iNotifyEvent->name};
+        auto const file = directory.getChildFile (String::fromUTF8 (iNotifyEvent.name));
+        if (isExcluded (file))
+            return;
 
-                     if (iNotifyEvent->mask & IN_CREATE)      e.fsEvent = FileSystemEvent::fileCreated;
-                else if (iNotifyEvent->mask & IN_CLOSE_WRITE) e.fsEvent = FileSystemEvent::fileUpdated;
-                else if (iNotifyEvent->mask & IN_MOVED_FROM)  e.fsEvent = FileSystemEvent::fileRenamedOldName;
-                else if (iNotifyEvent->mask & IN_MOVED_TO)    e.fsEvent = FileSystemEvent::fileRenamedNewName;
-                else if (iNotifyEvent->mask & IN_DELETE)      e.fsEvent = FileSystemEvent::fileDeleted;
+        if (iNotifyEvent.mask & IN_ISDIR)
+        {
+            // Files can be added to a new folder before we get to watch it, so report everything that's already in there
+            if (iNotifyEvent.mask & (IN_CREATE | IN_MOVED_TO))
+                addWatches (file, true);
+            else if (iNotifyEvent.mask & (IN_DELETE | IN_MOVED_FROM))
+                removeWatches (file);
+        }
 
-                ScopedLock sl(lock);
-                
-                bool duplicateEvent = false;
-                for (auto existing : events)
-                {
-                    if (e == existing)
-                    {
-                        duplicateEvent = true;
-                        break;
-                    }
-                }
+             if (iNotifyEvent.mask & IN_CREATE)                    addEvent (file, fileCreated);
+        else if (iNotifyEvent.mask & (IN_CLOSE_WRITE | IN_ATTRIB)) addEvent (file, fileUpdated);
+        else if (iNotifyEvent.mask & IN_MOVED_FROM)                addEvent (file, fileRenamedOldName);
+        else if (iNotifyEvent.mask & IN_MOVED_TO)                  addEvent (file, fileRenamedNewName);
+        else if (iNotifyEvent.mask & IN_DELETE)                    addEvent (file, fileDeleted);
+    }
 
-                if (! duplicateEvent)
-                    events.add (std::move (e));
-            }
+    // Only the last event for every file is kept, unless we already know that a folder needs to be rescanned
+    void addEvent (const File& file, FileSystemEvent fsEvent)
+    {
+        auto [it, inserted] = events.try_emplace (file.getFullPathName(), fsEvent);
+        if (! inserted && it->second != folderNeedsRescan)
+            it->second = fsEvent;
+    }
 
-            ScopedLock sl (lock);
-            if (events.size() > 0)
-                triggerAsyncUpdate();
-        }
+    void addWatches (const File& directory, bool reportContents)
+    {
+        std::set<int> visited;
+        addWatches (directory, reportContents, visited);
     }
 
-    void handleAsyncUpdate() override
+    void addWatches (const File& directory, bool reportContents, std::set<int>& visited)
     {
-        if(shouldQuit) return;
+        // A large tree can take a while, so stop walking it when the watcher is being destroyed
+        if (threadShouldExit() || isExcluded (directory))
+            return;
 
-        ScopedLock sl (lock);
+        if (watchedDirectories.size() >= maxWatchedFolders)
+        {
+            DBG ("FileSystemWatcher: too many folders in " + folder.getFullPathName() + ", not watching " + directory.getFullPathName());
+            return;
+        }
 
-        owner.folderChanged (folder);
+        constexpr uint32_t watchMask = IN_ATTRIB | IN_CREATE | IN_DELETE | IN_DELETE_SELF | IN_CLOSE_WRITE |
+                                       IN_MOVE_SELF | IN_MOVED_TO | IN_MOVED_FROM | IN_ONLYDIR;
 
-        for (auto& e : events)
-            owner.fileChanged (e.file, e.fsEvent);
+        auto wd = inotify_add_watch (fd, directory.getFullPathName().toRawUTF8(), watchMask);
 
-        events.clear();
+        // Symlinks can lead us back to a folder we've already seen, which returns the same watch descriptor
+        if (wd < 0 || ! visited.insert (wd).second)
+            return;
+
+        watchedDirectories.try_emplace (wd, directory);
+
+        for (auto& child : directory.findChildFiles (File::findFilesAndDirectories, false))
+        {
+            if (threadShouldExit())
+                return;
+
+            if (reportContents)
+                addEvent (child, fileCreated);
+
+            if (child.isDirectory())
+                addWatches (child, reportContents, visited);
+        }
     }
 
-    std::atomic<bool> shouldQuit = false;
-    FileSystemWatcher& owner;
-    File folder;
+    void removeWatches (const File& directory)
+    {
+        for (auto it = watchedDirectories.begin(); it != watchedDirectories.end();)
+        {
+            if (it->second == directory || it->second.isAChildOf (directory))
+            {
+                inotify_rm_watch (fd, it->first);
+                it = watchedDirectories.erase (it);
+            }
+            else
+            {
+                ++it;
+            }
+        }
+    }
+
+    bool isExcluded (const File& file) const
+    {
+        return isExcludedFrom (file, excludedFolders);
+    }
+
+    // Every watch uses kernel memory, and the number of watches per user is limited
+    static constexpr size_t maxWatchedFolders = 8192;
 
     CriticalSection lock;
-    Array<Event> events;
+    std::map<String, FileSystemEvent> events;
+    std::unordered_map<int, File> watchedDirectories;
 
-    int fd;
-    int wd;
+    int fd = -1;
 };
 #endif
 
@@ -235,8 +348,8 @@ public:
         }
     };
 
-    Impl (FileSystemWatcher& o, File f)
-      : Thread ("FileSystemWatcher::Impl"), owner (o), folder (f)
+    Impl (FileSystemWatcher& o, File f, Array<File> excluded)
+      : Thread ("FileSystemWatcher::Impl"), owner (o), folder (f), excludedFolders (std::move (excluded))
     {
         WCHAR path[_MAX_PATH] = {0};
         wcsncpy_s (path, folder.getFullPathName().toWideCharPointer(), _MAX_PATH - 1);
@@ -308,17 +421,17 @@ public:
                             break;
                     }
 
-                    bool duplicateEvent = false;
+                    bool skipEvent = isExcludedFrom (e.file, excludedFolders);
                     for (auto existing : events)
                     {
                         if (e == existing)
                         {
-                            duplicateEvent = true;
+                            skipEvent = true;
                             break;
                         }
                     }
 
-                    if (! duplicateEvent)
+                    if (! skipEvent)
                         events.add (e);
 
                     if (fni->NextEntryOffset > 0)
@@ -330,6 +443,13 @@ public:
                 if (events.size() > 0)
                     triggerAsyncUpdate();
             }
+            else if (success)
+            {
+                // The buffer overflowed, so we don't know what changed
+                ScopedLock sl (lock);
+                events.add ({ folder, folderNeedsRescan });
+                triggerAsyncUpdate();
+            }
         }
     }
 
@@ -337,8 +457,6 @@ public:
     {
         ScopedLock sl (lock);
 
-        owner.folderChanged (folder);
-
         for (auto e : events)
             owner.fileChanged (e.file, e.fsEvent);
 
@@ -347,6 +465,7 @@ public:
 
     FileSystemWatcher& owner;
     const File folder;
+    const Array<File> excludedFolders;
 
     CriticalSection lock;
     Array<Event> events;
@@ -359,7 +478,7 @@ public:
 class FileSystemWatcher::Impl
 {
 public:
-    Impl (FileSystemWatcher& o, File f) : owner (o), folder (f)
+    Impl (FileSystemWatcher& o, File f, Array<File> excluded) : owner (o), folder (f), excludedFolders (std::move (excluded))
     {
     }
 
@@ -369,6 +488,7 @@ public:
 
     FileSystemWatcher& owner;
     const File folder;
+    const Array<File> excludedFolders;
 };
 #endif
 
@@ -381,13 +501,13 @@ FileSystemWatcher::~FileSystemWatcher()
 {
 }
 
-void FileSystemWatcher::addFolder (const File& folder)
+void FileSystemWatcher::addFolder (const File& folder, const Array<File>& excludedFolders)
 {
     // You can only listen to folders that exist
     jassert (folder.isDirectory());
 
     if ( ! getWatchedFolders().contains (folder))
-        watched.add (new Impl (*this, folder));
+        watched.add (new Impl (*this, folder, excludedFolders));
 }
 
 void FileSystemWatcher::removeFolder (const File& folder)
@@ -417,14 +537,40 @@ void FileSystemWatcher::removeListener (Listener* listener)
     listeners.remove (listener);
 }
 
-void FileSystemWatcher::folderChanged (const File& folder)
+void FileSystemWatcher::fileChanged (const File& file, FileSystemEvent fsEvent)
 {
-    listeners.call (&FileSystemWatcher::Listener::folderChanged, folder);
+    listeners.call ([&file, fsEvent] (Listener& l) { l.fileChanged (file, fsEvent); });
 }
 
-void FileSystemWatcher::fileChanged (const File& file, FileSystemEvent fsEvent)
+void FileSystemWatcher::Listener::fileChanged (const File& file, FileSystemEvent fsEvent)
 {
-    listeners.call (&FileSystemWatcher::Listener::fileChanged, file, fsEvent);
+    // Only keep the last event for every file, unless we already know that a folder needs to be rescanned
+    auto [it, inserted] = pendingChanges.try_emplace (file.getFullPathName(), fsEvent);
+    if (! inserted && it->second != folderNeedsRescan)
+        it->second = fsEvent;
+
+    auto const now = Time::getMillisecondCounter();
+    if (! isTimerRunning())
+        firstPendingChange = now;
+
+    // Wait until things have been quiet for a bit, but don't keep postponing if changes keep coming in
+    auto const timeLeft = maxDelayMs - static_cast<int> (now - firstPendingChange);
+    startTimer (jlimit (1, debounceMs, timeLeft));
+}
+
+void FileSystemWatcher::Listener::timerCallback()
+{
+    stopTimer();
+
+    Array<Change> changes;
+    changes.ensureStorageAllocated (static_cast<int> (pendingChanges.size()));
+
+    for (auto& [path, fsEvent] : pendingChanges)
+        changes.add ({ File (path), fsEvent });
+
+    pendingChanges.clear();
+
+    fsChangeCallback (changes);
 }
 
 Array<File> FileSystemWatcher::getWatchedFolders()
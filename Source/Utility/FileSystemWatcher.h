@@ -7,18 +7,21 @@ For more information visit www.rabiensoftware.com
 
 #pragma once
 
+#include <map>
+
 #if JUCE_MAC || JUCE_WINDOWS || JUCE_LINUX || JUCE_BSD
 
 /**
 
     Watches a folder in the file system for changes.
 
-    Listener callbcks will be called every time a file is
+    Listener callbacks will be called every time a file is
     created, modified, deleted or renamed in the watched
-    folder.
+    folder, or in any of its subfolders.
 
-    FileSystemWatcher will also recursively watch all subfolders on
-    macOS and windows and will not on Linux.
+    Changes are collected per listener and delivered in batches,
+    so a burst of changes (like a git checkout) results in a single
+    callback with every file that changed.
 
  */
 class FileSystemWatcher {
@@ -26,8 +29,9 @@ public:
     FileSystemWatcher();
     ~FileSystemWatcher();
 
-    /** Adds a folder to be watched */
-    void addFolder(File const& folder);
+    /** Adds a folder to be watched. Changes inside the excluded folders are ignored,
+        and on Linux they aren't watched at all, since every folder takes up an inotify watch */
+    void addFolder(File const& folder, Array<File> const& excludedFolders = {});
 
     /** Removes a folder from being watched */
     void removeFolder(File const& folder);
@@ -48,36 +52,35 @@ public:
         fileDeleted,
         fileUpdated,
         fileRenamedOldName,
-        fileRenamedNewName
+        fileRenamedNewName,
+        folderNeedsRescan /** Events were lost, so anything inside this folder may have changed */
+    };
+
+    struct Change {
+        File file;
+        FileSystemEvent event;
     };
 
-    /** Receives callbacks from the FileSystemWatcher when a file changes */
-    class Listener : public Timer {
+    /** Receives callbacks from the FileSystemWatcher when files change */
+    class Listener : private Timer {
     public:
         virtual ~Listener() = default;
 
-        virtual void fsChangeCallback() = 0;
-
-        // group changes together
-        void timerCallback()
-        {
-            fsChangeCallback();
-            stopTimer();
-        }
-        /* Called when any file in the listened to folder changes with the name of
-           the folder that has changed. For example, use this for a file browser that
-           needs to refresh any time a file changes */
-        void folderChanged(const File)
-        {
-            startTimer(80);
-        }
-
-        /* Called for each file that has changed and how it has changed. Use this callback
-           if you need to reload a file when it's contents change */
-        void fileChanged(const File, FileSystemEvent)
-        {
-            startTimer(80);
-        }
+        /* Called once the watched folders have been quiet for debounceMs, or at most maxDelayMs after the first change,
+           with every file that changed since the last callback. Each file is listed once, with the last thing that happened to it */
+        virtual void fsChangeCallback(Array<Change> const& changes) = 0;
+
+        static constexpr int debounceMs = 250;
+        static constexpr int maxDelayMs = 2000;
+
+    private:
+        friend class FileSystemWatcher;
+
+        void fileChanged(File const& file, FileSystemEvent fsEvent);
+        void timerCallback() override;
+
+        std::map<String, FileSystemEvent> pendingChanges;
+        uint32 firstPendingChange = 0;
     };
 
     /** Registers a listener to be told when things happen to the text.
@@ -93,7 +96,6 @@ public:
 private:
     class Impl;
 
-    void folderChanged(File const& folder);
     void fileChanged(File const& file, FileSystemEvent fsEvent);
 
     ListenerList<Listener> listeners;
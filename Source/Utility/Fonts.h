@@ -1,6 +1,8 @@
 #pragma once
 #include <BinaryData.h>
 
+#include "Utility/TextLayoutCache.h"
+
 enum FontStyle {
     Regular,
     Bold,
@@ -59,7 +61,12 @@ struct Fonts {
     static Font getVariableFont() { return Font(instance->variableTypeface); }
     static Font getTabularNumbersFont() { return Font(instance->tabularTypeface); }
 
-    static Font setCurrentFont(Font const& font) { return instance->currentTypeface = font.getTypefacePtr(); }
+    static Font setCurrentFont(Font const& font)
+    {
+        // Cached text layouts refer to the font by name, so they're no longer valid
+        TextLayoutCache::clear();
+        return instance->currentTypeface = font.getTypefacePtr();
+    }
 
     // For drawing icons with icon font
     static void drawIcon(Graphics& g, String const& icon, Rectangle<int> bounds, Colour colour, int fontHeight = -1, bool centred = true)
@@ -178,7 +185,7 @@ struct Fonts {
     {
         g.setFont(getFontFromStyle(style).withHeight(fontHeight));
         g.setColour(colour);
-        g.drawFittedText(textToDraw, bounds, justification, numLines, minimumHoriontalScale);
+        TextLayoutCache::drawFittedText(g, textToDraw, bounds, justification, numLines, minimumHoriontalScale);
     }
 
     static void drawFittedText(Graphics& g, String const& textToDraw, int x, int y, int w, int h, Colour const& colour, int numLines = 1, float minimumHoriontalScale = 1.0f, int fontHeight = 15, Justification justification = Justification::centredLeft)
@@ -0,0 +1,156 @@
+/*
+ // Copyright (c) 2021-2023 Timothy Schoen
+ // For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ // WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+
+#pragma once
+
+#include <algorithm>
+#include <vector>
+
+// Sequence of lines that is split into chunks of at most maxChunkSize lines
+// Inserting or removing a line only moves the lines in its own chunk, and finding a line is a binary search over the chunks
+// The text editor stores its lines in here, so that editing a [text] or [coll] with 100k lines doesn't move all of them on every keystroke
+template<typename T, int maxChunkSize = 512>
+class LineRope {
+public:
+    int size() const { return numItems; }
+
+    bool isEmpty() const { return numItems == 0; }
+
+    T& operator[](int index)
+    {
+        jassert(isPositiveAndBelow(index, numItems));
+        int offset;
+        auto const chunk = findChunk(index, offset);
+        return chunks[chunk][offset];
+    }
+
+    T const& operator[](int index) const
+    {
+        jassert(isPositiveAndBelow(index, numItems));
+        int offset;
+        auto const chunk = findChunk(index, offset);
+        return chunks[chunk][offset];
+    }
+
+    // Appending only touches the last chunk, so loading a large text line by line is linear
+    void add(T item)
+    {
+        if (chunks.empty() || static_cast<int>(chunks.back().size()) >= maxChunkSize) {
+            chunkStarts.push_back(numItems);
+            chunks.emplace_back().reserve(maxChunkSize);
+        }
+
+        chunks.back().push_back(std::move(item));
+        numItems++;
+    }
+
+    void insert(int index, T item)
+    {
+        index = jlimit(0, numItems, index);
+        if (index == numItems) {
+            add(std::move(item));
+            return;
+        }
+
+        int offset;
+        auto const chunk = findChunk(index, offset);
+        auto& items = chunks[chunk];
+        items.insert(items.begin() + offset, std::move(item));
+        numItems++;
+
+        // Split full chunks in half, so the next inserts around here stay cheap
+        if (static_cast<int>(items.size()) > maxChunkSize) {
+            auto const half = static_cast<int>(items.size()) / 2;
+            std::vector<T> secondHalf(std::make_move_iterator(items.begin() + half), std::make_move_iterator(items.end()));
+            items.erase(items.begin() + half, items.end());
+            chunks.insert(chunks.begin() + chunk + 1, std::move(secondHalf));
+        }
+
+        updateChunkStarts(chunk);
+    }
+
+    void removeRange(int startIndex, int numberToRemove)
+    {
+        startIndex = jlimit(0, numItems, startIndex);
+        numberToRemove = jlimit(0, numItems - startIndex, numberToRemove);
+        if (numberToRemove == 0)
+            return;
+
+        int offset;
+        auto const firstChunk = findChunk(startIndex, offset);
+        auto chunk = firstChunk;
+
+        while (numberToRemove > 0) {
+            auto& items = chunks[chunk];
+            auto const numInChunk = std::min(numberToRemove, static_cast<int>(items.size()) - offset);
+            items.erase(items.begin() + offset, items.begin() + offset + numInChunk);
+            numItems -= numInChunk;
+            numberToRemove -= numInChunk;
+
+            if (items.empty())
+                chunks.erase(chunks.begin() + chunk);
+            else
+                chunk++;
+
+            offset = 0;
+        }
+
+        // Merge what's left around the removed lines if it fits in one chunk, so we don't end up with lots of tiny chunks
+        if (firstChunk > 0 && firstChunk < static_cast<int>(chunks.size())) {
+            auto& previous = chunks[firstChunk - 1];
+            auto& next = chunks[firstChunk];
+            if (previous.size() + next.size() <= static_cast<size_t>(maxChunkSize)) {
+                previous.insert(previous.end(), std::make_move_iterator(next.begin()), std::make_move_iterator(next.end()));
+                chunks.erase(chunks.begin() + firstChunk);
+            }
+        }
+
+        updateChunkStarts(std::max(0, firstChunk - 1));
+    }
+
+    void clear()
+    {
+        chunks.clear();
+        chunkStarts.clear();
+        numItems = 0;
+    }
+
+    template<typename Callback>
+    void forEach(Callback&& callback)
+    {
+        for (auto& items : chunks) {
+            for (auto& item : items) {
+                callback(item);
+            }
+        }
+    }
+
+    int getNumChunks() const { return static_cast<int>(chunks.size()); }
+
+private:
+    int findChunk(int index, int& offset) const
+    {
+        auto const it = std::upper_bound(chunkStarts.begin(), chunkStarts.end(), index);
+        auto const chunk = static_cast<int>(it - chunkStarts.begin()) - 1;
+        offset = index - chunkStarts[chunk];
+        return chunk;
+    }
+
+    void updateChunkStarts(int fromChunk)
+    {
+        chunkStarts.resize(chunks.size());
+
+        auto start = fromChunk > 0 ? chunkStarts[fromChunk - 1] + static_cast<int>(chunks[fromChunk - 1].size()) : 0;
+        for (int i = fromChunk; i < static_cast<int>(chunks.size()); i++) {
+            chunkStarts[i] = start;
+            start += static_cast<int>(chunks[i].size());
+        }
+    }
+
+    std::vector<std::vector<T>> chunks;
+    std::vector<int> chunkStarts;
+    int numItems = 0;
+};
@@ -0,0 +1,79 @@
+/*
+ // Copyright (c) 2021-2023 Timothy Schoen and Alex Mitchell
+ // For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ // WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+*/
+
+#pragma once
+
+// Wrapper around JUCE's oversampler that lets us choose between IIR and linear-phase FIR filters
+// The latency is always a whole number of samples, so we can report it to the host for delay compensation
+// JUCE takes care of the fractional part of the latency with an internal fractional delay
+class Oversampler {
+public:
+    enum Filter {
+        IIR,           // Minimum phase, very little latency, but the phase shift is different for every frequency
+        FIR,           // Linear phase halfband cascade
+        FIRHighQuality // Linear phase, with steeper filters and more stopband attenuation, at the cost of latency and CPU
+    };
+
+    // Factor is the power of two to oversample by, zero means no oversampling
+    void prepare(int numChannels, int newFactor, Filter newFilter, int maxBlockSize)
+    {
+        factor = newFactor;
+        filter = newFilter;
+
+        auto type = filter == IIR ? dsp::Oversampling<float>::filterHalfBandPolyphaseIIR : dsp::Oversampling<float>::filterHalfBandFIREquiripple;
+        oversampling = std::make_unique<dsp::Oversampling<float>>(std::max(1, numChannels), factor, type, filter == FIRHighQuality, true);
+        oversampling->initProcessing(maxBlockSize);
+    }
+
+    void reset()
+    {
+        if (oversampling)
+            oversampling->reset();
+    }
+
+    dsp::AudioBlock<float> processSamplesUp(dsp::AudioBlock<float> const& block)
+    {
+        if (!isActive())
+            return block;
+
+        return oversampling->processSamplesUp(block);
+    }
+
+    void processSamplesDown(dsp::AudioBlock<float>& block)
+    {
+        if (isActive())
+            oversampling->processSamplesDown(block);
+    }
+
+    // Latency at the host sample rate
+    int getLatencyInSamples() const
+    {
+        if (!isActive())
+            return 0;
+
+        return roundToInt(oversampling->getLatencyInSamples());
+    }
+
+    int getFactor() const
+    {
+        return factor;
+    }
+
+    Filter getFilter() const
+    {
+        return filter;
+    }
+
+private:
+    bool isActive() const
+    {
+        return factor > 0 && oversampling;
+    }
+
+    std::unique_ptr<dsp::Oversampling<float>> oversampling;
+    int factor = 0;
+    Filter filter = IIR;
+};
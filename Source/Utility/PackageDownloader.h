@@ -0,0 +1,288 @@
+/*
+ // Copyright (c) 2021-2023 Timothy Schoen
+ // For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ // WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+
+#pragma once
+
+#include <juce_cryptography/juce_cryptography.h>
+
+// Downloads deken archives into a content-addressed cache, and extracts them from there
+// Interrupted downloads continue where they left off, and archives are verified against the checksum that deken publishes next to them,
+// so reinstalling a package, or restoring it without a network connection, doesn't download it again
+// If a mirror is set, like "file:///path/to/mirror/", archives are loaded from there by file name instead
+// The least recently used archives are removed when the cache grows past its maximum size
+class PackageDownloader {
+public:
+    // Returns false to cancel the download
+    using ProgressCallback = std::function<bool(float)>;
+
+    static constexpr int64 defaultMaxCacheSize = 512 * 1024 * 1024;
+
+    PackageDownloader(File cacheDirectory, String mirrorURL = {}, int64 maxCacheSizeInBytes = defaultMaxCacheSize)
+        : cache(std::move(cacheDirectory))
+        , mirror(std::move(mirrorURL))
+        , maxCacheSize(maxCacheSizeInBytes)
+    {
+        if (mirror.isNotEmpty() && !mirror.endsWithChar('/'))
+            mirror += "/";
+    }
+
+    // Finds the archive for a url in the cache, or downloads it first. Blocks until done, so don't call this from the message thread
+    Result fetch(String const& url, File& archive, ProgressCallback const& progress = nullptr) const
+    {
+        if (!cache.isDirectory() && !cache.createDirectory())
+            return Result::fail("Failed to create package cache");
+
+        auto const source = resolve(url);
+        auto const key = SHA256(url.toUTF8()).toHexString().substring(0, 16);
+        auto const partialFile = cache.getChildFile(key + ".part");
+        auto const validatorFile = cache.getChildFile(key + ".validator");
+        auto const referenceFile = cache.getChildFile(key + ".ref");
+
+        // Prefer the published checksum, fall back to the one we verified last time when we're offline
+        // Only checksums that matched a published one are stored, so we never trust an archive that wasn't verified
+        auto expectedChecksum = readChecksum(readText(source + ".sha256"));
+        if (expectedChecksum.isEmpty())
+            expectedChecksum = readChecksum(referenceFile.loadFileAsString());
+
+        if (expectedChecksum.isNotEmpty()) {
+            auto cached = getArchiveFile(expectedChecksum, url);
+            if (cached.existsAsFile() && getChecksum(cached) == expectedChecksum) {
+                cached.setLastModificationTime(Time::getCurrentTime());
+                archive = cached;
+                return Result::ok();
+            }
+        }
+
+        String checksum;
+        for (int attempt = 0; attempt < 2; attempt++) {
+            auto const resumed = partialFile.getSize() > 0;
+
+            auto result = download(source, partialFile, validatorFile, expectedChecksum.isNotEmpty(), progress);
+            if (!result.wasOk())
+                return result;
+
+            checksum = getChecksum(partialFile);
+            if (expectedChecksum.isEmpty() || checksum == expectedChecksum)
+                break;
+
+            // Don't resume from a corrupt file next time
+            partialFile.deleteFile();
+            validatorFile.deleteFile();
+
+            // The partial file could be left over from a different version of the archive, so try once more from the start
+            if (!resumed || attempt > 0)
+                return Result::fail("The downloaded package is damaged, please try again");
+        }
+
+        archive = getArchiveFile(checksum, url);
+        if (!archive.existsAsFile() && !partialFile.moveFileTo(archive))
+            return Result::fail("Failed to store downloaded package");
+
+        partialFile.deleteFile();
+        validatorFile.deleteFile();
+
+        if (expectedChecksum.isNotEmpty())
+            referenceFile.replaceWithText(checksum);
+        else
+            referenceFile.deleteFile();
+
+        evict(archive);
+        return Result::ok();
+    }
+
+    // Extracts straight from the archive on disk, without loading it into memory
+    static Result extract(File const& archive, File const& destination)
+    {
+        ZipFile zip(archive);
+        return zip.uncompressTo(destination);
+    }
+
+    static String getChecksum(File const& file)
+    {
+        return SHA256(file).toHexString();
+    }
+
+    // Where a url is loaded from, after applying the mirror
+    String resolve(String const& url) const
+    {
+        if (mirror.isEmpty())
+            return url;
+
+        return mirror + URL::removeEscapeChars(url.fromLastOccurrenceOf("/", false, false));
+    }
+
+private:
+    File getArchiveFile(String const& checksum, String const& url) const
+    {
+        auto const extension = url.fromLastOccurrenceOf("/", false, false).fromLastOccurrenceOf(".", true, false);
+        return cache.getChildFile(checksum + (extension.length() > 1 ? extension : ".zip"));
+    }
+
+    // Removes partial downloads that were abandoned, and the least recently used archives until the cache fits again
+    void evict(File const& keep) const
+    {
+        auto const now = Time::getCurrentTime();
+
+        Array<File> archives;
+        int64 totalSize = 0;
+        for (auto const& file : cache.findChildFiles(File::findFiles, false)) {
+            if (file.hasFileExtension("ref"))
+                continue;
+
+            if (file.hasFileExtension("part;validator")) {
+                if (now - file.getLastModificationTime() > RelativeTime::days(abandonedDownloadDays))
+                    file.deleteFile();
+                continue;
+            }
+
+            archives.add(file);
+            totalSize += file.getSize();
+        }
+
+        std::sort(archives.begin(), archives.end(), [](File const& a, File const& b) {
+            return a.getLastModificationTime() < b.getLastModificationTime();
+        });
+
+        for (auto const& file : archives) {
+            if (totalSize <= maxCacheSize)
+                break;
+
+            auto const size = file.getSize();
+            if (file != keep && file.deleteFile())
+                totalSize -= size;
+        }
+    }
+
+    // Appends to the partial file if we can tell that it belongs to the same archive, otherwise starts over
+    // That's the case if the archive will be verified against a checksum, or if the server confirms that it didn't change
+    static Result download(String const& source, File const& partialFile, File const& validatorFile, bool hasChecksum, ProgressCallback const& progress)
+    {
+        auto const previousValidator = validatorFile.loadFileAsString();
+        auto offset = hasChecksum || previousValidator.isNotEmpty() ? partialFile.getSize() : 0;
+        int64 totalBytes = -1;
+        String validator;
+
+        std::unique_ptr<InputStream> instream;
+        if (source.startsWith("file://")) {
+            auto localFile = URL(source).getLocalFile();
+            if (!localFile.existsAsFile())
+                return Result::fail("Package not found in mirror: " + localFile.getFileName());
+
+            // Files in a mirror are recognised by their size and modification time
+            totalBytes = localFile.getSize();
+            validator = String(totalBytes) + " " + String(localFile.getLastModificationTime().toMilliseconds());
+            if (offset > totalBytes || (!hasChecksum && validator != previousValidator))
+                offset = 0;
+
+            auto fileStream = localFile.createInputStream();
+            if (!fileStream || !fileStream->setPosition(offset))
+                return Result::fail("Failed to open package in mirror");
+
+            instream = std::move(fileStream);
+        } else {
+            // With If-Range, the server only sends the rest of the file if it's still the same one, and the whole file otherwise
+            String headers;
+            if (offset > 0) {
+                headers = "Range: bytes=" + String(offset) + "-";
+                if (previousValidator.isNotEmpty())
+                    headers += "\r\nIf-Range: " + previousValidator;
+            }
+
+            int statusCode = 0;
+            StringPairArray responseHeaders;
+            instream = URL(source).createInputStream(URL::InputStreamOptions(URL::ParameterHandling::inAddress)
+                                                         .withConnectionTimeoutMs(10000)
+                                                         .withStatusCode(&statusCode)
+                                                         .withResponseHeaders(&responseHeaders)
+                                                         .withExtraHeaders(headers));
+
+            // The partial file is already complete
+            if (statusCode == 416 && offset > 0)
+                return Result::ok();
+
+            if (instream == nullptr || (statusCode != 200 && statusCode != 206))
+                return Result::fail("Failed to start download");
+
+            // The server ignored the range request, or the file changed, so we get the whole file again
+            if (statusCode == 200)
+                offset = 0;
+
+            // Weak ETags can't be used with If-Range
+            validator = responseHeaders["ETag"];
+            if (validator.isEmpty() || validator.startsWith("W/"))
+                validator = responseHeaders["Last-Modified"];
+
+            auto const length = instream->getTotalLength();
+            totalBytes = length >= 0 ? offset + length : -1;
+        }
+
+        if (offset == 0)
+            partialFile.deleteFile();
+
+        // Stored before downloading anything, so an interrupted download can be continued
+        if (offset == 0 || validator.isNotEmpty())
+            validatorFile.replaceWithText(validator);
+
+        FileOutputStream output(partialFile);
+        if (output.failedToOpen())
+            return Result::fail("Failed to write package to disk");
+
+        auto bytesDownloaded = offset;
+        HeapBlock<char> buffer(64 * 1024);
+
+        while (!instream->isExhausted()) {
+            auto const numRead = instream->read(buffer, 64 * 1024);
+            if (numRead <= 0)
+                break;
+
+            if (!output.write(buffer, static_cast<size_t>(numRead)))
+                return Result::fail("Failed to write package to disk");
+
+            bytesDownloaded += numRead;
+
+            // Keep the partial file when cancelled, so we can continue later
+            auto const fraction = totalBytes > 0 ? static_cast<float>(static_cast<double>(bytesDownloaded) / static_cast<double>(totalBytes)) : 0.0f;
+            if (progress && !progress(fraction))
+                return Result::fail("Download cancelled");
+        }
+
+        output.flush();
+
+        if (totalBytes > 0 && bytesDownloaded < totalBytes)
+            return Result::fail("Download interrupted, it will continue where it left off next time");
+
+        return Result::ok();
+    }
+
+    static String readText(String const& source)
+    {
+        if (source.startsWith("file://"))
+            return URL(source).getLocalFile().loadFileAsString();
+
+        int statusCode = 0;
+        auto instream = URL(source).createInputStream(URL::InputStreamOptions(URL::ParameterHandling::inAddress)
+                                                          .withConnectionTimeoutMs(5000)
+                                                          .withStatusCode(&statusCode));
+
+        if (instream == nullptr || statusCode != 200)
+            return {};
+
+        return instream->readEntireStreamAsString();
+    }
+
+    // Checksum files look like "<sha256> <filename>"
+    static String readChecksum(String const& text)
+    {
+        auto checksum = text.trim().upToFirstOccurrenceOf(" ", false, false).toLowerCase();
+        return checksum.length() == 64 && checksum.containsOnly("0123456789abcdef") ? checksum : String();
+    }
+
+    static constexpr int abandonedDownloadDays = 7;
+
+    File cache;
+    String mirror;
+    int64 maxCacheSize;
+};
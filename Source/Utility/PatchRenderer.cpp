@@ -0,0 +1,250 @@
+/*
+ // Copyright (c) 2021-2023 Timothy Schoen
+ // For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ // WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+
+#include "PatchRenderer.h"
+#include "PluginProcessor.h"
+#include "Utility/PluginParameter.h"
+
+var PatchRenderer::Statistics::toVar() const
+{
+    auto* result = new DynamicObject();
+    result->setProperty("audio_seconds", audioSeconds);
+    result->setProperty("render_seconds", renderSeconds);
+    result->setProperty("realtime_factor", getRealtimeFactor());
+    result->setProperty("mean_block_ms", meanBlockMs);
+    result->setProperty("max_block_ms", maxBlockMs);
+    result->setProperty("mean_load", meanLoad);
+    result->setProperty("peak_load", peakLoad);
+    result->setProperty("overloaded_blocks", numOverloadedBlocks);
+    result->setProperty("peak_level", peakLevel);
+    return var(result);
+}
+
+PatchRenderer::PatchRenderer(Settings renderSettings)
+    : settings(std::move(renderSettings))
+{
+}
+
+PatchRenderer::~PatchRenderer()
+{
+    if (processor) {
+        processor->patches.clear();
+        processor->releaseResources();
+    }
+}
+
+Result PatchRenderer::prepare()
+{
+    JUCE_ASSERT_MESSAGE_THREAD;
+
+    if (!settings.patchFile.existsAsFile())
+        return Result::fail("Patch not found: " + settings.patchFile.getFullPathName());
+
+    if (settings.midiFile != File()) {
+        auto result = readMidiFile();
+        if (result.failed())
+            return result;
+    }
+
+    if (settings.automationFile != File()) {
+        auto result = readAutomationFile();
+        if (result.failed())
+            return result;
+    }
+
+    processor = std::make_unique<PluginProcessor>();
+    processor->setNonRealtime(true);
+    processor->setProtectedMode(settings.limiter);
+
+    // Enable as many stereo buses as needed for the channel count, the same way a host would
+    auto layout = processor->getBusesLayout();
+    for (auto* buses : { &layout.inputBuses, &layout.outputBuses }) {
+        int channels = 0;
+        for (auto& bus : *buses) {
+            bus = channels < settings.numChannels ? AudioChannelSet::stereo() : AudioChannelSet::disabled();
+            channels += bus.size();
+        }
+    }
+
+    if (!processor->setBusesLayout(layout) || processor->getTotalNumOutputChannels() < settings.numChannels)
+        return Result::fail("Unsupported number of channels: " + String(settings.numChannels));
+
+    if (!processor->loadPatch(settings.patchFile, nullptr))
+        return Result::fail("Couldn't open patch: " + settings.patchFile.getFullPathName());
+
+    return Result::ok();
+}
+
+Result PatchRenderer::render()
+{
+    jassert(processor != nullptr);
+
+    // Parameter names can be changed by the patch, so we look them up after it has been loaded
+    std::vector<std::pair<RangedAudioParameter*, float>> automationEvents;
+    for (auto const& point : automation) {
+        RangedAudioParameter* target = nullptr;
+        for (auto* parameter : processor->getParameters()) {
+            auto* pdParameter = dynamic_cast<PlugDataParameter*>(parameter);
+            if (pdParameter && (pdParameter->getTitle() == point.parameterName || pdParameter->getParameterID() == point.parameterName)) {
+                target = pdParameter;
+                break;
+            }
+        }
+
+        if (!target)
+            return Result::fail("Unknown parameter in automation file: " + point.parameterName);
+
+        automationEvents.emplace_back(target, point.value);
+    }
+
+    settings.outputFile.deleteFile();
+    auto outputStream = std::make_unique<FileOutputStream>(settings.outputFile);
+    if (outputStream->failedToOpen())
+        return Result::fail("Couldn't write to " + settings.outputFile.getFullPathName());
+
+    WavAudioFormat wavFormat;
+    std::unique_ptr<AudioFormatWriter> writer(wavFormat.createWriterFor(outputStream.get(), settings.sampleRate, static_cast<unsigned int>(settings.numChannels), settings.bitDepth, {}, 0));
+    if (!writer)
+        return Result::fail("Unsupported output format: " + String(settings.bitDepth) + " bit, " + String(settings.sampleRate) + " Hz");
+
+    // The writer owns the stream now
+    outputStream.release();
+
+    processor->prepareToPlay(settings.sampleRate, settings.blockSize);
+    processor->startDSP();
+
+    auto const totalSamples = static_cast<int64>(settings.lengthInSeconds * settings.sampleRate);
+    auto const numChannels = jmax(processor->getTotalNumInputChannels(), processor->getTotalNumOutputChannels());
+
+    AudioBuffer<float> buffer(numChannels, settings.blockSize);
+    MidiBuffer midiBuffer;
+
+    int midiIndex = 0;
+    size_t automationIndex = 0;
+    int numBlocks = 0;
+    double totalBlockMs = 0.0;
+    double totalLoad = 0.0;
+
+    statistics = Statistics();
+    auto const renderStart = Time::getHighResolutionTicks();
+
+    for (int64 position = 0; position < totalSamples; position += settings.blockSize) {
+        auto const numSamples = static_cast<int>(jmin<int64>(settings.blockSize, totalSamples - position));
+        auto const blockEnd = static_cast<double>(position + numSamples) / settings.sampleRate;
+
+        buffer.setSize(numChannels, numSamples, false, false, true);
+        buffer.clear();
+        midiBuffer.clear();
+
+        // Parameters are sent to pd once per block, so automation is applied at the start of the block it falls in
+        while (automationIndex < automation.size() && automation[automationIndex].time < blockEnd) {
+            auto [parameter, value] = automationEvents[automationIndex++];
+            parameter->setValue(parameter->convertTo0to1(value));
+        }
+
+        while (midiIndex < midiSequence.getNumEvents()) {
+            auto const& message = midiSequence.getEventPointer(midiIndex)->message;
+            if (message.getTimeStamp() >= blockEnd)
+                break;
+
+            auto const samplePosition = static_cast<int64>(message.getTimeStamp() * settings.sampleRate) - position;
+            midiBuffer.addEvent(message, jlimit(0, numSamples - 1, static_cast<int>(samplePosition)));
+            midiIndex++;
+        }
+
+        auto const blockStart = Time::getHighResolutionTicks();
+        processor->processBlock(buffer, midiBuffer);
+        auto const blockMs = Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - blockStart) * 1000.0;
+
+        auto const load = blockMs / (numSamples / settings.sampleRate * 1000.0);
+        statistics.maxBlockMs = jmax(statistics.maxBlockMs, blockMs);
+        statistics.peakLoad = jmax(statistics.peakLoad, load);
+        statistics.numOverloadedBlocks += load > 1.0;
+        totalBlockMs += blockMs;
+        totalLoad += load;
+        numBlocks++;
+
+        statistics.peakLevel = jmax(statistics.peakLevel, buffer.getMagnitude(0, numSamples));
+
+        if (!writer->writeFromAudioSampleBuffer(buffer, 0, numSamples))
+            return Result::fail("Couldn't write to " + settings.outputFile.getFullPathName());
+    }
+
+    statistics.renderSeconds = Time::highResolutionTicksToSeconds(Time::getHighResolutionTicks() - renderStart);
+    statistics.audioSeconds = static_cast<double>(totalSamples) / settings.sampleRate;
+    statistics.meanBlockMs = numBlocks > 0 ? totalBlockMs / numBlocks : 0.0;
+    statistics.meanLoad = numBlocks > 0 ? totalLoad / numBlocks : 0.0;
+
+    processor->releaseDSP();
+    writer.reset();
+
+    return Result::ok();
+}
+
+StringArray PatchRenderer::getErrors() const
+{
+    JUCE_ASSERT_MESSAGE_THREAD;
+
+    StringArray errors;
+    if (processor) {
+        for (auto const& [object, message, type, length, repeats] : processor->getConsoleMessages()) {
+            if (type == 2)
+                errors.add(message);
+        }
+    }
+    return errors;
+}
+
+Result PatchRenderer::readMidiFile()
+{
+    FileInputStream stream(settings.midiFile);
+    MidiFile midiFile;
+    if (!stream.openedOk() || !midiFile.readFrom(stream))
+        return Result::fail("Couldn't read MIDI file: " + settings.midiFile.getFullPathName());
+
+    midiFile.convertTimestampTicksToSeconds();
+
+    midiSequence.clear();
+    for (int track = 0; track < midiFile.getNumTracks(); track++) {
+        for (auto const* event : *midiFile.getTrack(track)) {
+            // Tempo and track names don't mean anything to the patch
+            if (!event->message.isMetaEvent())
+                midiSequence.addEvent(event->message);
+        }
+    }
+    midiSequence.sort();
+
+    return Result::ok();
+}
+
+Result PatchRenderer::readAutomationFile()
+{
+    if (!settings.automationFile.existsAsFile())
+        return Result::fail("Couldn't read automation file: " + settings.automationFile.getFullPathName());
+
+    StringArray lines;
+    settings.automationFile.readLines(lines);
+
+    automation.clear();
+    for (int i = 0; i < lines.size(); i++) {
+        auto const line = lines[i].upToFirstOccurrenceOf("#", false, false).trim();
+        if (line.isEmpty())
+            continue;
+
+        auto tokens = StringArray::fromTokens(line, " \t,", "\"");
+        tokens.removeEmptyStrings();
+        if (tokens.size() != 3 || !tokens[0].containsOnly("0123456789.") || !tokens[2].containsOnly("0123456789.-e"))
+            return Result::fail("Invalid automation on line " + String(i + 1) + " of " + settings.automationFile.getFileName() + ": " + lines[i]);
+
+        automation.push_back({ tokens[0].getDoubleValue(), tokens[1], tokens[2].getFloatValue() });
+    }
+
+    std::stable_sort(automation.begin(), automation.end(), [](auto const& a, auto const& b) {
+        return a.time < b.time;
+    });
+
+    return Result::ok();
+}
@@ -0,0 +1,88 @@
+/*
+ // Copyright (c) 2021-2023 Timothy Schoen
+ // For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ // WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+
+#pragma once
+
+#include <juce_audio_processors/juce_audio_processors.h>
+#include <juce_audio_formats/juce_audio_formats.h>
+#include "Utility/Config.h"
+
+class PluginProcessor;
+
+// Renders a patch into an audio file without an audio device, as fast as the CPU allows
+// Every renderer has its own pd instance, so several patches can be rendered at the same time on different threads
+class PatchRenderer {
+public:
+    struct Settings {
+        File patchFile;
+        File outputFile;
+
+        // Optional standard MIDI file, all tracks are merged and sent to the patch
+        File midiFile;
+
+        // Optional text file with lines of "<seconds> <parameter> <value>", where the parameter is the name or id of a plugin parameter
+        File automationFile;
+
+        double lengthInSeconds = 10.0;
+        double sampleRate = 44100.0;
+        int blockSize = 256;
+        int numChannels = 2;
+        int bitDepth = 24;
+        bool limiter = true;
+    };
+
+    struct Statistics {
+        double audioSeconds = 0.0;
+        double renderSeconds = 0.0;
+        double meanBlockMs = 0.0;
+        double maxBlockMs = 0.0;
+
+        // Time spent processing a block, relative to the duration of that block
+        double meanLoad = 0.0;
+        double peakLoad = 0.0;
+
+        // Blocks that took longer than they would have had in realtime
+        int numOverloadedBlocks = 0;
+
+        float peakLevel = 0.0f;
+
+        double getRealtimeFactor() const { return renderSeconds > 0.0 ? audioSeconds / renderSeconds : 0.0; }
+
+        var toVar() const;
+    };
+
+    explicit PatchRenderer(Settings renderSettings);
+    ~PatchRenderer();
+
+    // Creates the pd instance and opens the patch and input files. Needs to be called on the message thread
+    Result prepare();
+
+    // Renders the patch and writes the output file, can be called from any thread
+    Result render();
+
+    // Errors that pd posted to the console while opening and rendering the patch. Needs to be called on the message thread
+    StringArray getErrors() const;
+
+    Settings const& getSettings() const { return settings; }
+    Statistics const& getStatistics() const { return statistics; }
+
+private:
+    Result readMidiFile();
+    Result readAutomationFile();
+
+    struct AutomationPoint {
+        double time;
+        String parameterName;
+        float value;
+    };
+
+    Settings settings;
+    Statistics statistics;
+
+    std::unique_ptr<PluginProcessor> processor;
+    MidiMessageSequence midiSequence;
+    std::vector<AutomationPoint> automation;
+};
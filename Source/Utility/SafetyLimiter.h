@@ -0,0 +1,174 @@
+/*
+ // Copyright (c) 2021-2023 Timothy Schoen and Alex Mitchell
+ // For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ // WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+*/
+
+#pragma once
+
+#if JUCE_USE_SSE_INTRINSICS || defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#    include <emmintrin.h>
+#    define PLUGDATA_SANITISE_SSE2 1
+#elif JUCE_USE_ARM_NEON || defined(__ARM_NEON) || defined(__ARM_NEON__)
+#    include <arm_neon.h>
+#    define PLUGDATA_SANITISE_NEON 1
+#endif
+
+// Safety net for protected mode
+// The limiter has no lookahead: the gain drops instantly when a peak goes over the threshold, and recovers smoothly afterwards
+// Most of the time the output stays below the threshold, so we only look at the peak of the block and skip the rest
+class SafetyLimiter {
+public:
+    // Replaces NaN, Inf and denormal values with zero
+    // Returns the number of NaN and Inf values that were found, denormals are not counted as faults
+    static int sanitise(float* samples, int numSamples) noexcept
+    {
+        int numFaults = 0;
+        int i = 0;
+
+#if PLUGDATA_SANITISE_SSE2
+        auto const exponentMask = _mm_set1_epi32(0x7f800000);
+        auto const zero = _mm_setzero_si128();
+        for (; i + 4 <= numSamples; i += 4) {
+            auto const bits = _mm_castps_si128(_mm_loadu_ps(samples + i));
+            auto const exponent = _mm_and_si128(bits, exponentMask);
+            auto const isNonFinite = _mm_cmpeq_epi32(exponent, exponentMask);
+            auto const isDenormal = _mm_cmpeq_epi32(exponent, zero);
+
+            auto const keep = _mm_andnot_si128(_mm_or_si128(isNonFinite, isDenormal), bits);
+            _mm_storeu_ps(samples + i, _mm_castsi128_ps(keep));
+
+            numFaults += countBits(static_cast<uint32>(_mm_movemask_ps(_mm_castsi128_ps(isNonFinite))));
+        }
+#elif PLUGDATA_SANITISE_NEON
+        auto const exponentMask = vdupq_n_u32(0x7f800000);
+        auto const zero = vdupq_n_u32(0);
+        for (; i + 4 <= numSamples; i += 4) {
+            auto const bits = vreinterpretq_u32_f32(vld1q_f32(samples + i));
+            auto const exponent = vandq_u32(bits, exponentMask);
+            auto const isNonFinite = vceqq_u32(exponent, exponentMask);
+            auto const isDenormal = vceqq_u32(exponent, zero);
+
+            auto const keep = vbicq_u32(bits, vorrq_u32(isNonFinite, isDenormal));
+            vst1q_f32(samples + i, vreinterpretq_f32_u32(keep));
+
+            // Each lane of the mask is either 0 or 0xffffffff
+            auto const ones = vshrq_n_u32(isNonFinite, 31);
+            auto const sum = vpadd_u32(vget_low_u32(ones), vget_high_u32(ones));
+            numFaults += static_cast<int>(vget_lane_u32(vpadd_u32(sum, sum), 0));
+        }
+#endif
+
+        for (; i < numSamples; i++) {
+            uint32 bits;
+            std::memcpy(&bits, samples + i, sizeof(float));
+
+            auto const exponent = bits & 0x7f800000;
+            if (exponent == 0x7f800000) {
+                samples[i] = 0.0f;
+                numFaults++;
+            } else if (exponent == 0) {
+                samples[i] = 0.0f;
+            }
+        }
+
+        return numFaults;
+    }
+
+    void prepare(double newSampleRate, int maxBlockSize)
+    {
+        sampleRate = newSampleRate;
+        blockSize = std::max(1, maxBlockSize);
+
+        envelope.resize(static_cast<size_t>(blockSize));
+        scratch.resize(static_cast<size_t>(blockSize));
+        releaseCoefficient = static_cast<float>(std::exp(-1.0 / (releaseTime * sampleRate)));
+
+        reset();
+    }
+
+    void reset()
+    {
+        gain = 1.0f;
+    }
+
+    void process(dsp::AudioBlock<float>& block) noexcept
+    {
+        auto const numChannels = static_cast<int>(block.getNumChannels());
+        auto const numSamples = static_cast<int>(block.getNumSamples());
+
+        if (numChannels == 0 || envelope.empty())
+            return;
+
+        // The host may give us more samples than it said it would
+        for (int start = 0; start < numSamples; start += blockSize) {
+            auto subBlock = block.getSubBlock(static_cast<size_t>(start), static_cast<size_t>(std::min(blockSize, numSamples - start)));
+            processSubBlock(subBlock);
+        }
+    }
+
+    // Output is limited to this level
+    static constexpr float threshold = 0.891f; // -1 dBFS
+
+private:
+    void processSubBlock(dsp::AudioBlock<float>& block) noexcept
+    {
+        auto const numChannels = static_cast<int>(block.getNumChannels());
+        auto const numSamples = static_cast<int>(block.getNumSamples());
+
+        // Fast path: nothing to do if every sample is under the threshold and we're not releasing
+        if (gain >= 1.0f) {
+            float peak = 0.0f;
+            for (int ch = 0; ch < numChannels; ch++) {
+                auto range = FloatVectorOperations::findMinAndMax(block.getChannelPointer(ch), numSamples);
+                peak = std::max(peak, std::max(-range.getStart(), range.getEnd()));
+            }
+
+            if (peak <= threshold)
+                return;
+        }
+
+        // Envelope detection: the highest absolute value of all channels, so the stereo image stays intact
+        auto* env = envelope.data();
+        auto* channelEnvelope = scratch.data();
+        FloatVectorOperations::abs(env, block.getChannelPointer(0), numSamples);
+        for (int ch = 1; ch < numChannels; ch++) {
+            FloatVectorOperations::abs(channelEnvelope, block.getChannelPointer(ch), numSamples);
+            FloatVectorOperations::max(env, env, channelEnvelope, numSamples);
+        }
+
+        // Gain computer: instant attack, exponential release towards unity gain
+        for (int n = 0; n < numSamples; n++) {
+            auto const target = env[n] > threshold ? threshold / env[n] : 1.0f;
+            gain = target < gain ? target : target + releaseCoefficient * (gain - target);
+            env[n] = gain;
+        }
+
+        // Snap back to unity, so the fast path can kick in again
+        if (gain > 0.9999f)
+            gain = 1.0f;
+
+        for (int ch = 0; ch < numChannels; ch++) {
+            auto* channel = block.getChannelPointer(ch);
+            FloatVectorOperations::multiply(channel, env, numSamples);
+
+            // The gain computer should already keep us under the threshold, this is just to be absolutely sure
+            FloatVectorOperations::clip(channel, channel, -1.0f, 1.0f, numSamples);
+        }
+    }
+
+    static int countBits(uint32 mask) noexcept
+    {
+        return static_cast<int>((mask & 1) + ((mask >> 1) & 1) + ((mask >> 2) & 1) + ((mask >> 3) & 1));
+    }
+
+    std::vector<float> envelope;
+    std::vector<float> scratch;
+    int blockSize = 0;
+
+    float gain = 1.0f;
+    float releaseCoefficient = 0.0f;
+
+    double sampleRate = 44100.0;
+    static constexpr double releaseTime = 0.05;
+};
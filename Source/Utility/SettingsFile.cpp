@@ -24,10 +24,268 @@ SettingsFileListener::~SettingsFileListener()
 
 JUCE_IMPLEMENT_SINGLETON(SettingsFile)
 
+static char const* const journalFileName = ".settings_journal";
+
+// Applies a record from the journal: it either sets a property of the settings tree, or replaces a whole top-level child tree
+// Records contain the new value, not the difference, so applying a record twice is harmless
+static void applySettingsRecord(ValueTree& settingsTree, ValueTree const& record)
+{
+    auto const name = record.getProperty("name").toString();
+
+    if (record.hasType("Property")) {
+        if (record.hasProperty("value"))
+            settingsTree.setProperty(name, record.getProperty("value"), nullptr);
+        else
+            settingsTree.removeProperty(name, nullptr);
+    } else if (record.hasType("Child")) {
+        auto existing = settingsTree.getChildWithName(name);
+        auto newChild = record.getChild(0);
+
+        if (!newChild.isValid())
+            settingsTree.removeChild(existing, nullptr);
+        else if (existing.isValid())
+            existing.copyPropertiesAndChildrenFrom(newChild, nullptr);
+        else
+            settingsTree.appendChild(newChild.createCopy(), nullptr);
+    }
+}
+
+// The journal is a header followed by records, each one a binary ValueTree prefixed with its size
+// Every plugdata process appends its own records, and reads the records of the others when the journal changes
+// When the journal gets too large, it's merged into the settings file, which stays in the same XML format as before
+// Files are replaced by writing a temporary file and renaming it, so a crash can't leave a half-written settings file behind
+class SettingsFile::Journal : private Thread {
+public:
+    Journal(File settings, int64 writer)
+        : Thread("Settings Writer")
+        , settingsFile(std::move(settings))
+        , journalFile(settingsFile.getSiblingFile(journalFileName))
+        , writerId(writer)
+    {
+        startThread();
+    }
+
+    ~Journal() override
+    {
+        stopThread(-1);
+
+        // Write what's left, and merge it into the settings file, so it's complete for the next launch
+        writePendingRecords();
+
+        ScopedFileLock lock(*this);
+        compact();
+    }
+
+    // Loads the settings file, with all the changes from the journal applied
+    ValueTree load()
+    {
+        ScopedFileLock lock(*this);
+
+        auto tree = ValueTree::fromXml(settingsFile.loadFileAsString());
+        if (!tree.isValid())
+            tree = ValueTree("SettingsTree");
+
+        std::vector<ValueTree> records;
+        readRecords(generation, position, records);
+        for (auto const& record : records) {
+            applySettingsRecord(tree, record);
+        }
+
+        return tree;
+    }
+
+    // Finds the records that other processes wrote since we last looked
+    // If another process merged the journal into the settings file in the meantime, the new settings file is returned too
+    bool readExternalChanges(ValueTree& snapshot, std::vector<ValueTree>& records)
+    {
+        ScopedFileLock lock(*this);
+
+        std::vector<ValueTree> newRecords;
+        if (readRecords(generation, position, newRecords))
+            snapshot = ValueTree::fromXml(settingsFile.loadFileAsString());
+
+        for (auto const& record : newRecords) {
+            if (static_cast<int64>(record.getProperty("writer")) != writerId)
+                records.push_back(record);
+        }
+
+        return snapshot.isValid() || !records.empty();
+    }
+
+    // Called from the message thread, the records are written on the journal thread
+    void append(MemoryBlock const& records)
+    {
+        {
+            ScopedLock lock(pendingLock);
+            pendingRecords.append(records.getData(), records.getSize());
+        }
+
+        notify();
+    }
+
+    static inline int const magic = 0x4a535450;
+    static inline int const headerSize = sizeof(int) + sizeof(int64);
+    static inline int64 const maxJournalSize = 256 * 1024;
+
+private:
+    struct ScopedFileLock {
+        explicit ScopedFileLock(Journal& journal)
+            : threadLock(journal.fileLock)
+            , processLock(journal.processLock)
+        {
+        }
+
+        // The InterProcessLock only keeps out other processes, not other threads in this one
+        CriticalSection::ScopedLockType threadLock;
+        InterProcessLock::ScopedLockType processLock;
+    };
+
+    void run() override
+    {
+        while (!threadShouldExit()) {
+            wait(-1);
+            writePendingRecords();
+        }
+    }
+
+    void writePendingRecords()
+    {
+        MemoryBlock records;
+        {
+            ScopedLock lock(pendingLock);
+            records.swapWith(pendingRecords);
+        }
+
+        if (records.isEmpty())
+            return;
+
+        ScopedFileLock lock(*this);
+
+        // Find the end of the last complete record: if a process crashed while appending, the incomplete record would hide everything after it
+        int64 journalGeneration = 0;
+        int64 validEnd = 0;
+        std::vector<ValueTree> existingRecords;
+        readRecords(journalGeneration, validEnd, existingRecords);
+
+        if (validEnd == 0) {
+            startNewJournal();
+            validEnd = headerSize;
+        }
+
+        {
+            FileOutputStream output(journalFile);
+            if (output.failedToOpen() || !output.setPosition(validEnd) || output.truncate().failed())
+                return;
+
+            output.write(records.getData(), records.getSize());
+            output.flush();
+        }
+
+        if (journalFile.getSize() > maxJournalSize)
+            compact();
+    }
+
+    // Reads the records after a position in the journal, and moves the position to the end of the last complete record
+    // Returns true if the journal was started over since we last read it, in which case it's read from the start
+    bool readRecords(int64& knownGeneration, int64& readPosition, std::vector<ValueTree>& records) const
+    {
+        FileInputStream input(journalFile);
+        if (input.failedToOpen() || input.getTotalLength() < headerSize || input.readInt() != magic)
+            return false;
+
+        auto const journalGeneration = input.readInt64();
+        auto const startedOver = journalGeneration != knownGeneration;
+        if (startedOver) {
+            knownGeneration = journalGeneration;
+            readPosition = headerSize;
+        }
+
+        input.setPosition(readPosition);
+        while (input.getNumBytesRemaining() >= static_cast<int64>(sizeof(int))) {
+            auto const size = input.readInt();
+            if (size <= 0 || size > input.getNumBytesRemaining())
+                break;
+
+            MemoryBlock data;
+            input.readIntoMemoryBlock(data, size);
+
+            auto record = ValueTree::readFromData(data.getData(), data.getSize());
+            if (!record.isValid())
+                break;
+
+            records.push_back(record);
+            readPosition = input.getPosition();
+        }
+
+        return startedOver;
+    }
+
+    // Merges the journal into the settings file. Only call this while holding the file lock
+    // The settings file is replaced first: if we crash before the journal is started over, replaying it again gives the same result
+    void compact()
+    {
+        auto tree = ValueTree::fromXml(settingsFile.loadFileAsString());
+
+        // Don't overwrite a settings file that we can't read, it might have been edited by hand
+        if (!tree.isValid() && settingsFile.getSize() > 0)
+            return;
+
+        if (!tree.isValid())
+            tree = ValueTree("SettingsTree");
+
+        int64 journalGeneration = 0;
+        int64 end = 0;
+        std::vector<ValueTree> records;
+        readRecords(journalGeneration, end, records);
+
+        if (records.empty())
+            return;
+
+        for (auto const& record : records) {
+            applySettingsRecord(tree, record);
+        }
+
+        TemporaryFile temporaryFile(settingsFile);
+        if (!temporaryFile.getFile().replaceWithText(tree.toXmlString()) || !temporaryFile.overwriteTargetFileWithTemporary())
+            return;
+
+        startNewJournal();
+    }
+
+    // Every new journal gets a random generation, so readers notice that it was started over
+    void startNewJournal()
+    {
+        TemporaryFile temporaryFile(journalFile);
+        {
+            FileOutputStream output(temporaryFile.getFile());
+            output.writeInt(magic);
+            output.writeInt64(Random::getSystemRandom().nextInt64());
+        }
+        temporaryFile.overwriteTargetFileWithTemporary();
+    }
+
+    File const settingsFile;
+    File const journalFile;
+    int64 const writerId;
+
+    // Where we are in the journal, only used from the message thread
+    int64 generation = 0;
+    int64 position = 0;
+
+    CriticalSection pendingLock;
+    MemoryBlock pendingRecords;
+
+    CriticalSection fileLock;
+    InterProcessLock processLock { "plugdata_settings" };
+};
+
 SettingsFile::~SettingsFile()
 {
-    // Save current settings before quitting
-    saveSettings();
+    // Write the last changes before quitting, the journal merges them into the settings file
+    if (isInitialised)
+        saveSettings();
+
+    journal.reset();
 
     clearSingletonInstance();
 }
@@ -40,13 +298,10 @@ SettingsFile* SettingsFile::initialise()
 
     isInitialised = true;
 
-    // Check if settings file exists, if not, create the default
-    if (!settingsFile.existsAsFile()) {
-        settingsFile.create();
-    } else {
-        // Or load the settings when they exist already
-        settingsTree = ValueTree::fromXml(settingsFile.loadFileAsString());
-    }
+    // Load the settings file and apply the changes in the journal, if they exist already
+    journal = std::make_unique<Journal>(settingsFile, writerId);
+    settingsTree = journal->load();
+    auto const loadedTree = settingsTree.createCopy();
 
     // Make sure all the properties exist
     for (auto& [propertyName, propertyValue] : defaultSettings) {
@@ -69,6 +324,17 @@ SettingsFile* SettingsFile::initialise()
 
     Desktop::getInstance().setGlobalScaleFactor(getProperty<float>("global_scale"));
 
+    // Write the defaults that we just added
+    for (int i = 0; i < settingsTree.getNumProperties(); i++) {
+        auto const name = settingsTree.getPropertyName(i);
+        if (settingsTree.getProperty(name) != loadedTree.getProperty(name))
+            changedProperties.insert(name.toString());
+    }
+    for (auto child : settingsTree) {
+        if (!child.isEquivalentTo(loadedTree.getChildWithName(child.getType())))
+            changedChildren.insert(child.getType().toString());
+    }
+
     saveSettings();
 
     settingsTree.addListener(this);
@@ -300,29 +566,82 @@ void SettingsFile::initialiseOverlayTree()
     }
 }
 
-void SettingsFile::reloadSettings()
+bool SettingsFile::reloadSettings()
 {
-    if (settingsChangedInternally) {
-        settingsChangedInternally = false;
-        return;
-    }
+    jassert(isInitialised);
 
-    settingsChangedExternally = true;
+    ValueTree snapshot;
+    std::vector<ValueTree> records;
+    if (!journal->readExternalChanges(snapshot, records))
+        return false;
 
-    jassert(isInitialised);
+    externalChangesApplied = false;
+    {
+        ScopedValueSetter<bool> applying(applyingExternalChanges, true);
 
-    auto newTree = ValueTree::fromXml(settingsFile.loadFileAsString());
+        if (snapshot.isValid())
+            applySnapshot(snapshot);
 
-    // Children shouldn't be overwritten as that would break some valueTree links
-    for (auto child : settingsTree) {
-        child.copyPropertiesAndChildrenFrom(newTree.getChildWithName(child.getType()), nullptr);
+        for (auto const& record : records) {
+            // Our own changes that we didn't write yet are newer
+            auto const& pendingChanges = record.hasType("Property") ? changedProperties : changedChildren;
+            if (!pendingChanges.count(record.getProperty("name").toString()))
+                applySettingsRecord(settingsTree, record);
+        }
     }
 
-    settingsTree.copyPropertiesFrom(newTree, nullptr);
+    if (!externalChangesApplied)
+        return false;
 
     for (auto* listener : listeners) {
         listener->settingsFileReloaded();
     }
+
+    return true;
+}
+
+// Applies a settings file that another process wrote, without touching what's the same
+void SettingsFile::applySnapshot(ValueTree const& snapshot)
+{
+    for (int i = 0; i < snapshot.getNumProperties(); i++) {
+        auto const name = snapshot.getPropertyName(i);
+        if (!changedProperties.count(name.toString()))
+            settingsTree.setProperty(name, snapshot.getProperty(name), nullptr);
+    }
+
+    for (auto child : snapshot) {
+        auto existing = settingsTree.getChildWithName(child.getType());
+        if (changedChildren.count(child.getType().toString()) || existing.isEquivalentTo(child))
+            continue;
+
+        // Children shouldn't be overwritten as that would break some valueTree links
+        if (existing.isValid())
+            existing.copyPropertiesAndChildrenFrom(child, nullptr);
+        else
+            settingsTree.appendChild(child.createCopy(), nullptr);
+    }
+}
+
+bool SettingsFile::isSettingsFile(File const& file)
+{
+    auto const settings = ProjectInfo::appDataDir.getChildFile(".settings");
+    return file == settings || file == settings.getSiblingFile(journalFileName);
+}
+
+// Remembers which part of the settings changed, so we only have to write that part
+void SettingsFile::markAsChanged(ValueTree const& tree, Identifier const& property)
+{
+    if (tree == settingsTree) {
+        changedProperties.insert(property.toString());
+    } else {
+        auto topLevelChild = tree;
+        while (topLevelChild.getParent().isValid() && topLevelChild.getParent() != settingsTree) {
+            topLevelChild = topLevelChild.getParent();
+        }
+        changedChildren.insert(topLevelChild.getType().toString());
+    }
+
+    startTimer(flushDelayMs);
 }
 
 void SettingsFile::valueTreePropertyChanged(ValueTree& treeWhosePropertyHasChanged, Identifier const& property)
@@ -331,40 +650,32 @@ void SettingsFile::valueTreePropertyChanged(ValueTree& treeWhosePropertyHasChang
         listener->propertyChanged(property.toString(), treeWhosePropertyHasChanged.getProperty(property));
     }
 
-    if (!settingsChangedExternally)
-        settingsChangedInternally = true;
-    startTimer(700);
+    if (applyingExternalChanges)
+        externalChangesApplied = true;
+    else
+        markAsChanged(treeWhosePropertyHasChanged, property);
 }
 
 void SettingsFile::valueTreeChildAdded(ValueTree& parentTree, ValueTree& childWhichHasBeenAdded)
 {
-    if (!settingsChangedExternally)
-        settingsChangedInternally = true;
-    startTimer(700);
+    if (applyingExternalChanges)
+        externalChangesApplied = true;
+    else
+        markAsChanged(parentTree == settingsTree ? childWhichHasBeenAdded : parentTree, {});
 }
 
 void SettingsFile::valueTreeChildRemoved(ValueTree& parentTree, ValueTree& childWhichHasBeenRemoved, int indexFromWhichChildWasRemoved)
 {
-    if (!settingsChangedExternally)
-        settingsChangedInternally = true;
-    startTimer(700);
+    if (applyingExternalChanges)
+        externalChangesApplied = true;
+    else
+        markAsChanged(parentTree == settingsTree ? childWhichHasBeenRemoved : parentTree, {});
 }
 
 void SettingsFile::timerCallback()
 {
-    jassert(isInitialised);
-
-    // Don't save again if we just loaded it from file
-    if (settingsChangedExternally) {
-        settingsChangedExternally = false;
-        stopTimer();
-        return;
-    }
-
-    // Save settings to file whenever valuetree state changes
     // Use timer to group changes together
     saveSettings();
-    stopTimer();
 }
 
 void SettingsFile::setGlobalScale(float newScale)
@@ -376,9 +687,43 @@ void SettingsFile::setGlobalScale(float newScale)
 void SettingsFile::saveSettings()
 {
     jassert(isInitialised);
-    // Save settings to file
-    auto xml = settingsTree.toXmlString();
-    settingsFile.replaceWithText(xml);
+    stopTimer();
+
+    if (changedProperties.empty() && changedChildren.empty())
+        return;
+
+    // Only the values are serialised here, the writing happens on the journal thread
+    MemoryOutputStream records;
+    auto writeRecord = [this, &records](ValueTree record) {
+        record.setProperty("writer", writerId, nullptr);
+
+        MemoryOutputStream data;
+        record.writeToStream(data);
+        records.writeInt(static_cast<int>(data.getDataSize()));
+        records.write(data.getData(), data.getDataSize());
+    };
+
+    for (auto const& name : changedProperties) {
+        ValueTree record("Property");
+        record.setProperty("name", name, nullptr);
+        if (settingsTree.hasProperty(name))
+            record.setProperty("value", settingsTree.getProperty(name), nullptr);
+        writeRecord(record);
+    }
+
+    for (auto const& type : changedChildren) {
+        ValueTree record("Child");
+        record.setProperty("name", type, nullptr);
+        auto child = settingsTree.getChildWithName(type);
+        if (child.isValid())
+            record.appendChild(child.createCopy(), nullptr);
+        writeRecord(record);
+    }
+
+    changedProperties.clear();
+    changedChildren.clear();
+
+    journal->append(records.getMemoryBlock());
 }
 
 void SettingsFile::setProperty(String const& name, var const& value)
@@ -5,6 +5,7 @@
  */
 
 #pragma once
+#include <set>
 #include "Pd/Library.h"
 
 class SettingsFileListener {
@@ -19,6 +20,9 @@ public:
 };
 
 // Class that manages the settings file
+// Changes are written as small records to a journal next to the settings file, on a background thread
+// The journal is merged back into the settings file when it grows too large, or when we quit
+// Multiple processes can share the settings: each one appends its own changes, and picks up the changes of the others when the journal changes
 class SettingsFile : public ValueTree::Listener
     , public Timer
     , public DeletedAtShutdown {
@@ -46,7 +50,11 @@ public:
     void initialiseThemesTree();
     void initialiseOverlayTree();
 
-    void reloadSettings();
+    // Applies the changes that other plugdata processes wrote since we last looked, returns true if anything changed
+    bool reloadSettings();
+
+    // True for the settings file and its journal
+    static bool isSettingsFile(File const& file);
 
     void valueTreePropertyChanged(ValueTree& treeWhosePropertyHasChanged, Identifier const& property) override;
     void valueTreeChildAdded(ValueTree& parentTree, ValueTree& childWhichHasBeenAdded) override;
@@ -54,6 +62,7 @@ public:
 
     void timerCallback() override;
 
+    // Writes the pending changes to the journal now, instead of waiting for the timer
     void saveSettings();
 
     void setProperty(String const& name, var const& value);
@@ -82,28 +91,50 @@ public:
 
     void setGlobalScale(float newScale);
 
+    static inline int const flushDelayMs = 300;
+
 private:
+    class Journal;
+
+    void markAsChanged(ValueTree const& tree, Identifier const& property);
+    void applySnapshot(ValueTree const& snapshot);
+
     bool isInitialised = false;
 
     Array<SettingsFileListener*> listeners;
 
     File settingsFile = ProjectInfo::appDataDir.getChildFile(".settings");
     ValueTree settingsTree = ValueTree("SettingsTree");
-    bool settingsChangedInternally = false;
-    bool settingsChangedExternally = false;
+
+    // Properties of the root tree, and top-level child trees, that changed since the last flush
+    std::set<String> changedProperties;
+    std::set<String> changedChildren;
+    bool applyingExternalChanges = false;
+    bool externalChangesApplied = false;
+
+    // Identifies our records in the journal
+    int64 const writerId = Random::getSystemRandom().nextInt64();
+
+    std::unique_ptr<Journal> journal;
 
     std::vector<std::pair<String, var>> defaultSettings {
         { "browser_path", var(ProjectInfo::appDataDir.getFullPathName()) },
         { "theme", var("light") },
         { "oversampling", var(0) },
+        { "oversampling_filter", var(0) },
         { "protected", var(1) },
         { "internal_synth", var(0) },
+        { "internal_synth_polyphony", var(64) },
+        { "internal_synth_cpu_budget", var(50) },
+        { "parallel_dsp", var(0) },
+        { "fade_graph_changes", var(1) },
         { "grid_enabled", var(1) },
         { "grid_type", var(6) },
         { "grid_size", var(20) },
         { "default_font", var("Inter") },
         { "native_window", var(false) },
         { "reload_last_state", var(false) },
+        { "deken_mirror", var("") },
         { "autoconnect", var(true) },
         { "origin", var(0) },
         { "border", var(0) },
@@ -0,0 +1,135 @@
+/*
+ // Copyright (c) 2021-2022 Timothy Schoen
+ // For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ // WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+
+#pragma once
+
+#include <unordered_map>
+#include <vector>
+
+// Uniform grid that sorts items into buckets by their bounds
+// This lets us find the items inside an area without checking every item, which is what we need for culling large patches
+template<typename T, int cellSize = 512>
+class SpatialIndex {
+public:
+    // Adds an item, or moves it if it was already added
+    void insert(T* item, Rectangle<int> bounds)
+    {
+        auto& entry = entries[item];
+
+        if (entry.isInserted) {
+            if (entry.bounds == bounds)
+                return;
+
+            if (getCellRange(entry.bounds) == getCellRange(bounds)) {
+                entry.bounds = bounds;
+                return;
+            }
+
+            removeFromCells(item, entry.bounds);
+        }
+
+        entry.bounds = bounds;
+        entry.isInserted = true;
+
+        forEachCell(bounds, [this, item](int64 key) {
+            cells[key].push_back(item);
+        });
+    }
+
+    void remove(T* item)
+    {
+        auto it = entries.find(item);
+        if (it == entries.end())
+            return;
+
+        removeFromCells(item, it->second.bounds);
+        entries.erase(it);
+    }
+
+    void clear()
+    {
+        cells.clear();
+        entries.clear();
+    }
+
+    // Calls the callback once for every item that intersects the area
+    template<typename Callback>
+    void findItemsInArea(Rectangle<int> area, Callback&& callback)
+    {
+        // Items that span multiple cells will be found multiple times, so we mark the ones we've already seen
+        currentQuery++;
+
+        forEachCell(area, [this, &area, &callback](int64 key) {
+            auto cell = cells.find(key);
+            if (cell == cells.end())
+                return;
+
+            for (auto* item : cell->second) {
+                auto& entry = entries[item];
+                if (entry.lastQuery == currentQuery || !entry.bounds.intersects(area))
+                    continue;
+
+                entry.lastQuery = currentQuery;
+                callback(item);
+            }
+        });
+    }
+
+    int size() const
+    {
+        return static_cast<int>(entries.size());
+    }
+
+private:
+    struct Entry {
+        Rectangle<int> bounds;
+        uint32 lastQuery = 0;
+        bool isInserted = false;
+    };
+
+    static int toCell(int position)
+    {
+        // Round towards negative infinity, so negative positions end up in the right cell
+        return position >= 0 ? position / cellSize : (position - cellSize + 1) / cellSize;
+    }
+
+    static Rectangle<int> getCellRange(Rectangle<int> bounds)
+    {
+        auto start = Point<int>(toCell(bounds.getX()), toCell(bounds.getY()));
+        auto end = Point<int>(toCell(bounds.getRight()), toCell(bounds.getBottom()));
+        return Rectangle<int>(start, end);
+    }
+
+    template<typename Callback>
+    static void forEachCell(Rectangle<int> bounds, Callback&& callback)
+    {
+        auto range = getCellRange(bounds);
+        for (int y = range.getY(); y <= range.getBottom(); y++) {
+            for (int x = range.getX(); x <= range.getRight(); x++) {
+                callback((static_cast<int64>(y) << 32) | static_cast<uint32>(x));
+            }
+        }
+    }
+
+    void removeFromCells(T* item, Rectangle<int> bounds)
+    {
+        forEachCell(bounds, [this, item](int64 key) {
+            auto cell = cells.find(key);
+            if (cell == cells.end())
+                return;
+
+            auto& items = cell->second;
+            items.erase(std::remove(items.begin(), items.end(), item), items.end());
+
+            if (items.empty())
+                cells.erase(cell);
+        });
+    }
+
+    std::unordered_map<int64, std::vector<T*>> cells;
+    std::unordered_map<T*, Entry> entries;
+    uint32 currentQuery = 0;
+};
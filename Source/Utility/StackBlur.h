@@ -0,0 +1,367 @@
+/*
+ // Copyright (c) 2021-2023 Timothy Schoen
+ // For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ // WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+ */
+
+#pragma once
+
+// Vectorised version of the stack blur in StackShadow.h
+// The blur itself runs on four 32-bit lanes at once: for ARGB and RGB images the lanes are the colour channels of one pixel,
+// for single channel images the lanes are four neighbouring rows or columns. The results are identical to the scalar version.
+// Large images are split into groups of lines that are blurred in parallel
+
+#include <JuceHeader.h>
+
+#if JUCE_USE_SSE_INTRINSICS || defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#    include <emmintrin.h>
+#    define PLUGDATA_STACKBLUR_SSE2 1
+#elif JUCE_USE_ARM_NEON || defined(__ARM_NEON) || defined(__ARM_NEON__)
+#    include <arm_neon.h>
+#    define PLUGDATA_STACKBLUR_NEON 1
+#endif
+
+class StackBlur {
+public:
+    // Images with more pixels than this will be blurred on multiple threads
+    static inline int multithreadingThreshold = 256 * 256;
+
+    static void apply(Image& img, unsigned int radius, unsigned int mulSum, unsigned int shrSum, bool allowMultithreading = true)
+    {
+        auto const w = img.getWidth();
+        auto const h = img.getHeight();
+
+        if (w <= 0 || h <= 0)
+            return;
+
+        Image::BitmapData data(img, Image::BitmapData::readWrite);
+
+        auto const format = img.getFormat();
+        auto const numChannels = format == Image::SingleChannel ? 1 : (format == Image::RGB ? 3 : 4);
+        auto const pixelStride = data.pixelStride;
+        auto const lineStride = data.lineStride;
+
+        auto const parameters = Parameters { radius, mulSum, shrSum };
+        bool const parallel = allowMultithreading && w * h > multithreadingThreshold;
+
+        if (numChannels == 1) {
+            // Horizontal pass: lanes are four rows
+            forEachGroup((h + 3) / 4, parallel, [&](int group) {
+                ParallelLines lines;
+                for (int lane = 0; lane < 4; lane++) {
+                    auto y = std::min(group * 4 + lane, h - 1);
+                    lines.base[lane] = data.getLinePointer(y);
+                }
+                lines.numLanes = std::min(4, h - group * 4);
+                lines.step = pixelStride;
+                blurLine(lines, static_cast<unsigned int>(w), parameters);
+            });
+
+            // Vertical pass: lanes are four neighbouring columns, which can be loaded with a single read
+            forEachGroup((w + 3) / 4, parallel, [&](int group) {
+                ParallelLines lines;
+                for (int lane = 0; lane < 4; lane++) {
+                    auto x = std::min(group * 4 + lane, w - 1);
+                    lines.base[lane] = data.getLinePointer(0) + x * pixelStride;
+                }
+                lines.numLanes = std::min(4, w - group * 4);
+                lines.step = lineStride;
+                blurLine(lines, static_cast<unsigned int>(h), parameters);
+            });
+        } else {
+            // Horizontal pass: lanes are the channels of a pixel
+            forEachGroup(h, parallel, [&](int y) {
+                auto pixels = PixelChannels { data.getLinePointer(y), pixelStride, numChannels };
+                blurLine(pixels, static_cast<unsigned int>(w), parameters);
+            });
+
+            // Vertical pass
+            forEachGroup(w, parallel, [&](int x) {
+                auto pixels = PixelChannels { data.getLinePointer(0) + x * pixelStride, lineStride, numChannels };
+                blurLine(pixels, static_cast<unsigned int>(h), parameters);
+            });
+        }
+    }
+
+private:
+    struct Parameters {
+        unsigned int radius;
+        unsigned int mulSum;
+        unsigned int shrSum;
+    };
+
+    // Four unsigned 32-bit integers
+#if PLUGDATA_STACKBLUR_SSE2
+    struct U32x4 {
+        __m128i v;
+
+        static U32x4 zero() { return { _mm_setzero_si128() }; }
+
+        // Unpacks 4 bytes into 4 lanes
+        static U32x4 fromBytes(uint32 bytes)
+        {
+            auto const zero = _mm_setzero_si128();
+            return { _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(static_cast<int>(bytes)), zero), zero) };
+        }
+
+        // Packs lanes that are already in 0-255 range back into 4 bytes
+        uint32 toBytes() const
+        {
+            auto const packed = _mm_packus_epi16(_mm_packs_epi32(v, v), v);
+            return static_cast<uint32>(_mm_cvtsi128_si32(packed));
+        }
+
+        U32x4 operator+(U32x4 other) const { return { _mm_add_epi32(v, other.v) }; }
+        U32x4 operator-(U32x4 other) const { return { _mm_sub_epi32(v, other.v) }; }
+
+        // Multiplies pixel values (< 256) by a small factor (< 256), the result fits in 16 bits
+        U32x4 mulSmall(unsigned int factor) const
+        {
+            return { _mm_mullo_epi16(v, _mm_set1_epi32(static_cast<int>(factor))) };
+        }
+
+        // (v * mul) >> shr with 64-bit intermediate precision
+        U32x4 mulShift(unsigned int mul, unsigned int shr) const
+        {
+            auto const multiplier = _mm_set1_epi32(static_cast<int>(mul));
+            auto const shift = _mm_cvtsi32_si128(static_cast<int>(shr));
+            auto const even = _mm_srl_epi64(_mm_mul_epu32(v, multiplier), shift);
+            auto const odd = _mm_srl_epi64(_mm_mul_epu32(_mm_srli_epi64(v, 32), multiplier), shift);
+            return { _mm_or_si128(even, _mm_slli_epi64(odd, 32)) };
+        }
+    };
+#elif PLUGDATA_STACKBLUR_NEON
+    struct U32x4 {
+        uint32x4_t v;
+
+        static U32x4 zero() { return { vdupq_n_u32(0) }; }
+
+        static U32x4 fromBytes(uint32 bytes)
+        {
+            auto const bytes8 = vreinterpret_u8_u32(vdup_n_u32(bytes));
+            return { vmovl_u16(vget_low_u16(vmovl_u8(bytes8))) };
+        }
+
+        uint32 toBytes() const
+        {
+            auto const narrow16 = vmovn_u32(v);
+            auto const narrow8 = vmovn_u16(vcombine_u16(narrow16, narrow16));
+            return vget_lane_u32(vreinterpret_u32_u8(narrow8), 0);
+        }
+
+        U32x4 operator+(U32x4 other) const { return { vaddq_u32(v, other.v) }; }
+        U32x4 operator-(U32x4 other) const { return { vsubq_u32(v, other.v) }; }
+
+        U32x4 mulSmall(unsigned int factor) const { return { vmulq_n_u32(v, factor) }; }
+
+        U32x4 mulShift(unsigned int mul, unsigned int shr) const
+        {
+            auto const shift = vdupq_n_s64(-static_cast<int64_t>(shr));
+            auto const low = vshlq_u64(vmull_n_u32(vget_low_u32(v), mul), shift);
+            auto const high = vshlq_u64(vmull_n_u32(vget_high_u32(v), mul), shift);
+            return { vcombine_u32(vmovn_u64(low), vmovn_u64(high)) };
+        }
+    };
+#else
+    struct U32x4 {
+        uint32 v[4];
+
+        static U32x4 zero() { return { { 0, 0, 0, 0 } }; }
+
+        static U32x4 fromBytes(uint32 bytes)
+        {
+            U32x4 result;
+            for (int i = 0; i < 4; i++)
+                result.v[i] = (bytes >> (i * 8)) & 0xFF;
+            return result;
+        }
+
+        uint32 toBytes() const
+        {
+            return v[0] | (v[1] << 8) | (v[2] << 16) | (v[3] << 24);
+        }
+
+        U32x4 operator+(U32x4 other) const { return { { v[0] + other.v[0], v[1] + other.v[1], v[2] + other.v[2], v[3] + other.v[3] } }; }
+        U32x4 operator-(U32x4 other) const { return { { v[0] - other.v[0], v[1] - other.v[1], v[2] - other.v[2], v[3] - other.v[3] } }; }
+
+        U32x4 mulSmall(unsigned int factor) const { return { { v[0] * factor, v[1] * factor, v[2] * factor, v[3] * factor } }; }
+
+        U32x4 mulShift(unsigned int mul, unsigned int shr) const
+        {
+            U32x4 result;
+            for (int i = 0; i < 4; i++)
+                result.v[i] = static_cast<uint32>((static_cast<uint64>(v[i]) * mul) >> shr);
+            return result;
+        }
+    };
+#endif
+
+    // Lanes are the channels of one pixel, the line is walked with a fixed step
+    struct PixelChannels {
+        uint8* base;
+        int step;
+        int numChannels;
+
+        uint32 load(unsigned int i) const
+        {
+            auto const* p = base + static_cast<size_t>(i) * step;
+            if (numChannels == 4) {
+                uint32 result;
+                std::memcpy(&result, p, 4);
+                return result;
+            }
+            return p[0] | (p[1] << 8) | (p[2] << 16);
+        }
+
+        void store(unsigned int i, uint32 bytes) const
+        {
+            auto* p = base + static_cast<size_t>(i) * step;
+            if (numChannels == 4) {
+                std::memcpy(p, &bytes, 4);
+                return;
+            }
+            p[0] = bytes & 0xFF;
+            p[1] = (bytes >> 8) & 0xFF;
+            p[2] = (bytes >> 16) & 0xFF;
+        }
+    };
+
+    // Lanes are up to four separate lines of a single channel image
+    struct ParallelLines {
+        uint8* base[4];
+        int step;
+        int numLanes;
+
+        uint32 load(unsigned int i) const
+        {
+            auto const offset = static_cast<size_t>(i) * step;
+
+            // Neighbouring columns are next to each other in memory
+            if (numLanes == 4 && base[1] == base[0] + 1 && base[3] == base[0] + 3) {
+                uint32 result;
+                std::memcpy(&result, base[0] + offset, 4);
+                return result;
+            }
+
+            return base[0][offset] | (base[1][offset] << 8) | (base[2][offset] << 16) | (static_cast<uint32>(base[3][offset]) << 24);
+        }
+
+        void store(unsigned int i, uint32 bytes) const
+        {
+            auto const offset = static_cast<size_t>(i) * step;
+            for (int lane = 0; lane < numLanes; lane++) {
+                base[lane][offset] = (bytes >> (lane * 8)) & 0xFF;
+            }
+        }
+    };
+
+    // Same algorithm as the scalar implementation in StackShadow, on four lanes at once
+    template<typename Lanes>
+    static void blurLine(Lanes const& lanes, unsigned int length, Parameters const& parameters)
+    {
+        auto const radius = jlimit(2u, 254u, parameters.radius);
+        auto const div = radius * 2 + 1;
+        auto const wm = length - 1;
+
+        U32x4 stack[254 * 2 + 1];
+
+        auto sum = U32x4::zero();
+        auto sumIn = U32x4::zero();
+        auto sumOut = U32x4::zero();
+
+        auto const first = U32x4::fromBytes(lanes.load(0));
+        for (unsigned int i = 0; i <= radius; ++i) {
+            stack[i] = first;
+            sum = sum + first.mulSmall(i + 1);
+            sumOut = sumOut + first;
+        }
+
+        for (unsigned int i = 1; i <= radius; ++i) {
+            auto const pixel = U32x4::fromBytes(lanes.load(std::min(i, wm)));
+            stack[i + radius] = pixel;
+            sum = sum + pixel.mulSmall(radius + 1 - i);
+            sumIn = sumIn + pixel;
+        }
+
+        unsigned int sp = radius;
+        unsigned int xp = std::min(radius, wm);
+
+        for (unsigned int x = 0; x < length; ++x) {
+            lanes.store(x, sum.mulShift(parameters.mulSum, parameters.shrSum).toBytes());
+
+            sum = sum - sumOut;
+
+            auto stackStart = sp + div - radius;
+            if (stackStart >= div)
+                stackStart -= div;
+
+            sumOut = sumOut - stack[stackStart];
+
+            if (xp < wm)
+                ++xp;
+
+            auto const pixel = U32x4::fromBytes(lanes.load(xp));
+            stack[stackStart] = pixel;
+
+            sumIn = sumIn + pixel;
+            sum = sum + sumIn;
+
+            if (++sp >= div)
+                sp = 0;
+
+            sumOut = sumOut + stack[sp];
+            sumIn = sumIn - stack[sp];
+        }
+    }
+
+    // Runs a function for every group index, optionally split over the worker threads
+    template<typename Function>
+    static void forEachGroup(int numGroups, bool parallel, Function const& function)
+    {
+        auto& pool = getThreadPool();
+        auto const numWorkers = pool.getNumThreads();
+
+        if (!parallel || numWorkers == 0 || numGroups < 8) {
+            for (int group = 0; group < numGroups; group++)
+                function(group);
+            return;
+        }
+
+        // The calling thread takes part as well
+        // The shared state is reference counted, because a worker might still be touching it after the last chunk was signalled
+        struct SharedState {
+            std::atomic<int> nextChunk = 0;
+            std::atomic<int> chunksDone = 0;
+            WaitableEvent finished;
+        };
+
+        auto const numChunks = std::min(numWorkers + 1, numGroups);
+        auto state = std::make_shared<SharedState>();
+
+        auto runChunks = [state, numChunks, numGroups, &function]() {
+            int chunk;
+            while ((chunk = state->nextChunk.fetch_add(1)) < numChunks) {
+                auto const start = numGroups * chunk / numChunks;
+                auto const end = numGroups * (chunk + 1) / numChunks;
+                for (int group = start; group < end; group++)
+                    function(group);
+
+                if (state->chunksDone.fetch_add(1) + 1 == numChunks)
+                    state->finished.signal();
+            }
+        };
+
+        for (int i = 0; i < numChunks - 1; i++) {
+            pool.addJob(runChunks);
+        }
+
+        runChunks();
+        state->finished.wait();
+    }
+
+    static ThreadPool& getThreadPool()
+    {
+        static ThreadPool pool(jlimit(1, 8, SystemStats::getNumCpus() - 1));
+        return pool;
+    }
+};
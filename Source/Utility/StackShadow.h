@@ -17,6 +17,7 @@
 #include <JuceHeader.h>
 #include "Utility/HashUtils.h"
 #include "Utility/Config.h"
+#include "Utility/StackBlur.h"
 
 #if JUCE_WINDOWS
 #    include <juce_gui_basics/native/juce_ScopedThreadDPIAwarenessSetter_windows.h>
@@ -684,14 +685,11 @@ public:
         }
     }
 
+    // The scalar versions above are kept as a reference implementation for the vectorised blur
     static void applyStackBlur(Image& img, int radius)
     {
-        if (img.getFormat() == Image::ARGB)
-            applyStackBlurARGB(img, (unsigned int)radius);
-        if (img.getFormat() == Image::RGB)
-            applyStackBlurRGB(img, (unsigned int)radius);
-        if (img.getFormat() == Image::SingleChannel)
-            applyStackBlurBW(img, (unsigned int)radius);
+        auto const clampedRadius = jlimit(2u, 254u, (unsigned int)radius);
+        StackBlur::apply(img, clampedRadius, stackblur_mul[clampedRadius], stackblur_shr[clampedRadius]);
     }
 
     static void renderDropShadow(Graphics& g, Path const& path, Colour color, int const radius = 1, Point<int> const offset = { 0, 0 }, int spread = 0, float scale = 1.0f)
@@ -736,6 +734,144 @@ public:
     }
 };
 
+// Shared cache for blurred rounded rectangles, like the object activity overlay
+// The blur is only rendered once per (corner radius, blur radius, colour, scale), and stretched as a nine-patch
+// image for every size, so the cost doesn't grow with the number of objects that use it
+// Only use this from the message thread
+class NinePatchShadow {
+public:
+    struct Stats {
+        uint64 hits = 0;
+        uint64 misses = 0;
+        uint64 evictions = 0;
+        int numImages = 0;
+        size_t numBytes = 0;
+    };
+
+    // Draws a blurred rounded rectangle that extends blurRadius + 1 pixels outside of bounds
+    // The centre can be left out, if the caller only wants the outer glow
+    static void drawRoundedRectangle(Graphics& g, Rectangle<float> bounds, float cornerRadius, int blurRadius, Colour colour, bool drawCentre = true)
+    {
+        // Quantize the scale, so small rounding differences don't create new cache entries
+        auto scale = std::round(g.getInternalContext().getPhysicalPixelScaleFactor() * 8.0f) / 8.0f;
+        scale = std::max(scale, 0.125f);
+
+        auto const& entry = getImage(cornerRadius, blurRadius, colour, scale);
+        auto const edge = entry.edge;
+
+        auto area = (bounds.expanded(blurRadius + 1) * scale).getSmallestIntegerContainer();
+
+        // Too small to stretch, render it directly instead
+        if (area.getWidth() < edge * 2 + 1 || area.getHeight() < edge * 2 + 1) {
+            Path shadowPath;
+            shadowPath.addRoundedRectangle(bounds, cornerRadius);
+            g.setColour(colour);
+            StackShadow::renderDropShadow(g, shadowPath, colour, blurRadius, { 0, 0 }, 0);
+            return;
+        }
+
+        g.saveState();
+        g.addTransform(AffineTransform::scale(1.0f / scale));
+
+        auto const& image = entry.image;
+        auto const x = area.getX();
+        auto const y = area.getY();
+        auto const right = area.getRight() - edge;
+        auto const bottom = area.getBottom() - edge;
+        auto const innerWidth = area.getWidth() - edge * 2;
+        auto const innerHeight = area.getHeight() - edge * 2;
+
+        // Corners
+        g.drawImage(image, x, y, edge, edge, 0, 0, edge, edge);
+        g.drawImage(image, right, y, edge, edge, edge + 1, 0, edge, edge);
+        g.drawImage(image, x, bottom, edge, edge, 0, edge + 1, edge, edge);
+        g.drawImage(image, right, bottom, edge, edge, edge + 1, edge + 1, edge, edge);
+
+        // Edges, stretched from a single row or column
+        g.drawImage(image, x + edge, y, innerWidth, edge, edge, 0, 1, edge);
+        g.drawImage(image, x + edge, bottom, innerWidth, edge, edge, edge + 1, 1, edge);
+        g.drawImage(image, x, y + edge, edge, innerHeight, 0, edge, edge, 1);
+        g.drawImage(image, right, y + edge, edge, innerHeight, edge + 1, edge, edge, 1);
+
+        if (drawCentre) {
+            g.drawImage(image, x + edge, y + edge, innerWidth, innerHeight, edge, edge, 1, 1);
+        }
+
+        g.restoreState();
+    }
+
+    static Stats getStats()
+    {
+        auto result = stats;
+        result.numImages = static_cast<int>(cache.size());
+        result.numBytes = 0;
+        for (auto const& [key, entry] : cache) {
+            result.numBytes += static_cast<size_t>(entry.image.getWidth()) * entry.image.getHeight() * 4;
+        }
+        return result;
+    }
+
+    static void clear()
+    {
+        cache.clear();
+        lruOrder.clear();
+    }
+
+    static inline int maxCachedImages = 64;
+
+private:
+    struct Entry {
+        Image image;
+        int edge;
+        std::list<hash32>::iterator lruPosition;
+    };
+
+    static Entry const& getImage(float cornerRadius, int blurRadius, Colour colour, float scale)
+    {
+        auto key = hash(String(cornerRadius) + "_" + String(blurRadius) + "_" + colour.toString() + "_" + String(scale));
+
+        auto it = cache.find(key);
+        if (it != cache.end()) {
+            stats.hits++;
+            lruOrder.splice(lruOrder.begin(), lruOrder, it->second.lruPosition);
+            return it->second;
+        }
+
+        stats.misses++;
+
+        while (static_cast<int>(cache.size()) >= maxCachedImages && !lruOrder.empty()) {
+            cache.erase(lruOrder.back());
+            lruOrder.pop_back();
+            stats.evictions++;
+        }
+
+        // The smallest image that contains all four blurred corners, plus one row and column to stretch
+        auto const scaledBlur = std::max(1, roundToInt(blurRadius * scale));
+        auto const padding = scaledBlur + 1;
+        auto const edge = padding + static_cast<int>(std::ceil(cornerRadius * scale));
+        auto const size = edge * 2 + 1;
+
+        Image image(Image::ARGB, size, size, true);
+        {
+            Graphics g(image);
+            g.setColour(colour);
+            g.fillRoundedRectangle(Rectangle<float>(padding, padding, size - padding * 2, size - padding * 2), cornerRadius * scale);
+        }
+        StackShadow::applyStackBlur(image, scaledBlur);
+
+        lruOrder.push_front(key);
+        auto& entry = cache[key];
+        entry.image = image;
+        entry.edge = edge;
+        entry.lruPosition = lruOrder.begin();
+        return entry;
+    }
+
+    static inline std::unordered_map<hash32, Entry> cache;
+    static inline std::list<hash32> lruOrder;
+    static inline Stats stats;
+};
+
 class StackDropShadower : private ComponentListener {
 public:
     /** Creates a DropShadower. */
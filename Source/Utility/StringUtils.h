@@ -36,12 +36,7 @@ struct StringUtils {
 
     static float getPreciseStringWidth(String const& text, Font const& font)
     {
-        float maxLineLength = 0;
-        for (auto& line : StringArray::fromLines(text)) {
-            maxLineLength = std::max(maxLineLength, font.getStringWidthFloat(line));
-        }
-
-        return maxLineLength;
+        return TextLayoutCache::getWidestLineWidth(text, font);
     }
 
     // used by console for a more optimised calculation
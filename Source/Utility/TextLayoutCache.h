@@ -0,0 +1,260 @@
+/*
+ // Copyright (c) 2021-2023 Timothy Schoen and Alex Mitchell
+ // For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ // WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+*/
+
+#pragma once
+
+#include <mutex>
+
+#include "Utility/HashUtils.h"
+
+// Shared cache for text measurements and glyph layouts
+// Opening or zooming a patch measures and draws the same object texts over and over, and shaping text is slow
+// Results are kept for the most recently used (text, font, layout) combinations, and are shared between all canvases
+// Objects can measure text while a patch is loading on another thread, so everything here is guarded by a mutex
+class TextLayoutCache {
+public:
+    struct Stats {
+        uint64 hits = 0;
+        uint64 misses = 0;
+        uint64 evictions = 0;
+        int numEntries = 0;
+    };
+
+    // Same as Font::getStringWidthFloat: the text is measured as a single line
+    static float getStringWidthFloat(String const& text, Font const& font)
+    {
+        return getEntry(text, font, { Measurement })->width;
+    }
+
+    static int getStringWidth(String const& text, Font const& font)
+    {
+        return roundToInt(getStringWidthFloat(text, font));
+    }
+
+    // Width of the widest line in a multi-line text
+    static float getWidestLineWidth(String const& text, Font const& font)
+    {
+        return getEntry(text, font, { Measurement })->widestLine;
+    }
+
+    // Number of lines that Pd text takes up when wrapped at maxLineWidth
+    // Besides wrapping, a line is also broken after every semicolon followed by a newline
+    static int getNumLines(String const& text, Font const& font, float maxLineWidth)
+    {
+        auto const entry = getEntry(text, font, { LineBreaks });
+        auto const& xOffsets = entry->xOffsets;
+        auto const& forcedBreaks = entry->forcedBreaks;
+
+        int numLines = 1;
+        float lineStart = 0.0f;
+        int nextForcedBreak = 0;
+
+        for (int i = 0; i < xOffsets.size(); i++) {
+            auto const isForcedBreak = nextForcedBreak < forcedBreaks.size() && forcedBreaks[nextForcedBreak] == i;
+            if (isForcedBreak)
+                nextForcedBreak++;
+
+            if (xOffsets[i] - lineStart >= maxLineWidth || isForcedBreak) {
+                lineStart = xOffsets[i];
+                numLines++;
+            }
+        }
+
+        return numLines;
+    }
+
+    // Same as Graphics::drawFittedText, with the current font and colour of g
+    // The glyphs are laid out once per (text, font, size, justification, lines, scale) and translated into place
+    static void drawFittedText(Graphics& g, String const& text, Rectangle<int> area, Justification justification, int maximumNumberOfLines, float minimumHorizontalScale = 0.0f)
+    {
+        if (text.isEmpty() || area.isEmpty() || !g.clipRegionIntersects(area))
+            return;
+
+        Layout layout { FittedText, area.getWidth(), area.getHeight(), justification.getFlags(), maximumNumberOfLines, minimumHorizontalScale };
+        auto const entry = getEntry(text, g.getCurrentFont(), layout);
+        entry->glyphs.draw(g, AffineTransform::translation(area.getPosition().toFloat()));
+    }
+
+    static Stats getStats()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto result = stats;
+        result.numEntries = static_cast<int>(cache.size());
+        return result;
+    }
+
+    // Call this when the typeface behind a font name changes, like when the default font is changed
+    static void clear()
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        cache.clear();
+        lruOrder.clear();
+    }
+
+    static inline int maxCachedEntries = 4096;
+
+private:
+    enum Kind {
+        Measurement,
+        LineBreaks,
+        FittedText
+    };
+
+    struct Layout {
+        Kind kind;
+        int width = 0;
+        int height = 0;
+        int justification = 0;
+        int maximumNumberOfLines = 0;
+        float minimumHorizontalScale = 0.0f;
+
+        bool operator==(Layout const& other) const
+        {
+            return kind == other.kind && width == other.width && height == other.height && justification == other.justification && maximumNumberOfLines == other.maximumNumberOfLines && minimumHorizontalScale == other.minimumHorizontalScale;
+        }
+    };
+
+    struct Key {
+        Key(String const& text, Font const& font, Layout const& layout)
+            : text(text)
+            , typefaceName(font.getTypefaceName())
+            , typefaceStyle(font.getTypefaceStyle())
+            , height(font.getHeight())
+            , horizontalScale(font.getHorizontalScale())
+            , kerning(font.getExtraKerningFactor())
+            , layout(layout)
+        {
+            keyHash = hash(text);
+            for (auto value : { static_cast<uint32>(hash(typefaceName)), static_cast<uint32>(hash(typefaceStyle)), bitsOf(height), bitsOf(horizontalScale), bitsOf(kerning), static_cast<uint32>(layout.kind), static_cast<uint32>(layout.width), static_cast<uint32>(layout.height), static_cast<uint32>(layout.justification), static_cast<uint32>(layout.maximumNumberOfLines), bitsOf(layout.minimumHorizontalScale) }) {
+                keyHash = (keyHash ^ value) * 0x01000193;
+            }
+        }
+
+        bool operator==(Key const& other) const
+        {
+            return keyHash == other.keyHash && layout == other.layout && height == other.height && horizontalScale == other.horizontalScale && kerning == other.kerning && text == other.text && typefaceName == other.typefaceName && typefaceStyle == other.typefaceStyle;
+        }
+
+        static uint32 bitsOf(float value)
+        {
+            uint32 bits;
+            std::memcpy(&bits, &value, sizeof(float));
+            return bits;
+        }
+
+        String text;
+        String typefaceName;
+        String typefaceStyle;
+        float height;
+        float horizontalScale;
+        float kerning;
+        Layout layout;
+        hash32 keyHash;
+    };
+
+    struct KeyHasher {
+        size_t operator()(Key const& key) const noexcept
+        {
+            return key.keyHash;
+        }
+    };
+
+    // Entries are immutable once created, so they can be used after the lock is released, even if they get evicted
+    struct Value {
+        float width = 0.0f;
+        float widestLine = 0.0f;
+        Array<float> xOffsets;
+        Array<int> forcedBreaks;
+        GlyphArrangement glyphs;
+    };
+
+    using ValuePtr = std::shared_ptr<Value const>;
+
+    struct Entry {
+        ValuePtr value;
+        std::list<Key>::iterator lruPosition;
+    };
+
+    static ValuePtr getEntry(String const& text, Font const& font, Layout const& layout)
+    {
+        Key key(text, font, layout);
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = cache.find(key);
+            if (it != cache.end()) {
+                stats.hits++;
+                lruOrder.splice(lruOrder.begin(), lruOrder, it->second.lruPosition);
+                return it->second.value;
+            }
+            stats.misses++;
+        }
+
+        // Don't hold the lock while shaping text, other threads may need the cache in the meantime
+        auto value = createValue(text, font, layout);
+
+        std::lock_guard<std::mutex> lock(mutex);
+
+        // Another thread might have added the same entry in the meantime
+        auto it = cache.find(key);
+        if (it != cache.end())
+            return it->second.value;
+
+        while (static_cast<int>(cache.size()) >= maxCachedEntries && !lruOrder.empty()) {
+            cache.erase(lruOrder.back());
+            lruOrder.pop_back();
+            stats.evictions++;
+        }
+
+        lruOrder.push_front(key);
+        cache.emplace(std::move(key), Entry { value, lruOrder.begin() });
+        return value;
+    }
+
+    static ValuePtr createValue(String const& text, Font const& font, Layout const& layout)
+    {
+        auto value = std::make_shared<Value>();
+
+        switch (layout.kind) {
+        case Measurement: {
+            value->width = font.getStringWidthFloat(text);
+            if (text.containsAnyOf("\r\n")) {
+                for (auto& line : StringArray::fromLines(text)) {
+                    value->widestLine = std::max(value->widestLine, font.getStringWidthFloat(line));
+                }
+            } else {
+                value->widestLine = value->width;
+            }
+            break;
+        }
+        case LineBreaks: {
+            Array<int> glyphs;
+            font.getGlyphPositions(text.trimCharactersAtEnd(";\n"), glyphs, value->xOffsets);
+
+            auto characters = text.getCharPointer();
+            juce_wchar lastCharacter = 0;
+            for (int i = 0; i < value->xOffsets.size() && !characters.isEmpty(); i++) {
+                auto const character = characters.getAndAdvance();
+                if (character == '\n' && lastCharacter == ';')
+                    value->forcedBreaks.add(i);
+                lastCharacter = character;
+            }
+            break;
+        }
+        case FittedText: {
+            value->glyphs.addFittedText(font, text, 0.0f, 0.0f, layout.width, layout.height, Justification(layout.justification), layout.maximumNumberOfLines, layout.minimumHorizontalScale);
+            break;
+        }
+        }
+
+        return value;
+    }
+
+    static inline std::mutex mutex;
+    static inline std::unordered_map<Key, Entry, KeyHasher> cache;
+    static inline std::list<Key> lruOrder;
+    static inline Stats stats;
+};
@@ -0,0 +1,162 @@
+/*
+ // Copyright (c) 2021-2023 Timothy Schoen and Alex Mitchell
+ // For information on usage and redistribution, and for a DISCLAIMER OF ALL
+ // WARRANTIES, see the file, "LICENSE.txt," in this distribution.
+*/
+
+#pragma once
+
+#include "Utility/HashUtils.h"
+
+// Shared cache for the parts of GUI objects that don't change with their value, like backgrounds, outlines and meter strips
+// A layer is rendered once per (style, size, scale) at the physical pixel scale, and is shared between all objects that look the same
+// That way, an object that repaints because its value changed only has to blit the layer and draw the value on top
+// Only use this from the message thread
+class WidgetLayerCache {
+public:
+    struct Stats {
+        uint64 hits = 0;
+        uint64 misses = 0;
+        uint64 evictions = 0;
+        int numImages = 0;
+        size_t numBytes = 0;
+    };
+
+    // Identifies the look of a layer: the name of the layer, followed by everything that changes how it's drawn
+    static hash32 makeStyle(char const* name, std::initializer_list<Colour> colours, std::initializer_list<float> parameters = {})
+    {
+        auto style = hash(name);
+        for (auto const& colour : colours) {
+            style = (style ^ colour.getARGB()) * 0x01000193;
+        }
+        for (auto parameter : parameters) {
+            uint32 bits;
+            std::memcpy(&bits, &parameter, sizeof(float));
+            style = (style ^ bits) * 0x01000193;
+        }
+        return style;
+    }
+
+    // Draws a layer that covers (0, 0, width, height), and renders it first if needed
+    static void draw(Graphics& g, hash32 style, int width, int height, std::function<void(Graphics&)> const& render)
+    {
+        drawRegion(g, style, width, height, { 0.0f, 0.0f, static_cast<float>(width), static_cast<float>(height) }, render);
+    }
+
+    // Only draws a part of the layer, like the lit part of a prerendered meter strip
+    static void drawRegion(Graphics& g, hash32 style, int width, int height, Rectangle<float> region, std::function<void(Graphics&)> const& render)
+    {
+        if (width <= 0 || height <= 0)
+            return;
+
+        // Quantize the scale, so small rounding differences don't create new cache entries
+        auto scale = std::round(g.getInternalContext().getPhysicalPixelScaleFactor() * 8.0f) / 8.0f;
+        scale = std::max(scale, 0.125f);
+
+        auto const& image = getImage({ style, width, height, scale }, render);
+        auto source = (region * scale).toNearestInt().getIntersection(image.getBounds());
+        if (source.isEmpty())
+            return;
+
+        g.saveState();
+        g.addTransform(AffineTransform::scale(1.0f / scale));
+        g.drawImage(image, source.getX(), source.getY(), source.getWidth(), source.getHeight(), source.getX(), source.getY(), source.getWidth(), source.getHeight());
+        g.restoreState();
+    }
+
+    static Stats getStats()
+    {
+        auto result = stats;
+        result.numImages = static_cast<int>(cache.size());
+        result.numBytes = numBytes;
+        return result;
+    }
+
+    static void clear()
+    {
+        cache.clear();
+        lruOrder.clear();
+        numBytes = 0;
+    }
+
+    static inline int maxCachedImages = 512;
+    static inline size_t maxCachedBytes = 64 * 1024 * 1024;
+
+private:
+    struct Key {
+        hash32 style;
+        int width;
+        int height;
+        float scale;
+
+        bool operator==(Key const& other) const
+        {
+            return style == other.style && width == other.width && height == other.height && scale == other.scale;
+        }
+    };
+
+    struct KeyHasher {
+        size_t operator()(Key const& key) const noexcept
+        {
+            auto result = key.style;
+            for (auto value : { static_cast<uint32>(key.width), static_cast<uint32>(key.height), static_cast<uint32>(key.scale * 8.0f) }) {
+                result = (result ^ value) * 0x01000193;
+            }
+            return result;
+        }
+    };
+
+    struct Entry {
+        Image image;
+        std::list<Key>::iterator lruPosition;
+    };
+
+    static size_t getImageSize(Image const& image)
+    {
+        return static_cast<size_t>(image.getWidth()) * image.getHeight() * 4;
+    }
+
+    static Image const& getImage(Key const& key, std::function<void(Graphics&)> const& render)
+    {
+        auto it = cache.find(key);
+        if (it != cache.end()) {
+            stats.hits++;
+            lruOrder.splice(lruOrder.begin(), lruOrder, it->second.lruPosition);
+            return it->second.image;
+        }
+
+        stats.misses++;
+
+        auto const imageWidth = std::max(1, roundToInt(key.width * key.scale));
+        auto const imageHeight = std::max(1, roundToInt(key.height * key.scale));
+        auto const newSize = static_cast<size_t>(imageWidth) * imageHeight * 4;
+
+        while (!lruOrder.empty() && (static_cast<int>(cache.size()) >= maxCachedImages || numBytes + newSize > maxCachedBytes)) {
+            auto oldest = cache.find(lruOrder.back());
+            numBytes -= getImageSize(oldest->second.image);
+            cache.erase(oldest);
+            lruOrder.pop_back();
+            stats.evictions++;
+        }
+
+        Image image(Image::ARGB, imageWidth, imageHeight, true);
+        {
+            Graphics g(image);
+            g.addTransform(AffineTransform::scale(key.scale));
+            render(g);
+        }
+
+        lruOrder.push_front(key);
+        numBytes += newSize;
+
+        auto& entry = cache[key];
+        entry.image = image;
+        entry.lruPosition = lruOrder.begin();
+        return entry.image;
+    }
+
+    static inline std::unordered_map<Key, Entry, KeyHasher> cache;
+    static inline std::list<Key> lruOrder;
+    static inline size_t numBytes = 0;
+    static inline Stats stats;
+};
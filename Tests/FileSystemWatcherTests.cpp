@@ -0,0 +1,101 @@
+#include <catch2/catch_all.hpp>
+
+#include <juce_gui_basics/juce_gui_basics.h>
+#define Rectangle juce::Rectangle
+
+#include <Utility/Config.h>
+#include <Utility/FileSystemWatcher.h>
+
+#if JUCE_LINUX
+
+struct CollectingListener : public FileSystemWatcher::Listener {
+    void fsChangeCallback(Array<FileSystemWatcher::Change> const& changes) override
+    {
+        numCallbacks++;
+        for (auto const& change : changes) {
+            changedFiles.add(change.file);
+        }
+    }
+
+    int numCallbacks = 0;
+    Array<File> changedFiles;
+};
+
+static void runMessageLoopFor(int milliseconds)
+{
+    MessageManager::getInstance()->runDispatchLoopUntil(milliseconds);
+}
+
+TEST_CASE("File system watcher reports changes in nested folders in one batch", "[filesystemwatcher]")
+{
+    ScopedJuceInitialiser_GUI gui;
+
+    TemporaryFile temporaryFolder;
+    auto root = temporaryFolder.getFile();
+    auto existingFolder = root.getChildFile("abstractions").getChildFile("nested");
+    REQUIRE(existingFolder.createDirectory());
+
+    FileSystemWatcher watcher;
+    CollectingListener listener;
+    watcher.addFolder(root, { root.getChildFile("ignored") });
+    watcher.addListener(&listener);
+
+    // Give the watcher thread time to add its watches
+    runMessageLoopFor(300);
+
+    // A change in a folder that existed when we started, and in folders that were created afterwards
+    existingFolder.getChildFile("osc.pd").replaceWithText("#N canvas 0 0 450 300 12;");
+    auto newFolder = root.getChildFile("new").getChildFile("deeper");
+    REQUIRE(newFolder.createDirectory());
+    newFolder.getChildFile("metro.pd").replaceWithText("#N canvas 0 0 450 300 12;");
+    root.getChildFile("ignored").createDirectory();
+    root.getChildFile("ignored").getChildFile("skip.pd").replaceWithText("");
+
+    runMessageLoopFor(FileSystemWatcher::Listener::debounceMs * 4);
+
+    CHECK(listener.numCallbacks == 1);
+    CHECK(listener.changedFiles.contains(existingFolder.getChildFile("osc.pd")));
+    CHECK(listener.changedFiles.contains(newFolder.getChildFile("metro.pd")));
+    CHECK(!listener.changedFiles.contains(root.getChildFile("ignored").getChildFile("skip.pd")));
+
+    // Every file is only listed once
+    Array<File> unique;
+    for (auto const& file : listener.changedFiles) {
+        unique.addIfNotAlreadyThere(file);
+    }
+    CHECK(unique.size() == listener.changedFiles.size());
+
+    watcher.removeListener(&listener);
+    root.deleteRecursively();
+}
+
+TEST_CASE("File system watcher only applies exclusions to the folder they were added with", "[filesystemwatcher]")
+{
+    ScopedJuceInitialiser_GUI gui;
+
+    TemporaryFile temporaryFolder;
+    auto root = temporaryFolder.getFile();
+    auto documents = root.getChildFile("Documents");
+    auto abstractions = documents.getChildFile("Abstractions");
+    REQUIRE(abstractions.createDirectory());
+
+    // The abstractions folder is excluded from the documents folder, but watched on its own
+    FileSystemWatcher watcher;
+    CollectingListener listener;
+    watcher.addFolder(documents, { abstractions });
+    watcher.addFolder(abstractions);
+    watcher.addListener(&listener);
+
+    runMessageLoopFor(300);
+
+    abstractions.getChildFile("osc.pd").replaceWithText("#N canvas 0 0 450 300 12;");
+
+    runMessageLoopFor(FileSystemWatcher::Listener::debounceMs * 4);
+
+    CHECK(listener.changedFiles.contains(abstractions.getChildFile("osc.pd")));
+
+    watcher.removeListener(&listener);
+    root.deleteRecursively();
+}
+
+#endif
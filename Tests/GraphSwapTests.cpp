@@ -0,0 +1,44 @@
+#include <catch2/catch_all.hpp>
+
+#include <juce_gui_basics/juce_gui_basics.h>
+#include <juce_audio_basics/juce_audio_basics.h>
+#define Rectangle juce::Rectangle
+
+#include <Utility/Config.h>
+#include <Pd/GraphSwap.h>
+
+TEST_CASE("Graph swap only suspends DSP for patches with signal objects", "[graphswap]")
+{
+    TemporaryFile temporaryFolder;
+    auto folder = temporaryFolder.getFile();
+    REQUIRE(folder.createDirectory());
+
+    auto controlPatch = folder.getChildFile("control.pd");
+    controlPatch.replaceWithText("#N canvas 0 50 450 300 12;\n"
+                                 "#X obj 20 20 metro 100;\n"
+                                 "#X obj 20 60 print tilde~;\n"
+                                 "#X connect 0 0 1 0;\n");
+    CHECK(!pd::GraphSwap::containsSignalObjects(controlPatch));
+
+    auto signalPatch = folder.getChildFile("signal.pd");
+    signalPatch.replaceWithText("#N canvas 0 50 450 300 12;\n"
+                                "#X obj 20 20 osc~ 440;\n"
+                                "#X obj 20 60 dac~;\n"
+                                "#X connect 0 0 1 0;\n");
+    CHECK(pd::GraphSwap::containsSignalObjects(signalPatch));
+
+    // Signal objects inside an abstraction next to the patch, and an abstraction that contains itself
+    auto parentPatch = folder.getChildFile("parent.pd");
+    parentPatch.replaceWithText("#N canvas 0 50 450 300 12;\n"
+                                "#X obj 20 20 parent;\n"
+                                "#X obj 20 60 signal;\n");
+    CHECK(pd::GraphSwap::containsSignalObjects(parentPatch));
+
+    auto recursivePatch = folder.getChildFile("recursive.pd");
+    recursivePatch.replaceWithText("#N canvas 0 50 450 300 12;\n"
+                                   "#X obj 20 20 recursive;\n"
+                                   "#X obj 20 60 control;\n");
+    CHECK(!pd::GraphSwap::containsSignalObjects(recursivePatch));
+
+    folder.deleteRecursively();
+}
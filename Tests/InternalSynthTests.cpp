@@ -0,0 +1,75 @@
+#include <catch2/catch_all.hpp>
+
+#include <juce_audio_basics/juce_audio_basics.h>
+
+#include <Utility/Config.h>
+#include <FluidLite/include/fluidlite.h>
+
+static File getTestSoundFont()
+{
+    return File(__FILE__).getParentDirectory().getParentDirectory().getChildFile("Libraries/FluidLite/example/sf_/Boomwhacker.sf2");
+}
+
+struct FluidSynthInstance {
+    FluidSynthInstance(File const& soundFont, int polyphony, double sampleRate = 48000.0)
+    {
+        settings = new_fluid_settings();
+        fluid_settings_setint(settings, "synth.polyphony", polyphony);
+        fluid_settings_setnum(settings, "synth.sample-rate", sampleRate);
+        synth = new_fluid_synth(settings);
+        loaded = fluid_synth_sfload(synth, soundFont.getFullPathName().toRawUTF8(), 1) >= 0;
+    }
+
+    ~FluidSynthInstance()
+    {
+        delete_fluid_synth(synth);
+        delete_fluid_settings(settings);
+    }
+
+    void render(AudioBuffer<float>& buffer)
+    {
+        auto* const* output = buffer.getArrayOfWritePointers();
+        fluid_synth_write_float(synth, buffer.getNumSamples(), output[0], 0, 1, output[1], 0, 1);
+    }
+
+    fluid_settings_t* settings;
+    fluid_synth_t* synth;
+    bool loaded;
+};
+
+TEST_CASE("Lowering the polyphony steals the least important voices", "[internalsynth]")
+{
+    FluidSynthInstance fluid(getTestSoundFont(), 256);
+    REQUIRE(fluid.loaded);
+
+    AudioBuffer<float> buffer(2, 256);
+
+    // Start eight notes one after the other, then release the oldest four
+    for (int note = 0; note < 8; note++) {
+        fluid_synth_noteon(fluid.synth, 0, 60 + note, 100);
+        fluid.render(buffer);
+    }
+    for (int note = 0; note < 4; note++) {
+        fluid_synth_noteoff(fluid.synth, 0, 60 + note);
+    }
+    fluid.render(buffer);
+
+    auto voicesPerNote = fluid_synth_get_active_voice_count(fluid.synth) / 8;
+    REQUIRE(voicesPerNote > 0);
+
+    // Only the notes that are still held should survive
+    REQUIRE(fluid_synth_set_polyphony(fluid.synth, voicesPerNote * 4) == 0);
+    CHECK(fluid_synth_get_active_voice_count(fluid.synth) == voicesPerNote * 4);
+
+    std::vector<fluid_voice_t*> voices(257, nullptr);
+    fluid_synth_get_voicelist(fluid.synth, voices.data(), static_cast<int>(voices.size()), -1);
+    for (auto* voice : voices) {
+        if (!voice)
+            break;
+        CHECK(fluid_voice_get_id(voice) >= 4);
+    }
+
+    // Raising the limit again doesn't bring back any voices
+    REQUIRE(fluid_synth_set_polyphony(fluid.synth, 256) == 0);
+    CHECK(fluid_synth_get_active_voice_count(fluid.synth) == voicesPerNote * 4);
+}
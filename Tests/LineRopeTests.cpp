@@ -0,0 +1,53 @@
+#include <catch2/catch_all.hpp>
+
+#include <juce_gui_basics/juce_gui_basics.h>
+#define Rectangle juce::Rectangle
+
+#include <Utility/Config.h>
+#include <Utility/LineRope.h>
+
+TEST_CASE("Line rope behaves like an array", "[linerope]")
+{
+    LineRope<String, 8> rope;
+    StringArray reference;
+    Random random(7);
+
+    for (int i = 0; i < 100; i++) {
+        rope.add(String(i));
+        reference.add(String(i));
+    }
+
+    for (int i = 0; i < 2000; i++) {
+        if (random.nextInt(3) != 0 || reference.isEmpty()) {
+            auto const index = random.nextInt(reference.size() + 1);
+            rope.insert(index, "inserted " + String(i));
+            reference.insert(index, "inserted " + String(i));
+        } else {
+            auto const index = random.nextInt(reference.size());
+            auto const count = random.nextInt(jmin(3, reference.size() - index) + 1);
+            rope.removeRange(index, count);
+            reference.removeRange(index, count);
+        }
+
+        REQUIRE(rope.size() == reference.size());
+    }
+
+    for (int i = 0; i < reference.size(); i++) {
+        CHECK(rope[i] == reference[i]);
+    }
+
+    // Removing lines shouldn't leave lots of small chunks behind
+    CHECK(rope.getNumChunks() <= reference.size() / 2 + 1);
+
+    // Removing a range that spans many chunks
+    rope.removeRange(10, rope.size() - 20);
+    reference.removeRange(10, reference.size() - 20);
+    REQUIRE(rope.size() == reference.size());
+    for (int i = 0; i < reference.size(); i++) {
+        CHECK(rope[i] == reference[i]);
+    }
+
+    rope.removeRange(0, rope.size());
+    CHECK(rope.isEmpty());
+    CHECK(rope.getNumChunks() == 0);
+}
@@ -0,0 +1,81 @@
+#include <catch2/catch_all.hpp>
+
+#include <juce_dsp/juce_dsp.h>
+
+#include <Utility/Config.h>
+#include <Utility/Oversampler.h>
+
+// Runs a signal through the oversampler without processing anything at the higher rate
+static std::vector<float> runOversampler(Oversampler& oversampler, std::vector<float> const& input, int blockSize)
+{
+    auto output = input;
+    AudioBuffer<float> buffer(1, blockSize);
+
+    for (size_t start = 0; start + blockSize <= output.size(); start += blockSize) {
+        buffer.copyFrom(0, 0, output.data() + start, blockSize);
+
+        auto block = dsp::AudioBlock<float>(buffer);
+        oversampler.processSamplesUp(block);
+        oversampler.processSamplesDown(block);
+
+        FloatVectorOperations::copy(output.data() + start, buffer.getReadPointer(0), blockSize);
+    }
+
+    return output;
+}
+
+TEST_CASE("Linear phase oversampling nulls against the delayed dry signal", "[oversampling]")
+{
+    auto filter = GENERATE(Oversampler::FIR, Oversampler::FIRHighQuality);
+    auto factor = GENERATE(1, 2, 3);
+
+    constexpr double sampleRate = 48000.0;
+    constexpr int blockSize = 256;
+    constexpr int numSamples = blockSize * 64;
+
+    Oversampler oversampler;
+    oversampler.prepare(1, factor, filter, blockSize);
+
+    auto latency = oversampler.getLatencyInSamples();
+    REQUIRE(latency > 0);
+
+    // A few sines well inside the passband of the halfband filters
+    std::vector<float> dry(numSamples);
+    for (int n = 0; n < numSamples; n++) {
+        auto t = n / sampleRate;
+        dry[n] = static_cast<float>(0.4 * std::sin(MathConstants<double>::twoPi * 220.0 * t) + 0.3 * std::sin(MathConstants<double>::twoPi * 1000.0 * t) + 0.2 * std::sin(MathConstants<double>::twoPi * 3100.0 * t));
+    }
+
+    auto wet = runOversampler(oversampler, dry, blockSize);
+
+    // Skip the start, where the filters are still settling
+    double residualEnergy = 0.0;
+    double signalEnergy = 0.0;
+    for (int n = latency + 2048; n < numSamples; n++) {
+        auto difference = static_cast<double>(wet[n]) - dry[n - latency];
+        residualEnergy += difference * difference;
+        signalEnergy += static_cast<double>(dry[n - latency]) * dry[n - latency];
+    }
+
+    // Being off by a single sample would leave a residual of around -17dB
+    auto nullDepth = Decibels::gainToDecibels(std::sqrt(residualEnergy / signalEnergy), -200.0);
+    CHECK(nullDepth < -40.0);
+}
+
+TEST_CASE("Oversampler latency", "[oversampling]")
+{
+    Oversampler oversampler;
+
+    oversampler.prepare(2, 0, Oversampler::FIR, 512);
+    CHECK(oversampler.getLatencyInSamples() == 0);
+
+    // Steeper filters need more taps, so they can't have less latency
+    oversampler.prepare(2, 2, Oversampler::FIR, 512);
+    auto firLatency = oversampler.getLatencyInSamples();
+
+    oversampler.prepare(2, 2, Oversampler::FIRHighQuality, 512);
+    CHECK(oversampler.getLatencyInSamples() >= firLatency);
+
+    oversampler.prepare(2, 2, Oversampler::IIR, 512);
+    CHECK(oversampler.getLatencyInSamples() < firLatency);
+}
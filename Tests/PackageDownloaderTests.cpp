@@ -0,0 +1,176 @@
+#include <catch2/catch_all.hpp>
+
+#include <juce_gui_basics/juce_gui_basics.h>
+#define Rectangle juce::Rectangle
+
+#include <Utility/Config.h>
+#include <Utility/PackageDownloader.h>
+
+struct TestMirror {
+    TestMirror()
+    {
+        root.createDirectory();
+        mirror.createDirectory();
+
+        // A small deken package with a single abstraction in it
+        ZipFile::Builder builder;
+        auto patch = root.getChildFile("mypackage-help.pd");
+        patch.replaceWithText(String::repeatedString("#X obj 10 10 osc~ 440;\n", 2000));
+        builder.addFile(patch, 9, "mypackage/mypackage-help.pd");
+
+        FileOutputStream output(archive);
+        builder.writeToStream(output, nullptr);
+        output.flush();
+
+        checksum = PackageDownloader::getChecksum(archive);
+        archive.withFileExtension("dek.sha256").replaceWithText(checksum + "  " + archive.getFileName());
+    }
+
+    ~TestMirror()
+    {
+        root.deleteRecursively();
+    }
+
+    File root = File::getSpecialLocation(File::tempDirectory).getChildFile("PackageDownloaderTest_" + String::toHexString(Random::getSystemRandom().nextInt()));
+    File mirror = root.getChildFile("mirror");
+    File cache = root.getChildFile("cache");
+    File archive = mirror.getChildFile("mypackage[v1.0](Linux-amd64-32).dek");
+    String url = "https://deken.example.org/mypackage/mypackage%5Bv1.0%5D%28Linux-amd64-32%29.dek";
+    String checksum;
+
+    File getPartialFile() const
+    {
+        return cache.getChildFile(SHA256(url.toUTF8()).toHexString().substring(0, 16) + ".part");
+    }
+
+    PackageDownloader getDownloader(int64 maxCacheSize = PackageDownloader::defaultMaxCacheSize) const
+    {
+        return PackageDownloader(cache, URL(mirror).toString(false), maxCacheSize);
+    }
+};
+
+TEST_CASE("Package downloader installs from a file mirror and verifies the archive", "[deken]")
+{
+    TestMirror test;
+    auto downloader = test.getDownloader();
+
+    File archive;
+    float lastProgress = 0.0f;
+    auto result = downloader.fetch(test.url, archive, [&lastProgress](float progress) {
+        lastProgress = progress;
+        return true;
+    });
+
+    REQUIRE(result.wasOk());
+    CHECK(archive.isAChildOf(test.cache));
+    CHECK(archive.getFileNameWithoutExtension() == test.checksum);
+    CHECK(lastProgress == 1.0f);
+
+    auto destination = test.root.getChildFile("Externals");
+    REQUIRE(PackageDownloader::extract(archive, destination).wasOk());
+    CHECK(destination.getChildFile("mypackage").getChildFile("mypackage-help.pd").existsAsFile());
+
+    // Once the archive is cached, reinstalling works without the mirror
+    test.archive.withFileExtension("dek.sha256").deleteFile();
+    test.archive.deleteFile();
+
+    File cachedArchive;
+    REQUIRE(downloader.fetch(test.url, cachedArchive).wasOk());
+    CHECK(cachedArchive == archive);
+}
+
+TEST_CASE("Package downloader continues partial downloads", "[deken]")
+{
+    TestMirror test;
+    auto downloader = test.getDownloader();
+
+    // Pretend that a previous download stopped halfway
+    MemoryBlock data;
+    REQUIRE(test.archive.loadFileAsData(data));
+    test.cache.createDirectory();
+    auto partialFile = test.getPartialFile();
+    partialFile.replaceWithData(data.getData(), data.getSize() / 2);
+
+    int numProgressCallbacks = 0;
+    File archive;
+    auto result = downloader.fetch(test.url, archive, [&numProgressCallbacks](float progress) {
+        CHECK(progress > 0.4f);
+        numProgressCallbacks++;
+        return true;
+    });
+
+    REQUIRE(result.wasOk());
+    CHECK(numProgressCallbacks > 0);
+    CHECK(PackageDownloader::getChecksum(archive) == test.checksum);
+    CHECK(!partialFile.exists());
+}
+
+TEST_CASE("Package downloader rejects damaged archives", "[deken]")
+{
+    TestMirror test;
+    auto downloader = test.getDownloader();
+
+    test.archive.withFileExtension("dek.sha256").replaceWithText(String::repeatedString("0", 64));
+
+    File archive;
+    auto result = downloader.fetch(test.url, archive);
+
+    CHECK(result.failed());
+    CHECK(test.cache.findChildFiles(File::findFiles, false).isEmpty());
+}
+
+TEST_CASE("Package downloader starts over when a partial download can't be verified", "[deken]")
+{
+    TestMirror test;
+    auto downloader = test.getDownloader();
+
+    // Left over from a different version of the archive
+    test.cache.createDirectory();
+    auto partialFile = test.getPartialFile();
+    partialFile.replaceWithText(String::repeatedString("x", static_cast<int>(test.archive.getSize() / 2)));
+
+    SECTION("with a checksum")
+    {
+        File archive;
+        REQUIRE(downloader.fetch(test.url, archive).wasOk());
+        CHECK(PackageDownloader::getChecksum(archive) == test.checksum);
+    }
+
+    SECTION("without a checksum")
+    {
+        test.archive.withFileExtension("dek.sha256").deleteFile();
+
+        File archive;
+        REQUIRE(downloader.fetch(test.url, archive).wasOk());
+        CHECK(PackageDownloader::getChecksum(archive) == test.checksum);
+
+        // Unverified archives are not used as a reference when offline
+        test.archive.deleteFile();
+        CHECK(downloader.fetch(test.url, archive).failed());
+    }
+
+    CHECK(!partialFile.exists());
+}
+
+TEST_CASE("Package downloader evicts the least recently used archives", "[deken]")
+{
+    TestMirror test;
+
+    test.cache.createDirectory();
+    auto oldArchive = test.cache.getChildFile(String::repeatedString("a", 64) + ".dek");
+    oldArchive.replaceWithText(String::repeatedString("x", 1024));
+    oldArchive.setLastModificationTime(Time::getCurrentTime() - RelativeTime::days(1));
+
+    auto abandonedDownload = test.cache.getChildFile("0123456789abcdef.part");
+    abandonedDownload.replaceWithText("x");
+    abandonedDownload.setLastModificationTime(Time::getCurrentTime() - RelativeTime::days(30));
+
+    // Only room for the archive we're about to download
+    auto downloader = test.getDownloader(test.archive.getSize());
+
+    File archive;
+    REQUIRE(downloader.fetch(test.url, archive).wasOk());
+    CHECK(archive.existsAsFile());
+    CHECK(!oldArchive.exists());
+    CHECK(!abandonedDownload.exists());
+}
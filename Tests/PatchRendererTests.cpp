@@ -0,0 +1,69 @@
+#include <catch2/catch_all.hpp>
+
+#include <juce_gui_basics/juce_gui_basics.h>
+#define Rectangle juce::Rectangle
+
+#include <Utility/Config.h>
+#include <Utility/PatchRenderer.h>
+
+TEST_CASE("Patch renderer renders a patch into a wav file", "[renderer]")
+{
+    ScopedJuceInitialiser_GUI gui;
+
+    TemporaryFile patchFile(".pd");
+    TemporaryFile outputFile(".wav");
+    patchFile.getFile().replaceWithText("#N canvas 0 50 450 300 12;\n"
+                                        "#X obj 20 20 osc~ 440;\n"
+                                        "#X obj 20 60 *~ 0.5;\n"
+                                        "#X obj 20 100 dac~;\n"
+                                        "#X connect 0 0 1 0;\n"
+                                        "#X connect 1 0 2 0;\n"
+                                        "#X connect 1 0 2 1;\n");
+
+    PatchRenderer::Settings settings;
+    settings.patchFile = patchFile.getFile();
+    settings.outputFile = outputFile.getFile();
+    settings.lengthInSeconds = 1.0;
+    settings.sampleRate = 48000.0;
+    settings.blockSize = 100;
+
+    PatchRenderer renderer(settings);
+    REQUIRE(renderer.prepare().wasOk());
+    REQUIRE(renderer.render().wasOk());
+
+    auto const& statistics = renderer.getStatistics();
+    CHECK(statistics.audioSeconds == Catch::Approx(1.0));
+    CHECK(statistics.renderSeconds > 0.0);
+    CHECK(statistics.peakLevel > 0.1f);
+
+    WavAudioFormat format;
+    std::unique_ptr<AudioFormatReader> reader(format.createReaderFor(outputFile.getFile().createInputStream().release(), true));
+    REQUIRE(reader != nullptr);
+    CHECK(reader->numChannels == 2);
+    CHECK(reader->lengthInSamples == 48000);
+    CHECK(reader->sampleRate == 48000.0);
+}
+
+TEST_CASE("Patch renderer rejects invalid input files", "[renderer]")
+{
+    ScopedJuceInitialiser_GUI gui;
+
+    TemporaryFile patchFile(".pd");
+    TemporaryFile automationFile(".txt");
+    patchFile.getFile().replaceWithText("#N canvas 0 50 450 300 12;\n");
+    automationFile.getFile().replaceWithText("# time parameter value\n"
+                                             "0.0 volume 0.8\n"
+                                             "1.5 volume\n");
+
+    PatchRenderer::Settings settings;
+    settings.patchFile = patchFile.getFile();
+    settings.automationFile = automationFile.getFile();
+
+    auto result = PatchRenderer(settings).prepare();
+    CHECK(result.failed());
+    CHECK(result.getErrorMessage().contains("line 3"));
+
+    settings.automationFile = File();
+    settings.patchFile = patchFile.getFile().getSiblingFile("does_not_exist.pd");
+    CHECK(PatchRenderer(settings).prepare().failed());
+}
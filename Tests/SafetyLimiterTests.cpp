@@ -0,0 +1,60 @@
+#include <catch2/catch_all.hpp>
+
+#include <juce_dsp/juce_dsp.h>
+
+#include <Utility/Config.h>
+#include <Utility/SafetyLimiter.h>
+
+static AudioBuffer<float> createNoise(int numChannels, int numSamples, float level, Random& random)
+{
+    AudioBuffer<float> buffer(numChannels, numSamples);
+    for (int ch = 0; ch < numChannels; ch++) {
+        for (int n = 0; n < numSamples; n++) {
+            buffer.setSample(ch, n, (random.nextFloat() * 2.0f - 1.0f) * level);
+        }
+    }
+    return buffer;
+}
+
+TEST_CASE("Sanitiser removes NaN, Inf and denormals", "[protectedmode]")
+{
+    // Use an odd length, so the scalar tail gets tested too
+    std::vector<float> samples(37, 0.25f);
+    samples[0] = std::numeric_limits<float>::quiet_NaN();
+    samples[5] = std::numeric_limits<float>::infinity();
+    samples[6] = -std::numeric_limits<float>::infinity();
+    samples[20] = std::numeric_limits<float>::denorm_min();
+    samples[36] = std::numeric_limits<float>::quiet_NaN();
+
+    CHECK(SafetyLimiter::sanitise(samples.data(), static_cast<int>(samples.size())) == 4);
+
+    for (size_t i = 0; i < samples.size(); i++) {
+        auto isFault = i == 0 || i == 5 || i == 6 || i == 20 || i == 36;
+        CHECK(samples[i] == (isFault ? 0.0f : 0.25f));
+    }
+}
+
+TEST_CASE("Safety limiter keeps the output under the threshold", "[protectedmode]")
+{
+    Random random(42);
+
+    SafetyLimiter limiter;
+    limiter.prepare(48000.0, 512);
+
+    // Quiet signals pass through untouched
+    auto quiet = createNoise(2, 512, 0.5f, random);
+    auto quietCopy = quiet;
+    auto quietBlock = dsp::AudioBlock<float>(quiet);
+    limiter.process(quietBlock);
+
+    for (int ch = 0; ch < 2; ch++) {
+        CHECK(std::memcmp(quiet.getReadPointer(ch), quietCopy.getReadPointer(ch), 512 * sizeof(float)) == 0);
+    }
+
+    // Loud signals are limited, also when the host sends larger blocks than announced
+    auto loud = createNoise(2, 2000, 8.0f, random);
+    auto loudBlock = dsp::AudioBlock<float>(loud);
+    limiter.process(loudBlock);
+
+    CHECK(loud.getMagnitude(0, loud.getNumSamples()) <= SafetyLimiter::threshold + 1e-6f);
+}
@@ -0,0 +1,64 @@
+#include <catch2/catch_all.hpp>
+
+#include <juce_graphics/juce_graphics.h>
+#define Rectangle juce::Rectangle
+
+#include <Utility/StackShadow.h>
+
+static Image createNoiseImage(Image::PixelFormat format, int width, int height, Random& random)
+{
+    auto image = Image(format, width, height, true, SoftwareImageType());
+    Image::BitmapData data(image, Image::BitmapData::readWrite);
+
+    for (int y = 0; y < height; y++) {
+        for (int x = 0; x < width; x++) {
+            // Keep ARGB pixels premultiplied, like JUCE expects
+            auto alpha = static_cast<uint8>(random.nextInt(256));
+            auto colour = Colour(static_cast<uint8>(random.nextInt(256)), static_cast<uint8>(random.nextInt(256)), static_cast<uint8>(random.nextInt(256)), alpha);
+            data.setPixelColour(x, y, format == Image::SingleChannel ? Colours::white.withAlpha(alpha) : colour);
+        }
+    }
+
+    return image;
+}
+
+static bool imagesAreEqual(Image const& a, Image const& b)
+{
+    Image::BitmapData dataA(a, Image::BitmapData::readOnly);
+    Image::BitmapData dataB(b, Image::BitmapData::readOnly);
+
+    for (int y = 0; y < a.getHeight(); y++) {
+        if (std::memcmp(dataA.getLinePointer(y), dataB.getLinePointer(y), static_cast<size_t>(a.getWidth() * dataA.pixelStride)) != 0)
+            return false;
+    }
+
+    return true;
+}
+
+TEST_CASE("Vectorised stack blur matches scalar version", "[stackblur]")
+{
+    Random random(42);
+
+    auto format = GENERATE(Image::ARGB, Image::RGB, Image::SingleChannel);
+    auto radius = GENERATE(1, 2, 6, 12, 60, 254);
+    auto size = GENERATE(std::pair<int, int>(1, 1), std::pair<int, int>(3, 17), std::pair<int, int>(64, 5), std::pair<int, int>(301, 299));
+
+    // Make sure the multithreaded path gets tested for the larger images
+    StackBlur::multithreadingThreshold = 64 * 64;
+
+    auto reference = createNoiseImage(format, size.first, size.second, random);
+    auto vectorised = reference.createCopy();
+
+    if (format == Image::ARGB)
+        StackShadow::applyStackBlurARGB(reference, static_cast<unsigned int>(radius));
+    if (format == Image::RGB)
+        StackShadow::applyStackBlurRGB(reference, static_cast<unsigned int>(radius));
+    if (format == Image::SingleChannel)
+        StackShadow::applyStackBlurBW(reference, static_cast<unsigned int>(radius));
+
+    StackShadow::applyStackBlur(vectorised, radius);
+
+    CHECK(imagesAreEqual(reference, vectorised));
+
+    StackBlur::multithreadingThreshold = 256 * 256;
+}
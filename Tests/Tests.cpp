@@ -5,6 +5,7 @@
 #define Rectangle juce::Rectangle
 
 #include <PluginProcessor.h>
+#include <Utility/SpatialIndex.h>
 
 
 #include <juce_core/system/juce_TargetPlatform.h>
@@ -77,3 +78,36 @@ TEST_CASE("Create and delete objects", "[name]")
     
     StopApplicationAfter(1500);
 }
+
+TEST_CASE("Spatial index finds items in area", "[culling]")
+{
+    SpatialIndex<int, 64> index;
+    int items[4];
+
+    index.insert(&items[0], { 10, 10, 20, 20 });
+    index.insert(&items[1], { -200, -200, 20, 20 });
+    index.insert(&items[2], { 0, 0, 1000, 1000 }); // Spans many cells
+    index.insert(&items[3], { 500, 500, 20, 20 });
+
+    auto findItems = [&index](Rectangle<int> area) {
+        Array<int*> found;
+        index.findItemsInArea(area, [&found](int* item) { found.add(item); });
+        return found;
+    };
+
+    auto found = findItems({ 0, 0, 100, 100 });
+    CHECK(found.size() == 2);
+    CHECK(found.contains(&items[0]));
+    CHECK(found.contains(&items[2]));
+
+    CHECK(findItems({ -250, -250, 100, 100 }).contains(&items[1]));
+
+    // Move an item, and make sure it's only found at the new position
+    index.insert(&items[3], { -100, 2000, 20, 20 });
+    CHECK(!findItems({ 490, 490, 40, 40 }).contains(&items[3]));
+    CHECK(findItems({ -100, 2000, 5, 5 }).contains(&items[3]));
+
+    index.remove(&items[2]);
+    CHECK(findItems({ 0, 0, 100, 100 }).size() == 1);
+    CHECK(index.size() == 3);
+}
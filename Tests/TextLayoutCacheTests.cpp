@@ -0,0 +1,70 @@
+#include <catch2/catch_all.hpp>
+
+#include <juce_gui_basics/juce_gui_basics.h>
+#define Rectangle juce::Rectangle
+
+#include <Utility/Config.h>
+#include <Utility/TextLayoutCache.h>
+
+TEST_CASE("Text layout cache returns the same widths as the font", "[textcache]")
+{
+    TextLayoutCache::clear();
+    auto font = Font(15.0f);
+
+    for (auto text : { "osc~ 440", "metro 100", "", "t b b f" }) {
+        CHECK(TextLayoutCache::getStringWidthFloat(text, font) == font.getStringWidthFloat(text));
+        CHECK(TextLayoutCache::getStringWidth(text, font) == font.getStringWidth(text));
+    }
+
+    // The widest line decides the width of multi-line text
+    CHECK(TextLayoutCache::getWidestLineWidth("f\nmessage box", font) == font.getStringWidthFloat("message box"));
+
+    // Different fonts don't share entries
+    CHECK(TextLayoutCache::getStringWidthFloat("osc~ 440", font.withHeight(30.0f)) == font.withHeight(30.0f).getStringWidthFloat("osc~ 440"));
+}
+
+TEST_CASE("Text layout cache breaks lines like Pd", "[textcache]")
+{
+    auto font = Font(15.0f);
+
+    CHECK(TextLayoutCache::getNumLines("set 1", font, 200.0f) == 1);
+    CHECK(TextLayoutCache::getNumLines("set 1;\nset 2;\nset 3", font, 200.0f) == 3);
+
+    // Wrapping a long line
+    auto longText = String::repeatedString("abcd ", 20);
+    auto width = font.getStringWidthFloat(longText);
+    CHECK(TextLayoutCache::getNumLines(longText, font, width / 3.5f) == 4);
+}
+
+TEST_CASE("Text layout cache evicts the least recently used entries", "[textcache]")
+{
+    TextLayoutCache::clear();
+    auto font = Font(15.0f);
+
+    auto const previousLimit = TextLayoutCache::maxCachedEntries;
+    TextLayoutCache::maxCachedEntries = 4;
+
+    auto before = TextLayoutCache::getStats();
+    for (int i = 0; i < 4; i++) {
+        TextLayoutCache::getStringWidth("object " + String(i), font);
+    }
+
+    // Touch the oldest entry, so "object 1" becomes the least recently used
+    TextLayoutCache::getStringWidth("object 0", font);
+    TextLayoutCache::getStringWidth("object 4", font);
+
+    auto after = TextLayoutCache::getStats();
+    CHECK(after.numEntries == 4);
+    CHECK(after.hits - before.hits == 1);
+    CHECK(after.misses - before.misses == 5);
+    CHECK(after.evictions - before.evictions == 1);
+
+    TextLayoutCache::getStringWidth("object 0", font);
+    CHECK(TextLayoutCache::getStats().hits - after.hits == 1);
+
+    TextLayoutCache::getStringWidth("object 1", font);
+    CHECK(TextLayoutCache::getStats().misses - after.misses == 1);
+
+    TextLayoutCache::maxCachedEntries = previousLimit;
+    TextLayoutCache::clear();
+}
@@ -0,0 +1,79 @@
+#include <catch2/catch_all.hpp>
+
+#include <juce_graphics/juce_graphics.h>
+#define Rectangle juce::Rectangle
+
+#include <Utility/Config.h>
+#include <Utility/WidgetLayerCache.h>
+
+static bool imagesAreEqual(Image const& a, Image const& b)
+{
+    for (int y = 0; y < a.getHeight(); y++) {
+        for (int x = 0; x < a.getWidth(); x++) {
+            if (a.getPixelAt(x, y) != b.getPixelAt(x, y))
+                return false;
+        }
+    }
+    return true;
+}
+
+TEST_CASE("Widget layers are rendered once and shared", "[widgetlayers]")
+{
+    WidgetLayerCache::clear();
+
+    int numRenders = 0;
+    auto render = [&numRenders](Graphics& g) {
+        numRenders++;
+        g.setColour(Colours::red);
+        g.fillRect(2, 2, 16, 36);
+    };
+
+    auto style = WidgetLayerCache::makeStyle("test", { Colours::red });
+    auto before = WidgetLayerCache::getStats();
+
+    Image expected(Image::ARGB, 20, 40, true);
+    {
+        Graphics g(expected);
+        render(g);
+    }
+
+    for (int i = 0; i < 3; i++) {
+        Image image(Image::ARGB, 20, 40, true);
+        Graphics g(image);
+        WidgetLayerCache::draw(g, style, 20, 40, render);
+        CHECK(imagesAreEqual(image, expected));
+    }
+
+    // The first render was for the reference image
+    CHECK(numRenders == 2);
+
+    auto after = WidgetLayerCache::getStats();
+    CHECK(after.misses - before.misses == 1);
+    CHECK(after.hits - before.hits == 2);
+
+    // A different style or size gets its own layer
+    Image image(Image::ARGB, 20, 40, true);
+    Graphics g(image);
+    WidgetLayerCache::draw(g, WidgetLayerCache::makeStyle("test", { Colours::blue }), 20, 40, render);
+    WidgetLayerCache::draw(g, style, 20, 30, render);
+    CHECK(numRenders == 4);
+}
+
+TEST_CASE("Widget layer regions only draw the requested part", "[widgetlayers]")
+{
+    WidgetLayerCache::clear();
+
+    auto render = [](Graphics& g) {
+        g.fillAll(Colours::white);
+    };
+
+    Image image(Image::ARGB, 10, 100, true);
+    {
+        Graphics g(image);
+        WidgetLayerCache::drawRegion(g, WidgetLayerCache::makeStyle("strip", {}), 10, 100, { 0.0f, 60.0f, 10.0f, 40.0f }, render);
+    }
+
+    CHECK(image.getPixelAt(5, 59).getAlpha() == 0);
+    CHECK(image.getPixelAt(5, 60) == Colours::white);
+    CHECK(image.getPixelAt(5, 99) == Colours::white);
+}